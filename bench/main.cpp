@@ -0,0 +1,671 @@
+/// @date 2026-10-16 (last modification)
+/// Microbenchmarks of typed quantities, scalars and vectors against hand-written raw `float` equivalents.
+/// Every pair runs over working sets from L1 to DRAM. A human readable table goes to `std::clog`, JSON with all
+/// samples summarised (median, percentiles, items/s) and the "abstraction penalty" (typed/raw median) to `std::cout`
+/// or to the file given after `--out`. `--quick` limits sizes and samples, e.g. for CI.
+/// Build in release mode, e.g. `cmake -DCMAKE_BUILD_TYPE=Release`. JSON tells whether it was optimised.
+///
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_vec_batch.h"
+#include "mth_vec_expr.h"
+#include "mth_vec_compact.h"
+#include "mth_fix_float.h"
+#include "flw_parallel.h"
+#include "ios_benders.h"
+#include "ios_format.h"
+#include "ios_parse.h"
+#include "ios_logging.h"
+#include "ios_profiling.h"
+#include "mem_pool.h"
+#include "mem_registry.h"
+#include "mth_geodesy.h"
+#include "mth_vec_anchored.h"
+#include "mth_units.h"
+#include "mth_vec_algebra.h"
+#include "mth_nbody.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace merry_tools::bench {
+
+    using namespace merry_tools::math;
+    using namespace merry_tools::iostreams;
+
+    // HARNESS:
+    //*////////
+
+    /// @brief Keeps the compiler from removing calculations whose results are never read.
+    template<class T>
+    inline void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void* sink; sink=&value;
+#endif
+    }
+
+    /// @brief Summary of one benchmark at one size.
+    struct result {
+        std::string name;              //!< What is measured, e.g. "vec3d_advance_aos"
+        std::string variant;           //!< "typed" or "raw" of a pair, any other, e.g. "tree", alone
+        std::size_t items=0;           //!< Elements processed by a single run.
+        std::size_t bytes=0;           //!< Working set of a single run.
+        double      median_ns=0;       //!< Median time of a single item.
+        double      p10_ns=0;          //!< 10th percentile of time of a single item.
+        double      p90_ns=0;          //!< 90th percentile of time of a single item.
+        double      items_per_sec=0;   //!< Items per second at the median.
+    };
+
+    /// @brief Settings of the whole run.
+    struct settings {
+        std::size_t samples=15;        //!< Timed samples for every result.
+        double      min_sample_s=2e-4; //!< Single sample repeats the kernel at least that long.
+        std::vector<std::size_t> sizes{1u<<10,1u<<14,1u<<18,1u<<22};   //!< Elements: L1, L2, L3, DRAM.
+    };
+
+    /// @brief Percentile of sorted samples, by nearest rank.
+    inline double percentile(const std::vector<double>& sorted,double p) {
+        std::size_t k=static_cast<std::size_t>(p*double(sorted.size()-1)+0.5);
+        return sorted[std::min(k,sorted.size()-1)];
+    }
+
+    /// @brief Warmup, calibration of repetitions per sample, then `samples` timed samples of `kernel()`.
+    template<class KERNEL>
+    result measure(const settings& cfg,const char* name,const char* variant,std::size_t items,std::size_t bytes,
+                   KERNEL&& kernel) {
+        typedef std::chrono::steady_clock clock;
+        std::size_t repeat=1;
+        for(;;) {                                                               // Warmup and calibration at once.
+            auto t0=clock::now();
+            for(std::size_t r=0;r<repeat;r++) kernel();
+            double s=std::chrono::duration<double>(clock::now()-t0).count();
+            if(s>=cfg.min_sample_s || repeat>=(1u<<20)) break;
+            repeat*=2;
+        }
+        std::vector<double> per_item;
+        per_item.reserve(cfg.samples);
+        for(std::size_t k=0;k<cfg.samples;k++) {
+            auto t0=clock::now();
+            for(std::size_t r=0;r<repeat;r++) kernel();
+            double s=std::chrono::duration<double>(clock::now()-t0).count();
+            per_item.push_back(s*1e9/double(repeat*items));
+        }
+        std::sort(per_item.begin(),per_item.end());
+        result res;
+        res.name=name; res.variant=variant; res.items=items; res.bytes=bytes;
+        res.median_ns=percentile(per_item,0.5);
+        res.p10_ns=percentile(per_item,0.1);
+        res.p90_ns=percentile(per_item,0.9);
+        res.items_per_sec=res.median_ns>0?1e9/res.median_ns:0;
+        return res;
+    }
+
+    // BENCHMARKS, IN PAIRS TYPED/RAW:
+    //*//////////////////////////////////////
+
+    /// @brief `d+v*t` on `Quantity` arrays.
+    void quantities(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        std::vector<DistSI> d(n,0_m),r(n,0_m); std::vector<VelocitySI> v(n,0_m_s); std::vector<TimeSI> t(n,0_s);
+        std::vector<float> rd(n),rr(n),rv(n),rt(n);
+        for(std::size_t i=0;i<n;i++) {
+            d[i]=DistSI{i*0.5}; v[i]=VelocitySI{1.0+i%7}; t[i]=TimeSI{0.01*(i%3)};
+            rd[i]=d[i].value;   rv[i]=v[i].value;         rt[i]=t[i].value;
+        }
+        const std::size_t bytes=n*4*sizeof(float);
+        out.push_back(measure(cfg,"quantity_fma","typed",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) r[i]=d[i]+v[i]*t[i];
+            keep(r[n-1]);
+        }));
+        out.push_back(measure(cfg,"quantity_fma","raw",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) rr[i]=rd[i]+rv[i]*rt[i];
+            keep(rr[n-1]);
+        }));
+    }
+
+    /// @brief `x+vx*dt` on `Scalar` arrays (axis checked).
+    void scalars(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        std::vector<Longitude> x(n,Longitude{0_m}),r(n,Longitude{0_m}); std::vector<VelAlong> v(n,VelAlong{0_m_s});
+        std::vector<float> rx(n),rr(n),rv(n);
+        const TimeSI dt=0.01_s;
+        for(std::size_t i=0;i<n;i++) {
+            x[i]=Longitude{DistSI{i*0.5}}; v[i]=VelAlong{VelocitySI{1.0+i%7}};
+            rx[i]=x[i].val.value;          rv[i]=v[i].val.value;
+        }
+        const std::size_t bytes=n*3*sizeof(float);
+        out.push_back(measure(cfg,"scalar_advance","typed",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) r[i]=x[i]+v[i]*dt;
+            keep(r[n-1]);
+        }));
+        out.push_back(measure(cfg,"scalar_advance","raw",n,bytes,[&] {
+            const float fdt=dt.value;
+            for(std::size_t i=0;i<n;i++) rr[i]=rx[i]+rv[i]*fdt;
+            keep(rr[n-1]);
+        }));
+    }
+
+    /// @brief `p+v*dt+a*dt*dt/2` on `Vec3D`: AoS with expression templates, SoA fused, SoA batch kernel.
+    void vectors3d(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        const VolumePosition zero=xD(Longitude{0_m},Latitude{0_m},Altitude{0_m});
+        std::vector<VolumePosition> p(n,zero),r(n,zero);
+        std::vector<VolumeVelocity> v(n,xD(VelAlong{1_m_s},VelAcross{2_m_s},VelUpward{3_m_s}));
+        std::vector<VolumeAcceleration> a(n,xD(AccAlong{0_m_s2},AccAcross{0_m_s2},AccUpward{-9.81_m_s2}));
+        std::vector<float> rp(3*n),rr(3*n),rv(3*n),ra(3*n);
+        for(std::size_t i=0;i<n;i++) {
+            p[i]=xD(Longitude{DistSI{i*1.0}},Latitude{DistSI{i*-0.5}},Altitude{DistSI{100.0}});
+            rp[3*i]=p[i].x.val.value; rp[3*i+1]=p[i].y.val.value; rp[3*i+2]=p[i].z.val.value;
+            rv[3*i]=v[i].x.val.value; rv[3*i+1]=v[i].y.val.value; rv[3*i+2]=v[i].z.val.value;
+            ra[3*i]=a[i].x.val.value; ra[3*i+1]=a[i].y.val.value; ra[3*i+2]=a[i].z.val.value;
+        }
+        const TimeSpan dt{0.01_s};
+        const std::size_t bytes=n*4*3*sizeof(float);
+        out.push_back(measure(cfg,"vec3d_advance_aos","typed",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) r[i]=p[i]+v[i]*dt+a[i]*dt*dt/2;
+            keep(r[n-1]);
+        }));
+        out.push_back(measure(cfg,"vec3d_advance_aos","raw",n,bytes,[&] {
+            const float h=dt.val.value;
+            for(std::size_t i=0;i<3*n;i++) rr[i]=rp[i]+rv[i]*h+ra[i]*h*h/2;
+            keep(rr[n-1]);
+        }));
+
+        VolumeArray<VolumePosition> P(n),R(n); VolumeArray<VolumeVelocity> V(n); VolumeArray<VolumeAcceleration> A(n);
+        for(std::size_t i=0;i<n;i++) { P[i]=p[i]; V[i]=v[i]; A[i]=a[i]; }
+        std::vector<float> cols[4][3];
+        for(auto& c:cols) for(auto& col:c) col.resize(n);
+        for(std::size_t i=0;i<n;i++) for(int k=0;k<3;k++) {
+            cols[0][k][i]=rp[3*i+k]; cols[2][k][i]=rv[3*i+k]; cols[3][k][i]=ra[3*i+k];
+        }
+        out.push_back(measure(cfg,"vec3d_advance_soa","typed",n,bytes,[&] {
+            evaluate(lazy(P)+lazy(V)*dt+lazy(A)*dt*dt/2,R);
+            keep(R.xs()[n-1]);
+        }));
+        out.push_back(measure(cfg,"vec3d_advance_soa","raw",n,bytes,[&] {
+            const float h=dt.val.value;
+            for(int k=0;k<3;k++) {
+                const float* pk=cols[0][k].data(); const float* vk=cols[2][k].data(); const float* ak=cols[3][k].data();
+                float* rk=cols[1][k].data();
+                for(std::size_t i=0;i<n;i++) rk[i]=pk[i]+vk[i]*h+ak[i]*h*h/2;
+            }
+            keep(cols[1][0][n-1]);
+        }));
+
+        const std::size_t bytes2=n*3*3*sizeof(float);
+        out.push_back(measure(cfg,"vec3d_batch_advance","typed",n,bytes2,[&] {
+            batch_advance(P,V,dt,R);
+            keep(R.xs()[n-1]);
+        }));
+        out.push_back(measure(cfg,"vec3d_batch_advance","raw",n,bytes2,[&] {
+            const float h=dt.val.value;
+            for(std::size_t i=0;i<3*n;i++) rr[i]=rp[i]+rv[i]*h;
+            keep(rr[n-1]);
+        }));
+    }
+
+    /// @brief Encoding and decoding of `UFloat16`, single and bulk, against manual rounding to the same grid.
+    void ufloat16(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        std::vector<float> src(n),dst(n); std::vector<UFloat16> packed(n); std::vector<std::uint16_t> raw(n);
+        for(std::size_t i=0;i<n;i++) src[i]=float(i%30000)*0.75f;
+        const std::size_t bytes=n*(sizeof(float)*2+sizeof(std::uint16_t));
+        auto raw_roundtrip=[&] {
+            for(std::size_t i=0;i<n;i++)
+                raw[i]=static_cast<std::uint16_t>(std::nearbyint(std::min(std::max(2.0f*src[i],0.0f),65534.0f)));
+            for(std::size_t i=0;i<n;i++) dst[i]=0.5f*float(raw[i]);
+            keep(dst[n-1]);
+        };
+        out.push_back(measure(cfg,"ufloat16_roundtrip","typed",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) packed[i]=src[i];
+            for(std::size_t i=0;i<n;i++) dst[i]=packed[i];
+            keep(dst[n-1]);
+        }));
+        out.push_back(measure(cfg,"ufloat16_roundtrip","raw",n,bytes,raw_roundtrip));
+        out.push_back(measure(cfg,"ufloat16_bulk","typed",n,bytes,[&] {
+            UFloat16::encode(src,packed);
+            UFloat16::decode(packed,dst);
+            keep(dst[n-1]);
+        }));
+        out.push_back(measure(cfg,"ufloat16_bulk","raw",n,bytes,raw_roundtrip));
+    }
+
+    /// @brief Bulk decoding of `CompactArray` against a hand-written loop over the same blocks of 16-bit codes.
+    void compact(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        VolumeArray<VolumePosition> P(n),R(n);
+        for(std::size_t i=0;i<n;i++)
+            P[i]=xD(Longitude{DistSI{float(i%5000)}},Latitude{DistSI{i*-0.25f}},Altitude{DistSI{float(i%300)}});
+        const CompactVolumeArray<VolumePosition> C(P);
+        const std::size_t block=C.block_size;
+        std::vector<std::int16_t> codes(3*n); std::vector<float> origins(3*C.blocks()),steps(3*C.blocks());
+        std::vector<float> raw(3*n);
+        for(std::size_t k=0;k<3;k++) {
+            const std::int16_t* col=k==0?C.column<0>():k==1?C.column<1>():C.column<2>();
+            std::copy(col,col+n,codes.begin()+k*n);
+            for(std::size_t b=0;b<C.blocks();b++) {
+                origins[k*C.blocks()+b]=C.frame(b).origin[k];
+                steps[k*C.blocks()+b]=C.frame(b).step[k];
+            }
+        }
+        const std::size_t bytes=n*3*(sizeof(std::int16_t)+sizeof(float));
+        out.push_back(measure(cfg,"compact_decode","typed",n,bytes,[&] {
+            C.decode(R);
+            keep(R.xs()[n-1]);
+        }));
+        out.push_back(measure(cfg,"compact_decode","raw",n,bytes,[&] {
+            for(std::size_t k=0;k<3;k++)
+                for(std::size_t b=0;b*block<n;b++) {
+                    const float o=origins[k*C.blocks()+b],h=steps[k*C.blocks()+b];
+                    for(std::size_t i=b*block;i<std::min(n,(b+1)*block);i++) raw[k*n+i]=float(codes[k*n+i])*h+o;
+                }
+            keep(raw[n-1]);
+        }));
+    }
+
+    /// @brief A parallel step of `d+v*t` on the pool against `std::thread`s spawned for every step, like before.
+    void parallel_step(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        std::vector<VolumePosition> P(n,xD(Longitude{0_m},Latitude{0_m},Altitude{0_m}));
+        std::vector<VolumeVelocity> V(n,xD(VelAlong{1_m_s},VelAcross{0_m_s},VelUpward{-2_m_s}));
+        for(std::size_t i=0;i<n;i++) V[i].y=VelAcross{VelocitySI{i*0.5f}};
+        const TimeSpan dt{0.01_s};
+        const std::size_t bytes=n*2*3*sizeof(float);
+        auto advance=[&](std::size_t b,std::size_t e) {
+            auto p=span_of(P).subspan(b,e-b);
+            batch_advance(p,span_of(V).subspan(b,e-b),dt,p);
+        };
+        out.push_back(measure(cfg,"parallel_step","typed",n,bytes,[&] {
+            flow::parallel_for(n,1024,advance);
+            keep(P[n-1]);
+        }));
+        out.push_back(measure(cfg,"parallel_step","raw",n,bytes,[&] {
+            const std::size_t threads=std::min<std::size_t>(flow::default_concurrency(),(n+1023)/1024);
+            const std::size_t step=(n+threads-1)/threads;
+            std::vector<std::thread> workers;
+            for(std::size_t b=step;b<n;b+=step) workers.emplace_back(advance,b,std::min(n,b+step));
+            advance(0,std::min(n,step));
+            for(auto& w:workers) w.join();
+            keep(P[n-1]);
+        }));
+    }
+
+    /// @brief Text of vectors by `format_to()` against iostreams by hand. Items are vectors.
+    void formatting(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        n=std::min<std::size_t>(n,1u<<14);
+        std::vector<VolumePosition> src(n,xD(Longitude{0_m},Latitude{0_m},Altitude{0_m}));
+        for(std::size_t i=0;i<n;i++) src[i]=xD(Longitude{DistSI{i*0.125f}},Latitude{DistSI{i*-3.5f}},Altitude{1_m});
+        std::vector<char> text(n*3*(max_number_chars+8));
+        std::ostringstream os;
+        const std::size_t bytes=n*sizeof(VolumePosition);
+        out.push_back(measure(cfg,"format_vec3d","typed",n,bytes,[&] {
+            char* p=text.data();
+            for(std::size_t i=0;i<n;i++) { p=format_to(p,text.data()+text.size(),src[i]).ptr; *p++='\n'; }
+            keep(p);
+        }));
+        out.push_back(measure(cfg,"format_vec3d","raw",n,bytes,[&] {
+            os.str({});
+            for(std::size_t i=0;i<n;i++)
+                os<<"X="<<src[i].x.val.value<<"[m] Y="<<src[i].y.val.value<<"[m] Z="<<src[i].z.val.value<<"[m]\n";
+            keep(os);
+        }));
+    }
+
+    /// @brief Vectors read by `parse()` against `strtof` and skipping labels by hand. Items are vectors.
+    void parsing(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        n=std::min<std::size_t>(n,1u<<14);
+        std::string text;
+        for(std::size_t i=0;i<n;i++) {
+            text+=to_text(xD(Longitude{DistSI{i*0.125f}},Latitude{DistSI{i*-3.5f}},Altitude{1_m}));
+            text+='\n';
+        }
+        VolumeArray<VolumePosition> dst(n);
+        const std::size_t bytes=n*sizeof(VolumePosition);
+        out.push_back(measure(cfg,"parse_vec3d","typed",n,bytes,[&] {
+            const char* p=text.data();
+            const char* const last=p+text.size();
+            VolumePosition v=xD(Longitude{0_m},Latitude{0_m},Altitude{0_m});
+            for(std::size_t i=0;i<n;i++) { p=parse(p,last,v).ptr+1; dst[i]=v; }
+            keep(dst.xs());
+        }));
+        out.push_back(measure(cfg,"parse_vec3d","raw",n,bytes,[&] {
+            const char* p=text.c_str();
+            char* end;
+            for(std::size_t i=0;i<n;i++) {
+                dst.xs()[i]=std::strtof(p+2,&end);   p=std::strchr(end,' ')+1;
+                dst.ys()[i]=std::strtof(p+2,&end);   p=std::strchr(end,' ')+1;
+                dst.zs()[i]=std::strtof(p+2,&end);   p=std::strchr(end,'\n')+1;
+            }
+            keep(dst.xs());
+        }));
+    }
+
+    /// @brief Lines by `log_line` into an asynchronous sink against `std::endl` on a file. Items are lines.
+    void logging(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        n=std::min<std::size_t>(n,1u<<12);
+        std::ofstream null_file("/dev/null");
+        log_sink sink(null_file,log_options{1<<20,log_overflow::block});
+        const std::size_t bytes=n*sizeof(float);
+        out.push_back(measure(cfg,"log_line","typed",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) log_line(sink)<<COLOR3<<"step "<<i<<" at "<<i*0.125f<<NOCOLO;
+        }));
+        sink.flush();
+        out.push_back(measure(cfg,"log_line","raw",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) null_file<<COLOR3<<"step "<<i<<" at "<<i*0.125f<<NOCOLO<<std::endl;
+        }));
+    }
+
+    /// @brief A small step timed by `PROFILE_SCOPE` against the same step untimed. Items are steps.
+    void profiling(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        std::vector<float> x(64,1.0f);
+        auto step=[&x](std::size_t i) { for(float& v:x) v=v*0.999f+float(i&7); };
+        const std::size_t bytes=n*x.size()*sizeof(float);
+        out.push_back(measure(cfg,"profile_scope","typed",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) { PROFILE_SCOPE("bench.step"); step(i); }
+            keep(x);
+        }));
+        out.push_back(measure(cfg,"profile_scope","raw",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) step(i);
+            keep(x);
+        }));
+    }
+
+    /// @brief Short-lived agents from an `object_pool` against `new`/`delete`. Items are agents.
+    void allocation(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        struct agent { float pos[3]; float vel[3]; std::uint32_t id; };
+        memory::object_pool<agent> pool(4096);
+        std::vector<agent*> live(n);
+        const std::size_t bytes=n*sizeof(agent);
+        out.push_back(measure(cfg,"agents_alloc","typed",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) live[i]=pool.create(agent{{0,0,0},{0,0,0},std::uint32_t(i)});
+            keep(live[n-1]->id);
+            pool.reset();
+        }));
+        out.push_back(measure(cfg,"agents_alloc","raw",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) live[i]=new agent{{0,0,0},{0,0,0},std::uint32_t(i)};
+            keep(live[n-1]->id);
+            for(agent* a:live) delete a;
+        }));
+    }
+
+    /// @brief Bodies with a registered guard against a plain one, created, swept by `validate_all()` and destroyed.
+    /// Items are bodies.
+    void guard_registry(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        struct registered { memory::registered_guard<std::uint32_t,0xB0D1E5u> marker; float pos[3]; };
+        struct plain { memory::guard<std::uint32_t,0xB0D1E5u> marker; float pos[3]; };
+        const std::size_t bytes=n*sizeof(plain);
+        out.push_back(measure(cfg,"guard_registry","typed",n,bytes,[&] {
+            std::vector<registered> bodies(n);
+            keep(memory::validate_all().checked);
+        }));
+        out.push_back(measure(cfg,"guard_registry","raw",n,bytes,[&] {
+            std::vector<plain> bodies(n);
+            std::size_t intact=0;
+            for(const plain& b:bodies) intact+=b.marker.is_constructed();
+            keep(intact);
+        }));
+    }
+
+    /// @brief Geodetic positions to a local tangent plane by `batch_geo_to_local` against `libm` trigonometry and
+    /// the rotation of the origin written out per point. Items are positions.
+    void geo_to_local(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        const double lat0=0.8,lon0=0.3,h0=120;
+        std::vector<GeoPosition> places;
+        std::vector<double> raw(3*n);
+        for(std::size_t i=0;i<n;i++) {
+            const double lat=lat0+(i%1000)*1e-5,lon=lon0+(i%777)*1e-5,h=h0+double(i%50);
+            places.push_back(xD(GeoLatitude{AngleSI64{lat}},GeoLongitude{AngleSI64{lon}},GeoHeight{DistSI64{h}}));
+            raw[3*i]=lat; raw[3*i+1]=lon; raw[3*i+2]=h;
+        }
+        const local_frame frame(places[0]);
+        std::vector<VolumePosition> local(n,VolumePosition{Longitude{0_m},Latitude{0_m},Altitude{0_m}});
+        std::vector<float> raw_local(3*n);
+        const std::size_t bytes=n*(sizeof(GeoPosition)+sizeof(VolumePosition));
+        out.push_back(measure(cfg,"geo_to_local","typed",n,bytes,[&] {
+            batch_geo_to_local(span_of(std::as_const(places)),span_of(local),frame);
+            keep(local[n-1].z.val.value);
+        }));
+        out.push_back(measure(cfg,"geo_to_local","raw",n,bytes,[&] {
+            const double a=wgs84.a,e2=wgs84.e2();
+            auto ecef=[&](double lat,double lon,double h,double* p) {
+                const double sl=std::sin(lat),cl=std::cos(lat),n=a/std::sqrt(1-e2*sl*sl);
+                p[0]=(n+h)*cl*std::cos(lon); p[1]=(n+h)*cl*std::sin(lon); p[2]=(n*(1-e2)+h)*sl;
+            };
+            double o[3];
+            ecef(raw[0],raw[1],raw[2],o);
+            const double sl=std::sin(raw[0]),cl=std::cos(raw[0]),so=std::sin(raw[1]),co=std::cos(raw[1]);
+            for(std::size_t i=0;i<n;i++) {
+                double p[3];
+                ecef(raw[3*i],raw[3*i+1],raw[3*i+2],p);
+                const double dx=p[0]-o[0],dy=p[1]-o[1],dz=p[2]-o[2];
+                raw_local[3*i]  =float(-so*dx+co*dy);
+                raw_local[3*i+1]=float(-sl*co*dx-sl*so*dy+cl*dz);
+                raw_local[3*i+2]=float(cl*co*dx+cl*so*dy+sl*dz);
+            }
+            keep(raw_local[3*n-1]);
+        }));
+    }
+
+    /// @brief A step of far positions in an `AnchoredArray` (float offsets, then `rebase()`) against positions kept
+    /// all in raw `double`, which is the other way to keep millimetres far from zero. Items are positions.
+    void anchored_step(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        AnchoredArray<VolumePosition> bodies;
+        bodies.reserve(n);
+        VecArray<VolumeVelocity> vel(n);
+        std::vector<double> raw_pos(3*n);
+        std::vector<float> raw_vel(3*n);
+        for(std::size_t i=0;i<n;i++) {
+            const double x=1e9+double(i),y=-2e8+0.5*double(i),z=double(i%100);
+            bodies.push_back(VolumePosition64{Scalar<Along,DistSI64>{DistSI64{x}},Scalar<Across,DistSI64>{DistSI64{y}},
+                                              Scalar<Upward,DistSI64>{DistSI64{z}}});
+            const float vx=float(i%13),vy=-3.f,vz=0.5f;
+            vel.set(i,VolumeVelocity{VelAlong{VelocitySI{vx}},VelAcross{VelocitySI{vy}},VelUpward{VelocitySI{vz}}});
+            raw_pos[3*i]=x; raw_pos[3*i+1]=y; raw_pos[3*i+2]=z;
+            raw_vel[3*i]=vx; raw_vel[3*i+1]=vy; raw_vel[3*i+2]=vz;
+        }
+        const std::size_t bytes=n*(sizeof(VolumePosition)+sizeof(VolumeVelocity));
+        out.push_back(measure(cfg,"anchored_step","typed",n,bytes,[&] {
+            keep(bodies.advance(vel,TimeSpan{0.01_s}));
+        }));
+        out.push_back(measure(cfg,"anchored_step","raw",n,bytes,[&] {
+            for(std::size_t i=0;i<3*n;i++) raw_pos[i]+=double(raw_vel[i])*0.01;
+            keep(raw_pos[3*n-1]);
+        }));
+    }
+
+    /// @brief Celsius to kelvin by `batch_to_si()` (constant factors, batch kernels) against a loop with factors
+    /// known only at run time, as a table of units would give them. Items are temperatures.
+    void units_to_si(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        std::vector<TempCelsius> celsius;
+        celsius.reserve(n);
+        std::vector<float> raw(n);
+        for(std::size_t i=0;i<n;i++) { celsius.push_back(float(i%400)*0.25f-50.f); raw[i]=celsius[i].value; }
+        std::vector<TempSI> kelvin(n,TempSI{0.f});
+        std::vector<float> raw_kelvin(n);
+        volatile double runtime_scale=1.0,runtime_offset=273.15;
+        const float s=float(runtime_scale),off=float(runtime_offset);
+        const std::size_t bytes=n*2*sizeof(float);
+        out.push_back(measure(cfg,"units_to_si","typed",n,bytes,[&] {
+            batch_to_si(span_of(std::as_const(celsius)),span_of(kelvin));
+            keep(kelvin[n-1]);
+        }));
+        out.push_back(measure(cfg,"units_to_si","raw",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) raw_kelvin[i]=raw[i]*s+off;
+            keep(raw_kelvin[n-1]);
+        }));
+    }
+
+    /// @brief `batch_normalize()` with refined reciprocal square roots against a loop with a square root and
+    /// a division per vector over the same columns. Items are vectors.
+    void normalize_vectors(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        VecArray<VolumeVelocity> vel(n);
+        std::vector<float> rx(n),ry(n),rz(n);
+        for(std::size_t i=0;i<n;i++) {
+            rx[i]=float(i%17)+1.f; ry[i]=-float(i%5); rz[i]=0.25f*float(i%11);
+            vel.set(i,VolumeVelocity{VelAlong{VelocitySI{rx[i]}},VelAcross{VelocitySI{ry[i]}},
+                                     VelUpward{VelocitySI{rz[i]}}});
+        }
+        const std::size_t bytes=n*sizeof(VolumeVelocity);
+        out.push_back(measure(cfg,"normalize_vectors","typed",n,bytes,[&] {
+            batch_normalize(vel,VelocitySI{1.f});
+            keep(vel.xs()[n-1]);
+        }));
+        out.push_back(measure(cfg,"normalize_vectors","raw",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) {
+                const float len=std::sqrt(rx[i]*rx[i]+ry[i]*ry[i]+rz[i]*rz[i]);
+                const float f=len>0?1.f/len:0.f;
+                rx[i]*=f; ry[i]*=f; rz[i]*=f;
+            }
+            keep(rx[n-1]);
+        }));
+    }
+
+    /// @brief Gravity of a cluster by `Gravity` against the raw float SIMD direct sum on the same tiles and threads.
+    ///        Barnes-Hut goes alone, as "tree", it is another algorithm. Items are bodies.
+    void nbody(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        n=std::min<std::size_t>(n,1u<<13);                                     // The direct sum is O(n^2).
+        VecArray<VolumePosition> pos(n);
+        std::vector<MassSI> masses(n,1e9_kg);
+        std::vector<float> rx(n),ry(n),rz(n),rm(n,1e9f),gm(n),ax(n),ay(n),az(n);
+        for(std::size_t i=0;i<n;i++) {
+            rx[i]=float(i%97)*10.f; ry[i]=float(i%89)*11.f; rz[i]=float(i%83)*3.f;
+            pos.set(i,VolumePosition{Longitude{DistSI{rx[i]}},Latitude{DistSI{ry[i]}},Altitude{DistSI{rz[i]}}});
+        }
+        Gravity<VolumePosition,VolumeAcceleration> g;
+        g.softening=1_m;
+        g.method=gravity_method::direct;
+        VecArray<VolumeAcceleration> acc;
+        const std::size_t bytes=n*(sizeof(VolumePosition)+sizeof(MassSI)+sizeof(VolumeAcceleration));
+        out.push_back(measure(cfg,"nbody_direct","typed",n,bytes,[&] {
+            g.accelerations(pos,masses,acc);
+            keep(acc.xs()[n-1]);
+        }));
+        out.push_back(measure(cfg,"nbody_direct","raw",n,bytes,[&] {
+            for(std::size_t i=0;i<n;i++) gm[i]=static_cast<float>(gravitational_constant*rm[i]);
+            math::detail::direct_gravity({rx.data(),ry.data(),rz.data(),gm.data(),n},1.f,
+                                         {ax.data(),ay.data(),az.data()},g.min_chunk,g.threads);
+            keep(ax[n-1]);
+        }));
+        g.method=gravity_method::barnes_hut;
+        out.push_back(measure(cfg,"nbody_barnes_hut","tree",n,bytes,[&] {
+            g.accelerations(pos,masses,acc);
+            keep(acc.xs()[n-1]);
+        }));
+    }
+
+    /// @brief Formatting with `keep_io_flags` against saving and restoring flags by hand. Items are numbers.
+    void benders(const settings& cfg,std::size_t n,std::vector<result>& out) {
+        n=std::min<std::size_t>(n,1u<<14);                                // Formatting is slow, bigger gives nothing.
+        std::vector<float> src(n);
+        for(std::size_t i=0;i<n;i++) src[i]=float(i)*0.125f;
+        std::ostringstream os;
+        const std::size_t bytes=n*sizeof(float);
+        out.push_back(measure(cfg,"ios_keep_flags","typed",n,bytes,[&] {
+            os.str({});
+            for(std::size_t i=0;i<n;i++) { keep_io_flags keeper(os); os<<std::hex<<std::showbase<<i<<' '<<src[i]; }
+            keep(os);
+        }));
+        out.push_back(measure(cfg,"ios_keep_flags","raw",n,bytes,[&] {
+            os.str({});
+            for(std::size_t i=0;i<n;i++) { auto f=os.flags(); os<<std::hex<<std::showbase<<i<<' '<<src[i]; os.flags(f); }
+            keep(os);
+        }));
+    }
+
+    // REPORTING:
+    //*//////////
+
+    void print_json(std::ostream& js,const std::vector<result>& all) {
+        js<<"{\n  \"optimized\": "<<
+#ifdef __OPTIMIZE__
+            "true"
+#else
+            "false"
+#endif
+          <<",\n  \"compiler\": \""<<
+#ifdef __VERSION__
+            __VERSION__
+#else
+            "unknown"
+#endif
+          <<"\",\n  \"simd\": \""<<simd::name(simd::active())<<"\",\n  \"results\": [\n";
+        for(std::size_t k=0;k<all.size();k++) {
+            const result& r=all[k];
+            js<<"    {\"name\": \""<<r.name<<"\", \"variant\": \""<<r.variant<<"\", \"items\": "<<r.items
+              <<", \"bytes\": "<<r.bytes<<", \"median_ns\": "<<r.median_ns<<", \"p10_ns\": "<<r.p10_ns
+              <<", \"p90_ns\": "<<r.p90_ns<<", \"items_per_sec\": "<<r.items_per_sec<<"}"
+              <<(k+1<all.size()?",":"")<<"\n";
+        }
+        js<<"  ],\n  \"penalties\": [\n";
+        bool first=true;
+        for(std::size_t k=0;k+1<all.size();k++) {                                   // Pairs are always adjacent.
+            const result& t=all[k]; const result& r=all[k+1];
+            if(t.variant!="typed" || r.variant!="raw" || t.name!=r.name || t.items!=r.items) continue;
+            js<<(first?"":",\n")<<"    {\"name\": \""<<t.name<<"\", \"items\": "<<t.items
+              <<", \"typed_over_raw\": "<<(r.median_ns>0?t.median_ns/r.median_ns:0)<<"}";
+            first=false;
+        }
+        js<<"\n  ]\n}\n";
+    }
+
+    void print_table(std::ostream& o,const std::vector<result>& all) {
+        keep_io_flags keeper(o);
+        o<<COLOR2<<std::left<<std::setw(22)<<"benchmark"<<std::setw(7)<<"kind"<<std::right<<std::setw(10)<<"items"
+         <<std::setw(12)<<"median ns"<<std::setw(12)<<"p90 ns"<<std::setw(14)<<"Mitems/s"<<NOCOLO<<'\n';
+        o<<std::fixed<<std::setprecision(3);
+        for(const result& r:all)
+            o<<std::left<<std::setw(22)<<r.name<<std::setw(7)<<r.variant<<std::right<<std::setw(10)<<r.items
+             <<std::setw(12)<<r.median_ns<<std::setw(12)<<r.p90_ns<<std::setw(14)<<r.items_per_sec*1e-6<<'\n';
+    }
+}
+
+int main(int argc,char* argv[]) {
+    using namespace merry_tools::bench;
+
+    settings cfg;
+    const char* out_path=nullptr;
+    for(int a=1;a<argc;a++) {
+        if(std::strcmp(argv[a],"--quick")==0) { cfg.samples=5; cfg.sizes={1u<<10,1u<<16}; }
+        else if(std::strcmp(argv[a],"--out")==0 && a+1<argc) out_path=argv[++a];
+        else { std::cerr<<"Usage: "<<argv[0]<<" [--quick] [--out results.json]"<<std::endl; return 1; }
+    }
+
+    std::vector<result> all;
+    for(std::size_t n:cfg.sizes) {
+        quantities(cfg,n,all);
+        scalars(cfg,n,all);
+        vectors3d(cfg,n,all);
+        ufloat16(cfg,n,all);
+        compact(cfg,n,all);
+        parallel_step(cfg,n,all);
+        if(n==cfg.sizes.front()) benders(cfg,n,all);
+        if(n==cfg.sizes.front()) formatting(cfg,n,all);
+        if(n==cfg.sizes.front()) parsing(cfg,n,all);
+        if(n==cfg.sizes.front()) logging(cfg,n,all);
+        if(n==cfg.sizes.front()) profiling(cfg,n,all);
+        allocation(cfg,n,all);
+        guard_registry(cfg,n,all);
+        geo_to_local(cfg,n,all);
+        anchored_step(cfg,n,all);
+        units_to_si(cfg,n,all);
+        normalize_vectors(cfg,n,all);
+        if(n==cfg.sizes.front() || n==cfg.sizes.back()) nbody(cfg,n,all);
+    }
+
+    print_table(std::clog,all);
+    if(out_path) {
+        std::ofstream js(out_path);
+        print_json(js,all);
+        if(!js) { std::cerr<<"Can't write "<<out_path<<std::endl; return 2; }
+    } else {
+        print_json(std::cout,all);
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+/** @file flw_parallel.h @brief Fork-join over chunks of an index range or of a container.
+ *  @details
+ *      `parallel_for(n,min_chunk,fn)` splits `[0,n)` into contiguous chunks and calls `fn(begin,end)` for each,
+ *      on the threads of `task_pool::global()` (see `flw_tasks.h`). The calling thread takes part. Ranges shorter
+ *      than two chunks run inline, with no task at all. The first exception thrown by any chunk is rethrown
+ *      after all chunks have finished.
+ *      `parallel_for_each()` does the same for elements of containers, e.g. `VecArray` or `std::vector`.
+ *      `parallel_sort()` sorts chunks concurrently and then merges them pairwise, also concurrently.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_FLOW_PARALLEL_H
+#define WB_FLOW_PARALLEL_H
+
+#include "flw_tasks.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+namespace merry_tools::flow {
+
+    /** @brief Calls `fn(begin,end)` for disjoint chunks covering `[0,n)`, possibly concurrently.
+     *         Returns when all are done.
+     *  \param n - size of the whole range
+     *  \param min_chunk - the smallest chunk worth a task. Chunks are never shorter, unless the whole range is
+     *  \param fn - callable as `fn(std::size_t begin,std::size_t end)`, safe for concurrent calls on disjoint ranges
+     *  \param threads - upper limit of chunks run at once. 0 means all threads of the pool, with adaptive grain */
+    template<class FUN>
+    void parallel_for(std::size_t n,std::size_t min_chunk,FUN&& fn,unsigned threads=0) {
+        if(threads==1 || n<=std::max<std::size_t>(min_chunk,1)) { if(n>0) fn(std::size_t(0),n); return; }
+        task_pool::global().parallel_for(n,min_chunk,fn,threads);
+    }
+
+    /** @brief Calls `fn(c[i])` for every element of a container with `size()` and `operator []`, concurrently.
+     *  \param min_chunk - the smallest number of elements worth a task
+     *  \param threads - upper limit of chunks run at once. 0 means all threads of the pool */
+    template<class CONT,class FUN>
+    void parallel_for_each(CONT& c,std::size_t min_chunk,FUN&& fn,unsigned threads=0) {
+        parallel_for(std::size(c),min_chunk,[&c,&fn](std::size_t b,std::size_t e) {
+            for(std::size_t i=b;i<e;i++) fn(c[i]);
+        },threads);
+    }
+
+    /** @brief `std::sort` of `[first,last)` on up to `threads` threads. Not stable, like `std::sort`.
+     *  \param min_chunk - the smallest number of elements worth a thread
+     *  \param threads - upper limit of threads, including the calling one. 0 means all threads of the pool */
+    template<class IT,class CMP>
+    void parallel_sort(IT first,IT last,CMP cmp,std::size_t min_chunk=std::size_t(1)<<14,unsigned threads=0) {
+        const auto n=static_cast<std::size_t>(last-first);
+        if(threads==0) threads=task_pool::global().concurrency();
+        min_chunk=std::max<std::size_t>(min_chunk,1);
+        const std::size_t pieces=std::min<std::size_t>(threads,(n+min_chunk-1)/min_chunk);
+        if(pieces<=1) { std::sort(first,last,cmp); return; }
+
+        const std::size_t step=(n+pieces-1)/pieces;
+        parallel_for(pieces,1,[&](std::size_t b,std::size_t e) {
+            for(std::size_t p=b;p<e;p++) std::sort(first+p*step,first+std::min(n,(p+1)*step),cmp);
+        },threads);
+        for(std::size_t width=step;width<n;width*=2) {
+            parallel_for((n+2*width-1)/(2*width),1,[&](std::size_t b,std::size_t e) {
+                for(std::size_t p=b;p<e;p++) {
+                    const std::size_t lo=p*2*width;
+                    std::inplace_merge(first+lo,first+std::min(n,lo+width),first+std::min(n,lo+2*width),cmp);
+                }
+            },threads);
+        }
+    }
+}
+
+#endif //WB_FLOW_PARALLEL_H
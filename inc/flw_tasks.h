@@ -0,0 +1,354 @@
+/** @file flw_tasks.h @brief Work-stealing thread pool, task groups, task graphs and per-thread scratch arenas.
+ *  @details
+ *      `task_pool` keeps its worker threads alive between calls, so a simulation step costs a few queue operations
+ *      instead of spawning threads. Every worker has its own deque: it takes its newest tasks, idle workers steal
+ *      the oldest ones of others. Threads outside the pool share one more deque. A thread waiting for its tasks
+ *      runs queued tasks meanwhile, so nested `parallel_for()` and tasks waiting for tasks never deadlock.
+ *
+ *      `task_pool::parallel_for()` splits ranges lazily: a task bigger than twice the grain puts its upper half
+ *      back to the queue and goes on with the lower one. Idle workers steal the big halves first, so the load
+ *      evens out without knowing the cost of elements. The grain adapts to the range and the number of threads.
+ *
+ *      `task_group` runs independent callables, `task_graph` runs callables in the order of their dependencies,
+ *      e.g. the phases of a step: forces -> integration -> rebuild of spatial indices. `scratch()` gives the bump
+ *      allocator of the current thread, for temporary buffers of tasks without `new` in every step.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_FLOW_TASKS_H
+#define WB_FLOW_TASKS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace merry_tools::flow {
+
+    /// @brief Number of threads used when not given, at least 1.
+    inline unsigned default_concurrency() {
+        unsigned n=std::thread::hardware_concurrency();
+        return n>0?n:1;
+    }
+
+    // TASKS:
+    //*//////
+
+    /// @brief Number of unfinished tasks of a batch, with the first exception thrown by any of them.
+    class task_counter {
+    public:
+        bool done() const { return pending.load(std::memory_order_acquire)==0; }
+
+    private:
+        friend class task_pool;
+        std::atomic<std::size_t> pending{0};
+        std::exception_ptr       error;
+        std::mutex               lock;
+    };
+
+    /// @brief The unit of work: `call(ctx,begin,end)`. Plain data, so queuing allocates nothing.
+    struct task {
+        void        (*call)(void* ctx,std::size_t begin,std::size_t end)=nullptr;
+        void*         ctx=nullptr;
+        std::size_t   begin=0;
+        std::size_t   end=0;
+        task_counter* counter=nullptr;   //!< Decremented when the call returns or throws.
+    };
+
+    // THE POOL:
+    //*/////////
+
+    /** @brief Work-stealing thread pool. The thread that waits for tasks runs tasks as well.
+     *  @details Implemented in `flw_tasks.cpp`. Most code uses the shared `global()` pool, through
+     *           `parallel_for()` of `flw_parallel.h`. */
+    class task_pool {
+    public:
+        /// @brief Pool of `threads-1` workers plus the waiting thread. 0 means `default_concurrency()`.
+        explicit task_pool(unsigned threads=0);
+        ~task_pool();
+
+        task_pool(const task_pool&)=delete;
+        task_pool& operator = (const task_pool&)=delete;
+
+        /// @brief The pool shared by the whole program, started on first use.
+        static task_pool& global();
+
+        /// @brief Threads running tasks: the workers and the waiting one.
+        unsigned concurrency() const { return unsigned(workers.size())+1; }
+
+        /// @brief Queues a task, which increments its counter. Safe from any thread.
+        void submit(const task& t);
+
+        /// @brief Runs queued tasks until all of the counter are done, then rethrows the first exception if any.
+        void wait(task_counter& counter);
+
+        /** @brief Calls `fn(begin,end)` for disjoint chunks covering `[0,n)`, concurrently. Returns when all are done.
+         *  \param min_chunk - the smallest chunk worth a task. Chunks are never shorter unless `n` is
+         *  \param fn - callable as `fn(std::size_t begin,std::size_t end)`, safe for concurrent calls on disjoint
+         *              ranges
+         *  \param threads - upper limit of chunks run at once. 0 means `concurrency()` with adaptive grain */
+        template<class FUN>
+        void parallel_for(std::size_t n,std::size_t min_chunk,FUN&& fn,unsigned threads=0);
+
+    private:
+        struct queue {
+            std::mutex       lock;
+            std::deque<task> tasks;
+        };
+
+        std::vector<std::unique_ptr<queue>> queues;    //!< [0] is shared by outside threads, then one per worker.
+        std::vector<std::thread>            workers;
+        std::atomic<std::size_t>            queued{0};
+        std::mutex                          sleep_lock;
+        std::condition_variable             wake;
+        bool                                stopping=false;
+
+        template<class FUN>
+        struct range_job {
+            FUN*         fn;
+            std::size_t  grain;
+            task_pool*   pool;
+            task_counter counter;
+
+            static void run(void* ctx,std::size_t b,std::size_t e) {
+                auto& job=*static_cast<range_job*>(ctx);
+                while(e-b>=2*job.grain) {                                  // Upper halves go to thieves.
+                    const std::size_t mid=b+(e-b)/2;
+                    job.pool->submit(task{&run,ctx,mid,e,&job.counter});
+                    e=mid;
+                }
+                (*job.fn)(b,e);
+            }
+        };
+
+        std::size_t home() const;
+        bool        pop(task& t);
+        void        execute(const task& t);
+        void        work(std::size_t index);
+    };
+
+    template<class FUN>
+    void task_pool::parallel_for(std::size_t n,std::size_t min_chunk,FUN&& fn,unsigned threads) {
+        if(n==0) return;
+        min_chunk=std::max<std::size_t>(min_chunk,1);
+        // Limited threads: at most `threads` chunks. Otherwise about 8 chunks per thread, to be stolen.
+        const std::size_t grain=threads!=0 && threads<concurrency()
+                                ?std::max(min_chunk,(n+threads-1)/threads)
+                                :std::max(min_chunk,n/(8*std::size_t(concurrency())));
+        if(threads==1 || n<2*grain) { fn(std::size_t(0),n); return; }
+
+        typedef std::remove_reference_t<FUN> fun_type;
+        range_job<fun_type> job{&fn,grain,this,{}};
+        job.counter.pending.fetch_add(1,std::memory_order_relaxed);
+        execute(task{&range_job<fun_type>::run,&job,0,n,&job.counter});
+        wait(job.counter);
+    }
+
+    // GROUPS AND GRAPHS:
+    //*//////////////////
+
+    /// @brief Independent callables run on a pool. `run()` is for a single thread, the one that calls `wait()`.
+    class task_group {
+    public:
+        explicit task_group(task_pool& p=task_pool::global()):pool(p) {}
+
+        /// @brief Waits for unfinished tasks. Their exceptions are lost, call `wait()` to get them.
+        ~task_group() {
+            try { wait(); } catch(...) {}                                                  // NOLINT(*-empty-catch)
+        }
+
+        task_group(const task_group&)=delete;
+        task_group& operator = (const task_group&)=delete;
+
+        /// @brief Queues `fn()`.
+        template<class FUN>
+        void run(FUN&& fn) {
+            jobs.emplace_back(std::forward<FUN>(fn));
+            pool.submit(task{&call,&jobs.back(),0,0,&counter});
+        }
+
+        /// @brief Returns when all queued callables are done. Rethrows the first exception if any.
+        void wait() { pool.wait(counter); }
+
+    private:
+        task_pool&                        pool;
+        task_counter                      counter;
+        std::deque<std::function<void()>> jobs;       //!< `deque` keeps addresses of queued callables.
+
+        static void call(void* fn,std::size_t,std::size_t) { (*static_cast<std::function<void()>*>(fn))(); }
+    };
+
+    /** @brief Callables with dependencies, built once and run many times, e.g. once per simulation step.
+     *  @details Independent nodes run concurrently and every node may use `parallel_for()` inside.
+     *           A node that throws stops its successors. The first exception is rethrown by `run()`. */
+    class task_graph {
+    public:
+        typedef std::size_t node;
+
+        /// @brief Adds `fn()` running after all nodes of `after`.
+        template<class FUN>
+        node add(FUN&& fn,std::initializer_list<node> after={}) {
+            vertices.emplace_back();
+            vertices.back().fn=std::forward<FUN>(fn);
+            const node added=vertices.size()-1;
+            for(node a:after) precede(a,added);
+            return added;
+        }
+
+        /// @brief `after` starts when `before` is done.
+        void precede(node before,node after) {                 assert(before<vertices.size() && after<vertices.size());
+            vertices[before].next.push_back(after);
+            vertices[after].inputs++;
+        }
+
+        std::size_t size() const { return vertices.size(); }
+
+        /// @brief Runs all nodes once and waits for them. Must not run concurrently with itself.
+        void run(task_pool& pool=task_pool::global()) {                                         assert(acyclic());
+            run_state state{this,&pool,{}};
+            for(auto& v:vertices) v.waiting.store(v.inputs,std::memory_order_relaxed);
+            for(node v=0;v<vertices.size();v++)
+                if(vertices[v].inputs==0) pool.submit(task{&call,&state,v,0,&state.counter});
+            pool.wait(state.counter);
+        }
+
+    private:
+        struct vertex {
+            std::function<void()>    fn;
+            std::vector<node>        next;
+            std::size_t              inputs=0;
+            std::atomic<std::size_t> waiting{0};
+        };
+
+        struct run_state {
+            task_graph*  graph;
+            task_pool*   pool;
+            task_counter counter;
+        };
+
+        std::deque<vertex> vertices;      //!< `deque`, because atomics don't move.
+
+        static void call(void* ctx,std::size_t v,std::size_t) {
+            auto& state=*static_cast<run_state*>(ctx);
+            vertex& self=state.graph->vertices[v];
+            self.fn();
+            for(node n:self.next)            // Submitted before this task counts as done, so `run()` can't return.
+                if(state.graph->vertices[n].waiting.fetch_sub(1,std::memory_order_acq_rel)==1)
+                    state.pool->submit(task{&call,ctx,n,0,&state.counter});
+        }
+
+        bool acyclic() const {
+            std::vector<std::size_t> inputs(vertices.size());
+            std::vector<node>        ready;
+            for(node v=0;v<vertices.size();v++) if((inputs[v]=vertices[v].inputs)==0) ready.push_back(v);
+            std::size_t visited=0;
+            while(!ready.empty()) {
+                const node v=ready.back(); ready.pop_back(); visited++;
+                for(node n:vertices[v].next) if(--inputs[n]==0) ready.push_back(n);
+            }
+            return visited==vertices.size();
+        }
+    };
+
+    // SCRATCH MEMORY:
+    //*///////////////
+
+    /** @brief Bump allocator of a single thread. Memory is kept after `release()`, so steps reuse it.
+     *  @details Allocations never move. Use `scratch_scope` to release everything allocated in a scope. */
+    class scratch_arena {
+    public:
+        /// @brief Position to `release()` to.
+        struct mark_type {
+            std::size_t block=0;
+            std::size_t offset=0;
+        };
+
+        /// @brief Uninitialised memory for `n` objects of `T`, aligned to a cache line at least.
+        template<class T>
+        T* allocate(std::size_t n) {
+            static_assert(std::is_trivially_destructible_v<T>,"Destructors are never called in scratch memory!");
+            return static_cast<T*>(allocate_bytes(n*sizeof(T),std::max<std::size_t>(alignof(T),64)));
+        }
+
+        mark_type mark() const { return {current,offset}; }
+
+        /// @brief Frees everything allocated after `m`.
+        void release(const mark_type& m) { current=m.block; offset=m.offset; }
+
+        /// @brief Bytes kept by the arena.
+        std::size_t capacity() const {
+            std::size_t total=0;
+            for(const auto& b:blocks) total+=b.size;
+            return total;
+        }
+
+    private:
+        struct block {
+            std::unique_ptr<unsigned char[]> data;
+            std::size_t                      size;
+        };
+
+        std::vector<block> blocks;
+        std::size_t        current=0;
+        std::size_t        offset=0;
+
+        void* allocate_bytes(std::size_t bytes,std::size_t align) {
+            for(;;) {
+                if(current<blocks.size()) {
+                    auto base=reinterpret_cast<std::uintptr_t>(blocks[current].data.get());
+                    const std::size_t start=((base+offset+align-1)&~(align-1))-base;
+                    if(start+bytes<=blocks[current].size) {
+                        offset=start+bytes;
+                        return blocks[current].data.get()+start;
+                    }
+                    if(current+1<blocks.size() && blocks[current+1].size>=bytes+align) {
+                        current++; offset=0;
+                        continue;
+                    }
+                }
+                const std::size_t size=std::max<std::size_t>({std::size_t(1)<<16,2*(bytes+align),
+                                                              blocks.empty()?0:2*blocks.back().size});
+                if(!blocks.empty()) current++;
+                blocks.insert(blocks.begin()+std::ptrdiff_t(current),
+                              block{std::make_unique<unsigned char[]>(size),size});
+                offset=0;
+            }
+        }
+    };
+
+    /// @brief Scratch arena of the calling thread, i.e. of the worker running the task.
+    inline scratch_arena& scratch() {
+        thread_local scratch_arena arena;
+        return arena;
+    }
+
+    /// @brief Everything allocated through the scope is released at its end.
+    class scratch_scope {
+    public:
+        scratch_scope():arena(scratch()),start(arena.mark()) {}
+        ~scratch_scope() { arena.release(start); }
+
+        scratch_scope(const scratch_scope&)=delete;
+        scratch_scope& operator = (const scratch_scope&)=delete;
+
+        template<class T>
+        T* allocate(std::size_t n) { return arena.allocate<T>(n); }
+
+    private:
+        scratch_arena&           arena;
+        scratch_arena::mark_type start;
+    };
+}
+
+#endif //WB_FLOW_TASKS_H
@@ -0,0 +1,220 @@
+/** @file ios_format.h @brief Fast text of quantities, scalars and vectors, and CSV/TSV tables of typed arrays.
+ *  @details
+ *      Numbers are written by `std::to_chars`: the shortest text that reads back to the same value, with no locale
+ *      and no stream in between. `format_to()` writes into the caller's buffer, `to_text()` into a buffer of the
+ *      calling thread. Quantities look like `1.5[m]`, scalars like `X=1.5[m]`, vectors like `X=1.5[m] Y=2[m]`.
+ *      `operator <<` for all of them writes the same text with a single `write()`.
+ *
+ *      `table_writer` writes whole arrays as CSV or TSV. Labels of columns, e.g. `X[m]`, are compile time
+ *      constants. Rows are formatted in blocks on all cores (see `flw_parallel.h`) and written in order.
+ *      All columns must have the same size, `std::invalid_argument` is thrown by `column()` otherwise.
+ *      Non-template parts are in `ios_format.cpp`.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_IOS_FORMAT_H
+#define WB_IOS_FORMAT_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_vec_expr.h"
+
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace merry_tools::iostreams {
+
+    /// @brief The longest text of a single number written by `std::to_chars` in the shortest form.
+    WB_GLOBAL_OUTSIDE_CLASS std::size_t max_number_chars=32;
+
+    namespace detail {
+        template<class T>
+        WB_GLOBAL_OUTSIDE_CLASS bool is_formattable_v=math::expr::is_quantity<T>::value || math::expr::is_object_v<T>;
+
+        constexpr std::size_t text_length(const char* s) {
+            std::size_t n=0;
+            while(s[n]!='\0') n++;
+            return n;
+        }
+
+        /// @brief Compile time text of an axis name and a unit, e.g. `X[m]`.
+        template<class AXIS,class UNIT>
+        struct label_text {
+            char text[text_length(AXIS::name())+text_length(UNIT::abbreviation())+1]{};
+
+            constexpr label_text() {
+                std::size_t pos=0;
+                for(const char* s=AXIS::name();*s;s++) text[pos++]=*s;
+                for(const char* s=UNIT::abbreviation();*s;s++) text[pos++]=*s;
+            }
+        };
+
+        template<class AXIS,class UNIT>
+        WB_GLOBAL_OUTSIDE_CLASS label_text<AXIS,UNIT> label_v{};
+
+        inline char* put(char* first,char* last,const char* text) {
+            for(;*text;text++) {
+                if(first==last) return nullptr;
+                *first++=*text;
+            }
+            return first;
+        }
+
+        inline char* put_number(char* first,char* last,double v) {
+            auto [ptr,ec]=std::to_chars(first,last,v);
+            return ec==std::errc()?ptr:nullptr;
+        }
+
+        inline char* put_number(char* first,char* last,float v) {
+            auto [ptr,ec]=std::to_chars(first,last,v);
+            return ec==std::errc()?ptr:nullptr;
+        }
+
+        /// @brief `X=1.5[m]`, or `nullptr` when it does not fit.
+        template<class AXIS,class QUANTITY>
+        char* put_component(char* first,char* last,typename QUANTITY::value_type v) {
+            if((first=put(first,last,AXIS::name()))==nullptr || first==last) return nullptr;
+            *first++='=';
+            if((first=put_number(first,last,v))==nullptr) return nullptr;
+            return put(first,last,QUANTITY::abbreviation());
+        }
+    }
+
+    // SINGLE VALUES:
+    //*//////////////
+
+    /// @brief Text of a quantity, scalar or vector in `[first,last)`, like `std::to_chars`: on success `ec` is empty
+    /// and `ptr` is the end of the text, otherwise `ec` is `std::errc::value_too_large`. No terminating zero.
+    template<class T,class=std::enable_if_t<detail::is_formattable_v<T>>>
+    std::to_chars_result format_to(char* first,char* last,const T& v) {
+        char* end;
+        if constexpr (math::expr::is_quantity<T>::value) {
+            end=detail::put_number(first,last,v.value);
+            if(end!=nullptr) end=detail::put(end,last,T::abbreviation());
+        } else {
+            typedef math::expr::object_traits<T> traits;
+            typedef typename traits::axes        axes;
+            typedef typename traits::quantity    q;
+            end=detail::put_component<typename axes::template at<0>,q>(first,last,math::expr::component<0>(v));
+            if constexpr (axes::size>1) {
+                if(end!=nullptr && end!=last) { *end++=' '; end=detail::put_component<typename axes::template at<1>,q>(
+                                                                  end,last,math::expr::component<1>(v)); }
+                else end=nullptr;
+            }
+            if constexpr (axes::size>2) {
+                if(end!=nullptr && end!=last) { *end++=' '; end=detail::put_component<typename axes::template at<2>,q>(
+                                                                  end,last,math::expr::component<2>(v)); }
+                else end=nullptr;
+            }
+        }
+        if(end==nullptr) return {last,std::errc::value_too_large};
+        return {end,std::errc()};
+    }
+
+    /// @brief Text in a buffer of the calling thread, valid until its next call of `to_text()`.
+    template<class T,class=std::enable_if_t<detail::is_formattable_v<T>>>
+    std::string_view to_text(const T& v) {
+        thread_local char buffer[4*(max_number_chars+40)];
+        const auto [end,ec]=format_to(buffer,buffer+sizeof buffer,v);
+        return ec==std::errc()?std::string_view(buffer,std::size_t(end-buffer)):std::string_view("<too long>");
+    }
+
+    /// @brief Text as a `std::string`, for the rare places where it has to be owned.
+    template<class T,class=std::enable_if_t<detail::is_formattable_v<T>>>
+    std::string to_string(const T& v) { return std::string(to_text(v)); }
+
+    // TABLES:
+    //*///////
+
+    /** @brief Writes typed arrays as CSV (or TSV) with a header of labels like `positions.X[m]`.
+     *  @details Columns are not copied, they must live until `write()`. All must have the same size. */
+    class table_writer {
+    public:
+        /// \param separator - `,` for CSV, `\t` for TSV
+        explicit table_writer(std::ostream& out,char separator=','):out(out),separator(separator) {}
+
+        /// @brief Vectors, e.g. `VolumeArray<VolumePosition>`, as one column per axis.
+        template<class VEC>
+        table_writer& column(const std::string& name,const math::VecArray<VEC>& values) {
+            typedef math::vec_traits<VEC> traits;
+            typedef typename traits::quantity::unit_type unit;
+            source s{name,values.size(),{values.xs(),values.ys(),nullptr},traits::dimensions,
+                     {detail::label_v<typename traits::axis_x,unit>.text,
+                      detail::label_v<typename traits::axis_y,unit>.text,""},
+                     &put_values<typename traits::value_type>};
+            if constexpr (traits::dimensions==3) {
+                s.data[2]=values.zs();
+                s.labels[2]=detail::label_v<typename traits::axis_z,unit>.text;
+            }
+            add(s);
+            return *this;
+        }
+
+        /// @brief Scalars or quantities in a container with `data()` and `size()`, e.g. `std::vector<MassQuan>`.
+        template<class CONT,class=decltype(std::declval<const CONT&>().data())>
+        table_writer& column(const std::string& name,const CONT& values) {
+            typedef std::remove_cv_t<std::remove_reference_t<decltype(*values.data())>> element;
+            if constexpr (math::expr::is_quantity<element>::value) {
+                static_assert(sizeof(element)==sizeof(typename element::value_type));
+                add(source{name,values.size(),{values.data(),nullptr,nullptr},1,
+                           {element::abbreviation(),"",""},&put_values<typename element::value_type>});
+            } else {
+                typedef math::expr::object_traits<element> traits;
+                static_assert(traits::axes::size==1 && sizeof(element)==sizeof(typename traits::value_type),
+                              "Vectors go in VecArray, single axis scalars in containers!");
+                add(source{name,values.size(),{values.data(),nullptr,nullptr},1,
+                           {detail::label_v<typename traits::axes::template at<0>,
+                                            typename traits::quantity::unit_type>.text,"",""},
+                           &put_values<typename traits::value_type>});
+            }
+            return *this;
+        }
+
+        /// @brief Writes the header and all rows. Rows are formatted on all cores, `threads` limits them.
+        void write(unsigned threads=0);
+
+        std::size_t rows() const { return sources.empty()?0:sources.front().count; }
+
+    private:
+        typedef char* (*put_type)(const void* column,std::size_t row,char* out);
+
+        struct source {
+            std::string  name;
+            std::size_t  count;
+            const void*  data[3];
+            std::size_t  components;
+            const char*  labels[3];
+            put_type     put;
+        };
+
+        std::ostream&       out;
+        char                separator;
+        std::vector<source> sources;
+
+        void add(const source& s);
+
+        /// @brief A number always fits, buffers have room for `max_number_chars` for every cell.
+        template<class FLOAT>
+        static char* put_values(const void* column,std::size_t row,char* out) {
+            return std::to_chars(out,out+max_number_chars,static_cast<const FLOAT*>(column)[row]).ptr;
+        }
+    };
+}
+
+namespace merry_tools::math {
+
+    /// @brief Quantities, scalars and vectors as `to_text()` writes them, e.g. `X=1.5[m] Y=2[m]`.
+    template<class T,class=std::enable_if_t<iostreams::detail::is_formattable_v<T>>>
+    std::ostream& operator << (std::ostream& o,const T& v) {
+        const std::string_view text=iostreams::to_text(v);
+        return o.write(text.data(),std::streamsize(text.size()));
+    }
+}
+
+#endif //WB_IOS_FORMAT_H
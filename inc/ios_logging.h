@@ -0,0 +1,165 @@
+/** @file ios_logging.h @brief Asynchronous colored logging: the hot path only copies text, a thread writes it.
+ *  @details
+ *      `log_sink` is an `ios_bender` bound to an output stream, e.g. `std::cerr`. Every thread logging to it gets
+ *      its own lock-free ring buffer (one producer, one consumer), so `log()` is a copy and two atomic operations,
+ *      without locks also for a thread logging to several sinks in turn, formatting by iostreams or system calls.
+ *      A background thread drains all rings in batches and writes each batch with a single `write()`. Lines of
+ *      one thread keep their order, lines of different threads are interleaved as they are drained.
+ *
+ *      `COLOR*`/`NOCOLO` sequences of `ios_benders.h` are kept or stripped by the drain thread, by default
+ *      stripped when the stream is not a terminal. When a ring is full, a line is dropped and counted, or
+ *      the thread waits for the drain (`log_overflow`). `flush()` returns when everything logged before it
+ *      is in the stream and the stream is flushed. The destructor drains and flushes too, like `text_at_end`.
+ *
+ *      `log_line` composes a line in a stack buffer, numbers and typed values by `std::to_chars` (see
+ *      `ios_format.h`), and logs it at the end of the full expression:
+ *      `log_line(sink)<<COLOR2<<"step "<<step<<" at "<<position<<NOCOLO;`
+ *      Non-template parts are in `ios_logging.cpp`.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_IOS_LOGGING_H
+#define WB_IOS_LOGGING_H
+
+#include "ios_benders.h"
+#include "ios_format.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace merry_tools::iostreams {
+
+    /// @brief What `log()` does when the ring of its thread is full.
+    enum class log_overflow {
+        drop,   //!< The line is lost and counted by `dropped()`. Logging never waits.
+        block   //!< The thread waits until the drain thread makes room. Nothing is lost.
+    };
+
+    /// @brief Whether ANSI colors of `ios_benders.h` reach the stream.
+    enum class log_colors {
+        automatic,  //!< Kept for `std::cout`, `std::cerr` and `std::clog` on a terminal, stripped otherwise.
+        keep,
+        strip
+    };
+
+    /// @brief Options of `log_sink`.
+    struct log_options {
+        std::size_t   ring_bytes=1<<16;    //!< Per thread, rounded up to a power of two.
+        log_overflow  overflow=log_overflow::drop;
+        log_colors    colors=log_colors::automatic;
+        unsigned      drain_ms=5;          //!< Longest time between drains when nobody asks for one.
+    };
+
+    /// @brief A logging target writing on a background thread. Log from any number of threads.
+    class log_sink: public ios_bender {
+    public:
+        /// @brief Not bound yet: the first stream it is put into with `<<` becomes its output.
+        explicit log_sink(const log_options& options={});
+
+        explicit log_sink(std::ostream& stream,const log_options& options={});
+
+        /// @brief Writes everything logged and flushes the stream.
+        ~log_sink() override;
+
+        log_sink(const log_sink&)=delete;
+        log_sink& operator = (const log_sink&)=delete;
+
+        /// @brief Binds the output stream, only once. Starts the drain thread.
+        void set(std::ios_base& stream) override;
+
+        /** @brief Queues `text` as it is, add `\n` for a line. Returns `false` when it was dropped.
+         *  @details Text longer than the ring is cut to its size. */
+        bool log(std::string_view text);
+
+        /// @brief Returns when all text logged before the call is written and the stream is flushed.
+        /// Returns at once when the sink has no stream yet.
+        void flush();
+
+        std::uint64_t dropped() const { return lost.load(std::memory_order_relaxed); }   //!< Lines dropped.
+        bool          colored() const { return with_colors; }     //!< Colors reach the stream.
+
+    private:
+        /// @brief Records are a 32 bit length and the text, wrapping around the end of the buffer.
+        struct ring {
+            explicit ring(std::size_t bytes);
+
+            std::thread::id                      owner;     //!< The only thread logging into it.
+            std::unique_ptr<char[]>              buffer;
+            std::size_t                          mask;
+            alignas(64) std::atomic<std::size_t> head{0};  //!< Written by the logging thread.
+            alignas(64) std::atomic<std::size_t> tail{0};  //!< Written by the drain thread.
+        };
+
+        log_options                        options;
+        std::uint64_t                      id;              //!< Unique, as addresses of sinks can repeat.
+        bool                               with_colors=true;
+        std::vector<std::unique_ptr<ring>> rings;           //!< Guarded by `lock`, only ever added.
+        std::mutex                         lock;
+        std::condition_variable            wake;            //!< For the drain thread.
+        std::condition_variable            drained;         //!< For threads in `flush()`.
+        std::uint64_t                      requested=0;     //!< Flushes asked for.
+        std::uint64_t                      done=0;          //!< Flushes finished.
+        bool                               stopping=false;
+        std::atomic<bool>                  running{false};  //!< The drain thread is started.
+        std::atomic<bool>                  hurry{false};    //!< A ring is over half full or a `log()` waits.
+        std::atomic<std::uint64_t>         lost{0};
+        std::thread                        drain;
+
+        ring& local();
+        void run();
+    };
+
+    /** @brief One line composed in a stack buffer and logged, with `\n`, when the object dies. Lines longer than
+     *  the buffer are cut. Strings, characters, integers, floating point numbers and typed values can be put. */
+    class log_line {
+    public:
+        explicit log_line(log_sink& sink):sink(sink) {}
+        ~log_line() { *end++='\n'; sink.log(std::string_view(text,std::size_t(end-text))); }
+
+        log_line(const log_line&)=delete;
+        log_line& operator = (const log_line&)=delete;
+
+        log_line& operator << (std::string_view s) {
+            const std::size_t n=std::min(s.size(),std::size_t(last-end));
+            end=std::copy(s.data(),s.data()+n,end);
+            return *this;
+        }
+        log_line& operator << (const char* s) { return *this<<std::string_view(s); }
+        log_line& operator << (const std::string& s) { return *this<<std::string_view(s); }
+        log_line& operator << (char c) { if(end!=last) *end++=c; return *this; }
+
+        template<class T,class=std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T,bool>>>
+        log_line& operator << (T v) {
+            const auto [ptr,ec]=std::to_chars(end,last,v);
+            if(ec==std::errc()) end=ptr;
+            return *this;
+        }
+
+        template<class T,class=std::enable_if_t<detail::is_formattable_v<T>>,class=void>
+        log_line& operator << (const T& v) {
+            const auto [ptr,ec]=format_to(end,last,v);
+            if(ec==std::errc()) end=ptr;
+            return *this;
+        }
+
+    private:
+        log_sink& sink;
+        char      text[512];
+        char*     end=text;
+        char*     last=text+sizeof text-1;    //!< Room for `\n`.
+    };
+}
+
+#endif //WB_IOS_LOGGING_H
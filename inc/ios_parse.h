@@ -0,0 +1,214 @@
+/** @file ios_parse.h @brief Reading of unit-annotated text into quantities, scalars and vectors, and of CSV/TSV tables.
+ *  @details
+ *      The mirror of `ios_format.h`. Numbers are read by `std::from_chars`, with no locale and no stream in between.
+ *      Units must be exactly `physical_unit::abbreviation()` and axes exactly `axis::name()` of the type read,
+ *      so `12.5[m/s]` is a `VelocitySI` but not a `DistSI`, and `X=12.5[m/s]` is a `VelAlong` but not a `VelAcross`.
+ *      `parse()` works like `std::from_chars`, `from_text()` throws `parse_error`.
+ *
+ *      `table_reader` maps a CSV or TSV file with a header of labels as `table_writer` writes them, e.g.
+ *      `pos.X[m]`, and reads the columns straight into typed arrays: the file is cut into chunks at line ends,
+ *      rows of every chunk are counted and then read on all cores (see `flw_parallel.h`). Fields are not quoted.
+ *      Non-template parts are in `ios_parse.cpp`.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_IOS_PARSE_H
+#define WB_IOS_PARSE_H
+
+#include "ios_format.h"
+#include "ios_snapshot.h"
+
+#include <charconv>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace merry_tools::iostreams {
+
+    /// @brief Text which is not a value of the type read, or a table without the columns asked for.
+    class parse_error: public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    namespace detail {
+        /// @brief End of `text` at the start of `[first,last)`, or `nullptr` when it is not there.
+        inline const char* expect(const char* first,const char* last,const char* text) {
+            for(;*text;text++,first++)
+                if(first==last || *first!=*text) return nullptr;
+            return first;
+        }
+
+        template<class FLOAT>
+        const char* get_number(const char* first,const char* last,FLOAT& v) {
+            auto [ptr,ec]=std::from_chars(first,last,v);
+            return ec==std::errc()?ptr:nullptr;
+        }
+
+        /// @brief `X=1.5[m]` into its raw value, or `nullptr` when the axis, number or unit does not match.
+        template<class AXIS,class QUANTITY>
+        const char* get_component(const char* first,const char* last,typename QUANTITY::value_type& v) {
+            if((first=expect(first,last,AXIS::name()))==nullptr || (first=expect(first,last,"="))==nullptr ||
+               (first=get_number(first,last,v))==nullptr) return nullptr;
+            return expect(first,last,QUANTITY::abbreviation());
+        }
+
+        inline const char* skip_blanks(const char* first,const char* last) {
+            while(first!=last && (*first==' ' || *first=='\t')) first++;
+            return first;
+        }
+
+        /// @brief A quantity, scalar or vector of zeros, as there are no default constructors.
+        template<class T>
+        T zero_of() {
+            if constexpr (math::expr::is_quantity<T>::value) {
+                return T{typename T::value_type(0)};
+            } else {
+                typedef typename math::expr::object_traits<T>::quantity q;
+                typedef typename math::expr::object_traits<T>::axes     axes;
+                const q zero{typename q::value_type(0)};
+                if constexpr (axes::size==1) return T{zero};
+                else if constexpr (axes::size==2)
+                    return T{math::Scalar<typename axes::template at<0>,q>{zero},
+                             math::Scalar<typename axes::template at<1>,q>{zero}};
+                else
+                    return T{math::Scalar<typename axes::template at<0>,q>{zero},
+                             math::Scalar<typename axes::template at<1>,q>{zero},
+                             math::Scalar<typename axes::template at<2>,q>{zero}};
+            }
+        }
+    }
+
+    // SINGLE VALUES:
+    //*//////////////
+
+    /// @brief Reads a quantity, scalar or vector as `format_to()` writes it, like `std::from_chars`: on success `ec`
+    /// is empty and `ptr` is the end of the text read, otherwise `ec` is `std::errc::invalid_argument` and `ptr`
+    /// is `first`. Components of vectors are separated by spaces or tabs. `v` is changed even on failure.
+    template<class T,class=std::enable_if_t<detail::is_formattable_v<T>>>
+    std::from_chars_result parse(const char* first,const char* last,T& v) {
+        const char* end;
+        if constexpr (math::expr::is_quantity<T>::value) {
+            end=detail::get_number(first,last,v.value);
+            if(end!=nullptr) end=detail::expect(end,last,T::abbreviation());
+        } else {
+            typedef math::expr::object_traits<T> traits;
+            typedef typename traits::axes        axes;
+            typedef typename traits::quantity    q;
+            end=detail::get_component<typename axes::template at<0>,q>(first,last,math::expr::component<0>(v));
+            if constexpr (axes::size>1)
+                if(end!=nullptr) end=detail::get_component<typename axes::template at<1>,q>(
+                                         detail::skip_blanks(end,last),last,math::expr::component<1>(v));
+            if constexpr (axes::size>2)
+                if(end!=nullptr) end=detail::get_component<typename axes::template at<2>,q>(
+                                         detail::skip_blanks(end,last),last,math::expr::component<2>(v));
+        }
+        if(end==nullptr) return {first,std::errc::invalid_argument};
+        return {end,std::errc()};
+    }
+
+    /// @brief The value in the whole `text`, e.g. `from_text<VelAlong>("X=12.5[m/s]")`. Throws `parse_error`.
+    template<class T,class=std::enable_if_t<detail::is_formattable_v<T>>>
+    T from_text(std::string_view text) {
+        T v=detail::zero_of<T>();
+        const char* last=text.data()+text.size();
+        const auto [end,ec]=parse(text.data(),last,v);
+        if(ec!=std::errc() || end!=last)
+            throw parse_error("'"+std::string(text)+"' is not like '"+to_string(detail::zero_of<T>())+"'");
+        return v;
+    }
+
+    // TABLES:
+    //*///////
+
+    /** @brief Reads columns of a CSV (or TSV) file with a header of labels like `positions.X[m]` into typed arrays.
+     *  @details Columns are bound by their name and type, the label must match, including the unit. Unbound
+     *  columns of the file are skipped. Arrays are resized by `read()` and must live until it returns. */
+    class table_reader {
+    public:
+        /// @brief Maps the file and reads its header. Throws `snapshot_error` when it can't be opened.
+        /// \param separator - `,` for CSV, `\t` for TSV
+        explicit table_reader(const std::string& path,char separator=',');
+
+        /// @brief Labels of the header, in order of columns.
+        const std::vector<std::string>& labels() const { return header; }
+
+        /// @brief Vectors, e.g. `VolumeArray<VolumePosition>`, from one column per axis. Throws `parse_error`
+        /// when a column is missing or has another unit.
+        template<class VEC>
+        table_reader& column(const std::string& name,VecArray<VEC>& values) {
+            typedef math::vec_traits<VEC> traits;
+            typedef typename traits::quantity::unit_type unit;
+            target t{{field(name,detail::label_v<typename traits::axis_x,unit>.text),
+                      field(name,detail::label_v<typename traits::axis_y,unit>.text),0},traits::dimensions,
+                     &get_values<typename traits::value_type>,[&values](std::size_t n,void* (&data)[3]) {
+                         values.resize(n);
+                         data[0]=values.xs(); data[1]=values.ys();
+                         if constexpr (traits::dimensions==3) data[2]=values.zs();
+                     }};
+            if constexpr (traits::dimensions==3)
+                t.fields[2]=field(name,detail::label_v<typename traits::axis_z,unit>.text);
+            targets.push_back(std::move(t));
+            return *this;
+        }
+
+        /// @brief Scalars or quantities into a container with `data()` and `resize()`, e.g. `std::vector<MassQuan>`.
+        template<class CONT,class=decltype(std::declval<CONT&>().data())>
+        table_reader& column(const std::string& name,CONT& values) {
+            typedef std::remove_cv_t<std::remove_reference_t<decltype(*values.data())>> element;
+            detail::check_in_place<element>();
+            const char* label;
+            if constexpr (math::expr::is_quantity<element>::value) {
+                label=element::abbreviation();
+            } else {
+                typedef math::expr::object_traits<element> traits;
+                static_assert(traits::axes::size==1,"Vectors go in VecArray, single axis scalars in containers!");
+                label=detail::label_v<typename traits::axes::template at<0>,typename traits::quantity::unit_type>.text;
+            }
+            targets.push_back(target{{field(name,label),0,0},1,&get_values<typename detail::raw_value<element>::type>,
+                                     [&values](std::size_t n,void* (&data)[3]) {
+                                         values.resize(n,detail::zero_of<element>());
+                                         data[0]=values.data();
+                                     }});
+            return *this;
+        }
+
+        /** @brief Reads all rows into the bound arrays, on all cores, `threads` limits them. Returns rows read.
+         *  @details Empty lines are skipped. Throws `parse_error` with the row and label of the first bad field. */
+        std::size_t read(unsigned threads=0);
+
+    private:
+        /// @brief Reads a number ending at `last`, returns `false` when it is not one.
+        typedef bool (*get_type)(const char* first,const char* last,void* column,std::size_t row);
+        typedef std::function<void(std::size_t rows,void* (&data)[3])> resize_type;
+
+        struct target {
+            std::size_t fields[3];
+            std::size_t components;
+            get_type    get;
+            resize_type resize;
+        };
+
+        mapped_file              file;
+        char                     separator;
+        std::vector<std::string> header;
+        std::size_t              body=0;        //!< Offset of the first row.
+        std::vector<target>      targets;
+
+        /// @brief Index of the column labelled as `table_writer` does it, throws `parse_error` if there is none.
+        std::size_t field(const std::string& name,const char* label) const;
+
+        template<class FLOAT>
+        static bool get_values(const char* first,const char* last,void* column,std::size_t row) {
+            auto [ptr,ec]=std::from_chars(first,last,static_cast<FLOAT*>(column)[row]);
+            return ec==std::errc() && ptr==last;
+        }
+    };
+}
+
+#endif //WB_IOS_PARSE_H
@@ -0,0 +1,170 @@
+/** @file ios_profiling.h @brief Scoped timers and hot counters per named region, reported by a stream bender.
+ *  @details
+ *      `PROFILE_SCOPE("name")` times the rest of the block, `PROFILE_COUNT("name",n)` adds `n` to a counter.
+ *      Every call site registers its region once (a function-local static), later passes only read the clock
+ *      (TSC on x86-64, `steady_clock` elsewhere) and update statistics of the calling thread: count, total,
+ *      extremes and a log2 histogram. There are no locks and no shared cache lines on the hot path.
+ *      Statistics of all threads, living and finished, are merged on demand into `profile_summaries()`,
+ *      a colored report by the `profile_report` bender at its destruction, or a JSON dump.
+ *
+ *      Defining `NO_PROFILING` before including this header turns both macros into nothing, like
+ *      `NO_MEMORY_GUARDS` does for `MEMORY_GUARD`. Non-template parts are in `ios_profiling.cpp`.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_IOS_PROFILING_H
+#define WB_IOS_PROFILING_H
+
+#include "ios_benders.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) && __has_include(<x86intrin.h>)
+#   include <x86intrin.h>
+#   define WB_PROFILE_TSC 1
+#else
+#   include <chrono>
+#   define WB_PROFILE_TSC 0
+#endif
+
+namespace merry_tools::iostreams {
+
+    /// @brief Buckets of histograms: bucket `b` counts values of `b` bits, the last one all longer.
+    inline constexpr std::size_t profile_buckets=48;
+
+    enum class profile_kind { timer, counter };
+
+    /// @brief Ticks of the profiling clock. Converted to nanoseconds only by reports.
+    inline std::uint64_t profile_ticks() {
+#if WB_PROFILE_TSC
+        return __rdtsc();
+#else
+        return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /// @brief Statistics of a region in one thread. Written only by that thread, read by reports at any time.
+    struct profile_stats {
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> total{0};
+        std::atomic<std::uint64_t> lowest{~std::uint64_t(0)};
+        std::atomic<std::uint64_t> highest{0};
+        std::atomic<std::uint64_t> buckets[profile_buckets]{};
+
+        /// @brief There is a single writer, so plain loads and stores do, with no read-modify-write.
+        void add(std::uint64_t v) {
+            constexpr auto r=std::memory_order_relaxed;
+            count.store(count.load(r)+1,r);
+            total.store(total.load(r)+v,r);
+            if(v<lowest.load(r)) lowest.store(v,r);
+            if(v>highest.load(r)) highest.store(v,r);
+            std::size_t b=0;
+            for(std::uint64_t x=v;x!=0 && b<profile_buckets-1;x>>=1) b++;
+            buckets[b].store(buckets[b].load(r)+1,r);
+        }
+    };
+
+    /// @brief A named call site, registered once. Regions with the same name are merged in reports.
+    class profile_region {
+    public:
+        /// @brief Registers the call site. Throws `std::length_error` above 4096 call sites in the program.
+        profile_region(const char* name,profile_kind kind);
+
+        /// @brief Statistics of this region in the calling thread.
+        profile_stats& local() const;
+
+    private:
+        std::size_t index;
+    };
+
+    /// @brief Times its scope into a region.
+    class scoped_timer {
+    public:
+        explicit scoped_timer(const profile_region& region):region(region),start(profile_ticks()) {}
+        ~scoped_timer() { region.local().add(profile_ticks()-start); }
+
+        scoped_timer(const scoped_timer&)=delete;
+        scoped_timer& operator = (const scoped_timer&)=delete;
+
+    private:
+        const profile_region& region;
+        std::uint64_t         start;
+    };
+
+    /// @brief Adds values, e.g. items of a phase, into a region.
+    class hot_counter {
+    public:
+        explicit hot_counter(const profile_region& region):region(region) {}
+        void add(std::uint64_t n=1) const { region.local().add(n); }
+
+    private:
+        const profile_region& region;
+    };
+
+    /// @brief Statistics of a region merged over all threads. Times in nanoseconds, counters as they are.
+    struct profile_summary {
+        std::string   name;
+        profile_kind  kind;
+        std::uint64_t count=0;
+        double        total=0;
+        double        lowest=0;
+        double        highest=0;
+        double        median=0;     //!< From the histogram, so only within a factor of two.
+        double        p99=0;        //!< Likewise.
+    };
+
+    /// @brief All regions with any hits, the biggest total first.
+    std::vector<profile_summary> profile_summaries();
+
+    /// @brief A colored table, one line per region.
+    void write_profile_report(std::ostream& out);
+
+    /// @brief `{"regions":[{"name":...,"kind":"timer","count":...,"total_ns":...},...]}`.
+    void write_profile_json(std::ostream& out);
+
+    /// @brief Writes the colored report on its stream when it dies, e.g. `std::clog<<profile_report();`
+    /// at the end of a block, or a named one living to the end of `main()`.
+    class profile_report: public ios_bender {
+    public:
+        profile_report() {}
+        explicit profile_report(std::ostream& stream):ios_bender(stream) {}
+        ~profile_report() override;
+    };
+}
+
+#define WB_PROFILE_CAT2(a,b) a##b
+#define WB_PROFILE_CAT(a,b) WB_PROFILE_CAT2(a,b)
+
+#ifdef PROFILE_SCOPE
+#   undef PROFILE_SCOPE
+#endif
+#ifdef PROFILE_COUNT
+#   undef PROFILE_COUNT
+#endif
+
+#ifdef NO_PROFILING
+#   define PROFILE_SCOPE(name)   static_assert(true,"profiling is off")
+#   define PROFILE_COUNT(name,n) ((void)0)
+#else
+/// Times the rest of the block as region `name`, a string literal.
+#   define PROFILE_SCOPE(name)                                                                                        \
+        static const ::merry_tools::iostreams::profile_region WB_PROFILE_CAT(wb_profile_region_,__LINE__){           \
+            name,::merry_tools::iostreams::profile_kind::timer};                                                      \
+        const ::merry_tools::iostreams::scoped_timer WB_PROFILE_CAT(wb_profile_timer_,__LINE__){                     \
+            WB_PROFILE_CAT(wb_profile_region_,__LINE__)}
+/// Adds `n` to the counter `name`, a string literal.
+#   define PROFILE_COUNT(name,n)                                                                                      \
+        do {                                                                                                          \
+            static const ::merry_tools::iostreams::profile_region wb_profile_counter{                                \
+                name,::merry_tools::iostreams::profile_kind::counter};                                                \
+            ::merry_tools::iostreams::hot_counter(wb_profile_counter).add(n);                                         \
+        } while(false)
+#endif
+
+#endif //WB_IOS_PROFILING_H
@@ -0,0 +1,306 @@
+/** @file ios_snapshot.h @brief Versioned binary snapshots of typed arrays, read back through `mmap` without copying.
+ *  @details
+ *      A snapshot is a 64 byte `snapshot_header`, one 256 byte `snapshot_column` per column, then raw values of
+ *      every component of every column, each aligned to 64 bytes like the columns of `VecArray`. So a mapped file
+ *      gives zero-copy `snapshot_view`s of vectors (e.g. `VolumePosition`) and `vec_span`s of scalars
+ *      (e.g. `MassQuan`) or quantities.
+ *
+ *      Every column keeps the name of its coordinate system, names of its axes, abbreviation of its unit and
+ *      storage precision. A typed view is given only when all of them match the requested type, otherwise
+ *      `snapshot_error` is thrown before any value is touched.
+ *
+ *      Files are written in the byte order of the writer, which is checked by the reader.
+ *      `snapshot_image` reads an image anywhere in memory, e.g. a frame of a trajectory (see `ios_trajectory.h`).
+ *      Mapping is implemented in `ios_snapshot.cpp`. Without `mmap` the file is read into memory.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_IOS_SNAPSHOT_H
+#define WB_IOS_SNAPSHOT_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_vec_batch.h"
+#include "mth_vec_expr.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace merry_tools::iostreams {
+
+    using math::VecArray;
+    using math::vec_span;
+    using math::vec_traits;
+
+    /// @brief Any problem with a snapshot: I/O, format, or types not matching the file.
+    struct snapshot_error: public std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    /// @brief Format version written. Readers reject other versions.
+    WB_GLOBAL_OUTSIDE_CLASS std::uint32_t snapshot_version=1;
+
+    // FILE LAYOUT:
+    //*////////////
+
+    /// @brief The beginning of every snapshot file.
+    struct snapshot_header {
+        char          magic[8];        //!< "MERRYSNP"
+        std::uint32_t version;         //!< `snapshot_version` of the writer.
+        std::uint32_t byte_order;      //!< 0x01020304 as written by the writer.
+        std::uint32_t columns;         //!< Number of `snapshot_column` records following the header.
+        std::uint32_t reserved0;
+        std::uint64_t image_bytes;     //!< Size of the whole image: the file or a frame of a trajectory.
+        std::uint64_t step;            //!< Simulation step of a trajectory frame, 0 otherwise.
+        double        time;            //!< Simulation time in [s] of a trajectory frame, 0 otherwise.
+        std::uint8_t  reserved[16];
+    };
+
+    /// @brief Description of a single column. Texts are zero terminated.
+    struct snapshot_column {
+        char          name[48];        //!< Given by the writer, e.g. "positions".
+        char          system[32];      //!< `coordinate_system::name()`, empty for bare quantities.
+        char          axes[3][16];     //!< `axis::name()` of every component, empty for bare quantities.
+        char          unit[32];        //!< `physical_unit::abbreviation()`.
+        std::uint32_t components;      //!< 1 for scalars and quantities, 2 or 3 for vectors.
+        std::uint32_t value_bytes;     //!< Storage precision: 4 for `float`, 8 for `double`.
+        std::uint64_t count;           //!< Number of elements.
+        std::uint64_t offset[3];       //!< Position of every component in the file.
+        std::uint8_t  reserved[56];
+    };
+
+    static_assert(sizeof(snapshot_header)==64 && sizeof(snapshot_column)==256,"The layout is a part of the format!");
+
+    namespace detail {
+        inline void put_text(char* field,std::size_t size,const char* text) {
+            const std::size_t length=std::strlen(text);
+            if(length>=size) throw snapshot_error(std::string("Too long for a snapshot: ")+text);
+            std::memcpy(field,text,length+1);
+        }
+
+        /// @brief Column of type `T` as it has to be in the file, without count and offsets.
+        template<class T>
+        snapshot_column describe() {
+            snapshot_column c{};
+            if constexpr (math::expr::is_quantity<T>::value) {
+                put_text(c.unit,sizeof c.unit,T::abbreviation());
+                c.components=1;
+                c.value_bytes=sizeof(typename T::value_type);
+            } else {
+                typedef math::expr::object_traits<T>  traits;
+                typedef typename traits::axes         axes;
+                typedef typename axes::template at<0> first;
+                put_text(c.system,sizeof c.system,first::system::name());
+                put_text(c.axes[0],sizeof c.axes[0],first::name());
+                if constexpr (axes::size>1) put_text(c.axes[1],sizeof c.axes[1],axes::template at<1>::name());
+                if constexpr (axes::size>2) put_text(c.axes[2],sizeof c.axes[2],axes::template at<2>::name());
+                put_text(c.unit,sizeof c.unit,traits::quantity::abbreviation());
+                c.components=axes::size;
+                c.value_bytes=sizeof(typename traits::value_type);
+            }
+            return c;
+        }
+
+        template<class T,class=void>
+        struct raw_value { typedef typename math::expr::object_traits<T>::value_type type; };
+
+        template<class T>
+        struct raw_value<T,std::enable_if_t<math::expr::is_quantity<T>::value>> {
+            typedef typename T::value_type type;
+        };
+
+        /// @brief Scalars and quantities are read in place, so they must be nothing more than their raw value.
+        template<class T,class VALUE=typename raw_value<T>::type>
+        constexpr void check_in_place() {
+            static_assert(std::is_standard_layout_v<T> && sizeof(T)==sizeof(VALUE) && alignof(T)==alignof(VALUE),
+                          "Only types made of a single raw value can be viewed in place!");
+        }
+
+        /// @brief Fills the header and offsets of columns with `components`, `value_bytes` and `count` set.
+        /// Returns the size of the whole image. Implemented in `ios_snapshot.cpp`.
+        std::uint64_t lay_out(snapshot_header& header,std::vector<snapshot_column>& records);
+
+        /// @brief Writes the image laid out by `lay_out()` into `out`, which has room for all of it.
+        void write_image(const snapshot_header& header,const std::vector<snapshot_column>& records,
+                         const std::vector<const void*>& data,unsigned char* out);
+    }
+
+    // WRITING:
+    //*////////
+
+    /// @brief Collects columns and writes them at once. Columns are not copied, they must live until `save()`.
+    class snapshot_writer {
+    public:
+        /// @brief Vectors, e.g. `VolumeArray<VolumePosition>`.
+        template<class VEC>
+        snapshot_writer& add(const std::string& name,const VecArray<VEC>& values) {
+            const void* data[3]={values.xs(),values.ys(),nullptr};
+            if constexpr (VecArray<VEC>::dimensions==3) data[2]=values.zs();
+            add_column(name,detail::describe<VEC>(),values.size(),data);
+            return *this;
+        }
+
+        /// @brief Scalars or quantities in a container with `data()` and `size()`, e.g. `std::vector<MassQuan>`.
+        template<class CONT,class=decltype(std::declval<const CONT&>().data())>
+        snapshot_writer& add(const std::string& name,const CONT& values) {
+            typedef std::remove_cv_t<std::remove_reference_t<decltype(*values.data())>> element;
+            detail::check_in_place<element>();
+            const void* data[3]={values.data(),nullptr,nullptr};
+            add_column(name,detail::describe<element>(),values.size(),data);
+            return *this;
+        }
+
+        /// @brief Writes all columns to `path` through a temporary file, so a failure never leaves half a file.
+        void save(const std::string& path) const;
+
+    private:
+        struct part {
+            snapshot_column column;
+            const void*     data[3];
+        };
+        std::vector<part> parts;
+
+        void add_column(const std::string& name,snapshot_column column,std::size_t count,const void* const data[3]);
+    };
+
+    // READING:
+    //*////////
+
+    /// @brief Read only, zero-copy view of vectors in a snapshot, with the interface of a constant `VecArray`.
+    template<class VEC>
+    class snapshot_view {
+        typedef vec_traits<VEC> traits;
+    public:
+        typedef typename traits::value_type  value_type;
+        typedef typename traits::quantity    quantity;
+
+        WB_STATIC_INSIDE_CLASS std::size_t dimensions=traits::dimensions;
+
+        std::size_t size()  const { return count; }
+        bool        empty() const { return count==0; }
+
+        template<std::size_t I>
+        const value_type* column() const { static_assert(I<dimensions); return columns[I]; }
+
+        const value_type* xs() const { return columns[0]; }
+        const value_type* ys() const { return columns[1]; }
+
+        template<std::size_t D=dimensions>
+        std::enable_if_t<D==3,const value_type*> zs() const { return columns[2]; }
+
+        VEC get(std::size_t i) const {
+            if constexpr (dimensions==2)
+                return VEC{ typename traits::scalar_x{quantity{columns[0][i]}},
+                            typename traits::scalar_y{quantity{columns[1][i]}} };
+            else
+                return VEC{ typename traits::scalar_x{quantity{columns[0][i]}},
+                            typename traits::scalar_y{quantity{columns[1][i]}},
+                            typename traits::scalar_z{quantity{columns[2][i]}} };
+        }
+
+        VEC operator [] (std::size_t i) const { return get(i); }
+
+        /// @brief Copy into a writable array, e.g. to go on with the simulation.
+        void copy_to(VecArray<VEC>& out) const {
+            out.resize(count);
+            if(count==0) return;
+            std::memcpy(out.xs(),columns[0],count*sizeof(value_type));
+            std::memcpy(out.ys(),columns[1],count*sizeof(value_type));
+            if constexpr (dimensions==3) std::memcpy(out.zs(),columns[2],count*sizeof(value_type));
+        }
+
+    private:
+        friend class snapshot_image;
+        const value_type* columns[dimensions]{};
+        std::size_t       count=0;
+    };
+
+    /** @brief Snapshot image in memory, with typed views of its columns. Does not own the memory.
+     *  @details The header and column records are checked on opening, types of columns when views are taken. */
+    class snapshot_image {
+    public:
+        snapshot_image()=default;
+
+        /// @brief Image at `base`, not longer than `available`. `what` names it in messages.
+        snapshot_image(const unsigned char* base,std::size_t available,const std::string& what);
+
+        snapshot_image(snapshot_image&& other) noexcept { *this=std::move(other); }
+        snapshot_image& operator = (snapshot_image&& other) noexcept;
+        snapshot_image(const snapshot_image&)=default;
+        snapshot_image& operator = (const snapshot_image&)=default;
+
+        std::size_t            columns() const { return column_count; }
+        const snapshot_column& column(std::size_t i) const { return records[i]; }
+        std::size_t            bytes()   const { return header.image_bytes; }
+        std::uint64_t          step()    const { return header.step; }
+        math::TimeSI64         time()    const { return math::TimeSI64{header.time}; }
+
+        /// @brief Column of the given name or `nullptr`.
+        const snapshot_column* find(const std::string& name) const;
+
+        /// @brief Vectors of the column, if it keeps exactly `VEC`: system, axes, unit and precision.
+        template<class VEC>
+        snapshot_view<VEC> vectors(const std::string& name) const {
+            const snapshot_column& c=checked(name,detail::describe<VEC>());
+            snapshot_view<VEC> view;
+            for(std::size_t k=0;k<view.dimensions;k++)
+                view.columns[k]=reinterpret_cast<const typename snapshot_view<VEC>::value_type*>(base+c.offset[k]);
+            view.count=c.count;
+            return view;
+        }
+
+        /// @brief Scalars or quantities of the column, e.g. `values<MassQuan>("masses")`, if the type matches.
+        template<class T>
+        vec_span<const T> values(const std::string& name) const {
+            detail::check_in_place<T>();
+            const snapshot_column& c=checked(name,detail::describe<T>());
+            return vec_span<const T>(reinterpret_cast<const T*>(base+c.offset[0]),c.count);
+        }
+
+    private:
+        const unsigned char*   base=nullptr;
+        snapshot_header        header{};
+        const snapshot_column* records=nullptr;
+        std::size_t            column_count=0;
+
+        const snapshot_column& checked(const std::string& name,const snapshot_column& expected) const;
+    };
+
+    /// @brief Read only file mapped into memory, or read into memory where `mmap` is missing.
+    class mapped_file {
+    public:
+        explicit mapped_file(const std::string& path);
+        ~mapped_file();
+
+        mapped_file(mapped_file&& other) noexcept;
+        mapped_file& operator = (mapped_file&& other) noexcept;
+        mapped_file(const mapped_file&)=delete;
+        mapped_file& operator = (const mapped_file&)=delete;
+
+        const unsigned char* data() const { return base; }
+        std::size_t          size() const { return bytes; }
+
+    private:
+        const unsigned char* base=nullptr;
+        std::size_t          bytes=0;
+
+        void release();
+    };
+
+    /// @brief Snapshot file mapped into memory. Views stay valid as long as the object.
+    class snapshot: public snapshot_image {
+    public:
+        explicit snapshot(const std::string& path);
+
+    private:
+        mapped_file file;
+    };
+}
+
+#endif //WB_IOS_SNAPSHOT_H
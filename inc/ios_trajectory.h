@@ -0,0 +1,144 @@
+/** @file ios_trajectory.h @brief Trajectories written by a background thread and read back frame by frame.
+ *  @details
+ *      `trajectory_writer::write()` copies the selected columns into one of `depth` staging buffers and returns,
+ *      while a background thread writes full buffers to the file in order. When all buffers wait for the disk,
+ *      `write()` blocks until one is free (backpressure) and `stalls()` counts it, so memory stays bounded.
+ *      Frames are decimated by `every` of the writer and single columns by their own `every`, e.g. positions
+ *      go to every frame and velocities to every tenth.
+ *
+ *      A trajectory file is a sequence of snapshot images (see `ios_snapshot.h`), each with its step and time.
+ *      `trajectory` maps the file and gives every frame as a `snapshot_image` with type checked views.
+ *      Non-template parts are in `ios_trajectory.cpp`.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_IOS_TRAJECTORY_H
+#define WB_IOS_TRAJECTORY_H
+
+#include "ios_snapshot.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace merry_tools::iostreams {
+
+    // WRITING:
+    //*////////
+
+    /// @brief Streams frames of typed columns to a file without stalling the simulation on I/O.
+    class trajectory_writer {
+    public:
+        /** \param path - the file, replaced if it exists
+         *  \param depth - staging buffers, i.e. frames copied but not written yet. At least 1
+         *  \param every - only steps divisible by it are written */
+        explicit trajectory_writer(const std::string& path,std::size_t depth=3,std::uint64_t every=1);
+
+        /// @brief Writes queued frames. Errors are lost, call `close()` to get them.
+        ~trajectory_writer();
+
+        trajectory_writer(const trajectory_writer&)=delete;
+        trajectory_writer& operator = (const trajectory_writer&)=delete;
+
+        /// @brief Vectors, e.g. `VolumeArray<VolumePosition>`, written when the step is divisible by `every`.
+        /// The array is read at every `write()`, so it may be resized in between.
+        template<class VEC>
+        trajectory_writer& column(const std::string& name,const VecArray<VEC>& values,std::uint64_t every=1) {
+            add_source(name,detail::describe<VEC>(),every,[&values](const void* (&data)[3]) {
+                data[0]=values.xs(); data[1]=values.ys();
+                if constexpr (VecArray<VEC>::dimensions==3) data[2]=values.zs();
+                return values.size();
+            });
+            return *this;
+        }
+
+        /// @brief Scalars or quantities in a container with `data()` and `size()`, e.g. `std::vector<MassQuan>`.
+        template<class CONT,class=decltype(std::declval<const CONT&>().data())>
+        trajectory_writer& column(const std::string& name,const CONT& values,std::uint64_t every=1) {
+            typedef std::remove_cv_t<std::remove_reference_t<decltype(*values.data())>> element;
+            detail::check_in_place<element>();
+            add_source(name,detail::describe<element>(),every,[&values](const void* (&data)[3]) {
+                data[0]=values.data();
+                return values.size();
+            });
+            return *this;
+        }
+
+        /// @brief Whether `write()` at this step writes anything.
+        bool due(std::uint64_t step) const { return step%every==0; }
+
+        /** @brief Copies columns due at `step` and queues the frame. Returns `false` for decimated steps.
+         *  @details Blocks while all staging buffers are queued. Rethrows errors of the background thread. */
+        bool write(std::uint64_t step,const math::TimeSI64& time);
+
+        /// @brief Returns when all queued frames are in the file.
+        void flush();
+
+        /// @brief Writes queued frames and closes the file. Rethrows errors of the background thread.
+        void close();
+
+        std::uint64_t frames() const { return written.load(std::memory_order_relaxed); }  //!< Frames in the file.
+        std::uint64_t stalls() const { return stalled.load(std::memory_order_relaxed); }  //!< Waits for a buffer.
+
+    private:
+        typedef std::function<std::size_t(const void* (&)[3])> fetch_type;
+
+        struct source {
+            snapshot_column column;
+            std::uint64_t   every;
+            fetch_type      fetch;
+        };
+
+        std::string                             path;
+        std::uint64_t                           every;
+        std::FILE*                              file=nullptr;
+        std::vector<source>                     sources;
+        std::vector<std::vector<unsigned char>> buffers;
+        std::deque<std::size_t>                 free_buffers;
+        std::deque<std::size_t>                 ready;          //!< In order, the front one is being written.
+        std::vector<snapshot_column>            records;        //!< Reused by every `write()`.
+        std::vector<const void*>                data;
+        std::mutex                              lock;
+        std::condition_variable                 changed;
+        bool                                    stopping=false;
+        std::exception_ptr                      error;
+        std::atomic<std::uint64_t>              written{0};
+        std::atomic<std::uint64_t>              stalled{0};
+        std::thread                             background;
+
+        void add_source(const std::string& name,snapshot_column column,std::uint64_t every,fetch_type fetch);
+        void rethrow();
+        void run();
+    };
+
+    // READING:
+    //*////////
+
+    /// @brief Trajectory file mapped into memory. Frames stay valid as long as the object.
+    class trajectory {
+    public:
+        /// @brief Maps the file and checks all frames. An incomplete last frame, e.g. after a crash, is skipped.
+        explicit trajectory(const std::string& path);
+
+        std::size_t           frames()   const { return images.size(); }
+        const snapshot_image& frame(std::size_t i) const { return images[i]; }
+
+        /// @brief `false` when the file ends with an incomplete frame.
+        bool complete() const { return whole; }
+
+    private:
+        mapped_file                 file;
+        std::vector<snapshot_image> images;
+        bool                        whole=true;
+    };
+}
+
+#endif //WB_IOS_TRAJECTORY_H
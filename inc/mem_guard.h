@@ -1,6 +1,6 @@
 /** @file
  * @brief  A control value/field template with a given length and uniq value.
- * @date 2024-10-24 (last modification)
+ * @date 2026-10-16 (last modification)
  */
 #ifndef MEMORY_GUARD_H
 #define MEMORY_GUARD_H
@@ -37,6 +37,12 @@ namespace merry_tools::memory {
             value>>=DESTR_SHIFT;                                                                 // PUT BREAKPOINT HERE!
         }
 
+        /// @brief Shifts the value like the destructor, but the object lives on. E.g. for blocks freed into a pool,
+        /// where a store in a destructor may be optimised away.
+        void retire() {                                                                        assert(is_constructed());
+            value>>=DESTR_SHIFT;
+        }
+
         [[maybe_unused]] [[nodiscard]] /// @brief It checks for construction and not destruction or accidental overwrite.
         bool is_constructed() const {
             // ReSharper disable once CppTooWideScope
@@ -96,7 +102,7 @@ namespace merry_tools::memory {
                                     bool valid_memory(const void* ptr) const       \
                                     {                                              \
                                       if(ptr!=nullptr) {                           \
-                                        if(_debug_memory_marker.is_valid())        \
+                                        if(_debug_memory_marker.is_constructed())  \
                                                        return true;                \
                                       }                                            \
                                       /*WB_TRAP("invalid memory of the object!");*/\
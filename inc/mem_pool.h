@@ -0,0 +1,237 @@
+/** @file mem_pool.h @brief Fixed-size block pools with per-thread caches and bump arenas, both with guard words.
+ *  @details
+ *      `block_pool` hands out blocks of one size from big slabs. Every thread keeps a small cache of free blocks,
+ *      so `allocate()` and `deallocate()` are a few instructions without locks, also for a thread using up to 16
+ *      pools in turn, and only a batch of blocks at a time goes between a cache and the shared free list.
+ *      `reset()` frees all blocks at once, e.g. all agents of a simulation step. `object_pool<T>` constructs and
+ *      destroys objects in such blocks.
+ *
+ *      `guarded_arena` is a bump allocator of a single thread, emptied at once by `reset()`.
+ *
+ *      With guards every block lies between two `memory::guard` words. `deallocate()` checks them and turns
+ *      the front one into its destructed value, so overruns and double frees fail an `assert`, and `validate()`
+ *      checks all blocks at any time, also with `NDEBUG`. Freed blocks are filled with `0xDD`. Like `MEMORY_GUARD`,
+ *      with `_NDEBUG` or `NO_MEMORY_GUARDS` defined before including this header there are no guard words at all.
+ *      Non-template parts are in `mem_pool.cpp`, which must be compiled with the same definitions.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_MEM_POOL_H
+#define WB_MEM_POOL_H
+
+#if defined(_NDEBUG) || defined(NO_MEMORY_GUARDS)                        // The same switch as of `MEMORY_GUARD`.
+#   define WB_POOL_GUARDS 0
+#else
+#   define WB_POOL_GUARDS 1
+#endif
+
+#include "mem_guard.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace merry_tools::memory {
+
+    /// @brief Whether blocks of pools and arenas are surrounded by guard words.
+    inline constexpr bool pool_guards=WB_POOL_GUARDS;
+
+    typedef guard<std::uint64_t,0x5AFEB10CC0DEF00Dull> front_guard;   //!< Before every guarded block.
+    typedef guard<std::uint64_t,0xE0FB10CCA11ED0F5ull> back_guard;    //!< After every guarded block.
+
+    // POOLS:
+    //*//////
+
+    /// @brief Blocks of a single size. Any thread may allocate and free, `reset()` and `validate()` only while
+    /// nobody does, e.g. between steps.
+    class block_pool {
+    public:
+        /** \param block_bytes - size of every block
+         *  \param alignment - of blocks, a power of two
+         *  \param slab_blocks - blocks allocated at once when the pool runs dry */
+        explicit block_pool(std::size_t block_bytes,std::size_t alignment=alignof(std::max_align_t),
+                            std::size_t slab_blocks=1024);
+        ~block_pool();
+
+        block_pool(const block_pool&)=delete;
+        block_pool& operator = (const block_pool&)=delete;
+
+        /// @brief An uninitialised block. Throws `std::bad_alloc` when no slab can be allocated.
+        void* allocate() {
+            cache& c=local();
+            if(c.count==0) refill(c);
+            void* p=c.head;
+            c.head=next_of(p);
+            c.count--;
+            return arm(p);
+        }
+
+        /// @brief Gives the block back, to the cache of the calling thread.
+        void deallocate(void* p) {
+            cache& c=local();
+            disarm(p);
+            next_of(p)=c.head;
+            c.head=p;
+            if(++c.count>=2*cache_blocks) spill(c);
+        }
+
+        /// @brief Frees all blocks of all threads at once, e.g. at the end of a step. Slabs are kept.
+        void reset();
+
+        /// @brief Checks guard words of all blocks, in use and free. Always `true` without guards.
+        bool validate() const;
+
+        std::size_t block_size() const { return bytes; }      //!< Usable bytes, `block_bytes` rounded up to 8.
+        std::size_t capacity() const;                         //!< Blocks in all slabs.
+
+    private:
+        /// @brief Free blocks of one thread, a list linked through the blocks themselves.
+        struct cache {
+            std::thread::id owner;
+            std::uint64_t   epoch=0;        //!< Of the pool when filled, older lists are forgotten by `reset()`.
+            void*           head=nullptr;
+            std::size_t     count=0;
+        };
+
+        static constexpr std::size_t cache_blocks=32;       //!< Blocks moved between a cache and the pool at once.
+
+        std::size_t                         bytes;
+        std::size_t                         alignment;
+        std::size_t                         front;          //!< Bytes before the block, the front guard in them.
+        std::size_t                         stride;
+        std::size_t                         slab_blocks;
+        std::uint64_t                       id;             //!< Unique, as addresses of pools can repeat.
+        std::atomic<std::uint64_t>          epoch{0};
+        mutable std::mutex                  lock;
+        std::vector<void*>                  slabs;          //!< Guarded by `lock`, like all below.
+        void*                               shared=nullptr; //!< Free list of the pool.
+        std::vector<std::unique_ptr<cache>> caches;
+
+        static void*& next_of(void* p) { return *static_cast<void**>(p); }
+
+        /// @brief Caches of the calling thread by pool ids, direct mapped. Ids are never reused, so an entry of
+        ///        a destroyed pool only misses. Pools of consecutive ids never evict each other.
+        struct known_cache {
+            std::uint64_t id=0;
+            cache*        mine=nullptr;
+        };
+        static constexpr std::size_t known_caches=16;
+
+        cache& local() {
+            thread_local known_cache known[known_caches];
+            known_cache& k=known[id%known_caches];
+            if(k.id!=id) { k.mine=&find_cache(); k.id=id; }
+            cache* mine=k.mine;
+            if(mine->epoch!=epoch.load(std::memory_order_relaxed)) {
+                mine->head=nullptr; mine->count=0;
+                mine->epoch=epoch.load(std::memory_order_relaxed);
+            }
+            return *mine;
+        }
+
+        cache& find_cache();
+        void refill(cache& c);
+        void spill(cache& c);
+        void add_slab();
+
+#if WB_POOL_GUARDS
+        void* arm(void* p) const {
+            new(static_cast<unsigned char*>(p)-sizeof(front_guard)) front_guard;
+            new(static_cast<unsigned char*>(p)+bytes) back_guard;
+            return p;
+        }
+        void disarm(void* p) const;
+#else
+        static void* arm(void* p) { return p; }
+        static void  disarm(void*) {}
+#endif
+    };
+
+    /// @brief Objects of `T` in blocks of a `block_pool`.
+    template<class T>
+    class object_pool {
+    public:
+        explicit object_pool(std::size_t slab_objects=1024):blocks(sizeof(T),alignof(T),slab_objects) {}
+
+        template<class... ARGS>
+        T* create(ARGS&&... args) {
+            void* p=blocks.allocate();
+            try {
+                return new(p) T(std::forward<ARGS>(args)...);
+            } catch(...) {
+                blocks.deallocate(p);
+                throw;
+            }
+        }
+
+        void destroy(T* p) {
+            p->~T();
+            blocks.deallocate(p);
+        }
+
+        /// @brief Frees all objects at once, without destructors.
+        void reset() {
+            static_assert(std::is_trivially_destructible_v<T>,"Reset would skip destructors, use destroy()!");
+            blocks.reset();
+        }
+
+        bool        validate() const { return blocks.validate(); }
+        std::size_t capacity() const { return blocks.capacity(); }
+
+    private:
+        block_pool blocks;
+    };
+
+    // ARENAS:
+    //*///////
+
+    /// @brief Bump allocator of a single thread, with guard words around every allocation when guards are on.
+    class guarded_arena {
+    public:
+        explicit guarded_arena(std::size_t chunk_bytes=1<<16):chunk_bytes(chunk_bytes) {}
+        ~guarded_arena();
+
+        guarded_arena(const guarded_arena&)=delete;
+        guarded_arena& operator = (const guarded_arena&)=delete;
+
+        /// @brief Uninitialised memory, `alignment` a power of two. Throws `std::bad_alloc`.
+        void* allocate(std::size_t bytes,std::size_t alignment=alignof(std::max_align_t));
+
+        /// @brief Uninitialised memory for `n` objects of `T`, never destroyed.
+        template<class T>
+        T* allocate(std::size_t n) {
+            static_assert(std::is_trivially_destructible_v<T>,"Destructors are never called in arenas!");
+            return static_cast<T*>(allocate(n*sizeof(T),alignof(T)));
+        }
+
+        /// @brief Frees everything at once. With guards, asserts that all allocations are intact first.
+        void reset();
+
+        /// @brief Checks guard words of all allocations since the last `reset()`. Always `true` without guards.
+        bool validate() const;
+
+        std::size_t used() const;          //!< Bytes allocated since the last `reset()`, guards included.
+        std::size_t capacity() const;      //!< Bytes of all chunks.
+
+    private:
+        struct chunk {
+            unsigned char* data;
+            std::size_t    size;
+            std::size_t    used=0;
+        };
+
+        std::size_t        chunk_bytes;
+        std::vector<chunk> chunks;
+        std::size_t        current=0;
+    };
+}
+
+#endif //WB_MEM_POOL_H
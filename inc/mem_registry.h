@@ -0,0 +1,109 @@
+/** @file mem_registry.h @brief Registry of live memory guards and a parallel sweep checking all of them at once.
+ *  @details
+ *      `registered_guard` is a `memory::guard` which enrols its address when constructed and withdraws it when
+ *      destroyed. Every thread enrols into its own shard of slots, so neither is more than a few instructions
+ *      without locks. A guard destroyed by another thread leaves a hole which the owner of the shard reuses later.
+ *
+ *      `validate_all()` sweeps all shards on all cores (see `flw_parallel.h`) and counts every registered guard
+ *      which no longer holds its constructed value, i.e. was overwritten by a stray write. Destroyed guards are
+ *      withdrawn before their marker is shifted, so they are never seen. An object relocated by `memcpy` or freed
+ *      without its destructor keeps its constructed value, and is found only once its memory is reused. Run it
+ *      while no thread destroys guarded objects, e.g. every N steps between steps of a soak test.
+ *
+ *      `REGISTERED_MEMORY_GUARD(type,value)` places one in a class like `MEMORY_GUARD` does, and is nothing
+ *      more than `MEMORY_GUARD` under `NO_MEMORY_GUARDS`. Non-template parts are in `mem_registry.cpp`.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_MEM_REGISTRY_H
+#define WB_MEM_REGISTRY_H
+
+#if defined(_NDEBUG) || defined(NO_MEMORY_GUARDS)
+#   define WB_REGISTERED_GUARDS 0
+#else
+#   define WB_REGISTERED_GUARDS 1
+#endif
+
+#include "mem_guard.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace merry_tools::memory {
+
+    /// @brief Size and the constructed value of a guard type, shared by all its instances.
+    struct guard_kind {
+        std::size_t   bytes;
+        std::uint64_t constructed;
+    };
+
+    template<typename UnsType,UnsType DEF_VALUE>
+    inline constexpr guard_kind guard_kind_v{sizeof(UnsType),std::uint64_t(DEF_VALUE)};
+
+    struct guard_shard;
+
+    /// @brief A place in the registry: the address of a guard value and its kind.
+    struct guard_slot {
+        std::atomic<const void*>       value{nullptr};
+        std::atomic<const guard_kind*> kind{nullptr};
+        guard_shard*                   owner=nullptr;
+    };
+
+    /// @brief Registers a guard value, returns its slot.
+    guard_slot* enrol_guard(const void* value,const guard_kind* kind);
+
+    /// @brief Forgets a slot of `enrol_guard()`, from any thread.
+    void withdraw_guard(guard_slot* slot);
+
+    /** @brief A `guard` known to the registry. Copies register themselves, assignment keeps the registration.
+     *  @details The guard value is the first member, so reading it through the slot reads the real marker. */
+    template<typename UnsType,UnsType DEF_VALUE,unsigned DESTR_SHIFT=4>
+    class registered_guard {
+        guard<UnsType,DEF_VALUE,DESTR_SHIFT> marker;
+        guard_slot*                          slot;
+
+    public:
+        registered_guard():slot(enrol_guard(&marker,&guard_kind_v<UnsType,DEF_VALUE>)) {}
+        registered_guard(const registered_guard&):registered_guard() {}
+        registered_guard& operator = (const registered_guard&) { return *this; }
+        ~registered_guard() { withdraw_guard(slot); }
+
+        [[nodiscard]] bool is_constructed() const { return marker.is_constructed(); }
+        [[nodiscard]] bool is_destructed() const { return marker.is_destructed(); }
+    };
+
+    /// @brief Outcome of `validate_all()`.
+    struct guard_report {
+        std::size_t              checked=0;       //!< Registered guards found.
+        std::size_t              overwritten=0;   //!< Without the constructed value.
+        std::vector<const void*> damaged;         //!< Addresses of overwritten guard values, a few.
+
+        bool ok() const { return overwritten==0; }
+    };
+
+    /** @brief Checks every registered guard, in parallel.
+     *  \param threads - upper limit of threads, 0 means all threads of the pool
+     *  \param addresses - at most so many addresses of damaged guards are kept in the report */
+    guard_report validate_all(unsigned threads=0,std::size_t addresses=64);
+
+    /// @brief Guards registered now, counted by a sweep of all slots. Not exact while threads enrol or withdraw.
+    std::size_t registered_guards();
+
+} //namespace merry_tools::memory
+
+#ifdef REGISTERED_MEMORY_GUARD
+#   undef REGISTERED_MEMORY_GUARD
+#endif
+
+#if WB_REGISTERED_GUARDS
+/// Like `MEMORY_GUARD`, with the marker checked also by `validate_all()`.
+#   define REGISTERED_MEMORY_GUARD(type,value)                                                                 \
+        ::merry_tools::memory::registered_guard<type,value> _debug_memory_marker;                                   \
+        bool valid_memory(const void* ptr) const { return ptr!=nullptr && _debug_memory_marker.is_constructed(); }
+#else
+#   define REGISTERED_MEMORY_GUARD(type,value) bool valid_memory(const void* ptr) const { return ptr!=nullptr; }
+#endif
+
+#endif //WB_MEM_REGISTRY_H
@@ -1,11 +1,22 @@
 /** @file
  *  @brief Klasa/y okrojonych float-ów
- *  @date 2024-10-24 (modification) */
+ *  @details `fix_float<TARGET,DISCRETE,MULTIPLIER,OFFSET,DIVISOR,OVERFLOW>` keeps a floating point value as an 8, 16
+ *           or 32-bit integer code: `code=round((value-OFFSET)*MULTIPLIER/DIVISOR)`. Bulk `encode()`/`decode()` of
+ *           `float` arrays run SIMD kernels (see `mth_fix_float.cpp`), selected like the ones of `mth_vec_batch.h`.
+ *  @date 2026-10-16 (modification) */
 #ifndef FLOAT16_H
 #define FLOAT16_H
 
-#include <cstdint>
 #include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSE2__) && defined(__x86_64__)
+#   include <immintrin.h>
+#endif
 
 /// @brief Math types & calculations
 namespace merry_tools::math {
@@ -13,51 +24,199 @@ namespace merry_tools::math {
     *  @{
     */
 
-    /// Unsigned UFloat16.
-    /// 2bytes positive float with resolution of 0.5[m], max(UFloat16)= ~0.5*65km min(UFloat16)=0km.
-    /// Range is checked in constructor & operators only in DEBUG mode (by `assert()`).
-    /// @note In RELEASE mode the difference with regular `float` is small, but in DEBUG mode it works 5 times slower.
-    /// @todo Na wzór tego pomysłu stworzyć szablon `fix_flat<type TARGETFLOAT,type DISCRETE,int MULTIPLIER>`
-    class UFloat16
+    // RAW KERNELS:
+    //*////////////
+
+    /// @brief Raw bulk conversions with runtime selected instruction set. Implemented in `mth_fix_float.cpp`.
+    /// `quantize` gives `out=round(clamp((in-offset)*scale,lo,hi))`, `dequantize` gives `out=in*step+offset`.
+    /// Rounding is to nearest even, exactly as in `fix_float`, so bulk and single conversions give the same codes.
+    namespace simd {
+        void quantize(const float* in,float offset,float scale,float lo,float hi,std::int8_t*   out,std::size_t n);
+        void quantize(const float* in,float offset,float scale,float lo,float hi,std::uint8_t*  out,std::size_t n);
+        void quantize(const float* in,float offset,float scale,float lo,float hi,std::int16_t*  out,std::size_t n);
+        void quantize(const float* in,float offset,float scale,float lo,float hi,std::uint16_t* out,std::size_t n);
+        void quantize(const float* in,float offset,float scale,float lo,float hi,std::int32_t*  out,std::size_t n);
+        void quantize(const float* in,float offset,float scale,float lo,float hi,std::uint32_t* out,std::size_t n);
+
+        void dequantize(const std::int8_t*   in,float offset,float step,float* out,std::size_t n);
+        void dequantize(const std::uint8_t*  in,float offset,float step,float* out,std::size_t n);
+        void dequantize(const std::int16_t*  in,float offset,float step,float* out,std::size_t n);
+        void dequantize(const std::uint16_t* in,float offset,float step,float* out,std::size_t n);
+        void dequantize(const std::int32_t*  in,float offset,float step,float* out,std::size_t n);
+        void dequantize(const std::uint32_t* in,float offset,float step,float* out,std::size_t n);
+    }
+
+    namespace detail {
+        /// @brief Rounding to nearest even, the same as SIMD conversions do. Inline `cvtss2si` where possible.
+        inline long long round_code(float v) {
+#if defined(__SSE2__) && defined(__x86_64__)
+            return _mm_cvtss_si64(_mm_set_ss(v));
+#else
+            return std::llrint(v);
+#endif
+        }
+
+        inline long long round_code(double v) {
+#if defined(__SSE2__) && defined(__x86_64__)
+            return _mm_cvtsd_si64(_mm_set_sd(v));
+#else
+            return std::llrint(v);
+#endif
+        }
+
+        /// @brief The biggest value of `FLOAT` not above `code`, so clamping never overflows the conversion.
+        template<class FLOAT>
+        constexpr FLOAT float_floor_of(long long code) {
+            constexpr int digits=std::numeric_limits<FLOAT>::digits;
+            long long top=code<0?-code:code;
+            int bits=0;
+            while(bits<62 && (top>>bits)!=0) bits++;
+            if(bits>digits) {
+                long long mask=(1LL<<(bits-digits))-1;
+                code=code<0?-((top+mask)&~mask):(code&~mask);
+            }
+            return FLOAT(code);
+        }
+
+        /// @brief `max` then `min` with the semantics of SIMD instructions, so NaN becomes `lo`.
+        template<class FLOAT>
+        constexpr FLOAT clamp_code(FLOAT v,FLOAT lo,FLOAT hi) {
+            v=v>lo?v:lo;
+            return v<hi?v:hi;
+        }
+    }
+
+    // OVERFLOW POLICIES:
+    //*//////////////////
+
+    /// @brief Out of range values are clamped to the nearest representable one.
+    struct fix_saturate {};
+
+    /// @brief Out of range values stop debug builds by `assert()`. In release mode they are clamped as well.
+    struct fix_assert {};
+
+    // THE TEMPLATE:
+    //*/////////////
+
+    /** @brief Floating point value kept as a small integer code.
+     *  @details The resolution is `DIVISOR/MULTIPLIER` of `TARGET` units and zero code means `OFFSET`.
+     *           The biggest code is reserved for "not assigned", like in a default constructed object.
+     *           Conversions round to nearest. They are inline, branchless and do not depend on the build mode,
+     *           except for the `assert()` of `fix_assert` policy.
+     *  \tparam TARGET - `float` or `double`, the type of values
+     *  \tparam DISCRETE - signed or unsigned 8, 16 or 32-bit integer type of codes
+     *  \tparam MULTIPLIER - codes per `DIVISOR` units of value, e.g. 2 for 0.5 resolution
+     *  \tparam OFFSET - value of zero code, e.g. 273 for temperatures in Kelvin around 0°C
+     *  \tparam DIVISOR - see `MULTIPLIER`, e.g. 10 with MULTIPLIER 1 gives 10 units resolution
+     *  \tparam OVERFLOW - `fix_assert` or `fix_saturate` */
+    template<class TARGET,class DISCRETE,int MULTIPLIER,int OFFSET=0,int DIVISOR=1,class OVERFLOW=fix_assert>
+    class fix_float
     {
+        static_assert(std::is_floating_point_v<TARGET>,"TARGET must be float or double!");
+        static_assert(std::is_integral_v<DISCRETE> && sizeof(DISCRETE)<=4,"DISCRETE must be 8, 16 or 32-bit integer!");
+        static_assert(MULTIPLIER>0 && DIVISOR>0,"The scale must be positive!");
+        static_assert(std::is_same_v<OVERFLOW,fix_assert> || std::is_same_v<OVERFLOW,fix_saturate>,
+                      "Unknown overflow policy!");
+
     public:
-        UFloat16():discreetValue(UINT16_MAX) {}
-        UFloat16(float value):discreetValue(static_cast<uint16_t>(_toInt*value)) { // NOLINT(*-explicit-constructor)
-                                                                                     assert(value*_toInt<(UINT16_MAX-1));
-        }
+        typedef TARGET   target_type;
+        typedef DISCRETE discrete_type;
 
-        UFloat16& operator = (float value) {                                         assert(value*_toInt<(UINT16_MAX-1));
-            discreetValue=static_cast<uint16_t>(_toInt*value);
+        static constexpr TARGET   scale=TARGET(MULTIPLIER)/TARGET(DIVISOR);  //!< Codes per unit.
+        static constexpr TARGET   step=TARGET(DIVISOR)/TARGET(MULTIPLIER);   //!< Resolution, i.e. units per code.
+        static constexpr TARGET   offset=TARGET(OFFSET);                     //!< Value of zero code.
+        static constexpr DISCRETE unassigned=std::numeric_limits<DISCRETE>::max();   //!< Reserved code.
+        static constexpr DISCRETE lowest_code=std::numeric_limits<DISCRETE>::min();
+        static constexpr DISCRETE highest_code=unassigned-1;
+        static constexpr TARGET   lo_limit=detail::float_floor_of<TARGET>(lowest_code);  //!< Clamp limits of codes
+        static constexpr TARGET   hi_limit=detail::float_floor_of<TARGET>(highest_code); //!< in `TARGET` precision.
+
+        /// @brief The smallest and the biggest value kept.
+        static constexpr TARGET lowest()  { return lo_limit*step+offset; }
+        static constexpr TARGET highest() { return hi_limit*step+offset; }
+
+        fix_float():discreetValue(unassigned) {}
+
+        fix_float(TARGET value):discreetValue(encode_one(value)) {}            // NOLINT(*-explicit-constructor)
+
+        fix_float& operator = (TARGET value) {
+            discreetValue=encode_one(value);
             return *this;
         }
 
-
-        UFloat16& operator += (float value) {
-            value+=static_cast<float>(*this);                                        assert(value*_toInt<(UINT16_MAX-1));
-            discreetValue=static_cast<uint16_t>(_toInt*value);
+        fix_float& operator += (TARGET value) {
+            discreetValue=encode_one(value+static_cast<TARGET>(*this));
             return *this;
         }
                                                                        // ReSharper disable once CppFunctionalStyleCast
-        operator float() const { return _toFloat * float(discreetValue); } // NOLINT(*-explicit-constructor)
+        operator TARGET() const { return TARGET(discreetValue)*step+offset; } // NOLINT(*-explicit-constructor)
 
-        bool isAssigned() const;
+        bool isAssigned() const { return discreetValue!=unassigned; }
         static bool isFloatingPoint() { return true; }
 
+        /// @brief Raw code, e.g. for files or network.
+        DISCRETE code() const { return discreetValue; }
+
+        /// @brief Object with the given raw code.
+        static fix_float from_code(DISCRETE c) { fix_float f; f.discreetValue=c; return f; }
+
+        /// @brief Code of a single value, with the overflow policy applied.
+        static DISCRETE encode_one(TARGET value) {
+            TARGET scaled=(value-offset)*scale;
+            if constexpr (std::is_same_v<OVERFLOW,fix_assert>)
+                assert(scaled>=lo_limit-TARGET(0.5) && scaled<=hi_limit+TARGET(0.5));
+            return static_cast<DISCRETE>(detail::round_code(detail::clamp_code(scaled,lo_limit,hi_limit)));
+        }
+
+        // BULK CONVERSIONS:
+        //*/////////////////
+
+        /// @brief Encodes `n` values at once, with SIMD for `float`. Checks of `fix_assert` run only in debug builds.
+        static void encode(const TARGET* in,fix_float* out,std::size_t n) {
+#ifndef NDEBUG
+            if constexpr (std::is_same_v<OVERFLOW,fix_assert>)
+                for(std::size_t i=0;i<n;i++) {
+                    TARGET scaled=(in[i]-offset)*scale;                                     // PUT BREAKPOINT HERE!
+                    assert(scaled>=lo_limit-TARGET(0.5) && scaled<=hi_limit+TARGET(0.5));
+                }
+#endif
+            if constexpr (std::is_same_v<TARGET,float>)
+                simd::quantize(in,offset,scale,lo_limit,hi_limit,codes(out),n);
+            else
+                for(std::size_t i=0;i<n;i++) out[i].discreetValue=encode_one(in[i]);
+        }
+
+        /// @brief Decodes `n` values at once, with SIMD for `float`.
+        static void decode(const fix_float* in,TARGET* out,std::size_t n) {
+            if constexpr (std::is_same_v<TARGET,float>)
+                simd::dequantize(codes(in),offset,step,out,n);
+            else
+                for(std::size_t i=0;i<n;i++) out[i]=in[i];
+        }
+
+        /// @brief Bulk encoding between containers with `data()` and `size()`, e.g. `std::vector`, of the same size.
+        template<class IN,class OUT>
+        static void encode(const IN& in,OUT& out) {                                   assert(in.size()==out.size());
+            encode(in.data(),out.data(),in.size());
+        }
+
+        /// @brief Bulk decoding between containers with `data()` and `size()` of the same size.
+        template<class IN,class OUT>
+        static void decode(const IN& in,OUT& out) {                                   assert(in.size()==out.size());
+            decode(in.data(),out.data(),in.size());
+        }
+
     private:
-        uint16_t discreetValue;
-        static constexpr float _toInt=2.0f;
-        static constexpr float _toFloat=1/_toInt;
-        static constexpr int _maxVal=UINT16_MAX-1;
+        DISCRETE discreetValue;
 
+        static DISCRETE*       codes(fix_float* p)       { return reinterpret_cast<DISCRETE*>(p); }
+        static const DISCRETE* codes(const fix_float* p) { return reinterpret_cast<const DISCRETE*>(p); }
     };
 
-    // METHOD IMPLEMENTATIONS:
-    //*///////////////////////
-
-    inline bool UFloat16::isAssigned() const
-    {
-        return discreetValue!=UINT16_MAX;
-    }
+    /// Unsigned UFloat16.
+    /// 2bytes positive float with resolution of 0.5[m], max(UFloat16)= ~0.5*65km min(UFloat16)=0km.
+    /// Range is checked in constructor & operators only in DEBUG mode (by `assert()`).
+    typedef fix_float<float,std::uint16_t,2> UFloat16;
 
     /** @} */
 } // merry_tools namespace
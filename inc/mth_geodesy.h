@@ -0,0 +1,229 @@
+/** @file mth_geodesy.h @brief Transforms between `Flat_simulation`, `Geographical`, `Earth_centered` and `Solar`.
+ *  @details
+ *      `GeoPosition` (see `mth_vectors.h`) is geodetic latitude, longitude and height on an `ellipsoid`, WGS 84
+ *      by default. `EarthPosition` is the same point in `Earth_centered` axes (ECEF), `SolarPosition` in `Solar` ones.
+ *      `Flat_simulation` positions (`VolumePosition` or `VolumePosition64`) are coordinates in a plane tangent
+ *      to the ellipsoid at the origin of a `local_frame`: `Along` to the east, `Across` to the north, `Upward` up.
+ *
+ *      Every transform exists for a single object and for whole spans. A frame keeps its rotation matrix and the
+ *      origin ready, so a batch is a loop of multiply-adds, and the trigonometry of geodetic positions goes through
+ *      SIMD registers in blocks of points (see `mth_geodesy.cpp`). Geodetic to local and back are single passes,
+ *      without `EarthPosition` in between.
+ *
+ *      `solar_frame` is a low precision model (about 0.01 degree): the Earth turns by its rotation angle, the axis
+ *      is tilted by the obliquity of J2000 and the Earth moves on a mean Keplerian orbit. `Solar` axes are those of
+ *      the ecliptic and equinox of J2000. Precession and nutation of the Earth's axis and the offset of the Sun from
+ *      the barycentre are ignored, so `Solar` here is heliocentric. Good for scenes, not for ephemerides.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_GEODESY_H
+#define WB_SIMULATIONS_GEODESY_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_vec_batch.h"
+#include "mth_vec_algebra.h"
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace merry_tools::math {
+
+    // REFERENCE ELLIPSOID AND FRAMES:
+    //*///////////////////////////////
+
+    /// @brief Shape of the Earth.
+    struct ellipsoid {
+        double a;   //!< Equatorial radius [m]
+        double f;   //!< Flattening
+
+        constexpr double b()  const { return a*(1-f); }          //!< Polar radius [m]
+        constexpr double e2() const { return f*(2-f); }          //!< Square of the first eccentricity
+    };
+
+    /// @brief The ellipsoid of GPS.
+    WB_GLOBAL_OUTSIDE_CLASS ellipsoid wgs84{6378137.0,1/298.257223563};
+
+    namespace detail {
+        /// @brief Rigid transform from `Earth_centered` axes: `rot*(p-shift)`, and back: `transposed(rot)*q+shift`.
+        struct rigid_transform {
+            double rot[9];      //!< Rows are the axes of the frame in `Earth_centered` ones.
+            double shift[3];    //!< Origin of the frame in `Earth_centered` axes.
+        };
+
+        // Raw kernels over triples of values, implemented in `mth_geodesy.cpp`. Geodetic triples are latitude,
+        // longitude and height. Input and output must not overlap.
+        void geo_to_earth(const double* in,double* out,std::size_t n,const ellipsoid& shape);
+        void earth_to_geo(const double* in,double* out,std::size_t n,const ellipsoid& shape);
+        void to_frame(const double* in,double* out,std::size_t n,const rigid_transform& t);
+        void to_frame(const double* in,float* out,std::size_t n,const rigid_transform& t);
+        void from_frame(const double* in,double* out,std::size_t n,const rigid_transform& t);
+        void from_frame(const float* in,double* out,std::size_t n,const rigid_transform& t);
+        void geo_to_frame(const double* in,double* out,std::size_t n,const ellipsoid& shape,const rigid_transform& t);
+        void geo_to_frame(const double* in,float* out,std::size_t n,const ellipsoid& shape,const rigid_transform& t);
+        void frame_to_geo(const double* in,double* out,std::size_t n,const ellipsoid& shape,const rigid_transform& t);
+        void frame_to_geo(const float* in,double* out,std::size_t n,const ellipsoid& shape,const rigid_transform& t);
+
+        /// @brief Rotation part of the transform, on typed axes.
+        template<class TO>
+        Mat3<earth_axes,TO,double> rotation_of(const rigid_transform& t) {
+            return {{{t.rot[0],t.rot[1],t.rot[2]},{t.rot[3],t.rot[4],t.rot[5]},{t.rot[6],t.rot[7],t.rot[8]}}};
+        }
+    }
+
+    /// @brief Plane tangent to the ellipsoid at a given origin, where `Flat_simulation` positions live.
+    class local_frame {
+    public:
+        explicit local_frame(const GeoPosition& origin,const ellipsoid& shape=wgs84);
+
+        const GeoPosition&   origin()       const { return origin_; }
+        const EarthPosition& origin_earth() const { return earth_; }
+        const ellipsoid&     shape()        const { return shape_; }
+        const detail::rigid_transform& transform() const { return transform_; }
+
+        /// @brief Rotation of `Earth_centered` directions and differences into the tangent plane.
+        Mat3<earth_axes,flat_axes,double> rotation() const { return detail::rotation_of<flat_axes>(transform_); }
+
+    private:
+        GeoPosition             origin_;
+        EarthPosition           earth_;
+        ellipsoid               shape_;
+        detail::rigid_transform transform_;
+    };
+
+    /// @brief Orientation of the Earth and its place on the orbit at one moment.
+    class solar_frame {
+    public:
+        /// \param since_j2000 - time since 2000-01-01 12:00 TT, UT1 is not told apart
+        explicit solar_frame(const TimeSI64& since_j2000);
+
+        const TimeSI64&      moment()       const { return moment_; }
+        const SolarPosition& earth_center() const { return earth_; }    //!< Centre of the Earth in `Solar` axes.
+        const detail::rigid_transform& transform() const { return transform_; }
+
+        /// @brief Rotation of `Earth_centered` directions and differences into `Solar` axes.
+        Mat3<earth_axes,solar_axes,double> rotation() const { return detail::rotation_of<solar_axes>(transform_); }
+
+    private:
+        TimeSI64                moment_;
+        SolarPosition           earth_;
+        detail::rigid_transform transform_;
+    };
+
+    // HELPERS FOR TYPE CHECKING:
+    //*//////////////////////////
+
+    namespace detail {
+        /// @brief Flat values of geodetic positions, with the same constness.
+        template<class GEO>
+        auto* flat_geo(vec_span<GEO> s) {
+            static_assert(std::is_same_v<std::remove_cv_t<GEO>,GeoPosition>,"Span of GeoPosition expected!");
+            static_assert(sizeof(GeoPosition)==3*sizeof(double) && std::is_standard_layout_v<GeoPosition>);
+            return reinterpret_cast<std::conditional_t<std::is_const_v<GEO>,const double*,double*>>(s.data());
+        }
+
+        /// @brief The same axes and unit as `VEC`, storage may differ, e.g. `VolumePosition` for `VolumePosition64`.
+        template<class VEC,class LIKE>
+        constexpr void check_position_like() {
+            typedef vec_traits<std::remove_cv_t<VEC>> t;
+            static_assert(t::dimensions==3,"Three dimensional positions expected!");
+            check_same_axes_and_unit<VEC,LIKE>();
+        }
+    }
+
+    // TRANSFORMS OF SINGLE POSITIONS:
+    //*///////////////////////////////
+
+    /// @brief Geodetic position to `Earth_centered` axes.
+    EarthPosition to_earth(const GeoPosition& p,const ellipsoid& shape=wgs84);
+
+    /// @brief `Earth_centered` position to geodetic one. Not for points within tens of kilometres from the centre.
+    GeoPosition to_geo(const EarthPosition& p,const ellipsoid& shape=wgs84);
+
+    /// @brief `Earth_centered` position to the tangent plane of the frame.
+    VolumePosition64 to_local(const EarthPosition& p,const local_frame& frame);
+
+    /// @brief Geodetic position to the tangent plane of the frame.
+    VolumePosition64 to_local(const GeoPosition& p,const local_frame& frame);
+
+    /// @brief Position in the tangent plane to `Earth_centered` axes.
+    EarthPosition to_earth(const VolumePosition64& p,const local_frame& frame);
+
+    /// @brief Position in the tangent plane to a geodetic one.
+    GeoPosition to_geo(const VolumePosition64& p,const local_frame& frame);
+
+    /// @brief `Earth_centered` position to `Solar` axes, at the moment of the frame.
+    SolarPosition to_solar(const EarthPosition& p,const solar_frame& frame);
+
+    /// @brief `Solar` position to `Earth_centered` axes, at the moment of the frame.
+    EarthPosition to_earth(const SolarPosition& p,const solar_frame& frame);
+
+    // BATCH TRANSFORMS ON SPANS (AoS):
+    //*////////////////////////////////
+    // Input spans may be spans of `const` elements or not. Output must not overlap with the input.
+    // Local positions may be `VolumePosition` or `VolumePosition64`.
+
+    /// @brief out[i]=to_earth(in[i])
+    template<class GEO,class EARTH>
+    void batch_to_earth(vec_span<GEO> in,vec_span<EARTH> out,const ellipsoid& shape=wgs84) {
+        detail::check_same_kind<EARTH,EarthPosition>();                                assert(in.size()==out.size());
+        detail::geo_to_earth(detail::flat_geo(in),detail::flat(out),in.size(),shape);
+    }
+
+    /// @brief out[i]=to_geo(in[i])
+    template<class EARTH,class GEO>
+    void batch_to_geo(vec_span<EARTH> in,vec_span<GEO> out,const ellipsoid& shape=wgs84) {
+        detail::check_same_kind<EARTH,EarthPosition>();                                assert(in.size()==out.size());
+        detail::earth_to_geo(detail::flat(in),detail::flat_geo(out),in.size(),shape);
+    }
+
+    /// @brief out[i]=to_local(in[i],frame) for `Earth_centered` positions.
+    template<class EARTH,class VEC>
+    void batch_earth_to_local(vec_span<EARTH> in,vec_span<VEC> out,const local_frame& frame) {
+        detail::check_same_kind<EARTH,EarthPosition>(); detail::check_position_like<VEC,VolumePosition>();
+        assert(in.size()==out.size());
+        detail::to_frame(detail::flat(in),detail::flat(out),in.size(),frame.transform());
+    }
+
+    /// @brief out[i]=to_earth(in[i],frame)
+    template<class VEC,class EARTH>
+    void batch_local_to_earth(vec_span<VEC> in,vec_span<EARTH> out,const local_frame& frame) {
+        detail::check_position_like<VEC,VolumePosition>(); detail::check_same_kind<EARTH,EarthPosition>();
+        assert(in.size()==out.size());
+        detail::from_frame(detail::flat(in),detail::flat(out),in.size(),frame.transform());
+    }
+
+    /// @brief out[i]=to_local(in[i],frame) for geodetic positions, in a single pass.
+    template<class GEO,class VEC>
+    void batch_geo_to_local(vec_span<GEO> in,vec_span<VEC> out,const local_frame& frame) {
+        detail::check_position_like<VEC,VolumePosition>();                             assert(in.size()==out.size());
+        detail::geo_to_frame(detail::flat_geo(in),detail::flat(out),in.size(),frame.shape(),frame.transform());
+    }
+
+    /// @brief out[i]=to_geo(in[i],frame), in a single pass.
+    template<class VEC,class GEO>
+    void batch_local_to_geo(vec_span<VEC> in,vec_span<GEO> out,const local_frame& frame) {
+        detail::check_position_like<VEC,VolumePosition>();                             assert(in.size()==out.size());
+        detail::frame_to_geo(detail::flat(in),detail::flat_geo(out),in.size(),frame.shape(),frame.transform());
+    }
+
+    /// @brief out[i]=to_solar(in[i],frame)
+    template<class EARTH,class SOLAR>
+    void batch_to_solar(vec_span<EARTH> in,vec_span<SOLAR> out,const solar_frame& frame) {
+        detail::check_same_kind<EARTH,EarthPosition>(); detail::check_same_kind<SOLAR,SolarPosition>();
+        assert(in.size()==out.size());
+        detail::to_frame(detail::flat(in),detail::flat(out),in.size(),frame.transform());
+    }
+
+    /// @brief out[i]=to_earth(in[i],frame) for `Solar` positions.
+    template<class SOLAR,class EARTH>
+    void batch_solar_to_earth(vec_span<SOLAR> in,vec_span<EARTH> out,const solar_frame& frame) {
+        detail::check_same_kind<SOLAR,SolarPosition>(); detail::check_same_kind<EARTH,EarthPosition>();
+        assert(in.size()==out.size());
+        detail::from_frame(detail::flat(in),detail::flat(out),in.size(),frame.transform());
+    }
+}
+
+#endif //WB_SIMULATIONS_GEODESY_H
@@ -0,0 +1,220 @@
+/** @file mth_integrators.h @brief Time integrators for typed particle states: Euler, semi-implicit Euler,
+ *         Velocity Verlet and RK4.
+ *  @details
+ *      `ParticleState<VolumePosition,VolumeVelocity>` keeps positions and velocities in SoA arrays. An `Integrator`
+ *      advances it by `TimeSpan` steps using a user callback, which fills accelerations for a range of particles:
+ *
+ *          accel(const ParticleState<POS,VEL>& s,std::size_t begin,std::size_t end,VecArray<ACC>& out);
+ *
+ *      The callback may read the whole state (e.g. for N-body forces), but writes only `out[begin,end)`. It is called
+ *      concurrently for disjoint ranges. For forces depending on a single particle only, `per_particle()` makes such
+ *      a callback from `ACC f(const POS&,const VEL&)`.
+ *
+ *      Every update is a single fused loop (see `mth_vec_expr.h`) run over chunks of particles on all cores
+ *      (see `flw_parallel.h`), so the units of every scheme are checked at compile time, too.
+ *      The results do not depend on the number of threads.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_INTEGRATORS_H
+#define WB_SIMULATIONS_INTEGRATORS_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_vec_batch.h"
+#include "mth_vec_expr.h"
+#include "flw_parallel.h"
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+namespace merry_tools::math {
+
+    /// @brief Available integration schemes.
+    enum class integration {
+        euler,                //!< Explicit, 1st order. Energy grows, for tests and comparisons only.
+        semi_implicit_euler,  //!< Symplectic, 1st order. Velocity first, then position with the new velocity.
+        velocity_verlet,      //!< Symplectic, 2nd order, single force evaluation per step. The default.
+        rk4                   //!< Classic Runge-Kutta, 4th order, four force evaluations per step.
+    };
+
+    /// @brief Name of the scheme, like "rk4".
+    constexpr const char* name(integration m) {
+        switch(m) {
+            case integration::euler:               return "euler";
+            case integration::semi_implicit_euler: return "semi-implicit euler";
+            case integration::velocity_verlet:     return "velocity verlet";
+            case integration::rk4:                 return "rk4";
+        }
+        return "?";
+    }
+
+    /** @brief Positions, velocities and time of a set of particles.
+     *  \tparam POS - position type, e.g. `VolumePosition` or `VolumePosition64`
+     *  \tparam VEL - velocity type with the same axes, e.g. `VolumeVelocity` */
+    template<class POS,class VEL>
+    struct ParticleState {
+        typedef POS position_type;
+        typedef VEL velocity_type;
+
+        VecArray<POS> pos;          //!< Positions, SoA.
+        VecArray<VEL> vel;          //!< Velocities, SoA.
+        TimeSI64      time{0.0};    //!< Time of the state, kept wide to not lose steps in long runs.
+
+        std::size_t size() const {                                               assert(pos.size()==vel.size());
+            return pos.size();
+        }
+
+        void resize(std::size_t n) { pos.resize(n); vel.resize(n); }
+
+        void push_back(const POS& p,const VEL& v) { pos.push_back(p); vel.push_back(v); }
+    };
+
+    /// @brief Callback for `Integrator` made from `ACC f(const POS&,const VEL&)`, for forces of single particles.
+    template<class FUN>
+    auto per_particle(FUN f) {
+        return [f](const auto& s,std::size_t begin,std::size_t end,auto& out) {
+            for(std::size_t i=begin;i<end;i++) out.set(i,f(s.pos.get(i),s.vel.get(i)));
+        };
+    }
+
+    /** @brief Multi-core integrator for `ParticleState<POS,VEL>` with accelerations of type `ACC`.
+     *  @details Work arrays are kept between steps, so a long run allocates only at the first step.
+     *           Velocity Verlet reuses accelerations of the previous step. Call `reset()` when the state is changed
+     *           outside of `step()`. With velocity dependent forces it is a 1st order scheme.
+     *  \tparam POS - position type
+     *  \tparam VEL - its time derivative
+     *  \tparam ACC - time derivative of VEL */
+    template<class POS,class VEL,class ACC>
+    class Integrator {
+        // Unit and axes checks once for all schemes.
+        static_assert((detail::check_rate_of<POS,VEL>(),detail::check_rate_of<VEL,ACC>(),true));
+
+    public:
+        typedef ParticleState<POS,VEL> state_type;
+
+        integration method;            //!< Scheme used by `step()`.
+        std::size_t min_chunk=4096;    //!< The smallest number of particles worth a thread.
+        unsigned    threads=0;         //!< Upper limit of threads, 0 means all cores.
+
+    private:
+        VecArray<ACC> acc;             //!< Accelerations of the current stage.
+        VecArray<ACC> acc_next;        //!< Accelerations at the end of Verlet step.
+        VecArray<VEL> dx;              //!< RK4 weighted sum of position slopes.
+        VecArray<ACC> dv;              //!< RK4 weighted sum of velocity slopes.
+        state_type    tmp;             //!< RK4 intermediate state.
+        bool          acc_valid=false; //!< `acc` holds accelerations of the current state.
+
+    public:
+        explicit Integrator(integration m=integration::velocity_verlet):method(m) {}
+
+        /// @brief Forgets accelerations cached between steps.
+        void reset() { acc_valid=false; }
+
+        /// @brief Advances the state by one step.
+        template<class ACCEL>
+        void step(state_type& s,const TimeSpan& dt,ACCEL&& accel) {
+            switch(method) {
+                case integration::euler:               euler(s,dt,accel);            break;
+                case integration::semi_implicit_euler: semi_implicit_euler(s,dt,accel); break;
+                case integration::velocity_verlet:     velocity_verlet(s,dt,accel);  break;
+                case integration::rk4:                 rk4(s,dt,accel);              break;
+            }
+        }
+
+        /// @brief Advances the state by `steps` steps.
+        template<class ACCEL>
+        void run(state_type& s,const TimeSpan& dt,std::size_t steps,ACCEL&& accel) {
+            for(std::size_t k=0;k<steps;k++) step(s,dt,accel);
+        }
+
+    private:
+        template<class FUN>
+        void for_chunks(std::size_t n,FUN&& fn) { flow::parallel_for(n,min_chunk,fn,threads); }
+
+        template<class ACCEL>
+        void accelerations(const state_type& s,ACCEL& accel,VecArray<ACC>& out) {
+            out.resize(s.size());
+            for_chunks(s.size(),[&](std::size_t b,std::size_t e) { accel(s,b,e,out); });
+        }
+
+        static void advance_time(state_type& s,const TimeSI& dt) { s.time=TimeSI64{s.time.value+dt.value}; }
+
+        template<class ACCEL>
+        void euler(state_type& s,const TimeSpan& dt,ACCEL& accel) {
+            accelerations(s,accel,acc);
+            for_chunks(s.size(),[&](std::size_t b,std::size_t e) {
+                evaluate(lazy(s.pos)+lazy(s.vel)*dt,s.pos,b,e);
+                evaluate(lazy(s.vel)+lazy(acc)*dt,s.vel,b,e);
+            });
+            advance_time(s,dt.val);
+            acc_valid=false;
+        }
+
+        template<class ACCEL>
+        void semi_implicit_euler(state_type& s,const TimeSpan& dt,ACCEL& accel) {
+            accelerations(s,accel,acc);
+            for_chunks(s.size(),[&](std::size_t b,std::size_t e) {
+                evaluate(lazy(s.vel)+lazy(acc)*dt,s.vel,b,e);
+                evaluate(lazy(s.pos)+lazy(s.vel)*dt,s.pos,b,e);
+            });
+            advance_time(s,dt.val);
+            acc_valid=false;
+        }
+
+        template<class ACCEL>
+        void velocity_verlet(state_type& s,const TimeSpan& dt,ACCEL& accel) {
+            if(!acc_valid || acc.size()!=s.size()) accelerations(s,accel,acc);
+            for_chunks(s.size(),[&](std::size_t b,std::size_t e) {
+                evaluate(lazy(s.pos)+lazy(s.vel)*dt+lazy(acc)*dt*dt/2,s.pos,b,e);
+            });
+            advance_time(s,dt.val);
+            accelerations(s,accel,acc_next);
+            for_chunks(s.size(),[&](std::size_t b,std::size_t e) {
+                evaluate(lazy(s.vel)+(lazy(acc)+lazy(acc_next))*dt/2,s.vel,b,e);
+            });
+            std::swap(acc,acc_next);
+            acc_valid=true;
+        }
+
+        template<class ACCEL>
+        void rk4(state_type& s,const TimeSpan& dt,ACCEL& accel) {
+            const std::size_t n=s.size();
+            const TimeSI h=dt.val;
+            const TimeSI half{h.value*0.5f};
+            tmp.resize(n); dx.resize(n); dv.resize(n);
+
+            accelerations(s,accel,acc);                                                                      // k1
+            for_chunks(n,[&](std::size_t b,std::size_t e) {
+                evaluate(lazy(s.vel),dx,b,e);
+                evaluate(lazy(acc),dv,b,e);
+                evaluate(lazy(s.pos)+lazy(s.vel)*half,tmp.pos,b,e);
+                evaluate(lazy(s.vel)+lazy(acc)*half,tmp.vel,b,e);
+            });
+            tmp.time=TimeSI64{s.time.value+half.value};
+
+            for(int k=2;k<=3;k++) {                                                                    // k2 and k3
+                const TimeSI& to=(k==2?half:h);
+                accelerations(tmp,accel,acc);
+                for_chunks(n,[&](std::size_t b,std::size_t e) {
+                    evaluate(lazy(dx)+lazy(tmp.vel)*2,dx,b,e);
+                    evaluate(lazy(dv)+lazy(acc)*2,dv,b,e);
+                    evaluate(lazy(s.pos)+lazy(tmp.vel)*to,tmp.pos,b,e);
+                    evaluate(lazy(s.vel)+lazy(acc)*to,tmp.vel,b,e);
+                });
+                tmp.time=TimeSI64{s.time.value+to.value};
+            }
+
+            accelerations(tmp,accel,acc);                                                                    // k4
+            for_chunks(n,[&](std::size_t b,std::size_t e) {
+                evaluate(lazy(s.pos)+(lazy(dx)+lazy(tmp.vel))*h/6,s.pos,b,e);
+                evaluate(lazy(s.vel)+(lazy(dv)+lazy(acc))*h/6,s.vel,b,e);
+            });
+            advance_time(s,h);
+            acc_valid=false;
+        }
+    };
+}
+
+#endif //WB_SIMULATIONS_INTEGRATORS_H
@@ -0,0 +1,196 @@
+/** @file mth_nbody.h @brief Newtonian gravity of N bodies: a direct SIMD sum and a Barnes-Hut tree.
+ *  @details
+ *      `Gravity<VolumePosition,VolumeAcceleration>` fills accelerations of all bodies from their positions and
+ *      masses (`MassSI` or `MassQuan` in any container with `data()` and `size()`). Positions may be any float
+ *      3D positions, e.g. `SolarOffset` relative to a common region of an `AnchoredArray`, accelerations must have
+ *      the same axes. Plummer `softening` keeps close encounters finite, bodies at the same place do not attract.
+ *
+ *      `gravity_method::direct` sums all pairs, O(n^2), exact to float. Sources go in tiles of L1 size, targets
+ *      in SIMD registers, one body of a tile at a time, so there are no horizontal sums. Chunks of targets run
+ *      on all cores (see `flw_parallel.h`). The best choice up to a few thousands of bodies.
+ *
+ *      `gravity_method::barnes_hut` sorts bodies by Morton codes (see `mth_spatial.h`) into an octree and replaces
+ *      far nodes by their masses at centres of mass, O(n log n). A node is far from a leaf, when it is farther than
+ *      `size/theta` plus the offset of its centre of mass from the centre of its box. All bodies of a leaf share
+ *      a single walk of the tree, and the list of nodes and bodies it collects goes through the same SIMD kernel
+ *      as the direct sum. Leaves run on all cores. `theta` 0.5 gives errors below 1% of typical accelerations,
+ *      `theta` 0 opens every node and gives the direct sum.
+ *
+ *      SIMD kernels follow `simd::active()` (see `mth_vec_batch.h`): `sse` and above use a reciprocal square root
+ *      with a Newton step, so they differ from `scalar` in the 6th digit.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_NBODY_H
+#define WB_SIMULATIONS_NBODY_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_reductions.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace merry_tools::math {
+
+    /// @brief Newtonian constant of gravitation [m^3/(kg*s^2)], CODATA 2018.
+    WB_GLOBAL_OUTSIDE_CLASS double gravitational_constant=6.67430e-11;
+
+    /// @brief Ways of `Gravity` to sum forces.
+    enum class gravity_method {
+        direct,      //!< All pairs, O(n^2).
+        barnes_hut,  //!< Octree with far nodes as single masses, O(n log n).
+        automatic    //!< `direct` up to `Gravity::direct_limit` bodies, `barnes_hut` above.
+    };
+
+    /// @brief Name of the method, like "barnes-hut".
+    constexpr const char* name(gravity_method m) {
+        switch(m) {
+            case gravity_method::direct:     return "direct";
+            case gravity_method::barnes_hut: return "barnes-hut";
+            case gravity_method::automatic:  return "automatic";
+        }
+        return "?";
+    }
+
+    namespace detail {
+        /// @brief Raw columns of bodies: positions and masses premultiplied by the gravitational constant.
+        struct gravity_bodies {
+            const float* x;
+            const float* y;
+            const float* z;
+            const float* gm;
+            std::size_t  n;
+        };
+
+        /// @brief Raw columns of accelerations.
+        struct gravity_out {
+            float* x;
+            float* y;
+            float* z;
+        };
+
+        // Raw kernels, implemented in `mth_nbody.cpp`. `eps2` is the square of the softening length.
+
+        /// @brief Accelerations of all bodies by all of them. Targets are split into chunks of `min_chunk` at least.
+        void direct_gravity(const gravity_bodies& b,float eps2,const gravity_out& out,std::size_t min_chunk,
+                            unsigned threads);
+
+        /// @brief Barnes-Hut octree over bodies sorted by Morton codes. Keeps its arrays between steps.
+        class gravity_tree {
+        public:
+            /// @brief Sorts bodies and builds the tree with leaves of at most `leaf_size` bodies, except
+            ///        for equal positions, and with masses and opening radii of nodes for `theta`.
+            ///        The largest nodes of at most `group_size` bodies share walks of the tree.
+            void build(const gravity_bodies& b,float theta,std::size_t leaf_size,std::size_t group_size,
+                       std::size_t min_chunk,unsigned threads);
+
+            /// @brief Accelerations of bodies given to `build()`, in their original order.
+            void accelerations(float eps2,const gravity_out& out,std::size_t min_chunk,unsigned threads) const;
+
+            std::size_t nodes()  const { return tree.size(); }
+            std::size_t leaves() const { return leaf_nodes.size(); }
+            std::size_t groups() const { return group_nodes.size(); }
+
+        private:
+            struct node {
+                std::uint32_t begin,end;       //!< Range of sorted bodies.
+                std::uint32_t first_child;
+                std::uint32_t children;        //!< 0 for leaves.
+                float         lo[3],hi[3];     //!< Bounding box of bodies.
+                float         c[3];            //!< Centre of mass.
+                float         gm;              //!< Total mass by the gravitational constant.
+                float         open2;           //!< Square of the distance, below which the node is opened.
+            };
+
+            std::vector<std::pair<std::uint64_t,std::uint32_t>> keys;    //!< Morton code and index of body.
+            std::vector<float>         x,y,z,gm;                          //!< Bodies in the order of `keys`.
+            std::vector<node>          tree;                              //!< Breadth first, children follow parents.
+            std::vector<std::uint32_t> leaf_nodes;
+            std::vector<std::uint32_t> group_nodes;
+
+            void moments(float theta,std::size_t min_chunk,unsigned threads);
+        };
+
+        /// @brief 3D float positions in metres and accelerations of the same axes in [m/s^2].
+        template<class POS,class ACC>
+        constexpr void check_gravity_of() {
+            typedef vec_traits<std::remove_cv_t<POS>> tp;
+            typedef vec_traits<std::remove_cv_t<ACC>> ta;
+            static_assert(tp::dimensions==3 && ta::dimensions==3,"Three dimensional vectors expected!");
+            static_assert(std::is_same_v<typename tp::value_type,float_base> &&
+                          std::is_same_v<typename ta::value_type,float_base>,"Vectors stored as float_base expected!");
+            static_assert(std::is_same_v<typename tp::quantity::unit_type,SI_length_unit>,"Positions expected!");
+            static_assert(std::is_same_v<typename ta::quantity::unit_type,SI_acceleration_unit>,
+                          "Accelerations expected!");
+            static_assert(std::is_same_v<typename tp::axis_x,typename ta::axis_x> &&
+                          std::is_same_v<typename tp::axis_y,typename ta::axis_y> &&
+                          std::is_same_v<typename tp::axis_z,typename ta::axis_z>,"Axes do not match!");
+        }
+    }
+
+    /** @brief Gravitational accelerations of bodies by each other, direct or by a Barnes-Hut tree.
+     *  @details Work arrays are kept between calls, so a long run allocates only at the first step.
+     *  \tparam POS - position type, e.g. `VolumePosition`
+     *  \tparam ACC - acceleration type with the same axes, e.g. `VolumeAcceleration` */
+    template<class POS,class ACC>
+    class Gravity {
+        static_assert((detail::check_gravity_of<POS,ACC>(),true));
+
+    public:
+        typedef typename vec_traits<POS>::quantity distance_type;   //!< E.g. `DistSI`.
+
+        gravity_method method=gravity_method::automatic;
+        distance_type  softening{0.f};        //!< Plummer softening length, 0 for point masses.
+        float          theta=0.5f;            //!< Opening angle of `barnes_hut`, smaller is slower and more exact.
+        std::size_t    direct_limit=4096;     //!< `automatic` sums all pairs up to that many bodies.
+        std::size_t    leaf_size=16;          //!< The most bodies in leaves of the tree.
+        std::size_t    group_size=256;        //!< The most bodies of nodes sharing a walk of the tree.
+        std::size_t    min_chunk=256;         //!< The smallest number of bodies worth a thread.
+        unsigned       threads=0;             //!< Upper limit of threads, 0 means all cores.
+
+        /// @brief Method used for `n` bodies.
+        gravity_method method_for(std::size_t n) const {
+            if(method!=gravity_method::automatic) return method;
+            return n<=direct_limit?gravity_method::direct:gravity_method::barnes_hut;
+        }
+
+        /// @brief Nodes of the last tree, 0 before the first `barnes_hut` call.
+        std::size_t tree_nodes() const { return tree.nodes(); }
+
+        /// @brief out[i]=sum of G*m[j]*(pos[j]-pos[i])/(|pos[j]-pos[i]|^2+softening^2)^1.5. `out` is resized.
+        template<class MASSES,class=std::enable_if_t<detail::is_measure_v<detail::element_of<MASSES>>>>
+        void accelerations(const VecArray<POS>& pos,const MASSES& masses,VecArray<ACC>& out) {
+            typedef detail::measure_of<detail::element_of<MASSES>> mass;
+            static_assert(std::is_same_v<typename mass::unit_type,SI_mass_unit>,"Masses expected!");
+            const std::size_t n=pos.size();                                                 assert(masses.size()==n);
+            out.resize(n);
+            if(n==0) return;
+
+            gm.resize(n);
+            const auto* m=masses.data();
+            for(std::size_t i=0;i<n;i++) gm[i]=static_cast<float>(gravitational_constant*detail::raw_of(m[i]));
+
+            const detail::gravity_bodies b{pos.xs(),pos.ys(),pos.zs(),gm.data(),n};
+            const detail::gravity_out    a{out.xs(),out.ys(),out.zs()};
+            const float eps2=softening.value*softening.value;
+            if(method_for(n)==gravity_method::direct) {
+                detail::direct_gravity(b,eps2,a,min_chunk,threads);
+            } else {
+                tree.build(b,theta,leaf_size,group_size,min_chunk,threads);
+                tree.accelerations(eps2,a,min_chunk,threads);
+            }
+        }
+
+    private:
+        std::vector<float>   gm;              //!< Masses by the gravitational constant.
+        detail::gravity_tree tree;
+    };
+
+}
+
+#endif //WB_SIMULATIONS_NBODY_H
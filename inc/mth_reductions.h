@@ -0,0 +1,284 @@
+/** @file mth_reductions.h @brief Typed parallel reductions: sums, min/max, bounding boxes, centroids, kinetic energy.
+ *  @details
+ *      Every reduction takes typed containers and returns typed results, e.g. a mass weighted centroid of
+ *      `VecArray<VolumePosition>` is a `VolumePosition` and the kinetic energy of masses and velocities is a quantity
+ *      in [kg*m^2/s^2]. Masses and other scalar weights come in any container with `data()` and `size()` of
+ *      `Scalar`s (like `MassQuan`) or of quantities (like `MassSI`).
+ *
+ *      Sums are accumulated in `double` with Neumaier compensation in 8 interleaved lanes, which compilers can keep
+ *      in SIMD registers. Blocks of `reduction_block` elements run on all cores (see `flw_parallel.h`) and their
+ *      partial sums are combined in block order, so results stay accurate for 10^7 and more `float` elements and do
+ *      not depend on the number of threads.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_REDUCTIONS_H
+#define WB_SIMULATIONS_REDUCTIONS_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_vec_expr.h"
+#include "flw_parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace merry_tools::math {
+
+    /// @brief Elements reduced by a single task. Results do not depend on the number of threads, only on this.
+    WB_GLOBAL_OUTSIDE_CLASS std::size_t reduction_block=4096;
+
+    /// @brief Axis aligned box of typed vectors, see `bounds()`.
+    template<class VEC>
+    struct bounding_box {
+        VEC lo;   //!< The smallest coordinates.
+        VEC hi;   //!< The biggest coordinates.
+    };
+
+    namespace detail {
+        /// @brief Neumaier (improved Kahan) summation. The error does not grow with the number of elements.
+        struct compensated_sum {
+            double sum=0;
+            double carry=0;
+
+            void add(double x) {
+                const double t=sum+x;
+                carry+=std::abs(sum)>=std::abs(x)?(sum-t)+x:(x-t)+sum;
+                sum=t;
+            }
+
+            void add(const compensated_sum& other) { add(other.sum); add(other.carry); }
+
+            double value() const { return sum+carry; }
+        };
+
+        /// @brief `N` compensated sums of `terms(i,double (&t)[N])` over `[0,n)`, block after block.
+        template<std::size_t N,class TERMS>
+        std::array<double,N> compensated_sums(std::size_t n,TERMS&& terms,unsigned threads) {
+            constexpr std::size_t lanes=8;
+            const std::size_t blocks=(n+reduction_block-1)/reduction_block;
+            std::vector<std::array<compensated_sum,N>> partial(blocks);
+            flow::parallel_for(blocks,4,[&](std::size_t b,std::size_t e) {
+                for(std::size_t k=b;k<e;k++) {
+                    const std::size_t first=k*reduction_block,last=std::min(n,first+reduction_block);
+                    compensated_sum lane[N][lanes];
+                    double t[lanes][N];
+                    std::size_t i=first;
+                    for(;i+lanes<=last;i+=lanes) {
+                        for(std::size_t l=0;l<lanes;l++) terms(i+l,t[l]);
+                        for(std::size_t j=0;j<N;j++) for(std::size_t l=0;l<lanes;l++) lane[j][l].add(t[l][j]);
+                    }
+                    for(std::size_t l=0;i<last;i++,l++) {
+                        terms(i,t[0]);
+                        for(std::size_t j=0;j<N;j++) lane[j][l].add(t[0][j]);
+                    }
+                    for(std::size_t j=0;j<N;j++) for(std::size_t l=0;l<lanes;l++) partial[k][j].add(lane[j][l]);
+                }
+            },threads);
+
+            std::array<compensated_sum,N> total;
+            for(const auto& p:partial) for(std::size_t j=0;j<N;j++) total[j].add(p[j]);
+            std::array<double,N> result{};
+            for(std::size_t j=0;j<N;j++) result[j]=total[j].value();
+            return result;
+        }
+
+        /// @brief `N` minima and maxima of `values(i,double (&v)[N])` over `[0,n)`. NaNs are skipped.
+        template<std::size_t N,class VALUES>
+        std::pair<std::array<double,N>,std::array<double,N>>
+        min_max_of(std::size_t n,VALUES&& values,unsigned threads) {
+            const std::size_t blocks=(n+reduction_block-1)/reduction_block;
+            std::vector<std::pair<std::array<double,N>,std::array<double,N>>> partial(blocks);
+            flow::parallel_for(blocks,4,[&](std::size_t b,std::size_t e) {
+                for(std::size_t k=b;k<e;k++) {
+                    auto& [lo,hi]=partial[k];
+                    lo.fill(std::numeric_limits<double>::infinity());
+                    hi.fill(-std::numeric_limits<double>::infinity());
+                    double v[N];
+                    for(std::size_t i=k*reduction_block;i<std::min(n,(k+1)*reduction_block);i++) {
+                        values(i,v);
+                        for(std::size_t j=0;j<N;j++) { lo[j]=v[j]<lo[j]?v[j]:lo[j]; hi[j]=v[j]>hi[j]?v[j]:hi[j]; }
+                    }
+                }
+            },threads);
+
+            std::pair<std::array<double,N>,std::array<double,N>> result;
+            result.first.fill(std::numeric_limits<double>::infinity());
+            result.second.fill(-std::numeric_limits<double>::infinity());
+            for(const auto& [lo,hi]:partial) for(std::size_t j=0;j<N;j++) {
+                result.first[j]=std::min(result.first[j],lo[j]);
+                result.second[j]=std::max(result.second[j],hi[j]);
+            }
+            return result;
+        }
+
+        /// @brief Element type of a container with `data()`.
+        template<class CONT>
+        using element_of=std::remove_cv_t<std::remove_reference_t<decltype(*std::declval<const CONT&>().data())>>;
+
+        /// @brief Quantity of a quantity or of a scalar, e.g. `MassSI` for `MassQuan`.
+        template<class T>
+        constexpr auto measure(const T& v) {
+            if constexpr (expr::is_quantity<T>::value) return v;
+            else return v.val;
+        }
+
+        template<class T>
+        using measure_of=decltype(measure(std::declval<T>()));
+
+        /// @brief Raw value of a quantity or of a scalar.
+        template<class T>
+        constexpr auto raw_of(const T& v) {
+            if constexpr (expr::is_quantity<T>::value) return v.value;
+            else return expr::component<0>(v);
+        }
+
+        /// @brief Quantity, scalar or vector made of raw values.
+        template<class T>
+        T make_from(const double* v) {
+            if constexpr (expr::is_quantity<T>::value) {
+                return T{static_cast<typename T::value_type>(v[0])};
+            } else {
+                typedef typename expr::object_traits<T>::quantity q;
+                typedef typename expr::object_traits<T>::axes     axes;
+                typedef typename q::value_type                    f;
+                if constexpr (axes::size==1) return T{q{static_cast<f>(v[0])}};
+                else if constexpr (axes::size==2)
+                    return T{Scalar<typename axes::template at<0>,q>{q{static_cast<f>(v[0])}},
+                             Scalar<typename axes::template at<1>,q>{q{static_cast<f>(v[1])}}};
+                else
+                    return T{Scalar<typename axes::template at<0>,q>{q{static_cast<f>(v[0])}},
+                             Scalar<typename axes::template at<1>,q>{q{static_cast<f>(v[1])}},
+                             Scalar<typename axes::template at<2>,q>{q{static_cast<f>(v[2])}}};
+            }
+        }
+
+        /// @brief Quantities and single axis scalars, the elements of containers reduced to a single value.
+        template<class T>
+        WB_GLOBAL_OUTSIDE_CLASS bool is_measure_v=expr::is_quantity<T>::value ||
+                                                  (expr::is_object_v<T> && !expr::is_vector_v<T>);
+
+        /// @brief Raw columns of all axes.
+        template<class VEC>
+        auto columns_of(const VecArray<VEC>& a) {
+            std::array<const typename VecArray<VEC>::value_type*,VecArray<VEC>::dimensions> cols{};
+            cols[0]=a.xs(); cols[1]=a.ys();
+            if constexpr (VecArray<VEC>::dimensions==3) cols[2]=a.zs();
+            return cols;
+        }
+    }
+
+    // SUMS:
+    //*/////
+
+    /// @brief Sum of quantities or scalars, e.g. the total mass of `std::vector<MassQuan>`.
+    template<class CONT,class=std::enable_if_t<detail::is_measure_v<detail::element_of<CONT>>>>
+    auto sum(const CONT& values,unsigned threads=0) {
+        typedef detail::element_of<CONT> element;
+        const auto* v=values.data();
+        const auto s=detail::compensated_sums<1>(values.size(),[v](std::size_t i,double (&t)[1]) {
+            t[0]=double(detail::raw_of(v[i]));
+        },threads);
+        return detail::make_from<element>(s.data());
+    }
+
+    /// @brief Sum of vectors, e.g. the total momentum of `VecArray` of momenta.
+    template<class VEC>
+    VEC sum(const VecArray<VEC>& values,unsigned threads=0) {
+        constexpr std::size_t D=VecArray<VEC>::dimensions;
+        const auto cols=detail::columns_of(values);
+        const auto s=detail::compensated_sums<D>(values.size(),[&cols](std::size_t i,double (&t)[D]) {
+            for(std::size_t a=0;a<D;a++) t[a]=cols[a][i];
+        },threads);
+        return detail::make_from<VEC>(s.data());
+    }
+
+    // EXTREMES:
+    //*/////////
+
+    /// @brief The smallest and the biggest of quantities or scalars. Must not be empty.
+    template<class CONT,class=std::enable_if_t<detail::is_measure_v<detail::element_of<CONT>>>>
+    auto min_max(const CONT& values,unsigned threads=0) {                                    assert(values.size()>0);
+        typedef detail::element_of<CONT> element;
+        const auto* v=values.data();
+        const auto [lo,hi]=detail::min_max_of<1>(values.size(),[v](std::size_t i,double (&t)[1]) {
+            t[0]=double(detail::raw_of(v[i]));
+        },threads);
+        return std::pair<element,element>{detail::make_from<element>(lo.data()),detail::make_from<element>(hi.data())};
+    }
+
+    /// @brief Axis aligned bounding box of vectors, e.g. of all positions. Must not be empty.
+    template<class VEC>
+    bounding_box<VEC> bounds(const VecArray<VEC>& values,unsigned threads=0) {                assert(!values.empty());
+        constexpr std::size_t D=VecArray<VEC>::dimensions;
+        const auto cols=detail::columns_of(values);
+        const auto [lo,hi]=detail::min_max_of<D>(values.size(),[&cols](std::size_t i,double (&t)[D]) {
+            for(std::size_t a=0;a<D;a++) t[a]=cols[a][i];
+        },threads);
+        return {detail::make_from<VEC>(lo.data()),detail::make_from<VEC>(hi.data())};
+    }
+
+    // CENTROIDS:
+    //*//////////
+
+    /// @brief Mean of positions. Must not be empty.
+    template<class POS>
+    POS centroid(const VecArray<POS>& pos,unsigned threads=0) {                                  assert(!pos.empty());
+        constexpr std::size_t D=VecArray<POS>::dimensions;
+        const auto cols=detail::columns_of(pos);
+        auto s=detail::compensated_sums<D>(pos.size(),[&cols](std::size_t i,double (&t)[D]) {
+            for(std::size_t a=0;a<D;a++) t[a]=cols[a][i];
+        },threads);
+        for(auto& v:s) v/=double(pos.size());
+        return detail::make_from<POS>(s.data());
+    }
+
+    /// @brief Weighted mean of positions, e.g. the center of mass for `MassQuan` weights. The total must not be 0.
+    template<class POS,class WEIGHTS>
+    POS centroid(const VecArray<POS>& pos,const WEIGHTS& weights,unsigned threads=0) {
+        constexpr std::size_t D=VecArray<POS>::dimensions;                         assert(weights.size()==pos.size());
+        const auto cols=detail::columns_of(pos);
+        const auto* w=weights.data();
+        const auto s=detail::compensated_sums<D+1>(pos.size(),[&cols,w](std::size_t i,double (&t)[D+1]) {
+            const double m=double(detail::raw_of(w[i]));
+            for(std::size_t a=0;a<D;a++) t[a]=m*cols[a][i];
+            t[D]=m;
+        },threads);                                                                                   assert(s[D]!=0);
+        double mean[D];
+        for(std::size_t a=0;a<D;a++) mean[a]=s[a]/s[D];
+        return detail::make_from<POS>(mean);
+    }
+
+    // ENERGY:
+    //*///////
+
+    /// @brief Kinetic energy in [kg*m^2/s^2] of masses moving with velocities: sum of m*v*v/2.
+    template<class MASSES,class VEL>
+    auto kinetic_energy(const MASSES& masses,const VecArray<VEL>& vel,unsigned threads=0) {
+        typedef detail::measure_of<detail::element_of<MASSES>> mass;
+        typedef typename vec_traits<VEL>::quantity             speed;
+        typedef decltype(std::declval<mass>()*std::declval<speed>()*std::declval<speed>()) energy;
+        static_assert(std::is_same_v<typename mass::unit_type,SI_mass_unit>,"Masses are needed!");
+        static_assert(std::is_same_v<typename speed::unit_type,SI_velocity_unit>,"Velocities are needed!");
+
+        constexpr std::size_t D=VecArray<VEL>::dimensions;                            assert(masses.size()==vel.size());
+        const auto cols=detail::columns_of(vel);
+        const auto* m=masses.data();
+        const auto s=detail::compensated_sums<1>(vel.size(),[&cols,m](std::size_t i,double (&t)[1]) {
+            double v2=0;
+            for(std::size_t a=0;a<D;a++) v2+=double(cols[a][i])*cols[a][i];
+            t[0]=0.5*double(detail::raw_of(m[i]))*v2;
+        },threads);
+        return detail::make_from<energy>(s.data());
+    }
+
+}
+
+#endif //WB_SIMULATIONS_REDUCTIONS_H
@@ -0,0 +1,602 @@
+/** @file mth_spatial.h @brief Spatial indices over `VecArray`s of positions: a hashed uniform grid and a linear octree.
+ *  @details
+ *      `UniformGrid<VolumePosition>` is a cell list: elements are counting-sorted into hashed cells of a given size.
+ *      It is the best choice for radius queries with a radius similar to the cell size, e.g. interactions with
+ *      a cut-off. Moved elements are handled by `update()`, which puts elements that left their cells on a short
+ *      "loose" list, and rebuilds only when the list gets long.
+ *
+ *      `MortonOctree<VolumePosition>` (a quadtree for 2D positions) sorts elements by Morton codes and builds
+ *      a tree of bounding boxes over the sorted ranges. It adapts to any density and radius, and it is the better
+ *      choice for k-nearest queries. `update()` refits the boxes to moved elements, keeping the order.
+ *
+ *      Both index the `VecArray` given to `rebuild()`, which must outlive them, and read current positions from it.
+ *      Single queries take typed points and return indices with typed distances (`DistSI` for `VolumePosition`).
+ *      Batched queries run on all cores (see `flw_parallel.h`) and return `neighbor_lists`.
+ *      Rebuilds compute keys and sort them on all cores, too.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_SPATIAL_H
+#define WB_SIMULATIONS_SPATIAL_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "flw_parallel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace merry_tools::math {
+
+    // QUERY RESULTS:
+    //*//////////////
+
+    /// @brief Single result of a spatial query.
+    template<class Q>
+    struct neighbor {
+        std::size_t index;     //!< Index of the element in the indexed array.
+        Q           distance;  //!< Distance from the query point.
+    };
+
+    /// @brief Results of batched queries, packed list after list. `begin(q)`/`end(q)` give results of the `q`-th query.
+    template<class Q>
+    class neighbor_lists {
+        std::vector<std::size_t> starts{0};
+        std::vector<neighbor<Q>> items;
+
+        template<class,class> friend class spatial_queries;
+
+    public:
+        std::size_t size()  const { return starts.size()-1; }        //!< Number of queries.
+        std::size_t total() const { return items.size(); }           //!< Number of all results.
+
+        std::size_t        count(std::size_t q) const { return starts[q+1]-starts[q]; }
+        const neighbor<Q>* begin(std::size_t q) const { return items.data()+starts[q]; }
+        const neighbor<Q>* end(std::size_t q)   const { return items.data()+starts[q+1]; }
+    };
+
+    namespace detail {
+        /// @brief Raw columns of all axes of `a`.
+        template<class VEC,class FLOAT>
+        void columns_of(const VecArray<VEC>& a,const FLOAT* (&out)[VecArray<VEC>::dimensions]) {
+            out[0]=a.xs(); out[1]=a.ys();
+            if constexpr (VecArray<VEC>::dimensions==3) out[2]=a.zs();
+        }
+
+        /// @brief Raw components of `v`.
+        template<class VEC,class FLOAT,std::size_t D>
+        void components_of(const VEC& v,FLOAT (&out)[D]) {
+            out[0]=v.x.val.value; out[1]=v.y.val.value;
+            if constexpr (D==3) out[2]=v.z.val.value;
+        }
+
+        template<class FLOAT>
+        bool by_distance(const neighbor<FLOAT>& a,const neighbor<FLOAT>& b) {
+            return a.distance.value<b.distance.value || (a.distance.value==b.distance.value && a.index<b.index);
+        }
+    }
+
+    // COMMON PART OF INDICES:
+    //*///////////////////////
+
+    /** @brief Batched queries and typed results, common to all indices. CRTP base.
+     *  @details `DERIVED` provides `radius(center,r,found)` and `nearest(center,k,found)`.
+     *  \tparam DERIVED - `UniformGrid<POS>` or `MortonOctree<POS>`
+     *  \tparam POS - position type, e.g. `VolumePosition` or `PlanePosition` */
+    template<class DERIVED,class POS>
+    class spatial_queries {
+        typedef vec_traits<POS> traits;
+
+    public:
+        typedef POS                                  position_type;
+        typedef typename traits::base_type           base_type;
+        typedef typename traits::value_type          value_type;
+        typedef typename traits::quantity            distance_type;  //!< E.g. `DistSI`.
+        typedef neighbor<distance_type>              neighbor_type;
+        typedef neighbor_lists<distance_type>        lists_type;
+
+        WB_STATIC_INSIDE_CLASS std::size_t dimensions=traits::dimensions;
+
+        std::size_t min_chunk=1024;    //!< The smallest number of elements or queries worth a thread.
+        unsigned    threads=0;         //!< Upper limit of threads, 0 means all cores.
+
+        /// @brief Elements within `r` of every point of `queries`, in no particular order.
+        void radius_all(const VecArray<POS>& queries,distance_type r,lists_type& out) const {
+            batch(queries,out,[&](const base_type& q,std::vector<neighbor_type>& found) { self().radius(q,r,found); });
+        }
+
+        /// @brief `k` nearest elements of every point of `queries`, nearest first.
+        void nearest_all(const VecArray<POS>& queries,std::size_t k,lists_type& out) const {
+            batch(queries,out,[&](const base_type& q,std::vector<neighbor_type>& found) { self().nearest(q,k,found); });
+        }
+
+    protected:
+        const VecArray<POS>* points=nullptr;   //!< The indexed array.
+
+        const DERIVED& self() const { return *static_cast<const DERIVED*>(this); }
+
+        std::size_t indexed() const { return points==nullptr?0:points->size(); }
+
+        static neighbor_type found_at(std::size_t i,value_type d2) { return {i,distance_type{std::sqrt(d2)}}; }
+
+        /// Squared distance between `c` and the `i`-th element.
+        static value_type distance2(const value_type (&c)[dimensions],const value_type* const (&cols)[dimensions],
+                                    std::size_t i) {
+            value_type d2=0;
+            for(std::size_t a=0;a<dimensions;a++) { const value_type d=cols[a][i]-c[a]; d2+=d*d; }
+            return d2;
+        }
+
+        /// Keeps the `k` nearest of `found`, nearest first.
+        static void keep_nearest(std::vector<neighbor_type>& found,std::size_t k) {
+            k=std::min(k,found.size());
+            std::partial_sort(found.begin(),found.begin()+k,found.end(),detail::by_distance<distance_type>);
+            found.erase(found.begin()+std::ptrdiff_t(k),found.end());
+        }
+
+    private:
+        template<class FUN>
+        void batch(const VecArray<POS>& queries,lists_type& out,FUN&& query) const {
+            struct piece {
+                std::size_t                first;
+                std::vector<std::size_t>   counts;
+                std::vector<neighbor_type> items;
+            };
+            std::vector<piece> pieces;
+            std::mutex         lock;
+            flow::parallel_for(queries.size(),min_chunk,[&](std::size_t b,std::size_t e) {
+                piece p{b,{},{}};
+                std::vector<neighbor_type> found;
+                for(std::size_t i=b;i<e;i++) {
+                    query(queries.get(i),found);
+                    p.counts.push_back(found.size());
+                    p.items.insert(p.items.end(),found.begin(),found.end());
+                }
+                std::lock_guard<std::mutex> guard(lock);
+                pieces.push_back(std::move(p));
+            },threads);
+
+            std::sort(pieces.begin(),pieces.end(),[](const piece& a,const piece& b) { return a.first<b.first; });
+            out.starts.assign(1,0);
+            out.items.clear();
+            for(piece& p:pieces) {
+                for(std::size_t c:p.counts) out.starts.push_back(out.starts.back()+c);
+                out.items.insert(out.items.end(),p.items.begin(),p.items.end());
+            }
+        }
+    };
+
+    // UNIFORM GRID:
+    //*/////////////
+
+    /** @brief Cell list with hashed cells of a fixed size, so empty space costs nothing.
+     *  \tparam POS - position type, e.g. `VolumePosition` or `PlanePosition` */
+    template<class POS>
+    class UniformGrid: public spatial_queries<UniformGrid<POS>,POS> {
+        typedef spatial_queries<UniformGrid<POS>,POS> base;
+        using base::dimensions;
+        using base::points;
+
+    public:
+        using typename base::value_type;
+        using typename base::base_type;
+        using typename base::distance_type;
+        using typename base::neighbor_type;
+
+        /// @brief `cell` should be close to the typical query radius.
+        explicit UniformGrid(distance_type cell):h(cell.value),inv_h(1/cell.value) {              assert(cell.value>0);
+        }
+
+        distance_type cell_size()    const { return distance_type{h}; }
+        std::size_t   size()         const { return this->indexed(); }
+        std::size_t   loose_count()  const { return loose.size(); }
+
+        /// @brief Indexes `pts` from scratch.
+        void rebuild(const VecArray<POS>& pts) {
+            points=&pts;
+            const std::size_t n=pts.size();
+            std::size_t buckets=64;
+            while(buckets<2*n) buckets*=2;
+            mask=buckets-1;
+
+            home.resize(n);
+            flow::parallel_for(n,this->min_chunk,[&](std::size_t b,std::size_t e) {
+                const value_type* cols[dimensions]; detail::columns_of(pts,cols);
+                for(std::size_t i=b;i<e;i++) home[i]=bucket_at(cols,i);
+            },this->threads);
+            for(std::size_t a=0;a<dimensions;a++) {
+                cell_lo[a]=std::numeric_limits<std::int64_t>::max();
+                cell_hi[a]=std::numeric_limits<std::int64_t>::min();
+            }
+            grow_bounds();
+
+            starts.assign(buckets+1,0);
+            for(std::size_t i=0;i<n;i++) starts[home[i]+1]++;
+            for(std::size_t b=0;b<buckets;b++) starts[b+1]+=starts[b];
+            order.resize(n);
+            std::vector<std::uint32_t> cursor(starts.begin(),starts.end()-1);
+            for(std::size_t i=0;i<n;i++) order[cursor[home[i]]++]=static_cast<std::uint32_t>(i);
+
+            loose.clear();
+            is_loose.assign(n,0);
+        }
+
+        /// @brief Follows elements moved since the last `rebuild()` or `update()`. Rebuilds, if the indexed array
+        ///        changed its size, or if more than 1/8 of elements left their cells.
+        void update() {                                                                       assert(points!=nullptr);
+            const std::size_t n=points->size();
+            if(n!=home.size()) { rebuild(*points); return; }
+            std::vector<unsigned char> left(n);
+            flow::parallel_for(n,this->min_chunk,[&](std::size_t b,std::size_t e) {
+                const value_type* cols[dimensions]; detail::columns_of(*points,cols);
+                for(std::size_t i=b;i<e;i++) left[i]=bucket_at(cols,i)!=home[i];
+            },this->threads);
+            grow_bounds();
+            for(std::size_t i=0;i<n;i++) if(left[i]) mark_loose(i);
+            if(loose.size()>n/8+64) rebuild(*points);
+        }
+
+        /// @brief Like `update()`, but checks only the listed elements.
+        void update(const std::vector<std::size_t>& moved) {                                  assert(points!=nullptr);
+            if(points->size()!=home.size()) { rebuild(*points); return; }
+            const value_type* cols[dimensions]; detail::columns_of(*points,cols);
+            for(std::size_t i:moved) {
+                if(bucket_at(cols,i)!=home[i]) mark_loose(i);
+                for(std::size_t a=0;a<dimensions;a++) {
+                    cell_lo[a]=std::min(cell_lo[a],cell_of(cols[a][i]));
+                    cell_hi[a]=std::max(cell_hi[a],cell_of(cols[a][i]));
+                }
+            }
+            if(loose.size()>points->size()/8+64) rebuild(*points);
+        }
+
+        /// @brief Elements within `r` of `center`, in no particular order.
+        void radius(const base_type& center,distance_type r,std::vector<neighbor_type>& found) const {
+            found.clear();
+            if(this->indexed()==0) return;
+            value_type c[dimensions]; detail::components_of(center,c);
+            const value_type* cols[dimensions]; detail::columns_of(*points,cols);
+            const value_type r2=r.value*r.value;
+
+            std::int64_t lo[dimensions],hi[dimensions],cur[dimensions];
+            double cells=1;
+            for(std::size_t a=0;a<dimensions;a++) {                      // Cells beyond elements are empty.
+                lo[a]=clamped_cell_of(c[a]-r.value,a); hi[a]=clamped_cell_of(c[a]+r.value,a);
+                cur[a]=lo[a];
+                cells*=double(hi[a]-lo[a]+1);
+            }
+            if(cells>double(starts.size())) {                             // Cheaper to check everything.
+                for(std::size_t i=0;i<home.size();i++) {
+                    const value_type d2=base::distance2(c,cols,i);
+                    if(d2<=r2) found.push_back(base::found_at(i,d2));
+                }
+                return;
+            }
+
+            for(;;) {
+                const std::size_t b=hash(cur);
+                for(std::uint32_t k=starts[b];k<starts[b+1];k++) {
+                    const std::uint32_t i=order[k];
+                    if(!in_cell(cols,i,cur)) continue;            // Other cell of the bucket, or moved out.
+                    const value_type d2=base::distance2(c,cols,i);
+                    if(d2<=r2) found.push_back(base::found_at(i,d2));
+                }
+                std::size_t a=0;
+                while(a<dimensions && ++cur[a]>hi[a]) { cur[a]=lo[a]; a++; }
+                if(a==dimensions) break;
+            }
+            for(std::uint32_t i:loose) {
+                if(bucket_at(cols,i)==home[i]) continue;                          // Back home, found above.
+                const value_type d2=base::distance2(c,cols,i);
+                if(d2<=r2) found.push_back(base::found_at(i,d2));
+            }
+        }
+
+        /// @brief `k` nearest elements of `center`, nearest first. Searches growing cubes of cells.
+        void nearest(const base_type& center,std::size_t k,std::vector<neighbor_type>& found) const {
+            found.clear();
+            if(this->indexed()==0 || k==0) return;
+            for(value_type r=h;;r*=2) {
+                radius(center,distance_type{r},found);
+                if(found.size()>=k || found.size()==this->indexed() || 2*r*inv_h>value_type(starts.size())) break;
+            }
+            if(found.size()<std::min(k,this->indexed())) {               // Radius got big, so check all at once.
+                value_type c[dimensions]; detail::components_of(center,c);
+                const value_type* cols[dimensions]; detail::columns_of(*points,cols);
+                found.clear();
+                for(std::size_t i=0;i<this->indexed();i++) found.push_back(base::found_at(i,base::distance2(c,cols,i)));
+            }
+            base::keep_nearest(found,k);
+        }
+
+    private:
+        value_type                 h;
+        value_type                 inv_h;
+        std::uint64_t              mask=0;
+        std::vector<std::uint32_t> home;      //!< Bucket of every element at the last rebuild.
+        std::vector<std::uint32_t> starts;    //!< The first position in `order` of every bucket, and the end.
+        std::vector<std::uint32_t> order;     //!< Elements sorted by buckets.
+        std::vector<std::uint32_t> loose;     //!< Elements which left their bucket since the last rebuild.
+        std::vector<unsigned char> is_loose;
+        std::int64_t               cell_lo[dimensions]={};   //!< Range of cells of all elements, current or past.
+        std::int64_t               cell_hi[dimensions]={};
+
+        std::int64_t cell_of(value_type v) const { return static_cast<std::int64_t>(std::floor(v*inv_h)); }
+
+        /// Cell of `v` along the axis `a`, clamped to the range of cells of elements before the cast, so any `v`
+        /// is fine, even the maximum or infinite.
+        std::int64_t clamped_cell_of(value_type v,std::size_t a) const {
+            const value_type q=std::floor(v*inv_h);
+            if(!(q>value_type(cell_lo[a]))) return cell_lo[a];
+            if(!(q<value_type(cell_hi[a]))) return cell_hi[a];
+            return static_cast<std::int64_t>(q);
+        }
+
+        /// Extends the range of cells to all elements.
+        void grow_bounds() {
+            if(this->indexed()==0) return;
+            const value_type* cols[dimensions]; detail::columns_of(*points,cols);
+            for(std::size_t a=0;a<dimensions;a++) {
+                const auto mm=std::minmax_element(cols[a],cols[a]+this->indexed());
+                cell_lo[a]=std::min(cell_lo[a],cell_of(*mm.first)); cell_hi[a]=std::max(cell_hi[a],cell_of(*mm.second));
+            }
+        }
+
+        std::size_t hash(const std::int64_t (&cell)[dimensions]) const {
+            std::uint64_t k=std::uint64_t(cell[0])*0x9E3779B97F4A7C15ull;
+            k^=std::uint64_t(cell[1])*0xC2B2AE3D27D4EB4Full;
+            if constexpr (dimensions==3) k^=std::uint64_t(cell[2])*0x165667B19E3779F9ull;
+            return static_cast<std::size_t>((k^(k>>29))&mask);
+        }
+
+        std::uint32_t bucket_at(const value_type* const (&cols)[dimensions],std::size_t i) const {
+            std::int64_t cell[dimensions];
+            for(std::size_t a=0;a<dimensions;a++) cell[a]=cell_of(cols[a][i]);
+            return static_cast<std::uint32_t>(hash(cell));
+        }
+
+        bool in_cell(const value_type* const (&cols)[dimensions],std::size_t i,
+                     const std::int64_t (&cell)[dimensions]) const {
+            for(std::size_t a=0;a<dimensions;a++) if(cell_of(cols[a][i])!=cell[a]) return false;
+            return true;
+        }
+
+        void mark_loose(std::size_t i) {
+            if(is_loose[i]) return;
+            is_loose[i]=1;
+            loose.push_back(static_cast<std::uint32_t>(i));
+        }
+    };
+
+    // LINEAR OCTREE:
+    //*//////////////
+
+    namespace detail {
+        /// @brief Bits of `v` spread to every 3rd bit, 21 bits at most.
+        inline std::uint64_t spread_by_3(std::uint64_t v) {
+            v&=0x1FFFFFull;
+            v=(v|v<<32)&0x1F00000000FFFFull;
+            v=(v|v<<16)&0x1F0000FF0000FFull;
+            v=(v|v<<8) &0x100F00F00F00F00Full;
+            v=(v|v<<4) &0x10C30C30C30C30C3ull;
+            v=(v|v<<2) &0x1249249249249249ull;
+            return v;
+        }
+
+        /// @brief Bits of `v` spread to every 2nd bit, 32 bits at most.
+        inline std::uint64_t spread_by_2(std::uint64_t v) {
+            v&=0xFFFFFFFFull;
+            v=(v|v<<16)&0x0000FFFF0000FFFFull;
+            v=(v|v<<8) &0x00FF00FF00FF00FFull;
+            v=(v|v<<4) &0x0F0F0F0F0F0F0F0Full;
+            v=(v|v<<2) &0x3333333333333333ull;
+            v=(v|v<<1) &0x5555555555555555ull;
+            return v;
+        }
+    }
+
+    /** @brief Octree (quadtree in 2D) of bounding boxes over elements sorted by Morton codes.
+     *  \tparam POS - position type, e.g. `VolumePosition` or `PlanePosition` */
+    template<class POS>
+    class MortonOctree: public spatial_queries<MortonOctree<POS>,POS> {
+        typedef spatial_queries<MortonOctree<POS>,POS> base;
+        using base::dimensions;
+        using base::points;
+
+    public:
+        using typename base::value_type;
+        using typename base::base_type;
+        using typename base::distance_type;
+        using typename base::neighbor_type;
+
+        WB_STATIC_INSIDE_CLASS int         bits=dimensions==3?21:32;   //!< Bits of Morton codes per axis.
+        WB_STATIC_INSIDE_CLASS std::size_t children_max=std::size_t(1)<<dimensions;
+
+        std::size_t leaf_size=16;      //!< Leaves hold at most that many elements, except for equal positions.
+
+        std::size_t size()  const { return this->indexed(); }
+        std::size_t nodes() const { return tree.size(); }
+
+        /// @brief Indexes `pts` from scratch.
+        void rebuild(const VecArray<POS>& pts) {
+            points=&pts;
+            const std::size_t n=pts.size();
+            tree.clear(); leaves.clear();
+            keys.resize(n);
+            if(n==0) return;
+
+            // Bounding box, then Morton codes of positions within it.
+            value_type lo[dimensions],hi[dimensions];
+            bounds(lo,hi);
+            double scale[dimensions];
+            const double cells=double((std::uint64_t(1)<<bits)-1);
+            for(std::size_t a=0;a<dimensions;a++) scale[a]=hi[a]>lo[a]?cells/(double(hi[a])-lo[a]):0;
+            flow::parallel_for(n,this->min_chunk,[&](std::size_t b,std::size_t e) {
+                const value_type* cols[dimensions]; detail::columns_of(pts,cols);
+                for(std::size_t i=b;i<e;i++) {
+                    std::uint64_t code=0;
+                    for(std::size_t a=0;a<dimensions;a++) {
+                        auto q=static_cast<std::uint64_t>((double(cols[a][i])-lo[a])*scale[a]);
+                        code|=(dimensions==3?detail::spread_by_3(q):detail::spread_by_2(q))<<a;
+                    }
+                    keys[i]={code,static_cast<std::uint32_t>(i)};
+                }
+            },this->threads);
+            flow::parallel_sort(keys.begin(),keys.end(),std::less<>{},this->min_chunk*16,this->threads);
+
+            // Nodes breadth first, so children always follow their parents.
+            tree.push_back(node{0,static_cast<std::uint32_t>(n),0,0,{},{}});
+            std::vector<int> level{bits-1};
+            for(std::size_t q=0;q<tree.size();q++) {
+                const std::uint32_t b=tree[q].begin,e=tree[q].end;
+                if(e-b<=leaf_size) { leaves.push_back(static_cast<std::uint32_t>(q)); continue; }
+                std::uint32_t split[children_max+1];
+                int l=level[q];
+                for(;l>=0;l--) {                                            // Levels with a single child are skipped.
+                    const unsigned shift=unsigned(l)*unsigned(dimensions);
+                    split[0]=b;
+                    for(std::size_t o=0;o<children_max;o++)
+                        split[o+1]=static_cast<std::uint32_t>(std::partition_point(keys.begin()+split[o],keys.begin()+e,
+                            [&](const key& k) { return ((k.first>>shift)&(children_max-1))<=o; })-keys.begin());
+                    std::size_t used=0;
+                    for(std::size_t o=0;o<children_max;o++) used+=split[o]!=split[o+1];
+                    if(used>1) break;
+                }
+                if(l<0) { leaves.push_back(static_cast<std::uint32_t>(q)); continue; }  // Equal positions only.
+                tree[q].first_child=static_cast<std::uint32_t>(tree.size());
+                for(std::size_t o=0;o<children_max;o++) {
+                    if(split[o]==split[o+1]) continue;
+                    tree.push_back(node{split[o],split[o+1],0,0,{},{}});
+                    level.push_back(l-1);
+                    tree[q].children++;
+                }
+            }
+            update();
+        }
+
+        /// @brief Refits bounding boxes to moved elements. The tree gets slower, but stays exact.
+        ///        Rebuild, when elements moved far. The indexed array must keep its size.
+        void update() {                                                                       assert(points!=nullptr);
+            assert(points->size()==keys.size());
+            flow::parallel_for(leaves.size(),std::max<std::size_t>(1,this->min_chunk/leaf_size),
+                               [&](std::size_t b,std::size_t e) {
+                const value_type* cols[dimensions]; detail::columns_of(*points,cols);
+                for(std::size_t l=b;l<e;l++) {
+                    node& nd=tree[leaves[l]];
+                    for(std::size_t a=0;a<dimensions;a++) {
+                        nd.lo[a]=std::numeric_limits<value_type>::max();
+                        nd.hi[a]=std::numeric_limits<value_type>::lowest();
+                        for(std::uint32_t k=nd.begin;k<nd.end;k++) {
+                            const value_type v=cols[a][keys[k].second];
+                            nd.lo[a]=std::min(nd.lo[a],v); nd.hi[a]=std::max(nd.hi[a],v);
+                        }
+                    }
+                }
+            },this->threads);
+            for(std::size_t q=tree.size();q-->0;) {
+                node& nd=tree[q];
+                if(nd.children==0) continue;
+                for(std::size_t a=0;a<dimensions;a++) {
+                    nd.lo[a]=tree[nd.first_child].lo[a]; nd.hi[a]=tree[nd.first_child].hi[a];
+                    for(std::uint32_t c=1;c<nd.children;c++) {
+                        nd.lo[a]=std::min(nd.lo[a],tree[nd.first_child+c].lo[a]);
+                        nd.hi[a]=std::max(nd.hi[a],tree[nd.first_child+c].hi[a]);
+                    }
+                }
+            }
+        }
+
+        /// @brief Elements within `r` of `center`, in no particular order.
+        void radius(const base_type& center,distance_type r,std::vector<neighbor_type>& found) const {
+            found.clear();
+            if(tree.empty()) return;
+            value_type c[dimensions]; detail::components_of(center,c);
+            const value_type* cols[dimensions]; detail::columns_of(*points,cols);
+            const value_type r2=r.value*r.value;
+            std::vector<std::uint32_t> stack{0};
+            while(!stack.empty()) {
+                const node& nd=tree[stack.back()]; stack.pop_back();
+                if(box_distance2(nd,c)>r2) continue;
+                if(nd.children==0) {
+                    for(std::uint32_t k=nd.begin;k<nd.end;k++) {
+                        const value_type d2=base::distance2(c,cols,keys[k].second);
+                        if(d2<=r2) found.push_back(base::found_at(keys[k].second,d2));
+                    }
+                }
+                else for(std::uint32_t ch=0;ch<nd.children;ch++) stack.push_back(nd.first_child+ch);
+            }
+        }
+
+        /// @brief `k` nearest elements of `center`, nearest first. Visits nodes nearest first.
+        void nearest(const base_type& center,std::size_t k,std::vector<neighbor_type>& found) const {
+            found.clear();
+            if(tree.empty() || k==0) return;
+            value_type c[dimensions]; detail::components_of(center,c);
+            const value_type* cols[dimensions]; detail::columns_of(*points,cols);
+
+            typedef std::pair<value_type,std::uint32_t> entry;                         // Squared distance, index.
+            std::priority_queue<entry,std::vector<entry>,std::greater<>> to_visit;     // Nodes, nearest on top.
+            std::priority_queue<entry> best;                                           // Elements, farthest on top.
+            to_visit.push({box_distance2(tree[0],c),0});
+            while(!to_visit.empty()) {
+                const entry top=to_visit.top(); to_visit.pop();
+                if(best.size()==k && top.first>best.top().first) break;
+                const node& nd=tree[top.second];
+                if(nd.children==0) {
+                    for(std::uint32_t i=nd.begin;i<nd.end;i++) {
+                        const entry e{base::distance2(c,cols,keys[i].second),keys[i].second};
+                        if(best.size()<k) best.push(e);
+                        else if(e<best.top()) { best.pop(); best.push(e); }
+                    }
+                }
+                else for(std::uint32_t ch=0;ch<nd.children;ch++)
+                    to_visit.push({box_distance2(tree[nd.first_child+ch],c),nd.first_child+ch});
+            }
+            for(;!best.empty();best.pop()) found.push_back(base::found_at(best.top().second,best.top().first));
+            std::reverse(found.begin(),found.end());
+        }
+
+    private:
+        typedef std::pair<std::uint64_t,std::uint32_t> key;  //!< Morton code and index of element.
+
+        struct node {
+            std::uint32_t begin,end;           //!< Range of `keys`.
+            std::uint32_t first_child;
+            std::uint32_t children;            //!< 0 for leaves.
+            value_type    lo[dimensions];      //!< Bounding box of elements.
+            value_type    hi[dimensions];
+        };
+
+        std::vector<key>           keys;
+        std::vector<node>          tree;
+        std::vector<std::uint32_t> leaves;
+
+        void bounds(value_type (&lo)[dimensions],value_type (&hi)[dimensions]) const {
+            const value_type* cols[dimensions]; detail::columns_of(*points,cols);
+            for(std::size_t a=0;a<dimensions;a++) {
+                const auto mm=std::minmax_element(cols[a],cols[a]+points->size());
+                lo[a]=*mm.first; hi[a]=*mm.second;
+            }
+        }
+
+        static value_type box_distance2(const node& nd,const value_type (&c)[dimensions]) {
+            value_type d2=0;
+            for(std::size_t a=0;a<dimensions;a++) {
+                const value_type d=c[a]<nd.lo[a]?nd.lo[a]-c[a]:c[a]>nd.hi[a]?c[a]-nd.hi[a]:value_type(0);
+                d2+=d*d;
+            }
+            return d2;
+        }
+    };
+
+}
+
+#endif //WB_SIMULATIONS_SPATIAL_H
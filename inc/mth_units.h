@@ -0,0 +1,227 @@
+/** @file mth_units.h @brief Units other than SI (km, h, km/h, degrees Celsius), converted by compile-time constants.
+ *  @details
+ *      A `scaled_unit` has the dimensions of an SI unit and `si=value*SCALE+OFFSET`, where `SCALE` and `OFFSET`
+ *      are `std::ratio`s. Factors are `constexpr`, so a conversion is a multiplication by a constant, with an
+ *      addition for units with offset, and literals like `5_km` or `20_degC` fold to SI constants.
+ *
+ *      `ScaledQuantity<km_unit>` (`DistKm`) keeps a value as it came, e.g. from a file. It converts to its SI
+ *      quantity once, implicitly (`DistSI d=trip;`) or by `si()`, and back by the explicit constructor, e.g. for
+ *      output. There is no dimensional arithmetic in scaled units, so mixed expressions like `trip+100_m` or
+ *      `trip.si()/duration.si()` are SI after the first operation, without any per-operation factors. Values of the
+ *      same linear unit may be added and subtracted as they are.
+ *
+ *      `batch_to_si()` and `batch_from_si()` convert spans and raw columns (e.g. of a `VecArray` read in km) with
+ *      the kernels of `mth_vec_batch.h`.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_UNITS_H
+#define WB_SIMULATIONS_UNITS_H
+
+#include "mth_vectors.h"
+#include "mth_vec_batch.h"
+
+#include <cassert>
+#include <cstddef>
+#include <ratio>
+#include <type_traits>
+
+namespace merry_tools::math {
+
+    // TEMPLATE FOR SCALED UNITS:
+    //*//////////////////////////
+
+    /** @brief Base for units measuring the same as `SI_UNIT`, with `si=value*SCALE+OFFSET`.
+     *  \tparam DERIVED
+     *  \tparam SI_UNIT - e.g. `SI_length_unit`
+     *  \tparam SCALE, OFFSET - `std::ratio`s, e.g. `std::kilo` for km */
+    template<class DERIVED,class SI_UNIT,class SCALE,class OFFSET=std::ratio<0>>
+    struct scaled_unit:public physical_unit<DERIVED,SI_UNIT::length,SI_UNIT::mass,SI_UNIT::time,SI_UNIT::temperature> {
+        typedef SI_UNIT si_unit;
+
+        WB_STATIC_INSIDE_CLASS bool linear=OFFSET::num==0;     //!< Without offset, values may be added as they are.
+
+        /// @brief Exact conversion of a constant, e.g. for literals. Integers times `SCALE` stay exact.
+        WB_STATIC_INSIDE_CLASS long double to_si(long double v) {
+            return v*SCALE::num/SCALE::den+static_cast<long double>(OFFSET::num)/OFFSET::den;
+        }
+
+        template<class FLOAT>   //!< `si=value*scale+offset`
+        WB_STATIC_INSIDE_CLASS FLOAT scale=FLOAT(static_cast<long double>(SCALE::num)/SCALE::den);
+
+        template<class FLOAT>
+        WB_STATIC_INSIDE_CLASS FLOAT offset=FLOAT(static_cast<long double>(OFFSET::num)/OFFSET::den);
+
+        template<class FLOAT>   //!< `value=si*inverse+back`
+        WB_STATIC_INSIDE_CLASS FLOAT inverse=FLOAT(static_cast<long double>(SCALE::den)/SCALE::num);
+
+        template<class FLOAT>
+        WB_STATIC_INSIDE_CLASS FLOAT back=FLOAT(-static_cast<long double>(OFFSET::num)*SCALE::den
+                                                /(static_cast<long double>(OFFSET::den)*SCALE::num));
+
+        /// @brief `value*scale+offset`, a single multiplication for linear units, as `+0` is kept without fast-math.
+        template<class FLOAT>
+        WB_STATIC_INSIDE_CLASS FLOAT si_of(FLOAT value) {
+            if constexpr (linear) return value*scale<FLOAT>;
+            else return value*scale<FLOAT>+offset<FLOAT>;
+        }
+
+        /// @brief `si*inverse+back`, likewise.
+        template<class FLOAT>
+        WB_STATIC_INSIDE_CLASS FLOAT value_of(FLOAT si) {
+            if constexpr (linear) return si*inverse<FLOAT>;
+            else return si*inverse<FLOAT>+back<FLOAT>;
+        }
+    };
+
+    // SCALED UNITS:
+    //*/////////////
+
+    /// @brief Kilometre
+    struct km_unit:public scaled_unit<km_unit,SI_length_unit,std::kilo> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[km]"; }};
+
+    /// @brief Hour
+    struct hour_unit:public scaled_unit<hour_unit,SI_time_unit,std::ratio<3600>> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[h]"; }};
+
+    /// @brief Kilometre per hour
+    struct km_h_unit:public scaled_unit<km_h_unit,SI_velocity_unit,std::ratio<1000,3600>> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[km/h]"; }};
+
+    /// @brief Degree Celsius
+    struct celsius_unit:public scaled_unit<celsius_unit,SI_temperature_unit,std::ratio<1>,std::ratio<27315,100>> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[degC]"; }};
+
+    // QUANTITIES MEASURED IN SCALED UNITS:
+    //*////////////////////////////////////
+
+    /** @brief A value measured in a `scaled_unit`, converted to its SI quantity at the boundary of calculations.
+     *  \tparam UNIT - e.g. `km_unit`
+     *  \tparam FLOAT - storage type of the value, also of its SI quantity */
+    template<class UNIT,class FLOAT=float_base>
+    struct ScaledQuantity {
+        // STATIC INFOS:
+        //*/////////////
+        WB_STATIC_INSIDE_CLASS  const char* abbreviation() { return UNIT::abbreviation(); }
+
+        typedef UNIT  unit_type;  //!< Scaled unit of the value.
+        typedef FLOAT value_type; //!< Storage type of the value.
+        typedef typename si_quantity_for<UNIT::length,UNIT::mass,UNIT::time,UNIT::temperature,FLOAT>::type si_type;
+
+        // SOLE VALUE:
+        //*///////////
+        FLOAT value; //!< In `UNIT`, not in SI
+
+        // CONSTRUCTORS AND CONVERSIONS:
+        //*/////////////////////////////
+        constexpr ScaledQuantity(const ScaledQuantity&) = default;
+
+        constexpr ScaledQuantity(const float& iniVal):value{(FLOAT)iniVal}{}
+
+        constexpr ScaledQuantity(const double& iniVal):value{(FLOAT)iniVal}{}
+
+        constexpr ScaledQuantity(const long double& iniVal):value{(FLOAT)iniVal}{}
+
+        constexpr ScaledQuantity(const unsigned long long& iniVal):value{(FLOAT)iniVal}{}
+
+        /// @brief From SI, e.g. `VelocityKmH{speed}` to print it in km/h.
+        explicit constexpr ScaledQuantity(const si_type& si)
+                :value{UNIT::template value_of<FLOAT>(si.value)}{}
+
+        constexpr ScaledQuantity& operator = (const ScaledQuantity&) = default;
+
+        /// @brief The same value in SI, by constant factors.
+        constexpr si_type si() const { return si_type{UNIT::template si_of<FLOAT>(value)}; }
+
+        /// @brief Implicit, so any SI expression takes scaled values, e.g. `DistSI d=trip+100_m;`.
+        constexpr operator si_type() const { return si(); } // NOLINT(*-explicit-constructor)
+
+        // OPERATORS OF LINEAR UNITS:
+        //*//////////////////////////
+        template<class U=UNIT,class=std::enable_if_t<U::linear>>
+        constexpr ScaledQuantity operator - () const { return ScaledQuantity{-value}; }
+
+        template<class U=UNIT,class=std::enable_if_t<U::linear>>
+        constexpr ScaledQuantity operator + (const ScaledQuantity& a) const { return ScaledQuantity{value+a.value}; }
+
+        template<class U=UNIT,class=std::enable_if_t<U::linear>>
+        constexpr ScaledQuantity operator - (const ScaledQuantity& a) const { return ScaledQuantity{value-a.value}; }
+
+        template<class U=UNIT,class=std::enable_if_t<U::linear>>
+        constexpr ScaledQuantity operator * (const double& m) const { return ScaledQuantity{value*m}; }
+
+        template<class U=UNIT,class=std::enable_if_t<U::linear>>
+        constexpr ScaledQuantity operator / (const double& d) const { return ScaledQuantity{value/d}; }
+    };
+
+    typedef ScaledQuantity<km_unit>                 DistKm;         //!< Distance in [km]
+    typedef ScaledQuantity<hour_unit>               TimeHour;       //!< Time in [h]
+    typedef ScaledQuantity<km_h_unit>               VelocityKmH;    //!< Velocity in [km/h]
+    typedef ScaledQuantity<celsius_unit>            TempCelsius;    //!< Temperature in [degC]
+    typedef ScaledQuantity<km_unit,float_wide>      DistKm64;       //!< Distance in [km] stored as `float_wide`
+    typedef ScaledQuantity<hour_unit,float_wide>    TimeHour64;     //!< Time in [h] stored as `float_wide`
+    typedef ScaledQuantity<km_h_unit,float_wide>    VelocityKmH64;  //!< Velocity in [km/h] stored as `float_wide`
+    typedef ScaledQuantity<celsius_unit,float_wide> TempCelsius64;  //!< Temperature in [degC] stored as `float_wide`
+
+    // CONVERTING LITERALS:
+    //*////////////////////
+    // They give SI quantities, constant at compile time, e.g. `static_assert((36_km_h).value==10.0f)`.
+
+    /// @brief Creates distance in [m] from [km]
+    WB_GLOBAL_OUTSIDE_CLASS auto operator "" _km   (long double val) { return DistSI{km_unit::to_si(val)}; }
+
+    /// @brief Creates time in [s] from [h]
+    WB_GLOBAL_OUTSIDE_CLASS auto operator "" _h    (long double val) { return TimeSI{hour_unit::to_si(val)}; }
+
+    /// @brief Creates velocity in [m/s] from [km/h]
+    WB_GLOBAL_OUTSIDE_CLASS auto operator "" _km_h (long double val) { return VelocitySI{km_h_unit::to_si(val)}; }
+
+    /// @brief Creates temperature in [K] from [degC]
+    WB_GLOBAL_OUTSIDE_CLASS auto operator "" _degC (long double val) { return TempSI{celsius_unit::to_si(val)}; }
+
+    /// @brief Creates distance in [m] from WHOLE [km]
+    WB_GLOBAL_OUTSIDE_CLASS auto operator "" _km   (unsigned long long val) { return DistSI{km_unit::to_si(val)}; }
+
+    /// @brief Creates time in [s] from WHOLE [h]
+    WB_GLOBAL_OUTSIDE_CLASS auto operator "" _h    (unsigned long long val) { return TimeSI{hour_unit::to_si(val)}; }
+
+    /// @brief Creates velocity in [m/s] from WHOLE [km/h]
+    WB_GLOBAL_OUTSIDE_CLASS auto operator "" _km_h (unsigned long long val) { return VelocitySI{km_h_unit::to_si(val)}; }
+
+    /// @brief Creates temperature in [K] from WHOLE [degC]
+    WB_GLOBAL_OUTSIDE_CLASS auto operator "" _degC (unsigned long long val) { return TempSI{celsius_unit::to_si(val)}; }
+
+    // BATCH CONVERSIONS:
+    //*//////////////////
+
+    /// @brief in[i]*scale+offset of `UNIT` for raw values, e.g. a column of a `VecArray` read in km. `out` may be `in`.
+    template<class UNIT,class FLOAT>
+    void batch_to_si(const FLOAT* in,FLOAT* out,std::size_t n) {
+        if constexpr (UNIT::linear) simd::scale(in,double(UNIT::template scale<FLOAT>),out,n);
+        else simd::affine(in,double(UNIT::template scale<FLOAT>),double(UNIT::template offset<FLOAT>),out,n);
+    }
+
+    /// @brief The inverse of `batch_to_si()`.
+    template<class UNIT,class FLOAT>
+    void batch_from_si(const FLOAT* in,FLOAT* out,std::size_t n) {
+        if constexpr (UNIT::linear) simd::scale(in,double(UNIT::template inverse<FLOAT>),out,n);
+        else simd::affine(in,double(UNIT::template inverse<FLOAT>),double(UNIT::template back<FLOAT>),out,n);
+    }
+
+    /// @brief out[i]=in[i].si(), e.g. from `std::vector<TempCelsius>` to `std::vector<TempSI>`.
+    template<class SCALED,class SI>
+    void batch_to_si(vec_span<SCALED> in,vec_span<SI> out) {
+        typedef std::remove_cv_t<SCALED> scaled;
+        static_assert(std::is_same_v<typename scaled::si_type,SI>,"Output must be the SI quantity of the input!");
+        assert(in.size()==out.size());
+        batch_to_si<typename scaled::unit_type>(detail::flat_quantities(in),detail::flat_quantities(out),in.size());
+    }
+
+    /// @brief out[i]=SCALED{in[i]}
+    template<class SI,class SCALED>
+    void batch_from_si(vec_span<SI> in,vec_span<SCALED> out) {
+        static_assert(std::is_same_v<typename SCALED::si_type,std::remove_cv_t<SI>>,
+                      "Input must be the SI quantity of the output!");
+        assert(in.size()==out.size());
+        batch_from_si<typename SCALED::unit_type>(detail::flat_quantities(in),detail::flat_quantities(out),in.size());
+    }
+}
+
+#endif //WB_SIMULATIONS_UNITS_H
@@ -0,0 +1,312 @@
+/** @file mth_vec_algebra.h @brief Dot and cross products, norms, directions and 3x3 matrices of typed vectors.
+ *  @details
+ *      Products multiply quantities, so units follow dimensional analysis: `dot(DistSI,DistSI)` is an `AreaSI`,
+ *      `cross` of a position and a velocity is measured in `[m^2/s]`, and `norm(VolumeVelocity)` is a `VelocitySI`.
+ *      Both vectors must lie on the same axes, as for `xD()`, while their precision may differ.
+ *
+ *      `normalize()` gives a dimensionless `Direction3D` (or `Direction2D`) on the axes of the vector, and a
+ *      direction times a quantity is a vector again, e.g. `normalize(v)*10_m_s`.
+ *
+ *      `Mat3<FROM,TO>` takes vectors on the axes `FROM` to the axes `TO`, e.g. `Mat3<earth_axes,flat_axes,double>`
+ *      is the rotation of a `local_frame` (see `mth_geodesy.h`). Products of matrices compile only when their axes
+ *      meet, and the inverse of a rotation is `transposed()`.
+ *
+ *      Batch norms and normalization work on `VecArray` columns with reciprocal square roots of SIMD registers
+ *      (see `simd::precision` in `mth_vec_batch.h`).
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_VEC_ALGEBRA_H
+#define WB_SIMULATIONS_VEC_ALGEBRA_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_vec_batch.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace merry_tools::math {
+
+    namespace detail {
+        /// @brief Type of the product of two quantities, e.g. `AreaSI` for `DistSI` and `DistSI`.
+        template<class Q1,class Q2>
+        using product_t=decltype(std::declval<Q1>()*std::declval<Q2>());
+
+        /// @brief Quantity of a product placed on an axis, which must not be dimensionless.
+        template<class Q1,class Q2>
+        constexpr void check_axial_product() {
+            static_assert(!std::is_arithmetic_v<product_t<Q1,Q2>>,"Dimensionless value can't lay on the axis!");
+        }
+    }
+
+    // PRODUCTS AND NORMS OF SINGLE VECTORS:
+    //*/////////////////////////////////////
+
+    /// @brief Dot product, e.g. `DistSI*DistSI -> AreaSI`, or a plain number for dimensionless results.
+    template<class AXIS1,class AXIS2,class Q1,class Q2>
+    constexpr auto dot(const Vec2D<AXIS1,AXIS2,Q1>& a,const Vec2D<AXIS1,AXIS2,Q2>& b) {
+        typedef detail::product_t<Q1,Q2> result;
+        return result{a.x.val*b.x.val+a.y.val*b.y.val};
+    }
+
+    /// @brief Dot product, e.g. `VolumeAcceleration` by `VolumeVelocity` is power per mass `[m^2/s^3]`.
+    template<class AXIS1,class AXIS2,class AXIS3,class Q1,class Q2>
+    constexpr auto dot(const Vec3D<AXIS1,AXIS2,AXIS3,Q1>& a,const Vec3D<AXIS1,AXIS2,AXIS3,Q2>& b) {
+        typedef detail::product_t<Q1,Q2> result;
+        return result{a.x.val*b.x.val+a.y.val*b.y.val+a.z.val*b.z.val};
+    }
+
+    /// @brief Cross product of plane vectors, i.e. `z` of the 3D one.
+    template<class AXIS1,class AXIS2,class Q1,class Q2>
+    constexpr auto cross(const Vec2D<AXIS1,AXIS2,Q1>& a,const Vec2D<AXIS1,AXIS2,Q2>& b) {
+        typedef detail::product_t<Q1,Q2> result;
+        return result{a.x.val*b.y.val-a.y.val*b.x.val};
+    }
+
+    /// @brief Cross product on the same axes, e.g. position by velocity gives `[m^2/s]`. Axes are right-handed.
+    template<class AXIS1,class AXIS2,class AXIS3,class Q1,class Q2>
+    constexpr auto cross(const Vec3D<AXIS1,AXIS2,AXIS3,Q1>& a,const Vec3D<AXIS1,AXIS2,AXIS3,Q2>& b) {
+        detail::check_axial_product<Q1,Q2>();
+        typedef detail::product_t<Q1,Q2> result;
+        return Vec3D<AXIS1,AXIS2,AXIS3,result>{Scalar<AXIS1,result>{result{a.y.val*b.z.val-a.z.val*b.y.val}},
+                                               Scalar<AXIS2,result>{result{a.z.val*b.x.val-a.x.val*b.z.val}},
+                                               Scalar<AXIS3,result>{result{a.x.val*b.y.val-a.y.val*b.x.val}}};
+    }
+
+    /// @brief Square of the length, e.g. `AreaSI` for positions. Cheaper than `norm()` for comparisons.
+    template<class AXIS1,class AXIS2,class QUANTITY>
+    constexpr auto norm2(const Vec2D<AXIS1,AXIS2,QUANTITY>& v) { return dot(v,v); }
+
+    /// @brief Square of the length, e.g. `AreaSI` for positions. Cheaper than `norm()` for comparisons.
+    template<class AXIS1,class AXIS2,class AXIS3,class QUANTITY>
+    constexpr auto norm2(const Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY>& v) { return dot(v,v); }
+
+    /// @brief Length, measured as components, e.g. `VelocitySI` for `PlaneVelocity`.
+    template<class AXIS1,class AXIS2,class QUANTITY>
+    inline QUANTITY norm(const Vec2D<AXIS1,AXIS2,QUANTITY>& v) {
+        return QUANTITY{std::sqrt(v.x.val.value*v.x.val.value+v.y.val.value*v.y.val.value)};
+    }
+
+    /// @brief Length, measured as components, e.g. `VelocitySI` for `VolumeVelocity`.
+    template<class AXIS1,class AXIS2,class AXIS3,class QUANTITY>
+    inline QUANTITY norm(const Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY>& v) {
+        return QUANTITY{std::sqrt(v.x.val.value*v.x.val.value+v.y.val.value*v.y.val.value
+                                  +v.z.val.value*v.z.val.value)};
+    }
+
+    // DIRECTIONS:
+    //*///////////
+
+    /** @brief Dimensionless vector of unit length on two axes.
+     *  \tparam AXIS1, AXIS2 - axes of x and y
+     *  \tparam FLOAT - storage type */
+    template<class AXIS1,class AXIS2,class FLOAT=float_base>
+    struct Direction2D {
+        FLOAT x;
+        FLOAT y;
+
+        constexpr Direction2D operator - () const { return {-x,-y}; }
+
+        /// @brief Vector of the given length, e.g. `dir*5_m_s` is `Vec2D<AXIS1,AXIS2,VelocitySI>`.
+        template<class QUANTITY>
+        constexpr Vec2D<AXIS1,AXIS2,QUANTITY> operator * (const QUANTITY& length) const {
+            return {Scalar<AXIS1,QUANTITY>{length*x},Scalar<AXIS2,QUANTITY>{length*y}};
+        }
+    };
+
+    /** @brief Dimensionless vector of unit length on three axes.
+     *  \tparam AXIS1, AXIS2, AXIS3 - axes of x, y and z
+     *  \tparam FLOAT - storage type */
+    template<class AXIS1,class AXIS2,class AXIS3,class FLOAT=float_base>
+    struct Direction3D {
+        FLOAT x;
+        FLOAT y;
+        FLOAT z;
+
+        constexpr Direction3D operator - () const { return {-x,-y,-z}; }
+
+        /// @brief Vector of the given length, e.g. `dir*5_m_s` is `Vec3D<AXIS1,AXIS2,AXIS3,VelocitySI>`.
+        template<class QUANTITY>
+        constexpr Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY> operator * (const QUANTITY& length) const {
+            return {Scalar<AXIS1,QUANTITY>{length*x},Scalar<AXIS2,QUANTITY>{length*y},
+                    Scalar<AXIS3,QUANTITY>{length*z}};
+        }
+    };
+
+    /// @brief Direction of the vector. Zero vector has zero direction.
+    template<class AXIS1,class AXIS2,class QUANTITY>
+    inline auto normalize(const Vec2D<AXIS1,AXIS2,QUANTITY>& v) {
+        typedef typename QUANTITY::value_type value_type;
+        const value_type len=norm(v).value,f=len>0?1/len:0;
+        return Direction2D<AXIS1,AXIS2,value_type>{v.x.val.value*f,v.y.val.value*f};
+    }
+
+    /// @brief Direction of the vector. Zero vector has zero direction.
+    template<class AXIS1,class AXIS2,class AXIS3,class QUANTITY>
+    inline auto normalize(const Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY>& v) {
+        typedef typename QUANTITY::value_type value_type;
+        const value_type len=norm(v).value,f=len>0?1/len:0;
+        return Direction3D<AXIS1,AXIS2,AXIS3,value_type>{v.x.val.value*f,v.y.val.value*f,v.z.val.value*f};
+    }
+
+    /// @brief Dot product of directions, the cosine of the angle between them.
+    template<class AXIS1,class AXIS2,class AXIS3,class FLOAT>
+    constexpr FLOAT dot(const Direction3D<AXIS1,AXIS2,AXIS3,FLOAT>& a,const Direction3D<AXIS1,AXIS2,AXIS3,FLOAT>& b) {
+        return a.x*b.x+a.y*b.y+a.z*b.z;
+    }
+
+    // AXIS-AWARE 3x3 MATRICES:
+    //*////////////////////////
+
+    /// @brief Ordered axes of a `Mat3`.
+    template<class AXIS1,class AXIS2,class AXIS3>
+    struct axes3 {
+        typedef AXIS1 x;
+        typedef AXIS2 y;
+        typedef AXIS3 z;
+
+        /// @brief Position of `AXIS` among the three, -1 when it is not there.
+        template<class AXIS>
+        WB_STATIC_INSIDE_CLASS int index_of=std::is_same_v<AXIS,AXIS1>?0:std::is_same_v<AXIS,AXIS2>?1
+                                           :std::is_same_v<AXIS,AXIS3>?2:-1;
+    };
+
+    typedef axes3<Along,Across,Upward>    flat_axes;    //!< Axes of `Flat_simulation` vectors
+    typedef axes3<Earth_x,Earth_y,Earth_z> earth_axes;  //!< Axes of `Earth_centered` vectors
+    typedef axes3<Solar_x,Solar_y,Solar_z> solar_axes;  //!< Axes of `Solar` vectors
+
+    /** @brief Matrix taking vectors on `FROM` axes to `TO` axes.
+     *  @details `m[r][c]` is the share of axis `c` of `FROM` in axis `r` of `TO`. For a rotation, the rows are
+     *  the axes of `TO` seen from `FROM`.
+     *  \tparam FROM, TO - `axes3` instances
+     *  \tparam FLOAT - storage type */
+    template<class FROM,class TO,class FLOAT=float_base>
+    struct Mat3 {
+        typedef FROM  from_axes;
+        typedef TO    to_axes;
+        typedef FLOAT value_type;
+
+        FLOAT m[3][3];
+
+        /// @brief Identity on the same axes.
+        WB_STATIC_INSIDE_CLASS Mat3 identity() {
+            static_assert(std::is_same_v<FROM,TO>,"Identity keeps vectors on their axes!");
+            return {{{1,0,0},{0,1,0},{0,0,1}}};
+        }
+
+        /// @brief Rotation by `angle` about one of the axes, counterclockwise when seen from its end.
+        template<class AXIS>
+        static Mat3 rotation_about(const AngleSI64& angle) {
+            static_assert(std::is_same_v<FROM,TO>,"Rotation about an axis keeps vectors on their axes!");
+            constexpr int k=FROM::template index_of<AXIS>;
+            static_assert(k>=0,"Axis of rotation must be one of the axes of the matrix!");
+            const FLOAT c=FLOAT(std::cos(angle.value)),s=FLOAT(std::sin(angle.value));
+            constexpr int i=(k+1)%3,j=(k+2)%3;
+            Mat3 r=identity();
+            r.m[i][i]=c; r.m[i][j]=-s;
+            r.m[j][i]=s; r.m[j][j]=c;
+            return r;
+        }
+
+        /// @brief Rotation by `angle` about any direction (Rodrigues' formula), counterclockwise seen from its end.
+        template<class FLOAT2>
+        static Mat3 rotation(const Direction3D<typename FROM::x,typename FROM::y,typename FROM::z,FLOAT2>& axis,
+                             const AngleSI64& angle) {
+            static_assert(std::is_same_v<FROM,TO>,"Rotation about a direction keeps vectors on their axes!");
+            const double c=std::cos(angle.value),s=std::sin(angle.value),t=1-c;
+            const double x=axis.x,y=axis.y,z=axis.z;
+            return {{{FLOAT(t*x*x+c),  FLOAT(t*x*y-s*z),FLOAT(t*x*z+s*y)},
+                     {FLOAT(t*x*y+s*z),FLOAT(t*y*y+c),  FLOAT(t*y*z-s*x)},
+                     {FLOAT(t*x*z-s*y),FLOAT(t*y*z+s*x),FLOAT(t*z*z+c)}}};
+        }
+
+        /// @brief The inverse, if it is a rotation.
+        constexpr Mat3<TO,FROM,FLOAT> transposed() const {
+            return {{{m[0][0],m[1][0],m[2][0]},{m[0][1],m[1][1],m[2][1]},{m[0][2],m[1][2],m[2][2]}}};
+        }
+
+        constexpr FLOAT determinant() const {
+            return m[0][0]*(m[1][1]*m[2][2]-m[1][2]*m[2][1])-m[0][1]*(m[1][0]*m[2][2]-m[1][2]*m[2][0])
+                  +m[0][2]*(m[1][0]*m[2][1]-m[1][1]*m[2][0]);
+        }
+
+        /// @brief Vector on `TO` axes, e.g. `rot*earth_offset` is a `Flat_simulation` one. Named types of the result
+        ///        are made from it, e.g. `VolumePosition p=rot*earth_offset;`.
+        template<class QUANTITY>
+        constexpr auto operator * (const Vec3D<typename FROM::x,typename FROM::y,typename FROM::z,QUANTITY>& v) const {
+            typedef typename QUANTITY::value_type value_type;
+            value_type r[3];
+            for(int i=0;i<3;i++)
+                r[i]=value_type(m[i][0])*v.x.val.value+value_type(m[i][1])*v.y.val.value
+                    +value_type(m[i][2])*v.z.val.value;
+            return Vec3D<typename TO::x,typename TO::y,typename TO::z,QUANTITY>{
+                    Scalar<typename TO::x,QUANTITY>{QUANTITY{r[0]}},Scalar<typename TO::y,QUANTITY>{QUANTITY{r[1]}},
+                    Scalar<typename TO::z,QUANTITY>{QUANTITY{r[2]}}};
+        }
+
+        /// @brief Direction on `TO` axes.
+        template<class FLOAT2>
+        constexpr auto operator * (const Direction3D<typename FROM::x,typename FROM::y,typename FROM::z,FLOAT2>& d)
+                                   const {
+            FLOAT2 r[3];
+            for(int i=0;i<3;i++) r[i]=FLOAT2(m[i][0])*d.x+FLOAT2(m[i][1])*d.y+FLOAT2(m[i][2])*d.z;
+            return Direction3D<typename TO::x,typename TO::y,typename TO::z,FLOAT2>{r[0],r[1],r[2]};
+        }
+
+        /// @brief Composition, `this` after `a`: from the axes of `a` to `TO`.
+        template<class FROM2>
+        constexpr Mat3<FROM2,TO,FLOAT> operator * (const Mat3<FROM2,FROM,FLOAT>& a) const {
+            Mat3<FROM2,TO,FLOAT> r{};
+            for(int i=0;i<3;i++)
+                for(int j=0;j<3;j++)
+                    r.m[i][j]=m[i][0]*a.m[0][j]+m[i][1]*a.m[1][j]+m[i][2]*a.m[2][j];
+            return r;
+        }
+    };
+
+    // BATCH NORMS ON ARRAYS (SoA):
+    //*////////////////////////////
+
+    namespace detail {
+        template<class VEC,class Q>
+        constexpr void check_norm_of() {
+            static_assert(std::is_same_v<std::remove_cv_t<Q>,typename vec_traits<VEC>::quantity>,
+                          "Norms must be measured like the components of vectors!");
+        }
+
+        /// @brief Column `z` of 3D arrays, `nullptr` for 2D ones.
+        template<class ARRAY>
+        auto* z_column(ARRAY& a) {
+            if constexpr (std::remove_cv_t<ARRAY>::dimensions==3) return a.zs();
+            else return static_cast<decltype(a.xs())>(nullptr);
+        }
+    }
+
+    /// @brief out[i]=norm(a[i])
+    template<class VEC,class Q>
+    void batch_norm(const VecArray<VEC>& a,vec_span<Q> out,simd::precision p=simd::precision::refined) {
+        detail::check_norm_of<VEC,Q>();                                                    assert(a.size()==out.size());
+        simd::norm(a.xs(),a.ys(),detail::z_column(a),detail::flat_quantities(out),a.size(),p);
+    }
+
+    /// @brief Every vector becomes its direction times `length`, zero vectors stay zero.
+    template<class VEC,class Q>
+    void batch_normalize(VecArray<VEC>& a,const Q& length,simd::precision p=simd::precision::refined) {
+        detail::check_norm_of<VEC,Q>();
+        simd::normalize(a.xs(),a.ys(),detail::z_column(a),a.size(),length.value,nullptr,p);
+    }
+
+    /// @brief Every vector becomes its direction times `length`, old norms go to `norms`.
+    template<class VEC,class Q>
+    void batch_normalize(VecArray<VEC>& a,const Q& length,vec_span<Q> norms,
+                         simd::precision p=simd::precision::refined) {
+        detail::check_norm_of<VEC,Q>();                                                  assert(a.size()==norms.size());
+        simd::normalize(a.xs(),a.ys(),detail::z_column(a),a.size(),length.value,detail::flat_quantities(norms),p);
+    }
+}
+
+#endif //WB_SIMULATIONS_VEC_ALGEBRA_H
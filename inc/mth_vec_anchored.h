@@ -0,0 +1,316 @@
+/** @file mth_vec_anchored.h @brief Positions of big worlds as float offsets from the origins of regions.
+ *  @details
+ *      `AnchoredArray<VolumePosition>` splits every position into the index of a cubic region (`int32_t` per axis,
+ *      the origin of a region is `index*extent`) and a `float_base` offset from that origin. Offsets are an ordinary
+ *      `VecArray`, so integrators and batch kernels (see `mth_vec_batch.h`) work on them at float speed, and only
+ *      `rebase()` touches the indices. The error of a position is that of a float of the size of `extent`, anywhere.
+ *      E.g. with regions of 4096 m, below half a millimetre in `Earth_centered` axes or even at 1 AU in `Solar` ones.
+ *
+ *      Every element has its own region, so entities move independently and need no sorting. `rebase()` moves
+ *      an element to a neighbouring region when its offset leaves `[-extent,extent]`, which keeps elements moving
+ *      back and forth over a border in one region. `extent` is a power of two, so rebasing changes no position.
+ *
+ *      Absolute positions are the wide vectors of the same axes (e.g. `VolumePosition64` or `EarthPosition`),
+ *      computed in `float_wide`. `relative_to()` gives float positions relative to any region in bulk, e.g. around
+ *      a camera or an observer, and `difference()` the float vector between two elements.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_VEC_ANCHORED_H
+#define WB_SIMULATIONS_VEC_ANCHORED_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_vec_batch.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace merry_tools::math {
+
+    namespace detail {
+        template<class VEC,std::size_t D=vec_traits<VEC>::dimensions>
+        struct wide_vec_of;
+
+        template<class VEC>
+        struct wide_vec_of<VEC,2> {
+            typedef vec_traits<VEC> t;
+            typedef Vec2D<typename t::axis_x,typename t::axis_y,
+                          with_precision_t<typename t::quantity,float_wide>> type;
+        };
+
+        template<class VEC>
+        struct wide_vec_of<VEC,3> {
+            typedef vec_traits<VEC> t;
+            typedef Vec3D<typename t::axis_x,typename t::axis_y,typename t::axis_z,
+                          with_precision_t<typename t::quantity,float_wide>> type;
+        };
+
+        /// @brief `Vec2D`/`Vec3D` with the axes and the unit of `VEC` stored as `float_wide`.
+        template<class VEC>
+        using wide_vec_t=typename wide_vec_of<VEC>::type;
+    }
+
+    /** @brief Container of float offsets from the origins of per element regions, for positions in big worlds.
+     *  \tparam VEC - position type with `float_base` storage, e.g. `VolumePosition`, `EarthOffset` or `SolarOffset` */
+    template<class VEC>
+    class AnchoredArray {
+        typedef vec_traits<VEC> traits;
+        static_assert(std::is_same_v<typename traits::value_type,float_base>,"Offsets are stored as float_base!");
+
+    public:
+        // STATIC INFOS:
+        //*/////////////
+        typedef VEC                                               element_type;
+        typedef typename traits::base_type                        base_type;
+        typedef typename traits::quantity                         quantity;
+        typedef typename traits::value_type                       value_type;
+        typedef detail::wide_vec_t<VEC>                           wide_type;    //!< Absolute positions.
+        typedef typename vec_traits<wide_type>::quantity          wide_quantity;
+        typedef std::int32_t                                      index_type;
+
+        WB_STATIC_INSIDE_CLASS std::size_t dimensions=traits::dimensions;
+
+        /// @brief Indices of a region along every axis.
+        typedef std::array<index_type,dimensions> region;
+
+    private:
+        VecArray<VEC>           offsets_;
+        std::vector<index_type> indices[dimensions];
+        float_wide              extent_;
+        value_type              inverse;
+
+    public:
+        // CONSTRUCTORS:
+        //*/////////////
+
+        /// @brief Empty container with cubic regions of the size `extent`, which must be a power of two.
+        explicit AnchoredArray(quantity extent=quantity{value_type(4096)})
+                :extent_(extent.value),inverse(1/extent.value) {
+            [[maybe_unused]] int exponent;                        assert(std::frexp(extent.value,&exponent)==0.5f);
+        }
+
+        // SIZE AND STORAGE:
+        //*/////////////////
+        std::size_t size()   const { return offsets_.size(); }
+        bool        empty()  const { return offsets_.empty(); }
+        quantity    extent() const { return quantity{value_type(extent_)}; }
+
+        void reserve(std::size_t n) {
+            offsets_.reserve(n);
+            for(auto& col:indices) col.reserve(n);
+        }
+
+        /// @brief New elements are at the origin of the region zero.
+        void resize(std::size_t n) {
+            offsets_.resize(n);
+            for(auto& col:indices) col.resize(n,0);
+        }
+
+        void clear() { resize(0); }
+
+        void push_back(const wide_type& p) {
+            const value_type zero[3]={0,0,0};
+            offsets_.push_back(base_of(zero));
+            for(auto& col:indices) col.push_back(0);
+            set(size()-1,p);
+        }
+
+        /// @brief Offsets of all elements from their regions, e.g. for `batch_advance`. Call `rebase()` after changes.
+        VecArray<VEC>&       offsets()       { return offsets_; }
+        const VecArray<VEC>& offsets() const { return offsets_; }
+
+        /// @brief Raw indices of regions along the `I`-th axis. Use for SIMD kernels only.
+        template<std::size_t I>
+        const index_type* indices_of() const { static_assert(I<dimensions); return indices[I].data(); }
+
+        // TYPED ELEMENT ACCESS:
+        //*/////////////////////
+
+        /// @brief Absolute position of the `i`-th element.
+        wide_type get(std::size_t i) const {                                                        assert(i<size());
+            const base_type o=offsets_.get(i);
+            return wide_of([&](std::size_t c) { return float_wide(indices[c][i])*extent_+float_wide(raw(o,c)); });
+        }
+
+        wide_type operator [] (std::size_t i) const { return get(i); }
+
+        /// @brief Moves the `i`-th element to `p`, into the region nearest to it.
+        void set(std::size_t i,const wide_type& p) {                                                assert(i<size());
+            float_wide rest[3]={0,0,0};
+            for(std::size_t c=0;c<dimensions;c++) {
+                const float_wide v=raw(p,c),k=std::nearbyint(v/extent_);          assert(std::fabs(k)<2147483647.0);
+                indices[c][i]=index_type(k);
+                rest[c]=v-k*extent_;
+            }
+            offsets_.set(i,base_of(rest));
+        }
+
+        region region_of(std::size_t i) const {                                                     assert(i<size());
+            region r;
+            for(std::size_t c=0;c<dimensions;c++) r[c]=indices[c][i];
+            return r;
+        }
+
+        /// @brief Region nearest to `p`, i.e. the one `set()` puts it in.
+        region region_of(const wide_type& p) const {
+            region r;
+            for(std::size_t c=0;c<dimensions;c++) r[c]=index_type(std::nearbyint(raw(p,c)/extent_));
+            return r;
+        }
+
+        /// @brief Absolute position of the origin of `r`.
+        wide_type origin(const region& r) const {
+            return wide_of([&](std::size_t c) { return float_wide(r[c])*extent_; });
+        }
+
+        /// @brief Offset of the `i`-th element from the origin of its region.
+        VEC offset(std::size_t i) const { return offsets_.get(i); }
+
+        // REBASING AND RELATIVE POSITIONS:
+        //*////////////////////////////////
+
+        /// @brief Moves elements of `[first,last)` whose offsets left `[-extent,extent]` to the nearest regions.
+        ///        Positions do not change. Disjoint ranges may be rebased concurrently.
+        /// @return Number of moved elements.
+        std::size_t rebase(std::size_t first,std::size_t last) {                  assert(first<=last && last<=size());
+            const value_type* none[3]={nullptr,nullptr,nullptr};
+            return chunked<false>(first,last,none,value_type(0));
+        }
+
+        std::size_t rebase() { return rebase(0,size()); }
+
+        /// @brief `offsets[i]+=rate[i]*dt` in float and `rebase()` in the same pass. E.g. positions from velocities.
+        /// @return Number of elements moved to other regions.
+        template<class RATE>
+        std::size_t advance(const VecArray<RATE>& rate,const TimeSpan& dt) {
+            detail::check_rate_of<VEC,RATE>();                                              assert(rate.size()==size());
+            const value_type* r[3]={rate.xs(),rate.ys(),nullptr};
+            if constexpr (dimensions==3) r[2]=rate.zs();
+            return chunked<true>(0,size(),r,dt.val.value);
+        }
+
+        /// @brief Float positions of all elements relative to the origin of `r`, exact to float for `|index-r|<2^24`.
+        void relative_to(const region& r,VecArray<VEC>& out) const {
+            out.resize(size());
+            for(std::size_t c=0;c<dimensions;c++) {
+                const value_type* o=column(c);
+                const index_type* k=indices[c].data();
+                value_type* res=out_column(out,c);
+                const value_type step=value_type(extent_);
+                for(std::size_t i=0;i<size();i++) res[i]=value_type(std::int64_t(k[i])-r[c])*step+o[i];
+            }
+        }
+
+        /// @brief Float vector from the `j`-th element to the `i`-th one.
+        VEC difference(std::size_t i,std::size_t j) const {                               assert(i<size() && j<size());
+            const base_type oi=offsets_.get(i),oj=offsets_.get(j);
+            value_type d[3]={0,0,0};
+            for(std::size_t c=0;c<dimensions;c++)
+                d[c]=value_type(std::int64_t(indices[c][i])-indices[c][j])*value_type(extent_)+(raw(oi,c)-raw(oj,c));
+            return base_of(d);
+        }
+
+    private:
+        /// Advances (if `ADVANCE`) and rebases chunks of `[first,last)`, axis by axis while a chunk is in cache.
+        /// Indices of regions are read and written only in chunks with moved elements, seldom in long runs.
+        /// Counts elements moved along any axis.
+        template<bool ADVANCE>
+        std::size_t chunked(std::size_t first,std::size_t last,const value_type* const* rate,value_type dt) {
+            constexpr std::size_t chunk=256;
+            std::size_t moved=0;
+            for(std::size_t b=first;b<last;b+=chunk) {
+                const std::size_t n=std::min(chunk,last-b);
+                index_type shifts[dimensions][chunk];
+                index_type any=0;
+                for(std::size_t c=0;c<dimensions;c++)
+                    any|=rebase_axis<ADVANCE>(column(c)+b,ADVANCE?rate[c]+b:nullptr,dt,shifts[c],n);
+                if(any==0) continue;
+                for(std::size_t i=0;i<n;i++) {
+                    index_type changed=0;
+                    for(std::size_t c=0;c<dimensions;c++) { indices[c][b+i]+=shifts[c][i]; changed|=shifts[c][i]; }
+                    moved+=changed!=0;
+                }
+            }
+            return moved;
+        }
+
+        /// Shifts of offsets by whole regions into `shifts`, returns them all or-ed.
+        /// Selects by a mask, so the loop stays branch-free also with `-ftrapping-math`.
+        template<bool ADVANCE>
+        index_type rebase_axis(value_type* o,const value_type* rate,value_type dt,index_type* shifts,
+                               std::size_t n) const {
+            const value_type step=value_type(extent_);
+            index_type any=0;
+            for(std::size_t i=0;i<n;i++) {
+                value_type v=o[i];
+                if constexpr (ADVANCE) v+=rate[i]*dt;
+                const index_type nearest=index_type(v*inverse+std::copysign(value_type(0.5),v));
+                const index_type shift=nearest & -index_type(std::fabs(v)>step);
+                o[i]=v-value_type(shift)*step;                  // Exact, `step` is a power of two.
+                shifts[i]=shift;
+                any|=shift;
+            }
+            return any;
+        }
+
+        template<class V>
+        static auto raw(const V& v,std::size_t c) {
+            if constexpr (dimensions==3) return c==0?v.x.val.value:c==1?v.y.val.value:v.z.val.value;
+            else return c==0?v.x.val.value:v.y.val.value;
+        }
+
+        template<class FLOAT>
+        static base_type base_of(const FLOAT* v) {
+            if constexpr (dimensions==3) {
+                return base_type{ typename traits::scalar_x{quantity{value_type(v[0])}},
+                                  typename traits::scalar_y{quantity{value_type(v[1])}},
+                                  typename traits::scalar_z{quantity{value_type(v[2])}} };
+            } else {
+                return base_type{ typename traits::scalar_x{quantity{value_type(v[0])}},
+                                  typename traits::scalar_y{quantity{value_type(v[1])}} };
+            }
+        }
+
+        template<class FUN>
+        static wide_type wide_of(FUN&& at) {
+            typedef vec_traits<wide_type> w;
+            if constexpr (dimensions==3) {
+                return wide_type{ typename w::scalar_x{wide_quantity{at(0)}},
+                                  typename w::scalar_y{wide_quantity{at(1)}},
+                                  typename w::scalar_z{wide_quantity{at(2)}} };
+            } else {
+                return wide_type{ typename w::scalar_x{wide_quantity{at(0)}},
+                                  typename w::scalar_y{wide_quantity{at(1)}} };
+            }
+        }
+
+        value_type* column(std::size_t c) { return out_column(offsets_,c); }
+
+        const value_type* column(std::size_t c) const {
+            if constexpr (dimensions==3) return c==0?offsets_.xs():c==1?offsets_.ys():offsets_.zs();
+            else return c==0?offsets_.xs():offsets_.ys();
+        }
+
+        static value_type* out_column(VecArray<VEC>& a,std::size_t c) {
+            if constexpr (dimensions==3) return c==0?a.xs():c==1?a.ys():a.zs();
+            else return c==0?a.xs():a.ys();
+        }
+    };
+
+    /// @brief Anchored container for 3D positions, e.g. `AnchoredVolumeArray<EarthOffset>`.
+    template<class VEC>
+    using AnchoredVolumeArray=std::enable_if_t<vec_traits<VEC>::dimensions==3,AnchoredArray<VEC>>;
+
+    /// @brief Anchored container for 2D positions, e.g. `AnchoredPlaneArray<PlanePosition>`.
+    template<class VEC>
+    using AnchoredPlaneArray=std::enable_if_t<vec_traits<VEC>::dimensions==2,AnchoredArray<VEC>>;
+
+}
+
+#endif //WB_SIMULATIONS_VEC_ANCHORED_H
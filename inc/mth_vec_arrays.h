@@ -0,0 +1,398 @@
+/** @file mth_vec_arrays.h @brief Structure-of-arrays containers for typed vectors.
+ *  @details
+ *      `VolumeArray<VolumePosition>` keeps every coordinate in its own aligned `float_base` column, so a sweep over
+ *      a million particles reads three contiguous streams instead of an array of 12-byte structures.
+ *      Elements are reachable only through typed proxies, so the axis/unit checks of `Vec2D`/`Vec3D` still apply.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_VEC_ARRAYS_H
+#define WB_SIMULATIONS_VEC_ARRAYS_H
+
+#include "mth_vectors.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace merry_tools::math {
+
+    // TRAITS OF VECTOR TYPES:
+    //*///////////////////////
+
+    /// @brief Alignment of every column in bytes. One cache line, which is also a full AVX-512 register.
+    WB_GLOBAL_OUTSIDE_CLASS std::size_t column_alignment=64;
+
+    /// @brief Primary template is intentionally empty. Only `Vec2D`/`Vec3D` and types derived from them have traits.
+    template<class VEC,class=void>
+    struct vec_traits {};
+
+    /// @brief Traits of any `Vec2D` instance.
+    template<class AXIS1,class AXIS2,class QUANTITY>
+    struct vec_traits<Vec2D<AXIS1,AXIS2,QUANTITY>> {
+        WB_STATIC_INSIDE_CLASS std::size_t dimensions=2;
+        typedef Vec2D<AXIS1,AXIS2,QUANTITY>                  base_type;  //!< The template the vector derives from.
+        typedef QUANTITY                                     quantity;   //!< Measure of every component.
+        typedef std::remove_cv_t<decltype(QUANTITY::value)>  value_type; //!< Storage type of every component.
+        typedef Scalar<AXIS1,QUANTITY>                       scalar_x;   //!< Type of `x` component.
+        typedef Scalar<AXIS2,QUANTITY>                       scalar_y;   //!< Type of `y` component.
+        typedef AXIS1                                        axis_x;     //!< Axis of `x` component.
+        typedef AXIS2                                        axis_y;     //!< Axis of `y` component.
+    };
+
+    /// @brief Traits of any `Vec3D` instance.
+    template<class AXIS1,class AXIS2,class AXIS3,class QUANTITY>
+    struct vec_traits<Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY>> {
+        WB_STATIC_INSIDE_CLASS std::size_t dimensions=3;
+        typedef Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY>            base_type;  //!< The template the vector derives from.
+        typedef QUANTITY                                     quantity;   //!< Measure of every component.
+        typedef std::remove_cv_t<decltype(QUANTITY::value)>  value_type; //!< Storage type of every component.
+        typedef Scalar<AXIS1,QUANTITY>                       scalar_x;   //!< Type of `x` component.
+        typedef Scalar<AXIS2,QUANTITY>                       scalar_y;   //!< Type of `y` component.
+        typedef Scalar<AXIS3,QUANTITY>                       scalar_z;   //!< Type of `z` component.
+        typedef AXIS1                                        axis_x;     //!< Axis of `x` component.
+        typedef AXIS2                                        axis_y;     //!< Axis of `y` component.
+        typedef AXIS3                                        axis_z;     //!< Axis of `z` component.
+    };
+
+    namespace detail {
+        template<class AXIS1,class AXIS2,class QUANTITY>
+        Vec2D<AXIS1,AXIS2,QUANTITY> vec_base_of(const Vec2D<AXIS1,AXIS2,QUANTITY>*); //!< Only for `decltype`.
+
+        template<class AXIS1,class AXIS2,class AXIS3,class QUANTITY>
+        Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY> vec_base_of(const Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY>*); //!< Only for `decltype`.
+    }
+
+    /// @brief Traits of named vectors like `VolumePosition` are taken from their `Vec2D`/`Vec3D` base.
+    template<class VEC>
+    struct vec_traits<VEC,std::void_t<decltype(detail::vec_base_of(static_cast<const VEC*>(nullptr)))>>:
+            public vec_traits<decltype(detail::vec_base_of(static_cast<const VEC*>(nullptr)))> {};
+
+    // ALIGNED COLUMN STORAGE:
+    //*///////////////////////
+
+    /// @brief A single aligned column of raw values. Capacity is always rounded up to whole `column_alignment` blocks,
+    ///        so SIMD loops may safely touch the padding behind the last element.
+    template<class FLOAT>
+    class aligned_column {
+        FLOAT*      data_=nullptr;
+        std::size_t capacity_=0;
+
+        WB_STATIC_INSIDE_CLASS std::size_t per_block=column_alignment/sizeof(FLOAT);
+
+    public:
+        aligned_column()=default;
+        aligned_column(const aligned_column&)=delete;
+        aligned_column& operator = (const aligned_column&)=delete;
+
+        aligned_column(aligned_column&& other) noexcept:data_(other.data_),capacity_(other.capacity_) {
+            other.data_=nullptr; other.capacity_=0;
+        }
+
+        aligned_column& operator = (aligned_column&& other) noexcept {
+            std::swap(data_,other.data_); std::swap(capacity_,other.capacity_);
+            return *this;
+        }
+
+        ~aligned_column() { release(); }
+
+        FLOAT*       data()       { return data_; }
+        const FLOAT* data() const { return data_; }
+        std::size_t  capacity() const { return capacity_; }
+
+        /// @brief Grows the column, keeping the first `keep` values. Padding is zeroed.
+        void reallocate(std::size_t new_capacity,std::size_t keep) {
+            new_capacity=(new_capacity+per_block-1)/per_block*per_block;
+            keep=std::min(keep,new_capacity);
+            auto* fresh=static_cast<FLOAT*>(::operator new(new_capacity*sizeof(FLOAT),
+                                                           std::align_val_t{column_alignment}));
+            if(keep>0) std::memcpy(fresh,data_,keep*sizeof(FLOAT));
+            std::memset(static_cast<void*>(fresh+keep),0,(new_capacity-keep)*sizeof(FLOAT));
+            release();
+            data_=fresh;
+            capacity_=new_capacity;
+        }
+
+    private:
+        void release() {
+            if(data_!=nullptr) ::operator delete(data_,std::align_val_t{column_alignment});
+            data_=nullptr;
+            capacity_=0;
+        }
+    };
+
+    // SOA CONTAINER OF TYPED VECTORS:
+    //*///////////////////////////////
+
+    template<class VEC> class VecArray;
+
+    /** @brief Proxy of a single element of `VecArray`. It behaves like a `VEC` lvalue, but keeps the components in columns.
+     *  \tparam VEC - named vector type (`VolumePosition` etc.)
+     *  \tparam CONST - `true` for read only proxies */
+    template<class VEC,bool CONST>
+    class vec_ref {
+        typedef vec_traits<VEC>                                      traits;
+        typedef std::conditional_t<CONST,const VecArray<VEC>,VecArray<VEC>> array_type;
+
+        array_type* arr;
+        std::size_t idx;
+
+    public:
+        typedef typename traits::base_type  base_type;
+        typedef typename traits::quantity   quantity;
+
+        constexpr vec_ref(array_type& a,std::size_t i):arr(&a),idx(i) {}
+        constexpr vec_ref(const vec_ref&)=default;
+
+        /// @brief Read only proxy can be made from the writable one.
+        template<bool OTHER,class=std::enable_if_t<CONST && !OTHER>>
+        constexpr vec_ref(const vec_ref<VEC,OTHER>& other):arr(other.array()),idx(other.index()) {}
+
+        array_type* array() const { return arr; }
+        std::size_t index() const { return idx; }
+
+        /// @brief Typed view of the whole element.
+        operator VEC() const { return arr->get(idx); } // NOLINT(*-explicit-constructor)
+
+        /// @brief Explicit form of the conversion above, handy with `auto`.
+        VEC get() const { return arr->get(idx); }
+
+        /// @brief Only the same axes and the same unit are accepted.
+        template<bool W=!CONST,class=std::enable_if_t<W>>
+        const vec_ref& operator = (const base_type& v) const { arr->set(idx,v); return *this; }
+
+        const vec_ref& operator = (const vec_ref& other) const {
+            static_assert(!CONST,"Read only element of VecArray!");
+            arr->set(idx,other.get());
+            return *this;
+        }
+
+        template<bool W=!CONST,class=std::enable_if_t<W>>
+        const vec_ref& operator += (const base_type& v) const { arr->set(idx,xD(get(),v)); return *this; }
+
+        template<bool W=!CONST,class=std::enable_if_t<W>>
+        const vec_ref& operator -= (const base_type& v) const { arr->set(idx,xD(get(),-v)); return *this; }
+
+        /// @brief Typed components. `x()`, `y()` for any vector, `z()` only for `Vec3D`.
+        auto x() const { return get().x; }
+        auto y() const { return get().y; }
+        template<bool D3=(traits::dimensions==3),class=std::enable_if_t<D3>>
+        auto z() const { return get().z; }
+    };
+
+    /** @brief Structure-of-arrays container for typed vectors.
+     *  @details Every axis has its own aligned column of raw values (see `column<I>()` and `xs()`, `ys()`, `zs()`).
+     *           Typed access goes through `vec_ref` proxies or `get()`/`set()`, which accept only the vector type
+     *           with the same axes and unit as `VEC`.
+     *  \tparam VEC - any type derived from `Vec2D` or `Vec3D`, e.g. `VolumePosition` or `PlaneVelocity` */
+    template<class VEC>
+    class VecArray {
+        typedef vec_traits<VEC> traits;
+
+    public:
+        // STATIC INFOS:
+        //*/////////////
+        typedef VEC                          element_type;
+        typedef typename traits::base_type   base_type;
+        typedef typename traits::quantity    quantity;
+        typedef typename traits::value_type  value_type;
+        typedef vec_ref<VEC,false>           reference;
+        typedef vec_ref<VEC,true>            const_reference;
+
+        WB_STATIC_INSIDE_CLASS std::size_t dimensions=traits::dimensions;
+
+        WB_STATIC_INSIDE_CLASS  const char* unit_abr() { return VEC::unit_abr(); }
+
+        WB_STATIC_INSIDE_CLASS  const char* axisX_abr() { return VEC::axisX_abr(); }
+
+        WB_STATIC_INSIDE_CLASS  const char* axisY_abr() { return VEC::axisY_abr(); }
+
+    private:
+        aligned_column<value_type> columns[dimensions];
+        std::size_t                count=0;
+
+    public:
+        // CONSTRUCTORS:
+        //*/////////////
+        VecArray()=default;
+
+        explicit VecArray(std::size_t n) { resize(n); }
+
+        VecArray(std::size_t n,const base_type& fill) { resize(n,fill); }
+
+        VecArray(const VecArray& other) { *this=other; }
+
+        /// @brief Takes the columns of `other`, which is left empty.
+        VecArray(VecArray&& other) noexcept:count(other.count) {
+            for(std::size_t c=0;c<dimensions;c++) columns[c]=std::move(other.columns[c]);
+            other.count=0;
+        }
+
+        VecArray& operator = (const VecArray& other) {
+            if(this==&other) return *this;
+            if(capacity()<other.count) reserve(other.count);
+            for(std::size_t c=0;c<dimensions;c++) {
+                std::memcpy(columns[c].data(),other.columns[c].data(),other.count*sizeof(value_type));
+                if(count>other.count)                                               // Padding stays zero.
+                    std::memset(static_cast<void*>(columns[c].data()+other.count),0,
+                                (count-other.count)*sizeof(value_type));
+            }
+            count=other.count;
+            return *this;
+        }
+
+        /// @brief Frees own columns and takes those of `other`, which is left empty.
+        VecArray& operator = (VecArray&& other) noexcept {
+            if(this==&other) return *this;
+            for(std::size_t c=0;c<dimensions;c++) {
+                aligned_column<value_type> dropped(std::move(columns[c]));
+                columns[c]=std::move(other.columns[c]);
+            }
+            count=other.count;
+            other.count=0;
+            return *this;
+        }
+
+        // SIZE AND STORAGE:
+        //*/////////////////
+        std::size_t size()     const { return count; }
+        std::size_t capacity() const { return columns[0].capacity(); }
+        bool        empty()    const { return count==0; }
+
+        /// @brief The most elements, whole blocks of every column still addressable.
+        std::size_t max_size() const {
+            return std::numeric_limits<std::ptrdiff_t>::max()/sizeof(value_type)/column_alignment*column_alignment;
+        }
+
+        void reserve(std::size_t n) {
+            if(n<=capacity()) return;
+            for(auto& col:columns) col.reallocate(n,count);
+        }
+
+        /// @brief New elements are zero vectors.
+        void resize(std::size_t n) {
+            if(n>capacity()) reserve(n);
+            else for(auto& col:columns) std::memset(static_cast<void*>(col.data()+std::min(n,count)),0,
+                                                    (capacity()-std::min(n,count))*sizeof(value_type));
+            count=n;
+        }
+
+        void resize(std::size_t n,const base_type& fill) {
+            std::size_t old=count;
+            resize(n);
+            for(std::size_t i=old;i<n;i++) set(i,fill);
+        }
+
+        void clear() { resize(0); }
+
+        void push_back(const base_type& v) {
+            if(count==capacity()) reserve(count<16?16:count+std::min(count,max_size()-count));
+            set(count++,v);
+        }
+
+        /// @brief Raw aligned column of the `I`-th axis. Use for SIMD kernels only.
+        template<std::size_t I>
+        value_type*       column()       { static_assert(I<dimensions); return columns[I].data(); }
+
+        template<std::size_t I>
+        const value_type* column() const { static_assert(I<dimensions); return columns[I].data(); }
+
+        value_type*       xs()       { return column<0>(); }
+        const value_type* xs() const { return column<0>(); }
+        value_type*       ys()       { return column<1>(); }
+        const value_type* ys() const { return column<1>(); }
+
+        template<std::size_t D=dimensions>
+        std::enable_if_t<D==3,value_type*>       zs()       { return column<2>(); }
+
+        template<std::size_t D=dimensions>
+        std::enable_if_t<D==3,const value_type*> zs() const { return column<2>(); }
+
+        // TYPED ELEMENT ACCESS:
+        //*/////////////////////
+        VEC get(std::size_t i) const {                                                                 assert(i<count);
+            if constexpr (dimensions==2) {
+                return VEC{ typename traits::scalar_x{quantity{columns[0].data()[i]}},
+                            typename traits::scalar_y{quantity{columns[1].data()[i]}} };
+            } else {
+                return VEC{ typename traits::scalar_x{quantity{columns[0].data()[i]}},
+                            typename traits::scalar_y{quantity{columns[1].data()[i]}},
+                            typename traits::scalar_z{quantity{columns[2].data()[i]}} };
+            }
+        }
+
+        void set(std::size_t i,const base_type& v) {                                                   assert(i<count);
+            columns[0].data()[i]=v.x.val.value;
+            columns[1].data()[i]=v.y.val.value;
+            if constexpr (dimensions==3) columns[2].data()[i]=v.z.val.value;
+        }
+
+        reference       operator [] (std::size_t i)       { return reference{*this,i}; }
+        VEC             operator [] (std::size_t i) const { return get(i); }
+
+        reference       front()       { return (*this)[0]; }
+        reference       back()        { return (*this)[count-1]; }
+
+        // ITERATION:
+        //*//////////
+
+        /// @brief Random access iterator producing proxies.
+        template<bool CONST>
+        class basic_iterator {
+            typedef std::conditional_t<CONST,const VecArray,VecArray> array_type;
+            array_type* arr=nullptr;
+            std::size_t idx=0;
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef VEC                             value_type;
+            typedef std::ptrdiff_t                  difference_type;
+            typedef vec_ref<VEC,CONST>              reference;
+            typedef void                            pointer;
+
+            basic_iterator()=default;
+            basic_iterator(array_type* a,std::size_t i):arr(a),idx(i) {}
+
+            reference operator * () const { return reference{*arr,idx}; }
+            reference operator [] (difference_type d) const { return reference{*arr,idx+d}; }
+
+            basic_iterator& operator ++ () { ++idx; return *this; }
+            basic_iterator  operator ++ (int) { auto tmp=*this; ++idx; return tmp; }
+            basic_iterator& operator -- () { --idx; return *this; }
+            basic_iterator  operator -- (int) { auto tmp=*this; --idx; return tmp; }
+            basic_iterator& operator += (difference_type d) { idx+=d; return *this; }
+            basic_iterator& operator -= (difference_type d) { idx-=d; return *this; }
+            basic_iterator  operator +  (difference_type d) const { return {arr,idx+d}; }
+            basic_iterator  operator -  (difference_type d) const { return {arr,idx-d}; }
+            difference_type operator -  (const basic_iterator& o) const { return difference_type(idx)-difference_type(o.idx); }
+
+            bool operator == (const basic_iterator& o) const { return idx==o.idx; }
+            bool operator != (const basic_iterator& o) const { return idx!=o.idx; }
+            bool operator <  (const basic_iterator& o) const { return idx<o.idx; }
+        };
+
+        typedef basic_iterator<false> iterator;
+        typedef basic_iterator<true>  const_iterator;
+
+        iterator       begin()       { return {this,0}; }
+        iterator       end()         { return {this,count}; }
+        const_iterator begin() const { return {this,0}; }
+        const_iterator end()   const { return {this,count}; }
+    };
+
+    /// @brief Container for 3D vectors, e.g. `VolumeArray<VolumePosition>`.
+    template<class VEC>
+    using VolumeArray=std::enable_if_t<vec_traits<VEC>::dimensions==3,VecArray<VEC>>;
+
+    /// @brief Container for 2D vectors, e.g. `PlaneArray<PlaneVelocity>`.
+    template<class VEC>
+    using PlaneArray=std::enable_if_t<vec_traits<VEC>::dimensions==2,VecArray<VEC>>;
+
+}
+
+#endif //WB_SIMULATIONS_VEC_ARRAYS_H
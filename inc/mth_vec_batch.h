@@ -0,0 +1,319 @@
+/** @file mth_vec_batch.h @brief Batch (SIMD) arithmetic over spans and arrays of typed vectors.
+ *  @details
+ *      Every typed entry point checks axes and units of whole spans at compile time, exactly as `xD()` does for
+ *      single objects, and then runs one of the raw kernels from `merry_tools::math::simd` over flat `float`
+ *      or `double` data, as chosen by the quantities. Wide positions may be advanced by narrow rates directly.
+ *      The kernel set (scalar, SSE, AVX2 or AVX-512) is chosen at runtime, on the first call.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_VEC_BATCH_H
+#define WB_SIMULATIONS_VEC_BATCH_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace merry_tools::math {
+
+    // RAW KERNELS WITH RUNTIME DISPATCH:
+    //*//////////////////////////////////
+
+    /// @brief Raw kernels over flat arrays of values. Implemented in `mth_vec_batch.cpp`.
+    namespace simd {
+
+        /// @brief Instruction set levels in increasing order.
+        enum class level { scalar=0, sse=1, avx2=2, avx512=3 };
+
+        /// @brief The best level supported by the CPU we are running on.
+        level detected();
+
+        /// @brief The level actually used by kernels.
+        level active();
+
+        /// @brief Limits the used level, e.g. for tests and benchmarks. Levels above `detected()` are clipped.
+        /// \return the level which is active after the call.
+        level use(level wanted);
+
+        /// @brief Name of the level, like "avx2".
+        const char* name(level l);
+
+        void add  (const float* a,const float* b,float* out,std::size_t n);           //!< out=a+b
+        void sub  (const float* a,const float* b,float* out,std::size_t n);           //!< out=a-b
+        void scale(const float* a,double s,float* out,std::size_t n);                  //!< out=a*s
+        void fma  (const float* a,const float* b,double s,float* out,std::size_t n);   //!< out=a+b*s
+        void affine(const float* a,double s,double o,float* out,std::size_t n);        //!< out=a*s+o
+
+        void add  (const double* a,const double* b,double* out,std::size_t n);         //!< out=a+b
+        void sub  (const double* a,const double* b,double* out,std::size_t n);         //!< out=a-b
+        void scale(const double* a,double s,double* out,std::size_t n);                //!< out=a*s
+        void fma  (const double* a,const double* b,double s,double* out,std::size_t n);//!< out=a+b*s
+        void fma  (const double* a,const float* b,double s,double* out,std::size_t n); //!< out=a+b*s, mixed precision
+        void affine(const double* a,double s,double o,double* out,std::size_t n);      //!< out=a*s+o
+
+        void convert(const float* in,double* out,std::size_t n);                       //!< widening copy
+        void convert(const double* in,float* out,std::size_t n);                       //!< narrowing copy (rounds)
+
+        /// @brief Accuracy of reciprocal square roots in `norm()` and `normalize()` of `float` columns.
+        /// @note The scalar level and `double` columns are always `exact`.
+        enum class precision {
+            fast,       //!< Hardware estimate only, relative error below 4e-4 (below 7e-5 with AVX-512).
+            refined,    //!< The estimate and one Newton-Raphson step, a few units in the last place.
+            exact       //!< Square root and division.
+        };
+
+        /// @brief out=|(x,y,z)| over columns. `z` may be `nullptr` for plane vectors.
+        void norm(const float* x,const float* y,const float* z,float* out,std::size_t n,precision p);
+        void norm(const double* x,const double* y,const double* z,double* out,std::size_t n,precision p);
+
+        /// @brief (x,y,z)*=length/|(x,y,z)| in place, zero vectors stay zero. Old norms go to `norms` if not null.
+        void normalize(float* x,float* y,float* z,std::size_t n,double length,float* norms,precision p);
+        void normalize(double* x,double* y,double* z,std::size_t n,double length,double* norms,precision p);
+    }
+
+    // SPAN OF TYPED OBJECTS:
+    //*//////////////////////
+
+    /** @brief Non-owning view of contiguous typed objects (`std::span` is C++20, so we have our own).
+     *  \tparam T - element type, may be `const` */
+    template<class T>
+    class vec_span {
+        T*          ptr=nullptr;
+        std::size_t len=0;
+    public:
+        typedef T           element_type;
+        typedef std::size_t size_type;
+
+        constexpr vec_span()=default;
+
+        constexpr vec_span(T* p,std::size_t n):ptr(p),len(n) {}
+
+        template<std::size_t N>
+        constexpr vec_span(T (&a)[N]):ptr(a),len(N) {} // NOLINT(*-explicit-constructor)
+
+        /// @brief Any container with `data()` and `size()`, like `std::vector` or `std::array`.
+        template<class CONT,class=std::enable_if_t<std::is_convertible_v<decltype(std::declval<CONT&>().data()),T*>>>
+        constexpr vec_span(CONT& c):ptr(c.data()),len(c.size()) {} // NOLINT(*-explicit-constructor)
+
+        /// @brief Writable span is also a read only one.
+        template<class U,class=std::enable_if_t<std::is_same_v<const U,T> && !std::is_same_v<U,T>>>
+        constexpr vec_span(const vec_span<U>& s):ptr(s.data()),len(s.size()) {} // NOLINT(*-explicit-constructor)
+
+        constexpr T*          data()  const { return ptr; }
+        constexpr std::size_t size()  const { return len; }
+        constexpr bool        empty() const { return len==0; }
+        constexpr T*          begin() const { return ptr; }
+        constexpr T*          end()   const { return ptr+len; }
+        constexpr T& operator [] (std::size_t i) const { return ptr[i]; }
+
+        constexpr vec_span subspan(std::size_t offset,std::size_t count) const { return {ptr+offset,count}; }
+    };
+
+    /// @brief Span over a whole container, e.g. `span_of(std::vector<VolumePosition>&)`.
+    template<class CONT>
+    constexpr auto span_of(CONT& c) { return vec_span<std::remove_reference_t<decltype(*c.data())>>(c.data(),c.size()); }
+
+    // HELPERS FOR TYPE CHECKING:
+    //*//////////////////////////
+
+    namespace detail {
+        /// @brief Number of raw values in a span of vectors stored as AoS.
+        template<class VEC>
+        constexpr std::size_t flat_values(std::size_t n) {
+            typedef vec_traits<std::remove_cv_t<VEC>> traits;
+            static_assert(std::is_standard_layout_v<std::remove_cv_t<VEC>>);
+            static_assert(sizeof(VEC)==traits::dimensions*sizeof(typename traits::value_type),
+                          "Vector type has padding and can't be processed as a flat array!");
+            return n*traits::dimensions;
+        }
+
+        /// @brief Span of vectors seen as a flat array of values, with the same constness.
+        template<class VEC>
+        auto* flat(vec_span<VEC> s) {
+            typedef typename vec_traits<std::remove_cv_t<VEC>>::value_type value_type;
+            return reinterpret_cast<std::conditional_t<std::is_const_v<VEC>,const value_type*,value_type*>>(s.data());
+        }
+
+        /// @brief Span of quantities seen as a flat array of values, with the same constness.
+        template<class Q>
+        auto* flat_quantities(vec_span<Q> s) {
+            typedef typename std::remove_cv_t<Q>::value_type value_type;
+            static_assert(sizeof(Q)==sizeof(value_type) && std::is_standard_layout_v<std::remove_cv_t<Q>>);
+            return reinterpret_cast<std::conditional_t<std::is_const_v<Q>,const value_type*,value_type*>>(s.data());
+        }
+
+        /// @brief Two vectors can be added when `xD()` accepts them, i.e. they have the same axes and units.
+        template<class VEC1,class VEC2>
+        constexpr void check_same_kind() {
+            typedef vec_traits<std::remove_cv_t<VEC1>> t1;
+            typedef vec_traits<std::remove_cv_t<VEC2>> t2;
+            static_assert(std::is_same_v<typename t1::base_type,typename t2::base_type>,
+                          "Axes, units or precision of the spans do not match!");
+        }
+
+        /// @brief The same axes and units, but the precision may differ.
+        template<class VEC1,class VEC2>
+        constexpr void check_same_axes_and_unit() {
+            typedef vec_traits<std::remove_cv_t<VEC1>> t1;
+            typedef vec_traits<std::remove_cv_t<VEC2>> t2;
+            static_assert(t1::dimensions==t2::dimensions,"Dimensions of the spans do not match!");
+            static_assert(std::is_same_v<typename t1::quantity::unit_type,typename t2::quantity::unit_type>,
+                          "Units of the spans do not match!");
+            static_assert(std::is_same_v<typename t1::axis_x,typename t2::axis_x> &&
+                          std::is_same_v<typename t1::axis_y,typename t2::axis_y>,
+                          "Axes of the spans do not match!");
+            if constexpr (t1::dimensions==3)
+                static_assert(std::is_same_v<typename t1::axis_z,typename t2::axis_z>,
+                              "Axes of the spans do not match!");
+        }
+
+        /// @brief `VEC + RATE*time` is valid only for the same axes and `RATE` being time derivative of `VEC`.
+        /// Rates may be narrower than `VEC` (`double` positions with `float` velocities), never wider.
+        template<class VEC,class RATE>
+        constexpr void check_rate_of() {
+            typedef vec_traits<std::remove_cv_t<VEC>>  tv;
+            typedef vec_traits<std::remove_cv_t<RATE>> tr;
+            typedef decltype(std::declval<typename tr::quantity>()*std::declval<TimeSI>()) integral;
+            static_assert(std::is_same_v<typename tv::quantity::unit_type,typename integral::unit_type>,
+                          "The second span must be the time derivative of the first one!");
+            static_assert(sizeof(typename tr::value_type)<=sizeof(typename tv::value_type),
+                          "Rate can't be stored wider than the advanced value!");
+            static_assert(tv::dimensions==tr::dimensions,"Dimensions of the spans do not match!");
+            static_assert(std::is_same_v<typename tv::axis_x,typename tr::axis_x> &&
+                          std::is_same_v<typename tv::axis_y,typename tr::axis_y>,
+                          "Axes of the spans do not match!");
+            if constexpr (tv::dimensions==3)
+                static_assert(std::is_same_v<typename tv::axis_z,typename tr::axis_z>,
+                              "Axes of the spans do not match!");
+        }
+    }
+
+    // BATCH OPERATIONS ON SPANS (AoS):
+    //*////////////////////////////////
+    // Input spans may be spans of `const` elements or not. Output may overlap with any input only exactly.
+
+    /// @brief out[i]=a[i]+b[i] for spans of vectors with the same axes and unit.
+    template<class VEC1,class VEC2,class VECR>
+    void batch_add(vec_span<VEC1> a,vec_span<VEC2> b,vec_span<VECR> out) {
+        detail::check_same_kind<VEC1,VEC2>(); detail::check_same_kind<VEC1,VECR>();    assert(a.size()==b.size() && a.size()==out.size());
+        simd::add(detail::flat(a),detail::flat(b),detail::flat(out),detail::flat_values<VEC1>(a.size()));
+    }
+
+    /// @brief out[i]=a[i]-b[i] for spans of vectors with the same axes and unit.
+    template<class VEC1,class VEC2,class VECR>
+    void batch_sub(vec_span<VEC1> a,vec_span<VEC2> b,vec_span<VECR> out) {
+        detail::check_same_kind<VEC1,VEC2>(); detail::check_same_kind<VEC1,VECR>();    assert(a.size()==b.size() && a.size()==out.size());
+        simd::sub(detail::flat(a),detail::flat(b),detail::flat(out),detail::flat_values<VEC1>(a.size()));
+    }
+
+    /// @brief out[i]=a[i]*s
+    template<class VEC1,class VECR>
+    void batch_scale(vec_span<VEC1> a,double s,vec_span<VECR> out) {
+        detail::check_same_kind<VEC1,VECR>();                                          assert(a.size()==out.size());
+        simd::scale(detail::flat(a),s,detail::flat(out),detail::flat_values<VEC1>(a.size()));
+    }
+
+    /// @brief out[i]=a[i]+b[i]*s for vectors of the same kind.
+    template<class VEC1,class VEC2,class VECR>
+    void batch_fma(vec_span<VEC1> a,vec_span<VEC2> b,double s,vec_span<VECR> out) {
+        detail::check_same_kind<VEC1,VEC2>(); detail::check_same_kind<VEC1,VECR>();    assert(a.size()==b.size() && a.size()==out.size());
+        simd::fma(detail::flat(a),detail::flat(b),s,detail::flat(out),detail::flat_values<VEC1>(a.size()));
+    }
+
+    /// @brief out[i]=pos[i]+rate[i]*dt, e.g. position from velocity or velocity from acceleration.
+    template<class VEC,class RATE,class VECR>
+    void batch_advance(vec_span<VEC> pos,vec_span<RATE> rate,const TimeSpan& dt,vec_span<VECR> out) {
+        detail::check_rate_of<VEC,RATE>(); detail::check_same_kind<VEC,VECR>();     assert(pos.size()==rate.size() && pos.size()==out.size());
+        simd::fma(detail::flat(pos),detail::flat(rate),dt.val.value,detail::flat(out),detail::flat_values<VEC>(pos.size()));
+    }
+
+    /// @brief out[i]=VECR{a[i]}, i.e. widening or narrowing of the whole span. Axes and unit must match.
+    template<class VEC1,class VECR>
+    void batch_convert(vec_span<VEC1> a,vec_span<VECR> out) {
+        detail::check_same_axes_and_unit<VEC1,VECR>();                                   assert(a.size()==out.size());
+        typedef typename vec_traits<std::remove_cv_t<VEC1>>::value_type from;
+        typedef typename vec_traits<std::remove_cv_t<VECR>>::value_type to;
+        if constexpr (std::is_same_v<from,to>)
+            std::copy(a.begin(),a.end(),out.begin());
+        else
+            simd::convert(detail::flat(a),detail::flat(out),detail::flat_values<VEC1>(a.size()));
+    }
+
+    // BATCH OPERATIONS ON ARRAYS (SoA):
+    //*/////////////////////////////////
+
+    /// @brief Column by column `out=a+b`. `out` is resized to the size of `a`.
+    template<class VEC1,class VEC2,class VECR>
+    void batch_add(const VecArray<VEC1>& a,const VecArray<VEC2>& b,VecArray<VECR>& out) {
+        detail::check_same_kind<VEC1,VEC2>(); detail::check_same_kind<VEC1,VECR>();           assert(a.size()==b.size());
+        out.resize(a.size());
+        simd::add(a.xs(),b.xs(),out.xs(),a.size());
+        simd::add(a.ys(),b.ys(),out.ys(),a.size());
+        if constexpr (VecArray<VEC1>::dimensions==3) simd::add(a.zs(),b.zs(),out.zs(),a.size());
+    }
+
+    /// @brief Column by column `out=a-b`. `out` is resized to the size of `a`.
+    template<class VEC1,class VEC2,class VECR>
+    void batch_sub(const VecArray<VEC1>& a,const VecArray<VEC2>& b,VecArray<VECR>& out) {
+        detail::check_same_kind<VEC1,VEC2>(); detail::check_same_kind<VEC1,VECR>();           assert(a.size()==b.size());
+        out.resize(a.size());
+        simd::sub(a.xs(),b.xs(),out.xs(),a.size());
+        simd::sub(a.ys(),b.ys(),out.ys(),a.size());
+        if constexpr (VecArray<VEC1>::dimensions==3) simd::sub(a.zs(),b.zs(),out.zs(),a.size());
+    }
+
+    /// @brief Column by column `out=a*s`. `out` is resized to the size of `a`.
+    template<class VEC1,class VECR>
+    void batch_scale(const VecArray<VEC1>& a,double s,VecArray<VECR>& out) {
+        detail::check_same_kind<VEC1,VECR>();
+        out.resize(a.size());
+        simd::scale(a.xs(),s,out.xs(),a.size());
+        simd::scale(a.ys(),s,out.ys(),a.size());
+        if constexpr (VecArray<VEC1>::dimensions==3) simd::scale(a.zs(),s,out.zs(),a.size());
+    }
+
+    /// @brief Column by column `out=a+b*s`. `out` is resized to the size of `a`.
+    template<class VEC1,class VEC2,class VECR>
+    void batch_fma(const VecArray<VEC1>& a,const VecArray<VEC2>& b,double s,VecArray<VECR>& out) {
+        detail::check_same_kind<VEC1,VEC2>(); detail::check_same_kind<VEC1,VECR>();           assert(a.size()==b.size());
+        out.resize(a.size());
+        simd::fma(a.xs(),b.xs(),s,out.xs(),a.size());
+        simd::fma(a.ys(),b.ys(),s,out.ys(),a.size());
+        if constexpr (VecArray<VEC1>::dimensions==3) simd::fma(a.zs(),b.zs(),s,out.zs(),a.size());
+    }
+
+    /// @brief Column by column `out=pos+rate*dt`. `out` may be the same array as `pos`.
+    template<class VEC,class RATE,class VECR>
+    void batch_advance(const VecArray<VEC>& pos,const VecArray<RATE>& rate,const TimeSpan& dt,VecArray<VECR>& out) {
+        detail::check_rate_of<VEC,RATE>(); detail::check_same_kind<VEC,VECR>();           assert(pos.size()==rate.size());
+        out.resize(pos.size());
+        simd::fma(pos.xs(),rate.xs(),dt.val.value,out.xs(),pos.size());
+        simd::fma(pos.ys(),rate.ys(),dt.val.value,out.ys(),pos.size());
+        if constexpr (VecArray<VEC>::dimensions==3) simd::fma(pos.zs(),rate.zs(),dt.val.value,out.zs(),pos.size());
+    }
+
+    /// @brief Column by column widening or narrowing. `out` is resized to the size of `a`.
+    template<class VEC1,class VECR>
+    void batch_convert(const VecArray<VEC1>& a,VecArray<VECR>& out) {
+        detail::check_same_axes_and_unit<VEC1,VECR>();
+        out.resize(a.size());
+        typedef typename VecArray<VEC1>::value_type from;
+        typedef typename VecArray<VECR>::value_type to;
+        if constexpr (std::is_same_v<from,to>) {
+            std::copy(a.xs(),a.xs()+a.size(),out.xs());
+            std::copy(a.ys(),a.ys()+a.size(),out.ys());
+            if constexpr (VecArray<VEC1>::dimensions==3) std::copy(a.zs(),a.zs()+a.size(),out.zs());
+        } else {
+            simd::convert(a.xs(),out.xs(),a.size());
+            simd::convert(a.ys(),out.ys(),a.size());
+            if constexpr (VecArray<VEC1>::dimensions==3) simd::convert(a.zs(),out.zs(),a.size());
+        }
+    }
+
+}
+
+#endif //WB_SIMULATIONS_VEC_BATCH_H
@@ -0,0 +1,308 @@
+/** @file mth_vec_compact.h @brief Compact, block floating point storage of typed vectors.
+ *  @details
+ *      `CompactArray<VolumePosition>` keeps every coordinate as a 16-bit code relative to the origin and the step
+ *      of its block of `BLOCK` elements, like `UFloat16` does with a fixed grid. A 3D position takes 6 bytes instead
+ *      of 12, 2D one 4 bytes instead of 8, plus a few bytes per block. Steps adapt to the extent of every block,
+ *      so the error of a coordinate is at most half of its block step, never below `min_step`. New blocks start
+ *      from the tightest step, and grow it when appended or set elements do not fit, by twice at least, so errors
+ *      of elements that went through such refits stay below a whole step.
+ *
+ *      Typed `get()`/`set()` decode and encode single elements on the fly. `encode()`/`decode()` convert whole
+ *      `VecArray`s, or ranges of blocks, with the bulk SIMD kernels of `mth_fix_float.h`. An element set out of
+ *      the range of its block triggers re-encoding of that block only.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_VEC_COMPACT_H
+#define WB_SIMULATIONS_VEC_COMPACT_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_fix_float.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace merry_tools::math {
+
+    /** @brief Block floating point container of typed vectors with 16-bit codes per coordinate.
+     *  @details Elements are reachable by value only (`get()`/`set()`), since they do not exist in memory.
+     *  \tparam VEC - any type derived from `Vec2D` or `Vec3D`, e.g. `VolumePosition` or `PlaneVelocity`
+     *  \tparam BLOCK - elements sharing an origin and a step, a multiple of 32 */
+    template<class VEC,std::size_t BLOCK=256>
+    class CompactArray {
+        typedef vec_traits<VEC> traits;
+        static_assert(BLOCK>0 && BLOCK%32==0,"BLOCK must be a multiple of 32, i.e. whole aligned column blocks!");
+
+    public:
+        // STATIC INFOS:
+        //*/////////////
+        typedef VEC                          element_type;
+        typedef typename traits::base_type   base_type;
+        typedef typename traits::quantity    quantity;
+        typedef typename traits::value_type  value_type;
+        typedef std::int16_t                 code_type;
+
+        WB_STATIC_INSIDE_CLASS std::size_t dimensions=traits::dimensions;
+        WB_STATIC_INSIDE_CLASS std::size_t block_size=BLOCK;
+        WB_STATIC_INSIDE_CLASS code_type   code_limit=32767;      //!< Codes are in `[-code_limit,code_limit]`.
+
+        /// @brief Origin and step of every axis of a single block.
+        struct block_frame {
+            value_type origin[dimensions];
+            value_type step[dimensions];
+        };
+
+    private:
+        aligned_column<code_type> codes[dimensions];
+        std::vector<block_frame>  frames;
+        std::size_t               count=0;
+        value_type                min_step;
+
+    public:
+        // CONSTRUCTORS:
+        //*/////////////
+
+        /// @brief Empty container. Steps of blocks are never below `resolution`, e.g. 1 cm for positions.
+        explicit CompactArray(quantity resolution=quantity{value_type(0)}):min_step(resolution.value) {}
+
+        /// @brief Encoded copy of `src`.
+        explicit CompactArray(const VecArray<VEC>& src,quantity resolution=quantity{value_type(0)}):min_step(resolution.value) {
+            encode(src);
+        }
+
+        CompactArray(CompactArray&&) noexcept=default;
+        CompactArray& operator = (CompactArray&&) noexcept=default;
+
+        // SIZE AND STORAGE:
+        //*/////////////////
+        std::size_t size()   const { return count; }
+        std::size_t blocks() const { return frames.size(); }
+        bool        empty()  const { return count==0; }
+
+        /// @brief Memory taken by codes and frames, without padding and the object itself.
+        std::size_t bytes() const { return count*dimensions*sizeof(code_type)+frames.size()*sizeof(block_frame); }
+
+        /// @brief New elements are zero vectors.
+        void resize(std::size_t n) {
+            const std::size_t old=count;
+            reshape(n);
+            const value_type zero[3]={0,0,0};
+            for(std::size_t i=old;i<n;i++) set_raw(i,zero);
+        }
+
+        void clear() { count=0; frames.clear(); }
+
+        void push_back(const base_type& v) {
+            if(count==capacity()) {
+                const std::size_t grown=std::max<std::size_t>(BLOCK,capacity()*2);
+                for(auto& col:codes) col.reallocate(grown,count);
+            }
+            if(count%BLOCK==0) frames.push_back(frame_around(v));
+            count++;
+            set(count-1,v);
+        }
+
+        /// @brief Origin and step of the `b`-th block.
+        const block_frame& frame(std::size_t b) const {                                      assert(b<frames.size());
+            return frames[b];
+        }
+
+        /// @brief The biggest error of the `I`-th coordinate of the elements of the `b`-th block after `encode()`.
+        ///        Refits by `set()` and `push_back()` may double it.
+        template<std::size_t I>
+        quantity max_error(std::size_t b) const { static_assert(I<dimensions); return quantity{frame(b).step[I]/2}; }
+
+        /// @brief Raw codes of the `I`-th axis. Use for SIMD kernels only.
+        template<std::size_t I>
+        const code_type* column() const { static_assert(I<dimensions); return codes[I].data(); }
+
+        // TYPED ELEMENT ACCESS:
+        //*/////////////////////
+        VEC get(std::size_t i) const {                                                                 assert(i<count);
+            const block_frame& f=frames[i/BLOCK];
+            auto at=[&](std::size_t c) { return quantity{value_type(codes[c].data()[i])*f.step[c]+f.origin[c]}; };
+            if constexpr (dimensions==2) {
+                return VEC{ typename traits::scalar_x{at(0)}, typename traits::scalar_y{at(1)} };
+            } else {
+                return VEC{ typename traits::scalar_x{at(0)}, typename traits::scalar_y{at(1)},
+                            typename traits::scalar_z{at(2)} };
+            }
+        }
+
+        VEC operator [] (std::size_t i) const { return get(i); }
+
+        /// @brief Only the same axes and the same unit are accepted. Refits axes of the block, where `v` is out of
+        ///        range, which adds up to half of the new step to the errors of the other elements of the block.
+        void set(std::size_t i,const base_type& v) {                                                   assert(i<count);
+            const value_type raw[3]={v.x.val.value,v.y.val.value,z_of(v)};
+            set_raw(i,raw);
+        }
+
+        // BULK CONVERSIONS:
+        //*/////////////////
+
+        /// @brief Replaces the content with encoded `src`.
+        void encode(const VecArray<VEC>& src) {
+            reshape(src.size());
+            encode(src,0,frames.size());
+        }
+
+        /// @brief Encodes blocks `[first,last)` from the same elements of `src`, which has the size of this container.
+        ///        Disjoint ranges may be encoded concurrently.
+        void encode(const VecArray<VEC>& src,std::size_t first,std::size_t last) {    assert(src.size()==count);
+            for(std::size_t b=first;b<last;b++) {
+                const std::size_t n=std::min(count,(b+1)*BLOCK)-b*BLOCK;
+                for(std::size_t c=0;c<dimensions;c++) encode_axis(b,c,n,column_of(src,c)+b*BLOCK);
+            }
+        }
+
+        /// @brief Decodes everything into `out`, resized to this size.
+        void decode(VecArray<VEC>& out) const {
+            out.resize(count);
+            decode(out,0,frames.size());
+        }
+
+        /// @brief Decodes blocks `[first,last)` into the same elements of `out`, which has the size of this container.
+        ///        Disjoint ranges may be decoded concurrently.
+        void decode(VecArray<VEC>& out,std::size_t first,std::size_t last) const {    assert(out.size()==count);
+            for(std::size_t b=first;b<last;b++) {
+                const std::size_t n=std::min(count,(b+1)*BLOCK)-b*BLOCK;
+                for(std::size_t c=0;c<dimensions;c++) decode_axis(b,c,n,column_of(out,c)+b*BLOCK);
+            }
+        }
+
+    private:
+        std::size_t capacity() const { return codes[0].capacity(); }
+
+        /// Storage for `n` elements, new ones with undefined values.
+        void reshape(std::size_t n) {
+            const std::size_t nb=(n+BLOCK-1)/BLOCK;
+            if(nb*BLOCK>capacity())
+                for(auto& col:codes) col.reallocate(nb*BLOCK,std::min(count,n));
+            frames.resize(nb,zero_frame());
+            count=n;
+        }
+
+        static value_type z_of(const base_type& v) {
+            if constexpr (dimensions==3) return v.z.val.value; else return value_type(0);
+        }
+
+        template<class ARRAY>
+        static auto column_of(ARRAY& a,std::size_t c) {
+            if constexpr (dimensions==3) return c==0?a.xs():c==1?a.ys():a.zs();
+            else return c==0?a.xs():a.ys();
+        }
+
+        /// At least `min_step`. Equal values get a step of an ulp of `origin`, so any other value refits the block.
+        value_type positive_step(value_type step,value_type origin) const {
+            step=std::max(step,min_step);
+            if(step>0) return step;
+            return std::max(std::abs(origin)*std::numeric_limits<value_type>::epsilon(),
+                            std::numeric_limits<value_type>::min());
+        }
+
+        block_frame zero_frame() const {
+            block_frame f;
+            for(std::size_t c=0;c<dimensions;c++) { f.origin[c]=0; f.step[c]=positive_step(0,0); }
+            return f;
+        }
+
+        block_frame frame_around(const base_type& v) const {
+            const value_type raw[3]={v.x.val.value,v.y.val.value,z_of(v)};
+            block_frame f;
+            for(std::size_t c=0;c<dimensions;c++) { f.origin[c]=raw[c]; f.step[c]=positive_step(0,raw[c]); }
+            return f;
+        }
+
+        /// The same arithmetic as `simd::quantize()`, so single and bulk encoding agree.
+        code_type code_of(value_type v,std::size_t c,std::size_t b) const {
+            const value_type s=(v-frames[b].origin[c])*(1/frames[b].step[c]);
+            return static_cast<code_type>(detail::round_code(detail::clamp_code<value_type>(s,-code_limit,code_limit)));
+        }
+
+        void set_raw(std::size_t i,const value_type* raw) {
+            const std::size_t b=i/BLOCK,first=b*BLOCK,n=std::min(count,first+BLOCK)-first;
+            for(std::size_t c=0;c<dimensions;c++) {
+                const value_type s=(raw[c]-frames[b].origin[c])*(1/frames[b].step[c]);
+                if(!(s<-code_limit || s>code_limit)) { codes[c].data()[i]=code_of(raw[c],c,b); continue; }
+                value_type buffer[BLOCK];
+                decode_axis(b,c,n,buffer);
+                buffer[i-first]=raw[c];
+                refit_axis(b,c,n,buffer);
+            }
+        }
+
+        /// The smallest and the biggest of `n` values, NaN skipped.
+        static void range_of(const value_type* in,std::size_t n,value_type& lo,value_type& hi) {
+            lo=hi=0;
+            bool any=false;
+            for(std::size_t k=0;k<n;k++) {
+                if(std::isnan(in[k])) continue;
+                lo=any?std::min(lo,in[k]):in[k]; hi=any?std::max(hi,in[k]):in[k]; any=true;
+            }
+        }
+
+        /// New frame of the axis `c` of the block `b` fitted to `n` values, then their codes.
+        /// One code of margin on each side keeps rounding of the scale inside the range.
+        void encode_axis(std::size_t b,std::size_t c,std::size_t n,const value_type* in) {
+            value_type lo,hi;
+            range_of(in,n,lo,hi);
+            block_frame& f=frames[b];
+            f.origin[c]=lo+(hi-lo)/2;
+            f.step[c]=positive_step((hi-lo)/(2*(code_limit-1)),f.origin[c]);
+            quantize_axis(b,c,n,in);
+        }
+
+        /// Frame of the axis `c` of the block `b` refitted to `n` decoded values and a new one out of its range.
+        /// If they fit the step, the origin moves by whole steps and old codes just shift. Otherwise the step grows
+        /// twice at least, so errors added by a series of refits sum up to less than the last step.
+        void refit_axis(std::size_t b,std::size_t c,std::size_t n,const value_type* in) {
+            value_type lo,hi;
+            range_of(in,n,lo,hi);
+            block_frame& f=frames[b];
+            const value_type half=(hi-lo)/2,middle=lo+half;
+            if(half<=(code_limit-1)*f.step[c]) {
+                f.origin[c]+=std::nearbyint((middle-f.origin[c])/f.step[c])*f.step[c];
+            } else {
+                f.origin[c]=middle;
+                f.step[c]=positive_step(std::max(half/(code_limit-1),2*f.step[c]),middle);
+            }
+            quantize_axis(b,c,n,in);
+        }
+
+        void quantize_axis(std::size_t b,std::size_t c,std::size_t n,const value_type* in) {
+            const block_frame& f=frames[b];
+            code_type* out=codes[c].data()+b*BLOCK;
+            if constexpr (std::is_same_v<value_type,float>)
+                simd::quantize(in,f.origin[c],1/f.step[c],-code_limit,code_limit,out,n);
+            else
+                for(std::size_t k=0;k<n;k++) out[k]=code_of(in[k],c,b);
+        }
+
+        void decode_axis(std::size_t b,std::size_t c,std::size_t n,value_type* out) const {
+            const block_frame& f=frames[b];
+            const code_type* in=codes[c].data()+b*BLOCK;
+            if constexpr (std::is_same_v<value_type,float>)
+                simd::dequantize(in,f.origin[c],f.step[c],out,n);
+            else
+                for(std::size_t k=0;k<n;k++) out[k]=value_type(in[k])*f.step[c]+f.origin[c];
+        }
+    };
+
+    /// @brief Compact container for 3D vectors, e.g. `CompactVolumeArray<VolumePosition>`.
+    template<class VEC,std::size_t BLOCK=256>
+    using CompactVolumeArray=std::enable_if_t<vec_traits<VEC>::dimensions==3,CompactArray<VEC,BLOCK>>;
+
+    /// @brief Compact container for 2D vectors, e.g. `CompactPlaneArray<PlanePosition>`.
+    template<class VEC,std::size_t BLOCK=256>
+    using CompactPlaneArray=std::enable_if_t<vec_traits<VEC>::dimensions==2,CompactArray<VEC,BLOCK>>;
+
+}
+
+#endif //WB_SIMULATIONS_VEC_COMPACT_H
@@ -0,0 +1,490 @@
+/** @file mth_vec_expr.h @brief Lazy (expression template) arithmetic over typed vectors, scalars and their containers.
+ *  @details
+ *      `p + v*dt + a*dt*dt/2` with `Vec3D` operands builds no intermediate vectors. Multiplying a vector by a factor
+ *      starts a tiny tree of nodes, which is evaluated component by component when assigned to a vector, e.g.
+ *      `VolumePosition next = p + v*dt;`. For plain sums like `res10-res3` use `lazy(res10)-res3`.
+ *
+ *      Containers take part through `lazy(VecArray)` or `lazy(vec_span)`, and `evaluate(expression,out)` runs
+ *      the whole expression element-wise in a single loop per column, with no intermediate arrays.
+ *      Single objects inside a container expression are broadcast, e.g. `lazy(vel)+g*dt`.
+ *
+ *      Axes and units are checked at compile time exactly like in `xD()`. Nodes keep containers by reference,
+ *      so an expression must not outlive its operands. Do not keep it in `auto` variables beyond the statement.
+ *
+ *  @date 2026-10-16 (last modification)
+ */
+#ifndef WB_SIMULATIONS_VEC_EXPR_H
+#define WB_SIMULATIONS_VEC_EXPR_H
+
+#include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_vec_batch.h"
+
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace merry_tools::math {
+
+    /// @brief Nodes of lazy expressions. Users need only `lazy()`, `evaluate()` and ordinary operators.
+    namespace expr {
+
+        // TRAITS OF OPERANDS:
+        //*///////////////////
+
+        /// @brief Axes of an operand, in order of components.
+        template<class... AXES>
+        struct axis_list {
+            WB_STATIC_INSIDE_CLASS std::size_t size=sizeof...(AXES);
+
+            template<std::size_t I>
+            using at=std::tuple_element_t<I,std::tuple<AXES...>>;
+        };
+
+        /// @brief Typed object, i.e. `Scalar`, `Vec2D` or `Vec3D`, made of axes and a quantity.
+        template<class AXES,class QUANTITY>
+        struct object_of;
+
+        template<class AXIS,class QUANTITY>
+        struct object_of<axis_list<AXIS>,QUANTITY> { typedef Scalar<AXIS,QUANTITY> type; };
+
+        template<class AXIS1,class AXIS2,class QUANTITY>
+        struct object_of<axis_list<AXIS1,AXIS2>,QUANTITY> { typedef Vec2D<AXIS1,AXIS2,QUANTITY> type; };
+
+        template<class AXIS1,class AXIS2,class AXIS3,class QUANTITY>
+        struct object_of<axis_list<AXIS1,AXIS2,AXIS3>,QUANTITY> { typedef Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY> type; };
+
+        namespace detail {
+            template<class AXIS,class QUANTITY>
+            Scalar<AXIS,QUANTITY> object_base_of(const Scalar<AXIS,QUANTITY>*);                 //!< Only for `decltype`.
+
+            template<class AXIS1,class AXIS2,class QUANTITY>
+            Vec2D<AXIS1,AXIS2,QUANTITY> object_base_of(const Vec2D<AXIS1,AXIS2,QUANTITY>*);     //!< Only for `decltype`.
+
+            template<class AXIS1,class AXIS2,class AXIS3,class QUANTITY>
+            Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY> object_base_of(const Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY>*); //!< Only for `decltype`.
+
+            template<class DERIVED,class UNIT,class FLOAT>
+            Quantity<DERIVED,UNIT,FLOAT> quantity_base_of(const Quantity<DERIVED,UNIT,FLOAT>*);  //!< Only for `decltype`.
+
+            template<class QUANTITY>
+            QUANTITY time_quantity_of(const Scalar<Time,QUANTITY>*);                             //!< Only for `decltype`.
+        }
+
+        /// @brief Traits of typed objects. Primary template is intentionally empty.
+        template<class OBJ,class=void>
+        struct object_traits {};
+
+        template<class AXIS,class QUANTITY>
+        struct object_traits<Scalar<AXIS,QUANTITY>> {
+            typedef Scalar<AXIS,QUANTITY>          base_type;
+            typedef QUANTITY                       quantity;
+            typedef typename QUANTITY::value_type  value_type;
+            typedef axis_list<AXIS>                axes;
+        };
+
+        template<class AXIS1,class AXIS2,class QUANTITY>
+        struct object_traits<Vec2D<AXIS1,AXIS2,QUANTITY>> {
+            typedef Vec2D<AXIS1,AXIS2,QUANTITY>    base_type;
+            typedef QUANTITY                       quantity;
+            typedef typename QUANTITY::value_type  value_type;
+            typedef axis_list<AXIS1,AXIS2>         axes;
+        };
+
+        template<class AXIS1,class AXIS2,class AXIS3,class QUANTITY>
+        struct object_traits<Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY>> {
+            typedef Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY> base_type;
+            typedef QUANTITY                          quantity;
+            typedef typename QUANTITY::value_type     value_type;
+            typedef axis_list<AXIS1,AXIS2,AXIS3>      axes;
+        };
+
+        /// @brief Named types like `VolumePosition` or `TimeSpan` take traits of their base template.
+        template<class OBJ>
+        struct object_traits<OBJ,std::void_t<decltype(detail::object_base_of(static_cast<const OBJ*>(nullptr)))>>:
+                public object_traits<decltype(detail::object_base_of(static_cast<const OBJ*>(nullptr)))> {};
+
+        // `node_tag`, the common base of all nodes, is in `mth_vectors.h` for the sake of the general `operator +/-`.
+
+        template<class T>
+        WB_GLOBAL_OUTSIDE_CLASS bool is_node_v=std::is_base_of_v<node_tag,T>;
+
+        template<class T,class=void>
+        struct is_object:std::false_type {};
+
+        template<class T>
+        struct is_object<T,std::void_t<typename object_traits<T>::base_type>>:std::true_type {};
+
+        /// @brief `Scalar`, `Vec2D`, `Vec3D` or anything derived from them.
+        template<class T>
+        WB_GLOBAL_OUTSIDE_CLASS bool is_object_v=is_object<T>::value;
+
+        template<class T,class=void>
+        struct is_vector:std::false_type {};
+
+        template<class T>
+        struct is_vector<T,std::enable_if_t<is_object<T>::value>>:
+                std::bool_constant<(object_traits<T>::axes::size>1)> {};
+
+        /// @brief Only `Vec2D`/`Vec3D` start lazy expressions by themselves. `Scalar` has its own eager operators.
+        template<class T>
+        WB_GLOBAL_OUTSIDE_CLASS bool is_vector_v=is_vector<T>::value;
+
+        template<class T,class=void>
+        struct is_quantity:std::false_type {};
+
+        template<class T>
+        struct is_quantity<T,std::void_t<decltype(detail::quantity_base_of(static_cast<const T*>(nullptr)))>>:
+                std::true_type {};
+
+        template<class T,class=void>
+        struct is_time_scalar:std::false_type {};
+
+        template<class T>
+        struct is_time_scalar<T,std::void_t<decltype(detail::time_quantity_of(static_cast<const T*>(nullptr)))>>:
+                std::true_type {};
+
+        /// @brief Allowed factors: plain numbers, quantities and `TimeSpan`-like scalars on the `Time` axis.
+        template<class T>
+        WB_GLOBAL_OUTSIDE_CLASS bool is_factor_v=std::is_arithmetic_v<T> || is_quantity<T>::value
+                                                 || is_time_scalar<T>::value;
+
+        /// @brief Factor as it takes part in the calculation: number or quantity, never a scalar.
+        template<class F>
+        constexpr auto factor_of(const F& f) {
+            if constexpr (is_time_scalar<F>::value) return f.val;
+            else return f;
+        }
+
+        template<class F>
+        using factor_t=decltype(factor_of(std::declval<F>()));
+
+        /// @brief Raw value of the `I`-th component of a typed object, writable when the object is.
+        template<std::size_t I,class OBJ>
+        constexpr auto& component(OBJ& o) {
+            if constexpr (object_traits<std::remove_cv_t<OBJ>>::axes::size==1) { static_assert(I==0); return o.val.value; }
+            else if constexpr (I==0) return o.x.val.value;
+            else if constexpr (I==1) return o.y.val.value;
+            else                     return o.z.val.value;
+        }
+
+        /// @brief Result of a node may be stored only into objects with the same axes, unit and precision.
+        template<class TARGET,class NODE>
+        constexpr void check_target() {
+            typedef object_traits<TARGET> tt;
+            static_assert(std::is_same_v<typename tt::axes,typename NODE::axes>,
+                          "Axes of the expression do not match the target!");
+            static_assert(std::is_same_v<typename tt::quantity::unit_type,typename NODE::quantity::unit_type>,
+                          "Unit of the expression does not match the target!");
+            static_assert(std::is_same_v<typename tt::value_type,typename NODE::value_type>,
+                          "Precision of the expression does not match the target! Convert explicitly.");
+        }
+
+        /// @brief Typed object of `TARGET` type from the `i`-th element of a node.
+        template<class TARGET,class NODE>
+        constexpr TARGET materialize(const NODE& n,std::size_t i) {
+            check_target<TARGET,NODE>();
+            typedef typename object_traits<TARGET>::quantity  quantity;
+            typedef typename object_traits<TARGET>::axes      axes;
+            typedef Scalar<typename axes::template at<0>,quantity> scalar_x;
+            if constexpr (axes::size==1) {
+                return TARGET{quantity{n.template get<0>(i)}};
+            } else if constexpr (axes::size==2) {
+                typedef Scalar<typename axes::template at<1>,quantity> scalar_y;
+                return TARGET{scalar_x{quantity{n.template get<0>(i)}},scalar_y{quantity{n.template get<1>(i)}}};
+            } else {
+                typedef Scalar<typename axes::template at<1>,quantity> scalar_y;
+                typedef Scalar<typename axes::template at<2>,quantity> scalar_z;
+                return TARGET{scalar_x{quantity{n.template get<0>(i)}},scalar_y{quantity{n.template get<1>(i)}},
+                              scalar_z{quantity{n.template get<2>(i)}}};
+            }
+        }
+
+        // NODES:
+        //*//////
+        // Every node has `axes`, `quantity`, `value_type`, `size()` (0 for a single object, which is broadcast)
+        // and `get<I>(i)` giving the raw value of the `I`-th component of the `i`-th element.
+
+        /** @brief Base of every node, gives conversion to typed objects.
+         *  \tparam DERIVED - the node itself
+         *  \tparam AXES - `axis_list` of the result
+         *  \tparam QUANTITY - measure of the result */
+        template<class DERIVED,class AXES,class QUANTITY>
+        struct node:public node_tag {
+            typedef AXES                                    axes;
+            typedef QUANTITY                                quantity;
+            typedef typename QUANTITY::value_type           value_type;
+            typedef typename object_of<AXES,QUANTITY>::type result_type; //!< `Scalar`, `Vec2D` or `Vec3D`
+
+            WB_STATIC_INSIDE_CLASS std::size_t dimensions=AXES::size;
+
+            /// @brief Result for a single object, or for the `i`-th element of a container expression.
+            constexpr result_type eval(std::size_t i=0) const {
+                return materialize<result_type>(static_cast<const DERIVED&>(*this),i);
+            }
+
+            /// @brief Implicit evaluation into any typed object with the same axes, unit and precision.
+            template<class TARGET,class=std::enable_if_t<is_object_v<TARGET>>>
+            constexpr operator TARGET () const { // NOLINT(*-explicit-constructor)
+                return materialize<TARGET>(static_cast<const DERIVED&>(*this),0);
+            }
+        };
+
+        /// @brief Leaf keeping a copy of a single typed object.
+        template<class OBJ>
+        struct object_leaf:public node<object_leaf<OBJ>,typename object_traits<OBJ>::axes,
+                                                         typename object_traits<OBJ>::quantity> {
+            typename object_traits<OBJ>::base_type obj;
+
+            constexpr explicit object_leaf(const OBJ& o):obj(o) {}
+
+            constexpr std::size_t size() const { return 0; }
+
+            template<std::size_t I>
+            constexpr auto get(std::size_t /*i*/) const { return component<I>(obj); }
+        };
+
+        /// @brief Leaf referencing a SoA container.
+        template<class VEC>
+        struct array_leaf:public node<array_leaf<VEC>,typename object_traits<VEC>::axes,
+                                                       typename object_traits<VEC>::quantity> {
+            const VecArray<VEC>& arr;
+
+            explicit array_leaf(const VecArray<VEC>& a):arr(a) {}
+
+            std::size_t size() const { return arr.size(); }
+
+            template<std::size_t I>
+            auto get(std::size_t i) const { return arr.template column<I>()[i]; }
+        };
+
+        /// @brief Leaf referencing an AoS span.
+        template<class VEC>
+        struct span_leaf:public node<span_leaf<VEC>,typename object_traits<VEC>::axes,
+                                                     typename object_traits<VEC>::quantity> {
+            vec_span<const VEC> span;
+
+            explicit span_leaf(vec_span<const VEC> s):span(s) {}
+
+            std::size_t size() const { return span.size(); }
+
+            template<std::size_t I>
+            auto get(std::size_t i) const { return component<I>(span[i]); }
+        };
+
+        /// @brief Operands are nodes or typed objects. Objects are wrapped into leaves.
+        template<class T>
+        constexpr auto as_node(const T& t) {
+            if constexpr (is_node_v<T>) return t;
+            else return object_leaf<T>(t);
+        }
+
+        template<class T>
+        using node_t=decltype(as_node(std::declval<T>()));
+
+        /// @brief Both sides of `+`/`-` must have the same axes and unit. Precision of the result is the wider one.
+        template<class L,class R>
+        struct additive {
+            static_assert(std::is_same_v<typename L::axes,typename R::axes>,"Axes of the operands do not match!");
+            static_assert(std::is_same_v<typename L::quantity::unit_type,typename R::quantity::unit_type>,
+                          "Units of the operands do not match!");
+            typedef std::conditional_t<(sizeof(typename L::value_type)>=sizeof(typename R::value_type)),
+                                       typename L::quantity,typename R::quantity> quantity;
+        };
+
+        /// @brief Size of a binary node. Objects (size 0) are broadcast over containers.
+        template<class L,class R>
+        std::size_t joint_size(const L& l,const R& r) {
+            assert(l.size()==0 || r.size()==0 || l.size()==r.size());
+            return l.size()!=0?l.size():r.size();
+        }
+
+        /// @brief `l+r` component-wise.
+        template<class L,class R>
+        struct sum:public node<sum<L,R>,typename L::axes,typename additive<L,R>::quantity> {
+            typedef typename sum::value_type value_type;
+            L l; R r;
+
+            constexpr sum(const L& iniL,const R& iniR):l(iniL),r(iniR) {}
+
+            std::size_t size() const { return joint_size(l,r); }
+
+            template<std::size_t I>
+            constexpr value_type get(std::size_t i) const {
+                return value_type(l.template get<I>(i))+value_type(r.template get<I>(i));
+            }
+        };
+
+        /// @brief `l-r` component-wise, with no negated temporary.
+        template<class L,class R>
+        struct difference:public node<difference<L,R>,typename L::axes,typename additive<L,R>::quantity> {
+            typedef typename difference::value_type value_type;
+            L l; R r;
+
+            constexpr difference(const L& iniL,const R& iniR):l(iniL),r(iniR) {}
+
+            std::size_t size() const { return joint_size(l,r); }
+
+            template<std::size_t I>
+            constexpr value_type get(std::size_t i) const {
+                return value_type(l.template get<I>(i))-value_type(r.template get<I>(i));
+            }
+        };
+
+        /// @brief `-e` component-wise.
+        template<class E>
+        struct negation:public node<negation<E>,typename E::axes,typename E::quantity> {
+            E e;
+
+            constexpr explicit negation(const E& iniE):e(iniE) {}
+
+            std::size_t size() const { return e.size(); }
+
+            template<std::size_t I>
+            constexpr auto get(std::size_t i) const { return -e.template get<I>(i); }
+        };
+
+        /// @brief Result quantity of `E*F` or `E/F`. Numbers keep the quantity, quantities change it.
+        template<class E,class F,bool DIVIDE>
+        struct scaled_quantity {
+            typedef typename E::quantity Q;
+            typedef std::conditional_t<std::is_arithmetic_v<F>,std::common_type<Q>,
+                    std::conditional_t<DIVIDE,std::common_type<decltype(std::declval<Q>()/std::declval<F>())>,
+                                              std::common_type<decltype(std::declval<Q>()*std::declval<F>())>>> selector;
+            typedef typename selector::type type;
+            static_assert(!std::is_arithmetic_v<type>,"Dimensionless value can't lay on the axis!");
+        };
+
+        /// @brief Raw value of a factor in the precision of the result.
+        template<class VALUE,class F>
+        constexpr VALUE raw_factor(const F& f) {
+            if constexpr (std::is_arithmetic_v<F>) return VALUE(f);
+            else return VALUE(f.value);
+        }
+
+        /// @brief `e*f` for a number or quantity `f`. The factor is rounded to the precision of the result once.
+        template<class E,class F>
+        struct product:public node<product<E,F>,typename E::axes,typename scaled_quantity<E,F,false>::type> {
+            typedef typename product::value_type value_type;
+            E e; value_type f;
+
+            constexpr product(const E& iniE,const F& iniF):e(iniE),f(raw_factor<value_type>(iniF)) {}
+
+            std::size_t size() const { return e.size(); }
+
+            template<std::size_t I>
+            constexpr value_type get(std::size_t i) const { return value_type(e.template get<I>(i))*f; }
+        };
+
+        /// @brief `e/f` for a number or quantity `f`.
+        template<class E,class F>
+        struct quotient:public node<quotient<E,F>,typename E::axes,typename scaled_quantity<E,F,true>::type> {
+            typedef typename quotient::value_type value_type;
+            E e; value_type f;
+
+            constexpr quotient(const E& iniE,const F& iniF):e(iniE),f(raw_factor<value_type>(iniF)) {}
+
+            std::size_t size() const { return e.size(); }
+
+            template<std::size_t I>
+            constexpr value_type get(std::size_t i) const { return value_type(e.template get<I>(i))/f; }
+        };
+
+        /// @brief `+`/`-` is lazy when at least one operand is a node and both are nodes or typed objects.
+        template<class L,class R>
+        WB_GLOBAL_OUTSIDE_CLASS bool lazy_additive_v=(is_node_v<L> || is_node_v<R>) &&
+                                                     (is_node_v<L> || is_object_v<L>) &&
+                                                     (is_node_v<R> || is_object_v<R>);
+
+        /// @brief `*`/`/` is lazy for a node or a vector on the left (right for `*` too) and a factor.
+        template<class E>
+        WB_GLOBAL_OUTSIDE_CLASS bool lazy_scalable_v=is_node_v<E> || is_vector_v<E>;
+
+        // OPERATORS:
+        //*//////////
+        // They live here and in `merry_tools::math`, so ADL finds them for nodes and typed objects alike.
+
+        template<class L,class R,class=std::enable_if_t<lazy_additive_v<L,R>>>
+        constexpr auto operator + (const L& l,const R& r) { return sum<node_t<L>,node_t<R>>(as_node(l),as_node(r)); }
+
+        template<class L,class R,class=std::enable_if_t<lazy_additive_v<L,R>>>
+        constexpr auto operator - (const L& l,const R& r) {
+            return difference<node_t<L>,node_t<R>>(as_node(l),as_node(r));
+        }
+
+        template<class E,class=std::enable_if_t<is_node_v<E>>>
+        constexpr auto operator - (const E& e) { return negation<E>(e); }
+
+        template<class E,class F,class=std::enable_if_t<lazy_scalable_v<E> && is_factor_v<F>>>
+        constexpr auto operator * (const E& e,const F& f) {
+            return product<node_t<E>,factor_t<F>>(as_node(e),factor_of(f));
+        }
+
+        template<class F,class E,class=std::enable_if_t<lazy_scalable_v<E> && is_factor_v<F>>,class=void>
+        constexpr auto operator * (const F& f,const E& e) {
+            return product<node_t<E>,factor_t<F>>(as_node(e),factor_of(f));
+        }
+
+        template<class E,class F,class=std::enable_if_t<lazy_scalable_v<E> && is_factor_v<F>>>
+        constexpr auto operator / (const E& e,const F& f) {
+            return quotient<node_t<E>,factor_t<F>>(as_node(e),factor_of(f));
+        }
+    }
+
+    using expr::operator+;
+    using expr::operator-;
+    using expr::operator*;
+    using expr::operator/;
+
+    // ENTRY POINTS:
+    //*/////////////
+
+    /// @brief Lazy view of a single `Scalar`, `Vec2D` or `Vec3D`, e.g. `lazy(res10)-res3`.
+    template<class OBJ,class=std::enable_if_t<expr::is_object_v<OBJ>>>
+    constexpr auto lazy(const OBJ& o) { return expr::object_leaf<OBJ>(o); }
+
+    /// @brief Lazy view of a whole SoA array.
+    template<class VEC>
+    auto lazy(const VecArray<VEC>& a) { return expr::array_leaf<VEC>(a); }
+
+    /// @brief Lazy view of a whole AoS span.
+    template<class VEC>
+    auto lazy(vec_span<VEC> s) { return expr::span_leaf<std::remove_const_t<VEC>>(s); }
+
+    /// @brief Runs the expression for elements `[begin,end)` only, in a single loop per column. `out` is not resized.
+    ///        Disjoint ranges may run concurrently. `out` may be an operand.
+    template<class VEC,class NODE,class=std::enable_if_t<expr::is_node_v<NODE>>>
+    void evaluate(const NODE& e,VecArray<VEC>& out,std::size_t begin,std::size_t end) {
+        expr::check_target<VEC,NODE>();                   assert(begin<=end && end<=out.size());
+        auto column=[&](auto axis) {
+            constexpr std::size_t I=decltype(axis)::value;
+            typename VecArray<VEC>::value_type* col=out.template column<I>();
+            for(std::size_t i=begin;i<end;i++) col[i]=e.template get<I>(i);
+        };
+        column(std::integral_constant<std::size_t,0>{});
+        column(std::integral_constant<std::size_t,1>{});
+        if constexpr (NODE::dimensions==3) column(std::integral_constant<std::size_t,2>{});
+    }
+
+    /// @brief Runs the whole expression in a single loop per column. `out` is resized to the size of the expression,
+    ///        or keeps its size when the expression has no containers (then it is filled). `out` may be an operand.
+    template<class VEC,class NODE,class=std::enable_if_t<expr::is_node_v<NODE>>>
+    void evaluate(const NODE& e,VecArray<VEC>& out) {
+        out.resize(e.size()!=0?e.size():out.size());
+        evaluate(e,out,0,out.size());
+    }
+
+    /// @brief Runs the whole expression in a single loop over a span of the same size. `out` may be an operand.
+    template<class VEC,class NODE,class=std::enable_if_t<expr::is_node_v<NODE> && !std::is_const_v<VEC>>>
+    void evaluate(const NODE& e,vec_span<VEC> out) {
+        expr::check_target<VEC,NODE>();                                         assert(e.size()==0 || e.size()==out.size());
+        for(std::size_t i=0;i<out.size();i++) {
+            expr::component<0>(out[i])=e.template get<0>(i);
+            if constexpr (NODE::dimensions>1) expr::component<1>(out[i])=e.template get<1>(i);
+            if constexpr (NODE::dimensions>2) expr::component<2>(out[i])=e.template get<2>(i);
+        }
+    }
+}
+
+#endif //WB_SIMULATIONS_VEC_EXPR_H
@@ -3,14 +3,16 @@
  *
  *      Created by borkowsk on 10.12.22.
  *      Names changed from `create` into `xD` 11.12.23
- *  @date 2024-10-24 (last modification)
+ *  @date 2026-10-16 (last modification)
  */
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "google-explicit-constructor"
 #ifndef WB_SIMULATIONS_VECTORS_H
 #define WB_SIMULATIONS_VECTORS_H
 
+#include <cstddef>
 #include <string_view>
+#include <type_traits>
 
 namespace merry_tools::math {
 
@@ -19,9 +21,13 @@ namespace merry_tools::math {
         return std::string_view(a)==b;
     }
 
-    /// @brief Basic floating point type used for all physical values.
+    /// @brief Default floating point type used for physical values.
+    /// @note Any `Quantity` may choose its own storage type (see `DistSI64` etc. below).
     typedef float float_base;
 
+    /// @brief Floating point type for quantities which need more precision than `float_base`.
+    typedef double float_wide;
+
 /// @brief ....
 #define WB_STATIC_INSIDE_CLASS     static inline constexpr
 
@@ -33,8 +39,10 @@ namespace merry_tools::math {
 
     /// @brief Any class describing any coordinate system should inherit from this template.
     /// \tparam DERIVED - derived class (see `flat_simulation` below)
-    template<class DERIVED>
+    /// \tparam PRECISION - the cheapest storage type still correct for positions in this system
+    template<class DERIVED,class PRECISION=float_base>
     struct coordinate_system { WB_STATIC_INSIDE_CLASS const char* name() { return "????"; }
+                               typedef PRECISION precision; //!< Storage type suggested for positions.
                                //WB_VEC_CLASS_SPECIFIC bool isCoordinateSystem() {return true;}
     };
 
@@ -42,15 +50,16 @@ namespace merry_tools::math {
     struct Flat_simulation: public coordinate_system<Flat_simulation> { WB_STATIC_INSIDE_CLASS const char* name(){
                                                                                               return "flat-Earth"; }};
     /// @brief Geographical system, where gravity acts toward center of the earth, and 0 on Z axis is a "sea level"
-    struct Geographical:    public coordinate_system<Geographical>    { WB_STATIC_INSIDE_CLASS const char* name(){
+    /// @note Wide, as `float` latitude and longitude are only good to about half a meter.
+    struct Geographical:    public coordinate_system<Geographical,float_wide>    { WB_STATIC_INSIDE_CLASS const char* name(){
                                                                                               return "geographical"; }};
     /// @brief A space system with the Earth as the center of the coordinate system and
     ///        the equatorial plane as the XY plane.
-    struct Earth_centered:  public coordinate_system<Earth_centered>  { WB_STATIC_INSIDE_CLASS const char* name(){
+    struct Earth_centered:  public coordinate_system<Earth_centered,float_wide>  { WB_STATIC_INSIDE_CLASS const char* name(){
                                                                                               return "geo-centered"; }};
     /// @brief A space system A space system with the zero point at the center of mass of the Solar System and
     ///        the ecliptic plane as the X,Y plane
-    struct Solar:           public coordinate_system<Solar>           { WB_STATIC_INSIDE_CLASS const char* name(){
+    struct Solar:           public coordinate_system<Solar,float_wide>           { WB_STATIC_INSIDE_CLASS const char* name(){
                                                                                               return "solar-system"; }};
 
     // AXIS FOR BASIC FLAT SYSTEM:
@@ -60,7 +69,9 @@ namespace merry_tools::math {
     /// \tparam DERIVED -  derived class (see `time` below)
     /// \tparam SYSTEM - should be type derived from `coordinate_system` template.
     template<class DERIVED,class SYSTEM>
-    struct axis                                              { WB_STATIC_INSIDE_CLASS const char* name(){ return "?"; } };
+    struct axis                                              { WB_STATIC_INSIDE_CLASS const char* name(){ return "?"; }
+                                                               typedef SYSTEM system; //!< Where the axis belongs.
+    };
 
     /// @brief Time pseudo-axis --> https://en.wikipedia.org/wiki/Time_in_physics
     /// @note The smallest time step considered theoretically observable is called the Planck time,
@@ -83,62 +94,127 @@ namespace merry_tools::math {
     struct Upward:     public axis<Upward,Flat_simulation>    { WB_STATIC_INSIDE_CLASS const char* name(){ return "Z"; }
                                                                                                 } static is_upward;
 
+    // AXIS FOR OTHER SYSTEMS:
+    //*////////////////////////
+
+    /// @brief Geodetic latitude, positive to the north -> https://en.wikipedia.org/wiki/Geodetic_coordinates
+    struct Geo_latitude:  public axis<Geo_latitude,Geographical>  { WB_STATIC_INSIDE_CLASS const char* name(){ return "lat"; }
+                                                                                                } static is_geo_latitude;
+    /// @brief Longitude, positive to the east of Greenwich
+    struct Geo_longitude: public axis<Geo_longitude,Geographical> { WB_STATIC_INSIDE_CLASS const char* name(){ return "lon"; }
+                                                                                                } static is_geo_longitude;
+    /// @brief Height above the ellipsoid, along its normal
+    struct Geo_height:    public axis<Geo_height,Geographical>    { WB_STATIC_INSIDE_CLASS const char* name(){ return "h"; }
+                                                                                                } static is_geo_height;
+    /// @brief Towards the meridian of Greenwich on the equator -> https://en.wikipedia.org/wiki/Earth-centered,_Earth-fixed_coordinate_system
+    struct Earth_x:       public axis<Earth_x,Earth_centered>     { WB_STATIC_INSIDE_CLASS const char* name(){ return "Xe"; }
+                                                                                                } static is_earth_x;
+    /// @brief Towards 90 degrees east on the equator
+    struct Earth_y:       public axis<Earth_y,Earth_centered>     { WB_STATIC_INSIDE_CLASS const char* name(){ return "Ye"; }
+                                                                                                } static is_earth_y;
+    /// @brief Towards the North Pole
+    struct Earth_z:       public axis<Earth_z,Earth_centered>     { WB_STATIC_INSIDE_CLASS const char* name(){ return "Ze"; }
+                                                                                                } static is_earth_z;
+    /// @brief Towards the vernal equinox, in the ecliptic plane
+    struct Solar_x:       public axis<Solar_x,Solar>              { WB_STATIC_INSIDE_CLASS const char* name(){ return "Xs"; }
+                                                                                                } static is_solar_x;
+    /// @brief 90 degrees further along the ecliptic
+    struct Solar_y:       public axis<Solar_y,Solar>              { WB_STATIC_INSIDE_CLASS const char* name(){ return "Ys"; }
+                                                                                                } static is_solar_y;
+    /// @brief Towards the north pole of the ecliptic
+    struct Solar_z:       public axis<Solar_z,Solar>              { WB_STATIC_INSIDE_CLASS const char* name(){ return "Zs"; }
+                                                                                                } static is_solar_z;
+
     // TEMPLATE FOR ANY PHYSICAL UNITS:
     //*////////////////////////////////
 
     /// @brief Base class for any physical unit
     /// \tparam DERIVED
-    template<class DERIVED>
-    struct physical_unit { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[?]"; }};
+    /// \tparam LENGTH, MASS, TIME, TEMPERATURE - exponents of base dimensions, e.g. `1,0,-1,0` for velocity
+    template<class DERIVED,int LENGTH=0,int MASS=0,int TIME=0,int TEMPERATURE=0>
+    struct physical_unit { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[?]"; }
+                           WB_STATIC_INSIDE_CLASS int length=LENGTH;           //!< Exponent of length  [m]
+                           WB_STATIC_INSIDE_CLASS int mass=MASS;               //!< Exponent of mass    [kg]
+                           WB_STATIC_INSIDE_CLASS int time=TIME;               //!< Exponent of time    [s]
+                           WB_STATIC_INSIDE_CLASS int temperature=TEMPERATURE; //!< Exponent of temperature [K]
+    };
+
+    /// @brief SI quantity type for the given dimension exponents and storage. Known dimensions are specialised below
+    ///        the named SI quantities, the rest ends in `DerivedSI`, and dimensionless values are just `FLOAT`.
+    template<int LENGTH,int MASS,int TIME,int TEMPERATURE,class FLOAT=float_base>
+    struct si_quantity_for;
+
+    /// @brief Type of the product of quantities measured in `UNIT1` and `UNIT2`, stored as `FLOAT`.
+    template<class UNIT1,class UNIT2,class FLOAT=float_base>
+    using si_product_t=typename si_quantity_for<UNIT1::length+UNIT2::length,UNIT1::mass+UNIT2::mass,
+                                                UNIT1::time+UNIT2::time,UNIT1::temperature+UNIT2::temperature,
+                                                FLOAT>::type;
+
+    /// @brief Type of the quotient of quantities measured in `UNIT1` and `UNIT2`, stored as `FLOAT`.
+    template<class UNIT1,class UNIT2,class FLOAT=float_base>
+    using si_quotient_t=typename si_quantity_for<UNIT1::length-UNIT2::length,UNIT1::mass-UNIT2::mass,
+                                                 UNIT1::time-UNIT2::time,UNIT1::temperature-UNIT2::temperature,
+                                                 FLOAT>::type;
 
     // PHYSICAL SI UNITS:
     //*//////////////////
 
     /// @brief Base SI unit of time
-    struct SI_time_unit:public physical_unit<SI_time_unit> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[s]"; }};
+    struct SI_time_unit:public physical_unit<SI_time_unit,0,0,1,0> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[s]"; }};
 
     /// @brief Base SI unit of mass
-    struct SI_mass_unit:public physical_unit<SI_mass_unit> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[kg]"; }};
+    struct SI_mass_unit:public physical_unit<SI_mass_unit,0,1,0,0> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[kg]"; }};
 
     /// @brief Base SI unit of temperature
-    struct SI_temperature_unit:public physical_unit<SI_temperature_unit> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[K]"; }};
+    struct SI_temperature_unit:public physical_unit<SI_temperature_unit,0,0,0,1> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[K]"; }};
 
     /// @brief Base SI unit of length
-    struct SI_length_unit:public physical_unit<SI_length_unit> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[m]"; }};
+    struct SI_length_unit:public physical_unit<SI_length_unit,1,0,0,0> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[m]"; }};
+
+    /// @brief Plane angle, dimensionless in SI, but a unit of its own here, so angles are not mixed with numbers
+    struct SI_angle_unit:public physical_unit<SI_angle_unit,0,0,0,0> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[rad]"; }};
 
     /// @brief A unit derived from the SI system, e.g. speed
-    struct SI_velocity_unit:public physical_unit<SI_velocity_unit> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[m/s]"; }};
+    struct SI_velocity_unit:public physical_unit<SI_velocity_unit,1,0,-1,0> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[m/s]"; }};
 
     /// @brief A unit derived from the SI system, e.g. acceleration
-    struct SI_acceleration_unit:public physical_unit<SI_acceleration_unit> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[m/s^2]"; }};
+    struct SI_acceleration_unit:public physical_unit<SI_acceleration_unit,1,0,-2,0> { WB_STATIC_INSIDE_CLASS const char* abbreviation() { return "[m/s^2]"; }};
 
     // TEMPLATE FOR PHYSICAL QUANTITIES MEASURED IN ANY UNITS:
     //*///////////////////////////////////////////////////////
 
     /** @brief Base for any physical quantity measured in particular unit.
      *  \tparam DERIVED
-     *  \tparam UNIT  */
-    template<class DERIVED,class UNIT>
+     *  \tparam UNIT
+     *  \tparam FLOAT - storage type of the value */
+    template<class DERIVED,class UNIT,class FLOAT=float_base>
     struct Quantity {
         // STATIC INFOS:
         //*/////////////
-        WB_STATIC_INSIDE_CLASS  char* abbreviation() { return UNIT::abbreviation(); }
+        WB_STATIC_INSIDE_CLASS  const char* abbreviation() { return UNIT::abbreviation(); }
+
+        typedef UNIT  unit_type;  //!< Physical unit of the value.
+        typedef FLOAT value_type; //!< Storage type of the value.
 
         // SOLE VALUE:
         //*///////////
-        float_base value; //!< internal data keeps value, but type decide about unit and meaning
+        FLOAT value; //!< internal data keeps value, but type decide about unit and meaning
 
         // CONSTRUCTORS:
         //*/////////////
         constexpr Quantity(const Quantity&) = default;
 
-        constexpr Quantity(const float& iniVal):value{(float_base)iniVal}{}
+        constexpr Quantity(const float& iniVal):value{(FLOAT)iniVal}{}
+
+        constexpr Quantity(const double& iniVal):value{(FLOAT)iniVal}{}
 
-        constexpr Quantity(const double& iniVal):value{(float_base)iniVal}{}
+        constexpr Quantity(const long double& iniVal):value{(FLOAT)iniVal}       {/** @todo RANGE CHECK ASSERT? */}
 
-        constexpr Quantity(const long double& iniVal):value{(float_base)iniVal}       {/** @todo RANGE CHECK ASSERT? */}
+        constexpr Quantity(const unsigned long long& iniVal):value{(FLOAT)iniVal}{/** @todo RANGE CHECK ASSERT? */}
 
-        constexpr Quantity(const unsigned long long& iniVal):value{(float_base)iniVal}{/** @todo RANGE CHECK ASSERT? */}
+        /// @brief Explicit widening or narrowing from the same unit stored with another precision.
+        template<class DERIVED2,class FLOAT2,class=std::enable_if_t<!std::is_same_v<FLOAT,FLOAT2>>>
+        explicit constexpr Quantity(const Quantity<DERIVED2,UNIT,FLOAT2>& other):value{(FLOAT)other.value}{}
 
         // OPERATORS:
         //*//////////
@@ -153,31 +229,49 @@ namespace merry_tools::math {
         constexpr Quantity operator * (const double& m) const   { return Quantity{value * m };      }
 
         constexpr Quantity operator / (const double& d) const   { return Quantity{ value / d };     }
+
+        /// @brief Dimensions are added, e.g. `VelocitySI*TimeSI -> DistSI`. Resolved entirely at compile time.
+        ///        Mixed precision gives the wider one, e.g. `VelocitySI*TimeSI64 -> DistSI64`.
+        template<class DERIVED2,class UNIT2,class FLOAT2>
+        constexpr auto operator * (const Quantity<DERIVED2,UNIT2,FLOAT2>& a) const {
+            typedef std::common_type_t<FLOAT,FLOAT2> common;
+            return si_product_t<UNIT,UNIT2,common>{ common(value) * common(a.value) };
+        }
+
+        /// @brief Dimensions are subtracted, e.g. `DistSI/TimeSI -> VelocitySI`, `DistSI/DistSI -> float_base`.
+        template<class DERIVED2,class UNIT2,class FLOAT2>
+        constexpr auto operator / (const Quantity<DERIVED2,UNIT2,FLOAT2>& d) const {
+            typedef std::common_type_t<FLOAT,FLOAT2> common;
+            return si_quotient_t<UNIT,UNIT2,common>{ common(value) / common(d.value) };
+        }
     };
 
-/// @brief Macro which defines elements required for body of any class derived from `Quantity`
-#define WB_VEC_QUANTITY_BODY(THE0CLASS,UNIT)                                                 using  Quantity::Quantity; \
+/// @brief Macro which defines elements required for body of any class derived from `Quantity` with given storage
+#define WB_VEC_QUANTITY_BODY_T(THE0CLASS,UNIT,FLOAT)                                         using  Quantity::Quantity; \
                                                                                              using  Quantity::operator+;\
                                                                                              using  Quantity::operator-;\
                                                                                              using  Quantity::operator*;\
                                                                                              using  Quantity::operator/;\
                                                                                                                         \
-                                                         constexpr THE0CLASS(const Quantity<THE0CLASS,UNIT> & sc):      \
+                                                         constexpr THE0CLASS(const Quantity<THE0CLASS,UNIT,FLOAT> & sc):\
                                                                                                           Quantity{sc}{}\
                                                                                                                         \
                                                          constexpr auto operator - () { return THE0CLASS(-this->value);}\
                                                                                                                         \
                                                          constexpr friend inline THE0CLASS xD(                          \
-                                                                            const Quantity<THE0CLASS,UNIT> & sc){       \
+                                                                            const Quantity<THE0CLASS,UNIT,FLOAT> & sc){ \
                                                                             return THE0CLASS(sc.value);                 \
                                                                             }                                           \
                                                                                                                         \
                                                          constexpr friend inline THE0CLASS xD(                          \
-                                                                            const Quantity<THE0CLASS,UNIT> & sc1,       \
-                                                                            const Quantity<THE0CLASS,UNIT> & sc2 ){     \
+                                                                            const Quantity<THE0CLASS,UNIT,FLOAT> & sc1, \
+                                                                            const Quantity<THE0CLASS,UNIT,FLOAT> & sc2 ){\
                                                                             return THE0CLASS(sc1.value+sc2.value);      \
                                                                             }                                           \
 
+/// @brief Macro which defines elements required for body of any class derived from `Quantity`
+#define WB_VEC_QUANTITY_BODY(THE0CLASS,UNIT)      WB_VEC_QUANTITY_BODY_T(THE0CLASS,UNIT,float_base)
+
     // PHYSICAL QUANTITIES MEASURED IN SI UNITS:
     //*/////////////////////////////////////////
 
@@ -199,6 +293,133 @@ namespace merry_tools::math {
     /// @brief It is a quantity of acceleration measured in SI units
     struct AccelerationSI: public Quantity<AccelerationSI,SI_acceleration_unit> {WB_VEC_QUANTITY_BODY(AccelerationSI,SI_acceleration_unit)};
 
+    /// @brief It is a quantity of plane angle measured in radians
+    struct AngleSI:    public Quantity<AngleSI,SI_angle_unit>       {WB_VEC_QUANTITY_BODY(AngleSI,SI_angle_unit)};
+
+    // PHYSICAL QUANTITIES MEASURED IN SI UNITS WITH WIDE PRECISION:
+    //*/////////////////////////////////////////////////////////////
+    // Conversions from and to the default ones are explicit only, e.g. `DistSI64{dist}` or `DistSI{dist64}`.
+
+    /// @brief It is a quantity of time measured in SI units, stored as `float_wide`
+    struct TimeSI64:     public Quantity<TimeSI64,SI_time_unit,float_wide>         {WB_VEC_QUANTITY_BODY_T(TimeSI64,SI_time_unit,float_wide)};
+
+    /// @brief It is a quantity of mass measured in SI units, stored as `float_wide`
+    struct MassSI64:     public Quantity<MassSI64,SI_mass_unit,float_wide>         {WB_VEC_QUANTITY_BODY_T(MassSI64,SI_mass_unit,float_wide)};
+
+    /// @brief It is a quantity of temperature measured in SI units, stored as `float_wide`
+    struct TempSI64:     public Quantity<TempSI64,SI_temperature_unit,float_wide>  {WB_VEC_QUANTITY_BODY_T(TempSI64,SI_temperature_unit,float_wide)};
+
+    /// @brief It is a quantity of length measured in SI units, stored as `float_wide`
+    struct DistSI64:     public Quantity<DistSI64,SI_length_unit,float_wide>       {WB_VEC_QUANTITY_BODY_T(DistSI64,SI_length_unit,float_wide)};
+
+    /// @brief It is a quantity of speed measured in SI units, stored as `float_wide`
+    struct VelocitySI64: public Quantity<VelocitySI64,SI_velocity_unit,float_wide> {WB_VEC_QUANTITY_BODY_T(VelocitySI64,SI_velocity_unit,float_wide)};
+
+    /// @brief It is a quantity of acceleration measured in SI units, stored as `float_wide`
+    struct AccelerationSI64: public Quantity<AccelerationSI64,SI_acceleration_unit,float_wide> {WB_VEC_QUANTITY_BODY_T(AccelerationSI64,SI_acceleration_unit,float_wide)};
+
+    /// @brief It is a quantity of plane angle measured in radians, stored as `float_wide`
+    struct AngleSI64:    public Quantity<AngleSI64,SI_angle_unit,float_wide>       {WB_VEC_QUANTITY_BODY_T(AngleSI64,SI_angle_unit,float_wide)};
+
+    // DIMENSIONAL ANALYSIS OF SI QUANTITIES:
+    //*//////////////////////////////////////
+
+    namespace detail {
+        /// @brief Compile-time text of a derived SI unit, e.g. "[m^2*kg/s^2]" or "[kg*m^-1*s^-2]".
+        template<int LENGTH,int MASS,int TIME,int TEMPERATURE>
+        struct derived_unit_text {
+            char text[48]{};
+
+            constexpr derived_unit_text() {
+                const int         exps[4]={LENGTH,MASS,TIME,TEMPERATURE};
+                const char* const syms[4]={"m","kg","s","K"};
+                int negatives=0;
+                for(int e:exps) if(e<0) negatives++;
+
+                std::size_t pos=0;
+                text[pos++]='[';
+                bool first=true;
+                for(int i=0;i<4;i++) if(exps[i]>0) {                       // Positive exponents first.
+                    if(!first) text[pos++]='*';
+                    append(pos,syms[i],exps[i]);
+                    first=false;
+                }
+                for(int i=0;i<4;i++) if(exps[i]<0) {
+                    if(negatives==1) {                                      // Single one goes into the denominator.
+                        if(first) text[pos++]='1';
+                        text[pos++]='/';
+                        append(pos,syms[i],-exps[i]);
+                    } else {                                                // Many are written with negative exponents.
+                        if(!first) text[pos++]='*';
+                        append(pos,syms[i],exps[i]);
+                    }
+                    first=false;
+                }
+                text[pos++]=']';
+            }
+
+            constexpr void append(std::size_t& pos,const char* sym,int exp) {
+                while(*sym) text[pos++]=*sym++;
+                if(exp==1) return;
+                text[pos++]='^';
+                if(exp<0) { text[pos++]='-'; exp=-exp; }
+                if(exp>=10) text[pos++]=char('0'+exp/10);
+                text[pos++]=char('0'+exp%10);
+            }
+        };
+    }
+
+    /// @brief Unit for any combination of SI base dimensions without its own name.
+    template<int LENGTH,int MASS,int TIME,int TEMPERATURE>
+    struct SI_derived_unit:public physical_unit<SI_derived_unit<LENGTH,MASS,TIME,TEMPERATURE>,LENGTH,MASS,TIME,TEMPERATURE> {
+        WB_STATIC_INSIDE_CLASS detail::derived_unit_text<LENGTH,MASS,TIME,TEMPERATURE> text{};
+        WB_STATIC_INSIDE_CLASS const char* abbreviation() { return text.text; }
+    };
+
+    /// @brief Quantity measured in a derived SI unit without its own name, e.g. area `[m^2]` or force `[m*kg/s^2]`.
+    template<int LENGTH,int MASS,int TIME,int TEMPERATURE,class FLOAT=float_base>
+    struct DerivedSI: public Quantity<DerivedSI<LENGTH,MASS,TIME,TEMPERATURE,FLOAT>,SI_derived_unit<LENGTH,MASS,TIME,TEMPERATURE>,FLOAT> {
+        typedef Quantity<DerivedSI,SI_derived_unit<LENGTH,MASS,TIME,TEMPERATURE>,FLOAT> base_quantity;
+        using  base_quantity::base_quantity;
+        using  base_quantity::operator+;
+        using  base_quantity::operator-;
+        using  base_quantity::operator*;
+        using  base_quantity::operator/;
+
+        constexpr DerivedSI(const base_quantity& sc):base_quantity{sc}{}
+
+        constexpr auto operator - () const { return DerivedSI(-this->value); }
+    };
+
+    /// @brief Any not named combination of dimensions.
+    template<int LENGTH,int MASS,int TIME,int TEMPERATURE,class FLOAT>
+    struct si_quantity_for { typedef DerivedSI<LENGTH,MASS,TIME,TEMPERATURE,FLOAT> type; };
+
+    /// @brief Dimensionless result, e.g. `DistSI/DistSI`, is a plain number.
+    template<class FLOAT>
+    struct si_quantity_for<0,0,0,0,FLOAT>                 { typedef FLOAT            type; };
+    template<> struct si_quantity_for<0,0,1,0,float_base> { typedef TimeSI           type; };
+    template<> struct si_quantity_for<0,1,0,0,float_base> { typedef MassSI           type; };
+    template<> struct si_quantity_for<0,0,0,1,float_base> { typedef TempSI           type; };
+    template<> struct si_quantity_for<1,0,0,0,float_base> { typedef DistSI           type; };
+    template<> struct si_quantity_for<1,0,-1,0,float_base>{ typedef VelocitySI       type; };
+    template<> struct si_quantity_for<1,0,-2,0,float_base>{ typedef AccelerationSI   type; };
+    template<> struct si_quantity_for<0,0,1,0,float_wide> { typedef TimeSI64         type; };
+    template<> struct si_quantity_for<0,1,0,0,float_wide> { typedef MassSI64         type; };
+    template<> struct si_quantity_for<0,0,0,1,float_wide> { typedef TempSI64         type; };
+    template<> struct si_quantity_for<1,0,0,0,float_wide> { typedef DistSI64         type; };
+    template<> struct si_quantity_for<1,0,-1,0,float_wide>{ typedef VelocitySI64     type; };
+    template<> struct si_quantity_for<1,0,-2,0,float_wide>{ typedef AccelerationSI64 type; };
+
+    /// @brief The same quantity stored with another precision, e.g. `DistSI64` for `DistSI`.
+    template<class QUANTITY,class FLOAT>
+    using with_precision_t=typename si_quantity_for<QUANTITY::unit_type::length,QUANTITY::unit_type::mass,
+                                                    QUANTITY::unit_type::time,QUANTITY::unit_type::temperature,
+                                                    FLOAT>::type;
+
+    /// @brief Area in [m^2], e.g. `DistSI*DistSI`.
+    typedef si_quantity_for<2,0,0,0>::type AreaSI;
+
     /// @brief Creates time in [s]
     WB_GLOBAL_OUTSIDE_CLASS auto operator "" _s    (long double val) { return TimeSI{val}; }
 
@@ -217,6 +438,9 @@ namespace merry_tools::math {
     /// @brief Creates acceleration in [m/s^2]
     WB_GLOBAL_OUTSIDE_CLASS auto operator "" _m_s2 (long double val) { return AccelerationSI{val}; }
 
+    /// @brief Creates plane angle in [rad]
+    WB_GLOBAL_OUTSIDE_CLASS auto operator "" _rad  (long double val) { return AngleSI{val}; }
+
     /// @brief Creates time in WHOLE [s]
     WB_GLOBAL_OUTSIDE_CLASS auto operator "" _s    (unsigned long long val) { return TimeSI{val}; }
 
@@ -245,9 +469,11 @@ namespace merry_tools::math {
     struct Scalar {
         // STATIC INFOS:
         //*/////////////
-        WB_STATIC_INSIDE_CLASS  char* unit_abr() { return QUANTITY::abbreviation(); }
+        WB_STATIC_INSIDE_CLASS  const char* unit_abr() { return QUANTITY::abbreviation(); }
+
+        WB_STATIC_INSIDE_CLASS  const char* axis_abr() { return AXIS::name(); }
 
-        WB_STATIC_INSIDE_CLASS  char* axis_abr() { return AXIS::name(); }
+        typedef typename QUANTITY::value_type value_type; //!< Storage type, chosen by the quantity.
 
         // SOLE VALUE:
         //*///////////
@@ -259,6 +485,12 @@ namespace merry_tools::math {
 
         constexpr Scalar(const QUANTITY& initVal):val(initVal){}
 
+        /// @brief Explicit widening or narrowing from the same axis and unit stored with another precision.
+        template<class QUANTITY2,class=std::enable_if_t<
+                    std::is_same_v<typename QUANTITY2::unit_type,typename QUANTITY::unit_type> &&
+                    !std::is_same_v<typename QUANTITY2::value_type,value_type>>>
+        explicit constexpr Scalar(const Scalar<AXIS,QUANTITY2>& other):val(QUANTITY{(value_type)other.val.value}){}
+
         // OPERATORS:
         //*//////////
         constexpr Scalar operator + () { return *this;}
@@ -270,6 +502,22 @@ namespace merry_tools::math {
         constexpr Scalar operator * (const double& m) const { return Scalar{val * m };}
 
         constexpr Scalar operator / (const double& d) const { return Scalar{val / d };}
+
+        /// @brief Multiplication by a quantity keeps the axis, e.g. `VelAlong*TimeSI -> Scalar<Along,DistSI>`.
+        template<class DERIVED2,class UNIT2,class FLOAT2>
+        constexpr auto operator * (const Quantity<DERIVED2,UNIT2,FLOAT2>& q) const {
+            typedef decltype(val*q) result;
+            static_assert(!std::is_arithmetic_v<result>,"Dimensionless value can't lay on the axis!");
+            return Scalar<AXIS,result>{val*q};
+        }
+
+        /// @brief Division by a quantity keeps the axis, e.g. `Longitude/TimeSI -> Scalar<Along,VelocitySI>`.
+        template<class DERIVED2,class UNIT2,class FLOAT2>
+        constexpr auto operator / (const Quantity<DERIVED2,UNIT2,FLOAT2>& q) const {
+            typedef decltype(val/q) result;
+            static_assert(!std::is_arithmetic_v<result>,"Dimensionless value can't lay on the axis!");
+            return Scalar<AXIS,result>{val/q};
+        }
     };
 
     // /// @brief ???
@@ -410,11 +658,13 @@ namespace merry_tools::math {
     struct Vec2D {
         // STATIC INFOS:
         //*/////////////
-        WB_STATIC_INSIDE_CLASS  char* unit_abr() { return QUANTITY::abbreviation(); }
+        WB_STATIC_INSIDE_CLASS  const char* unit_abr() { return QUANTITY::abbreviation(); }
+
+        WB_STATIC_INSIDE_CLASS  const char* axisX_abr() { return AXIS1::name(); }
 
-        WB_STATIC_INSIDE_CLASS  char* axisX_abr() { return AXIS1::name(); }
+        WB_STATIC_INSIDE_CLASS  const char* axisY_abr() { return AXIS2::name(); }
 
-        WB_STATIC_INSIDE_CLASS  char* axisY_abr() { return AXIS2::name(); }
+        typedef typename QUANTITY::value_type value_type; //!< Storage type, chosen by the quantity.
 
         // VALUES:
         //*///////
@@ -427,6 +677,12 @@ namespace merry_tools::math {
 
         constexpr Vec2D(const Scalar<AXIS1,QUANTITY>& iniX,const Scalar<AXIS2,QUANTITY>& iniY):x(iniX),y(iniY){}
 
+        /// @brief Explicit widening or narrowing from the same axes and unit stored with another precision.
+        template<class QUANTITY2,class=std::enable_if_t<
+                    std::is_same_v<typename QUANTITY2::unit_type,typename QUANTITY::unit_type> &&
+                    !std::is_same_v<typename QUANTITY2::value_type,value_type>>>
+        explicit constexpr Vec2D(const Vec2D<AXIS1,AXIS2,QUANTITY2>& other):x(other.x),y(other.y){}
+
         // OPERATORS:
         //*//////////
         constexpr Vec2D operator + () { return *this;}
@@ -506,13 +762,15 @@ namespace merry_tools::math {
     struct Vec3D {
         // STATIC INFOS:
         //*/////////////
-        WB_STATIC_INSIDE_CLASS  char* unit_abr() { return QUANTITY::abbreviation(); }
+        WB_STATIC_INSIDE_CLASS  const char* unit_abr() { return QUANTITY::abbreviation(); }
+
+        WB_STATIC_INSIDE_CLASS  const char* axisX_abr() { return AXIS1::name(); }
 
-        WB_STATIC_INSIDE_CLASS  char* axisX_abr() { return AXIS1::name(); }
+        WB_STATIC_INSIDE_CLASS  const char* axisY_abr() { return AXIS2::name(); }
 
-        WB_STATIC_INSIDE_CLASS  char* axisY_abr() { return AXIS2::name(); }
+        WB_STATIC_INSIDE_CLASS  const char* axisZ_abr() { return AXIS3::name(); }
 
-        WB_STATIC_INSIDE_CLASS  char* axisZ_abr() { return AXIS3::name(); }
+        typedef typename QUANTITY::value_type value_type; //!< Storage type, chosen by the quantity.
 
         // VALUES:
         //*///////
@@ -528,6 +786,12 @@ namespace merry_tools::math {
 
         constexpr Vec3D(const Vec3D&) = default;
 
+        /// @brief Explicit widening or narrowing from the same axes and unit stored with another precision.
+        template<class QUANTITY2,class=std::enable_if_t<
+                    std::is_same_v<typename QUANTITY2::unit_type,typename QUANTITY::unit_type> &&
+                    !std::is_same_v<typename QUANTITY2::value_type,value_type>>>
+        explicit constexpr Vec3D(const Vec3D<AXIS1,AXIS2,AXIS3,QUANTITY2>& other):x(other.x),y(other.y),z(other.z){}
+
         // OPERATORS:
         //*//////////
         constexpr Vec3D operator + () { return *this;}
@@ -622,6 +886,81 @@ namespace merry_tools::math {
     constexpr inline VolumeAcceleration xD(const Vec2D<Along,Across,AccelerationSI>& iniPV,
                                            const Scalar<Upward,AccelerationSI>& iniZ) { return {iniPV.x,iniPV.y,iniZ}; }
 
+    /** @brief 3D position for `Flat_simulation` stored as `float_wide`, for big scenes.
+     *  @details Converts explicitly from/to `VolumePosition`. It may be advanced by the ordinary `VolumeVelocity`.
+     */
+    struct VolumePosition64: public Vec3D<Along,Across,Upward,DistSI64> {WB_VEC_VEC3D_BODY(VolumePosition64, Along, Across, Upward, DistSI64)};
+
+    /// @brief Function which makes 3D wide position from 3 scalars.
+    constexpr inline VolumePosition64 xD(const Scalar<Along,DistSI64>& iniX,
+                                         const Scalar<Across,DistSI64>& iniY,
+                                         const Scalar<Upward,DistSI64>& iniZ) { return {iniX,iniY,iniZ}; }
+
+    // POSITIONS FOR OTHER COORDINATE SYSTEMS MEASURED IN SI UNITS:
+    //*////////////////////////////////////////////////////////////
+    // Transforms between systems are in `mth_geodesy.h`.
+
+    /// @brief Geodetic latitude in radians
+    struct GeoLatitude:public Scalar<Geo_latitude,AngleSI64> {WB_VEC_SCALAR_BODY(GeoLatitude,Geo_latitude,AngleSI64)};
+
+    /// @brief Longitude in radians
+    struct GeoLongitude:public Scalar<Geo_longitude,AngleSI64> {WB_VEC_SCALAR_BODY(GeoLongitude,Geo_longitude,AngleSI64)};
+
+    /// @brief Height above the ellipsoid
+    struct GeoHeight:public Scalar<Geo_height,DistSI64> {WB_VEC_SCALAR_BODY(GeoHeight,Geo_height,DistSI64)};
+
+    /// @brief Geodetic position. Not a `Vec3D`, as its components are measured in different units.
+    struct GeoPosition {
+        GeoLatitude  lat;
+        GeoLongitude lon;
+        GeoHeight    height;
+    };
+
+    /// @brief Function which makes geodetic position from 3 scalars.
+    constexpr inline GeoPosition xD(const Scalar<Geo_latitude,AngleSI64>& lat,
+                                    const Scalar<Geo_longitude,AngleSI64>& lon,
+                                    const Scalar<Geo_height,DistSI64>& height) { return {lat,lon,height}; }
+
+    /// @brief Position in `Earth_centered` axes (ECEF)
+    struct EarthPosition: public Vec3D<Earth_x,Earth_y,Earth_z,DistSI64> {WB_VEC_VEC3D_BODY(EarthPosition,Earth_x,Earth_y,Earth_z,DistSI64)};
+
+    /// @brief Function which makes `Earth_centered` position from 3 scalars.
+    constexpr inline EarthPosition xD(const Scalar<Earth_x,DistSI64>& iniX,
+                                      const Scalar<Earth_y,DistSI64>& iniY,
+                                      const Scalar<Earth_z,DistSI64>& iniZ) { return {iniX,iniY,iniZ}; }
+
+    /// @brief Position in `Solar` axes
+    struct SolarPosition: public Vec3D<Solar_x,Solar_y,Solar_z,DistSI64> {WB_VEC_VEC3D_BODY(SolarPosition,Solar_x,Solar_y,Solar_z,DistSI64)};
+
+    /// @brief Function which makes `Solar` position from 3 scalars.
+    constexpr inline SolarPosition xD(const Scalar<Solar_x,DistSI64>& iniX,
+                                      const Scalar<Solar_y,DistSI64>& iniY,
+                                      const Scalar<Solar_z,DistSI64>& iniZ) { return {iniX,iniY,iniZ}; }
+
+    /// @brief Position in `Earth_centered` axes stored as `float_base`, e.g. offset from a region of `AnchoredArray`.
+    struct EarthOffset: public Vec3D<Earth_x,Earth_y,Earth_z,DistSI> {WB_VEC_VEC3D_BODY(EarthOffset,Earth_x,Earth_y,Earth_z,DistSI)};
+
+    /// @brief Function which makes `Earth_centered` offset from 3 scalars.
+    constexpr inline EarthOffset xD(const Scalar<Earth_x,DistSI>& iniX,
+                                    const Scalar<Earth_y,DistSI>& iniY,
+                                    const Scalar<Earth_z,DistSI>& iniZ) { return {iniX,iniY,iniZ}; }
+
+    /// @brief Position in `Solar` axes stored as `float_base`, e.g. offset from a region of `AnchoredArray`.
+    struct SolarOffset: public Vec3D<Solar_x,Solar_y,Solar_z,DistSI> {WB_VEC_VEC3D_BODY(SolarOffset,Solar_x,Solar_y,Solar_z,DistSI)};
+
+    /// @brief Function which makes `Solar` offset from 3 scalars.
+    constexpr inline SolarOffset xD(const Scalar<Solar_x,DistSI>& iniX,
+                                    const Scalar<Solar_y,DistSI>& iniY,
+                                    const Scalar<Solar_z,DistSI>& iniZ) { return {iniX,iniY,iniZ}; }
+
+    namespace expr {
+        /// @brief Common base of nodes of lazy expressions, defined in `mth_vec_expr.h`. They have their own operators.
+        struct node_tag {};
+
+        template<class... T>
+        WB_GLOBAL_OUTSIDE_CLASS bool none_is_node_v=(!std::is_base_of_v<node_tag,T> && ...);
+    }
+
     //template<class ADDEND> // NON-EXPECTED RECURRENCE HERE!!!
     //constexpr inline auto operator + ( const ADDEND& a1,const ADDEND& a2){ return xD(a1+a2); }
 
@@ -630,18 +969,18 @@ namespace merry_tools::math {
      *  \tparam ADDEND2
      *  \param a1
      *  \param a2
-     *  \return ??? */
-    template<class ADDEND1,class ADDEND2>
-    constexpr inline auto operator + ( const ADDEND1& a1,const ADDEND2& a2){ return xD(a1,a2); }
+     *  \return whatever `xD(a1,a2)` returns. Other operands are left to other overloads (see `mth_vec_expr.h`). */
+    template<class ADDEND1,class ADDEND2,class=std::enable_if_t<expr::none_is_node_v<ADDEND1,ADDEND2>>>
+    constexpr inline auto operator + ( const ADDEND1& a1,const ADDEND2& a2) -> decltype(xD(a1,a2)) { return xD(a1,a2); }
 
     /** @brief General `operator -` for objects accepted by any of `xD()` functions, which are possessing `unary -`.
      *  \tparam ADDEND1
      *  \tparam ADDEND2
      *  \param a1
      *  \param a2
-     *  \return ??? */
-    template<class ADDEND1,class ADDEND2>
-    constexpr inline auto operator - ( const ADDEND1& a1,const ADDEND2& a2){ return xD(a1,-a2); }
+     *  \return whatever `xD(a1,-a2)` returns. Other operands are left to other overloads (see `mth_vec_expr.h`). */
+    template<class ADDEND1,class ADDEND2,class=std::enable_if_t<expr::none_is_node_v<ADDEND1,ADDEND2>>>
+    constexpr inline auto operator - ( const ADDEND1& a1,const ADDEND2& a2) -> decltype(xD(a1,-a2)) { return xD(a1,-a2); }
 }
 
 
@@ -0,0 +1,123 @@
+/// @date 2026-10-16 (last modification)
+/// Work-stealing `task_pool` of `flw_tasks.h`.
+/// Deques are guarded by mutexes: tasks are chunks of work, so a lock per task costs nothing measurable,
+/// while idle workers sleep on a condition variable instead of spinning.
+///
+#include "flw_tasks.h"
+
+namespace merry_tools::flow {
+
+    namespace {
+        thread_local const task_pool* current_pool=nullptr;   // The pool the calling thread works for, if any.
+        thread_local std::size_t      current_queue=0;
+        thread_local std::size_t      steal_from=0;           // Rotates, so thieves don't all start at one queue.
+
+        constexpr int spins_before_sleep=64;
+    }
+
+    task_pool::task_pool(unsigned threads) {
+        if(threads==0) threads=default_concurrency();
+        for(unsigned q=0;q<threads;q++) queues.push_back(std::make_unique<queue>());
+        workers.reserve(threads-1);
+        for(unsigned w=1;w<threads;w++) workers.emplace_back([this,w] { work(w); });
+    }
+
+    task_pool::~task_pool() {
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            stopping=true;
+        }
+        wake.notify_all();
+        for(auto& w:workers) w.join();
+    }
+
+    task_pool& task_pool::global() {
+        static task_pool pool;
+        return pool;
+    }
+
+    std::size_t task_pool::home() const { return current_pool==this?current_queue:0; }
+
+    void task_pool::submit(const task& t) {
+        t.counter->pending.fetch_add(1,std::memory_order_relaxed);
+        {
+            queue& q=*queues[home()];
+            std::lock_guard<std::mutex> guard(q.lock);
+            q.tasks.push_back(t);
+        }
+        queued.fetch_add(1,std::memory_order_release);
+        { std::lock_guard<std::mutex> guard(sleep_lock); }            // No worker misses it between check and wait.
+        wake.notify_one();
+    }
+
+    bool task_pool::pop(task& t) {
+        if(queued.load(std::memory_order_acquire)==0) return false;
+        const std::size_t own=home();
+        {
+            queue& q=*queues[own];
+            std::lock_guard<std::mutex> guard(q.lock);
+            if(!q.tasks.empty()) {
+                t=q.tasks.back(); q.tasks.pop_back();
+                queued.fetch_sub(1,std::memory_order_relaxed);
+                return true;
+            }
+        }
+        const std::size_t n=queues.size();
+        const std::size_t first=steal_from++;
+        for(std::size_t k=0;k<n;k++) {
+            const std::size_t victim=(first+k)%n;
+            if(victim==own) continue;
+            queue& q=*queues[victim];
+            std::lock_guard<std::mutex> guard(q.lock);
+            if(!q.tasks.empty()) {                                       // The oldest task is the biggest.
+                t=q.tasks.front(); q.tasks.pop_front();
+                queued.fetch_sub(1,std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void task_pool::execute(const task& t) {
+        task_counter& counter=*t.counter;
+        try {
+            t.call(t.ctx,t.begin,t.end);
+        } catch(...) {
+            std::lock_guard<std::mutex> guard(counter.lock);
+            if(!counter.error) counter.error=std::current_exception();
+        }
+        counter.pending.fetch_sub(1,std::memory_order_acq_rel);       // The last access, the waiter may go on.
+    }
+
+    void task_pool::wait(task_counter& counter) {
+        task t;
+        while(!counter.done()) {
+            if(pop(t)) execute(t);
+            else std::this_thread::yield();
+        }
+        if(counter.error) {
+            std::exception_ptr error=counter.error;
+            counter.error=nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    void task_pool::work(std::size_t index) {
+        current_pool=this;
+        current_queue=index;
+        steal_from=index+1;
+        task t;
+        for(;;) {
+            bool found=false;
+            for(int s=0;s<spins_before_sleep && !found;s++) {
+                found=pop(t);
+                if(!found) std::this_thread::yield();
+            }
+            if(found) { execute(t); continue; }
+
+            std::unique_lock<std::mutex> guard(sleep_lock);
+            wake.wait(guard,[this] { return stopping || queued.load(std::memory_order_acquire)>0; });
+            if(stopping && queued.load(std::memory_order_acquire)==0) return;
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/// @date 2026-10-16 (last modification)
+/// Table writing of `ios_format.h`.
+/// Rows are formatted in blocks, a batch of blocks at once on all cores, into buffers reused by every batch.
+/// Blocks of a batch are written in order, so the file is the same for any number of threads.
+///
+#include "ios_format.h"
+#include "flw_parallel.h"
+
+#include <stdexcept>
+
+namespace merry_tools::iostreams {
+
+    namespace {
+        constexpr std::size_t rows_per_block=4096;
+    }
+
+    void table_writer::add(const source& s) {
+        if(!sources.empty() && s.count!=sources.front().count)         // All columns must have the same size!
+            throw std::invalid_argument("Column '"+s.name+"' has "+std::to_string(s.count)+" rows, the table "
+                                        +std::to_string(sources.front().count));
+        sources.push_back(s);
+    }
+
+    void table_writer::write(unsigned threads) {
+        std::string header;
+        std::size_t width=0;
+        for(const source& s:sources)
+            for(std::size_t k=0;k<s.components;k++,width++) {
+                if(width>0) header+=separator;
+                if(!s.name.empty()) { header+=s.name; if(*s.labels[k]!='[') header+='.'; }   // Not for quantities.
+                header+=s.labels[k];
+            }
+        header+='\n';
+        out.write(header.data(),std::streamsize(header.size()));
+        if(width==0) return;
+
+        const std::size_t n=rows();
+        const std::size_t blocks=(n+rows_per_block-1)/rows_per_block;
+        const std::size_t batch=std::max<std::size_t>(2,threads!=0?threads:flow::task_pool::global().concurrency());
+        std::vector<std::vector<char>> texts(std::min(batch,blocks));
+        std::vector<std::size_t>       lengths(texts.size());
+        for(std::size_t first=0;first<blocks;first+=batch) {
+            const std::size_t count=std::min(batch,blocks-first);
+            flow::parallel_for(count,1,[&](std::size_t b,std::size_t e) {
+                for(std::size_t k=b;k<e;k++) {
+                    const std::size_t lo=(first+k)*rows_per_block,hi=std::min(n,lo+rows_per_block);
+                    std::vector<char>& text=texts[k];
+                    text.resize(rows_per_block*width*(max_number_chars+1));
+                    char* p=text.data();
+                    for(std::size_t row=lo;row<hi;row++) {
+                        for(const source& s:sources)
+                            for(std::size_t c=0;c<s.components;c++) {
+                                p=s.put(s.data[c],row,p);
+                                *p++=separator;
+                            }
+                        p[-1]='\n';
+                    }
+                    lengths[k]=std::size_t(p-text.data());
+                }
+            },threads);
+            for(std::size_t k=0;k<count;k++) out.write(texts[k].data(),std::streamsize(lengths[k]));
+        }
+    }
+}
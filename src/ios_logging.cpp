@@ -0,0 +1,188 @@
+/// @date 2026-10-16 (last modification)
+/// Rings and the drain thread of `ios_logging.h`.
+/// A thread finds its rings through a `thread_local` table of 16 entries, direct mapped by ids of sinks, and
+/// takes the lock only the first time it logs to a sink. Ids are never reused and consecutive ids never evict
+/// each other, so a thread logging to a few sinks in turn stays without locks.
+///
+#include "ios_logging.h"
+
+#include <chrono>
+#include <cstring>
+
+#if __has_include(<unistd.h>)
+#   include <unistd.h>
+#   define WB_LOGGING_ISATTY(fd) (::isatty(fd)!=0)
+#else
+#   define WB_LOGGING_ISATTY(fd) false
+#endif
+
+namespace merry_tools::iostreams {
+
+    namespace {
+        std::atomic<std::uint64_t> sinks{0};
+
+        constexpr std::size_t length_bytes=sizeof(std::uint32_t);
+
+        /// @brief Removes ANSI sequences `ESC [ ... letter` in place.
+        void strip_colors(std::string& text) {
+            std::size_t out=0;
+            for(std::size_t i=0;i<text.size();) {
+                if(text[i]=='\033' && i+1<text.size() && text[i+1]=='[') {
+                    i+=2;
+                    while(i<text.size() && !(text[i]>='@' && text[i]<='~')) i++;
+                    i++;
+                } else {
+                    text[out++]=text[i++];
+                }
+            }
+            text.resize(out);
+        }
+
+        bool on_terminal(const std::ios_base* stream) {
+            if(stream==&std::cout) return WB_LOGGING_ISATTY(1);
+            if(stream==&std::cerr || stream==&std::clog) return WB_LOGGING_ISATTY(2);
+            return false;
+        }
+    }
+
+    log_sink::ring::ring(std::size_t bytes):owner(std::this_thread::get_id()) {
+        std::size_t size=64;
+        while(size<bytes) size*=2;
+        buffer.reset(new char[size]);
+        mask=size-1;
+    }
+
+    log_sink::log_sink(const log_options& options):options(options),id(++sinks) {}
+
+    log_sink::log_sink(std::ostream& stream,const log_options& options):log_sink(options) { set(stream); }
+
+    log_sink::~log_sink() {
+        if(!running.load()) return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping=true;
+        }
+        wake.notify_one();
+        drain.join();
+    }
+
+    void log_sink::set(std::ios_base& stream) {
+        if(is_set()) return;
+        ios_bender::set(stream);
+        with_colors=options.colors==log_colors::keep ||
+                    (options.colors==log_colors::automatic && on_terminal(the_stream));
+        drain=std::thread([this] { run(); });
+        running.store(true);
+    }
+
+    log_sink::ring& log_sink::local() {
+        struct known_ring {
+            std::uint64_t id=0;
+            ring*         mine=nullptr;
+        };
+        thread_local known_ring known[16];
+        known_ring& k=known[id%16];
+        if(k.id==id) return *k.mine;
+
+        const std::thread::id me=std::this_thread::get_id();
+        std::lock_guard<std::mutex> guard(lock);
+        ring* mine=nullptr;
+        for(const auto& r:rings)
+            if(r->owner==me) mine=r.get();      // Also a ring of a finished thread with the same id.
+        if(mine==nullptr) {
+            rings.push_back(std::make_unique<ring>(options.ring_bytes));
+            mine=rings.back().get();
+        }
+        k.id=id;
+        k.mine=mine;
+        return *mine;
+    }
+
+    bool log_sink::log(std::string_view text) {
+        ring& r=local();
+        const std::size_t capacity=r.mask+1;
+        const std::size_t n=std::min(text.size(),capacity-length_bytes);
+        const std::size_t need=length_bytes+n;
+        const std::size_t head=r.head.load(std::memory_order_relaxed);
+        std::size_t used=head-r.tail.load(std::memory_order_acquire);
+        while(capacity-used<need) {
+            if(options.overflow==log_overflow::drop || !running.load(std::memory_order_relaxed)) {
+                lost.fetch_add(1,std::memory_order_relaxed);
+                return false;
+            }
+            if(!hurry.exchange(true)) wake.notify_one();
+            std::this_thread::yield();
+            used=head-r.tail.load(std::memory_order_acquire);
+        }
+
+        const std::uint32_t length=static_cast<std::uint32_t>(n);
+        char bytes[length_bytes];
+        std::memcpy(bytes,&length,length_bytes);
+        auto put=[&r](std::size_t at,const char* from,std::size_t count) {
+            const std::size_t pos=at&r.mask,first=std::min(count,r.mask+1-pos);
+            std::memcpy(r.buffer.get()+pos,from,first);
+            std::memcpy(r.buffer.get(),from+first,count-first);
+        };
+        put(head,bytes,length_bytes);
+        put(head+length_bytes,text.data(),n);
+        r.head.store(head+need,std::memory_order_release);
+
+        if(used+need>capacity/2 && !hurry.load(std::memory_order_relaxed) && !hurry.exchange(true))
+            wake.notify_one();
+        return true;
+    }
+
+    void log_sink::flush() {
+        if(!running.load()) return;
+        std::unique_lock<std::mutex> guard(lock);
+        const std::uint64_t ticket=++requested;
+        wake.notify_one();
+        drained.wait(guard,[&] { return done>=ticket; });
+    }
+
+    void log_sink::run() {
+        std::ostream& out=*dynamic_cast<std::ostream*>(the_stream);   // Nobody logs into an INPUT stream.
+        std::string        batch;
+        std::vector<ring*> all;
+        std::unique_lock<std::mutex> guard(lock);
+        for(;;) {
+            wake.wait_for(guard,std::chrono::milliseconds(options.drain_ms),
+                          [&] { return stopping || requested>done || hurry.load(); });
+            const bool          stop=stopping;
+            const std::uint64_t ticket=requested;
+            all.clear();
+            for(const auto& r:rings) all.push_back(r.get());
+            guard.unlock();
+
+            hurry.store(false);
+            for(ring* r:all) {
+                const std::size_t head=r->head.load(std::memory_order_acquire);
+                std::size_t tail=r->tail.load(std::memory_order_relaxed);
+                auto get=[r,&batch](std::size_t at,std::size_t count) {
+                    const std::size_t pos=at&r->mask,first=std::min(count,r->mask+1-pos);
+                    batch.append(r->buffer.get()+pos,first);
+                    batch.append(r->buffer.get(),count-first);
+                };
+                while(tail!=head) {
+                    const std::size_t at=batch.size();
+                    get(tail,length_bytes);
+                    std::uint32_t length;
+                    std::memcpy(&length,batch.data()+at,length_bytes);
+                    batch.resize(at);
+                    get(tail+length_bytes,length);
+                    tail+=length_bytes+length;
+                }
+                r->tail.store(tail,std::memory_order_release);
+            }
+            if(!with_colors) strip_colors(batch);
+            if(!batch.empty()) out.write(batch.data(),std::streamsize(batch.size()));
+            batch.clear();
+            if(ticket>done || stop) out.flush();
+
+            guard.lock();
+            done=ticket;
+            drained.notify_all();
+            if(stop) break;
+        }
+    }
+}
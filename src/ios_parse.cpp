@@ -0,0 +1,129 @@
+/// @date 2026-10-16 (last modification)
+/// Table reading of `ios_parse.h`.
+/// The file is cut into chunks at line ends, rows of chunks are counted on all cores, arrays are resized once
+/// and then every chunk reads its rows from the index where the previous chunk ends.
+///
+#include "ios_parse.h"
+#include "flw_parallel.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace merry_tools::iostreams {
+
+    namespace {
+        constexpr std::size_t min_chunk_bytes=1<<16;
+
+        /// @brief Calls `fn(first,last)` for every non-empty line, without the line end.
+        template<class FN>
+        void for_lines(const char* first,const char* last,FN&& fn) {
+            while(first<last) {
+                const void* found=std::memchr(first,'\n',std::size_t(last-first));
+                const char* end=found!=nullptr?static_cast<const char*>(found):last;
+                const char* next=found!=nullptr?end+1:last;
+                if(end!=first && end[-1]=='\r') end--;
+                if(end!=first) fn(first,end);
+                first=next;
+            }
+        }
+
+        const char* find(const char* first,const char* last,char c) {
+            const void* found=std::memchr(first,c,std::size_t(last-first));
+            return found!=nullptr?static_cast<const char*>(found):last;
+        }
+    }
+
+    table_reader::table_reader(const std::string& path,char separator):file(path),separator(separator) {
+        const char* const first=reinterpret_cast<const char*>(file.data());
+        const char* const last=first+file.size();
+        const char* end=find(first,last,'\n');
+        body=std::size_t(end-first)+(end!=last?1:0);
+        if(end!=first && end[-1]=='\r') end--;
+        for(const char* p=first;end!=first;p++) {
+            const char* q=find(p,end,separator);
+            header.emplace_back(p,q);
+            if(q==end) break;
+            p=q;
+        }
+    }
+
+    std::size_t table_reader::field(const std::string& name,const char* label) const {
+        std::string wanted=name;
+        if(!name.empty() && *label!='[') wanted+='.';
+        wanted+=label;
+        const auto found=std::find(header.begin(),header.end(),wanted);
+        if(found!=header.end()) return std::size_t(found-header.begin());
+
+        const std::string same=wanted.substr(0,wanted.find('['));
+        for(const std::string& h:header)
+            if(h.compare(0,same.size(),same)==0 && h.size()>same.size() && h[same.size()]=='[')
+                throw parse_error("Column '"+h+"' has another unit than '"+wanted+"'");
+        throw parse_error("No column '"+wanted+"'");
+    }
+
+    std::size_t table_reader::read(unsigned threads) {
+        const char* const first=reinterpret_cast<const char*>(file.data())+body;
+        const char* const last=reinterpret_cast<const char*>(file.data())+file.size();
+        const std::size_t bytes=std::size_t(last-first);
+        const std::size_t concurrency=threads!=0?threads:flow::task_pool::global().concurrency();
+        const std::size_t chunks=std::max<std::size_t>(1,std::min(bytes/min_chunk_bytes,4*concurrency));
+
+        std::vector<const char*> starts(chunks+1,last);
+        starts[0]=first;
+        for(std::size_t k=1;k<chunks;k++) {
+            const char* p=std::max(first+k*(bytes/chunks),starts[k-1]);
+            const char* line_end=find(p,last,'\n');
+            starts[k]=line_end!=last?line_end+1:last;
+        }
+
+        std::vector<std::size_t> rows(chunks+1,0);      // Rows before the chunk, after the prefix sum.
+        flow::parallel_for(chunks,1,[&](std::size_t b,std::size_t e) {
+            for(std::size_t k=b;k<e;k++)
+                for_lines(starts[k],starts[k+1],[&](const char*,const char*) { rows[k+1]++; });
+        },threads);
+        for(std::size_t k=0;k<chunks;k++) rows[k+1]+=rows[k];
+        const std::size_t n=rows[chunks];
+
+        std::vector<get_type> gets(header.size(),nullptr);
+        std::vector<void*>    columns(header.size(),nullptr);
+        std::size_t           width=0;                  // Fields to look at, the rest of a line is skipped.
+        for(target& t:targets) {
+            void* data[3]{};
+            t.resize(n,data);
+            for(std::size_t c=0;c<t.components;c++) {
+                gets[t.fields[c]]=t.get;
+                columns[t.fields[c]]=data[c];
+                width=std::max(width,t.fields[c]+1);
+            }
+        }
+        if(width==0 || n==0) return n;
+
+        std::vector<std::string> errors(chunks);
+        flow::parallel_for(chunks,1,[&](std::size_t b,std::size_t e) {
+            for(std::size_t k=b;k<e;k++) {
+                std::size_t row=rows[k];
+                for_lines(starts[k],starts[k+1],[&](const char* p,const char* end) {
+                    if(!errors[k].empty()) return;
+                    for(std::size_t f=0;;f++) {
+                        const char* q=find(p,end,separator);
+                        if(gets[f]!=nullptr && !gets[f](p,q,columns[f],row)) {
+                            errors[k]="Row "+std::to_string(row+1)+", column '"+header[f]+"': '"+std::string(p,q)+
+                                      "' is not a number";
+                            return;
+                        }
+                        if(f+1==width) break;
+                        if(q==end) {
+                            errors[k]="Row "+std::to_string(row+1)+" has no column '"+header[f+1]+"'";
+                            return;
+                        }
+                        p=q+1;
+                    }
+                    row++;
+                });
+            }
+        },threads);
+        for(const std::string& error:errors)
+            if(!error.empty()) throw parse_error(error);
+        return n;
+    }
+}
@@ -0,0 +1,219 @@
+/// @date 2026-10-16 (last modification)
+/// Registry of regions and merging of per-thread statistics of `ios_profiling.h`.
+/// Statistics of a thread live in blocks of regions allocated by that thread. When the thread ends, they are
+/// added to the totals of finished threads. Ticks of the TSC are converted by comparing it with `steady_clock`.
+///
+#include "ios_profiling.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace merry_tools::iostreams {
+
+    namespace {
+        constexpr std::size_t block_regions=16;
+        constexpr std::size_t max_blocks=256;
+
+        /// @brief Plain sums of statistics, of finished threads or for a report.
+        struct totals {
+            profile_kind  kind=profile_kind::timer;
+            std::uint64_t count=0;
+            std::uint64_t total=0;
+            std::uint64_t lowest=~std::uint64_t(0);
+            std::uint64_t highest=0;
+            std::uint64_t buckets[profile_buckets]{};
+
+            void add(const profile_stats& s) {
+                constexpr auto r=std::memory_order_relaxed;
+                count+=s.count.load(r);
+                total+=s.total.load(r);
+                lowest=std::min(lowest,s.lowest.load(r));
+                highest=std::max(highest,s.highest.load(r));
+                for(std::size_t b=0;b<profile_buckets;b++) buckets[b]+=s.buckets[b].load(r);
+            }
+
+            void add(const totals& t) {
+                count+=t.count; total+=t.total;
+                lowest=std::min(lowest,t.lowest); highest=std::max(highest,t.highest);
+                for(std::size_t b=0;b<profile_buckets;b++) buckets[b]+=t.buckets[b];
+            }
+
+            /// @brief Upper end of the bucket holding the `q` quantile, not above the highest value.
+            std::uint64_t quantile(double q) const {
+                const auto wanted=std::uint64_t(q*double(count));
+                std::uint64_t seen=0;
+                for(std::size_t b=0;b<profile_buckets;b++)
+                    if((seen+=buckets[b])>wanted || b+1==profile_buckets)
+                        return b==0?0:std::min(highest,(std::uint64_t(1)<<b)-1);
+                return highest;
+            }
+        };
+
+        struct thread_table;
+
+        /// @brief Never destroyed, so tables of threads ending during static destruction can still retire.
+        struct registry {
+            std::mutex                                lock;
+            std::vector<const char*>                  names;
+            std::vector<profile_kind>                 kinds;
+            std::vector<thread_table*>                live;
+            std::vector<totals>                       finished;
+            const std::uint64_t                       start_ticks=profile_ticks();
+            const std::chrono::steady_clock::time_point start_time=std::chrono::steady_clock::now();
+        };
+
+        registry& regions() {
+            static registry* r=new registry;
+            return *r;
+        }
+
+        struct thread_table {
+            std::atomic<profile_stats*> blocks[max_blocks]{};
+
+            thread_table() {
+                registry& r=regions();
+                std::lock_guard<std::mutex> guard(r.lock);
+                r.live.push_back(this);
+            }
+
+            ~thread_table() {
+                registry& r=regions();
+                std::lock_guard<std::mutex> guard(r.lock);
+                r.live.erase(std::find(r.live.begin(),r.live.end(),this));
+                r.finished.resize(r.names.size());
+                for(std::size_t k=0;k<max_blocks;k++) {
+                    std::unique_ptr<profile_stats[]> block(blocks[k].load(std::memory_order_relaxed));
+                    if(block)
+                        for(std::size_t i=0;i<block_regions && k*block_regions+i<r.finished.size();i++)
+                            r.finished[k*block_regions+i].add(block[i]);
+                }
+            }
+        };
+
+        thread_local thread_table this_thread_table;
+
+        /// @brief Nanoseconds of a tick, measured against `steady_clock` since the first region.
+        double tick_nanoseconds(registry& r) {
+#if WB_PROFILE_TSC
+            auto elapsed=std::chrono::steady_clock::now()-r.start_time;
+            if(elapsed<std::chrono::milliseconds(10)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10)-elapsed);
+                elapsed=std::chrono::steady_clock::now()-r.start_time;
+            }
+            const std::uint64_t ticks=profile_ticks()-r.start_ticks;
+            return double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())/double(ticks);
+#else
+            (void)r;
+            return 1.0;
+#endif
+        }
+
+        std::string json_text(const std::string& s) {
+            std::string out;
+            for(char c:s) {
+                if(c=='"' || c=='\\') out+='\\';
+                out+=c;
+            }
+            return out;
+        }
+    }
+
+    profile_region::profile_region(const char* name,profile_kind kind) {
+        registry& r=regions();
+        std::lock_guard<std::mutex> guard(r.lock);
+        if(r.names.size()>=block_regions*max_blocks)                           // Blocks of threads can't grow.
+            throw std::length_error("Too many profile regions, at most "+std::to_string(block_regions*max_blocks)
+                                    +", the next is "+name);
+        index=r.names.size();
+        r.names.push_back(name);
+        r.kinds.push_back(kind);
+    }
+
+    profile_stats& profile_region::local() const {
+        std::atomic<profile_stats*>& slot=this_thread_table.blocks[index/block_regions];
+        profile_stats* block=slot.load(std::memory_order_relaxed);
+        if(block==nullptr) {
+            block=new profile_stats[block_regions];
+            slot.store(block,std::memory_order_release);
+        }
+        return block[index%block_regions];
+    }
+
+    std::vector<profile_summary> profile_summaries() {
+        registry& r=regions();
+        std::map<std::string,totals> merged;
+        {
+            std::lock_guard<std::mutex> guard(r.lock);
+            std::vector<totals> all(r.finished);
+            all.resize(r.names.size());
+            for(const thread_table* t:r.live)
+                for(std::size_t k=0;k<max_blocks;k++)
+                    if(const profile_stats* block=t->blocks[k].load(std::memory_order_acquire))
+                        for(std::size_t i=0;i<block_regions && k*block_regions+i<all.size();i++)
+                            all[k*block_regions+i].add(block[i]);
+            for(std::size_t i=0;i<all.size();i++) {
+                all[i].kind=r.kinds[i];
+                totals& m=merged[r.names[i]];
+                m.kind=all[i].kind;
+                m.add(all[i]);
+            }
+        }
+        const double scale=tick_nanoseconds(r);
+
+        std::vector<profile_summary> out;
+        for(const auto& [name,t]:merged) {
+            if(t.count==0) continue;
+            const double unit=t.kind==profile_kind::timer?scale:1.0;
+            out.push_back(profile_summary{name,t.kind,t.count,double(t.total)*unit,double(t.lowest)*unit,
+                                          double(t.highest)*unit,double(t.quantile(0.5))*unit,
+                                          double(t.quantile(0.99))*unit});
+        }
+        std::stable_sort(out.begin(),out.end(),[](const profile_summary& a,const profile_summary& b) {
+            return a.kind!=b.kind?a.kind<b.kind:a.total>b.total;
+        });
+        return out;
+    }
+
+    void write_profile_report(std::ostream& out) {
+        const std::vector<profile_summary> all=profile_summaries();
+        keep_io_flags keeper(out);
+        out<<std::fixed<<std::setprecision(0);
+        out<<COLOR2<<std::left<<std::setw(32)<<"region"<<std::right<<std::setw(12)<<"calls"<<std::setw(14)<<"total"
+           <<std::setw(12)<<"mean"<<std::setw(12)<<"min"<<std::setw(12)<<"~p50"<<std::setw(12)<<"~p99"
+           <<std::setw(12)<<"max"<<NOCOLO<<'\n';
+        for(const profile_summary& s:all) {
+            const bool timer=s.kind==profile_kind::timer;
+            out<<(timer?COLOR6:COLOR5)<<std::left<<std::setw(32)<<s.name<<std::right<<COLOR3<<std::setw(12)<<s.count
+               <<std::setw(14)<<s.total<<std::setw(12)<<s.total/double(s.count)<<std::setw(12)<<s.lowest
+               <<std::setw(12)<<s.median<<std::setw(12)<<s.p99<<std::setw(12)<<s.highest
+               <<COLFIL<<(timer?" [ns]":" [#]")<<NOCOLO<<'\n';
+        }
+        out.flush();
+    }
+
+    void write_profile_json(std::ostream& out) {
+        const std::vector<profile_summary> all=profile_summaries();
+        keep_io_flags keeper(out);
+        out<<std::setprecision(17)<<"{\"regions\":[";
+        for(std::size_t i=0;i<all.size();i++) {
+            const profile_summary& s=all[i];
+            const char* unit=s.kind==profile_kind::timer?"_ns":"";
+            out<<(i==0?"":",")<<"\n  {\"name\":\""<<json_text(s.name)<<"\",\"kind\":\""
+               <<(s.kind==profile_kind::timer?"timer":"counter")<<"\",\"count\":"<<s.count
+               <<",\"total"<<unit<<"\":"<<s.total<<",\"min"<<unit<<"\":"<<s.lowest
+               <<",\"p50"<<unit<<"\":"<<s.median<<",\"p99"<<unit<<"\":"<<s.p99
+               <<",\"max"<<unit<<"\":"<<s.highest<<"}";
+        }
+        out<<"\n]}\n";
+    }
+
+    profile_report::~profile_report() {
+        if(is_set()) write_profile_report(*dynamic_cast<std::ostream*>(the_stream));
+    }
+}
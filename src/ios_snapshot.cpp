@@ -0,0 +1,242 @@
+/// @date 2026-10-16 (last modification)
+/// Writing, mapping and checking of snapshot files of `ios_snapshot.h`.
+/// POSIX systems map files with `mmap`, others read the whole file into memory aligned like `VecArray`.
+///
+#include "ios_snapshot.h"
+
+#include <cstdio>
+#include <fstream>
+#include <new>
+
+#if __has_include(<sys/mman.h>)
+#   define WB_SNAPSHOT_MMAP 1
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#else
+#   define WB_SNAPSHOT_MMAP 0
+#endif
+
+namespace merry_tools::iostreams {
+
+    namespace {
+        constexpr char          magic[8]={'M','E','R','R','Y','S','N','P'};
+        constexpr std::uint32_t byte_order_mark=0x01020304;
+        constexpr std::uint64_t data_alignment=64;
+
+        std::uint64_t aligned(std::uint64_t offset) { return (offset+data_alignment-1)/data_alignment*data_alignment; }
+
+        std::string column_text(const char* field,std::size_t size) { return std::string(field,strnlen(field,size)); }
+
+        /// @brief What differs between the file and the expected type, or empty.
+        std::string mismatch(const snapshot_column& got,const snapshot_column& expected) {
+            auto compare=[](const char* what,const std::string& g,const std::string& e) {
+                return g==e?std::string():std::string(what)+" '"+e+"' expected, '"+g+"' found";
+            };
+            if(got.components!=expected.components)
+                return std::to_string(expected.components)+" components expected, "+std::to_string(got.components)
+                       +" found";
+            std::string diff=compare("system",column_text(got.system,sizeof got.system),
+                                     column_text(expected.system,sizeof expected.system));
+            for(std::size_t k=0;k<expected.components && diff.empty();k++)
+                diff=compare("axis",column_text(got.axes[k],sizeof got.axes[k]),
+                             column_text(expected.axes[k],sizeof expected.axes[k]));
+            if(diff.empty())
+                diff=compare("unit",column_text(got.unit,sizeof got.unit),
+                             column_text(expected.unit,sizeof expected.unit));
+            if(diff.empty() && got.value_bytes!=expected.value_bytes)
+                diff=std::to_string(expected.value_bytes)+" byte values expected, "+std::to_string(got.value_bytes)
+                     +" found";
+            return diff;
+        }
+    }
+
+    // LAYOUT:
+    //*///////
+
+    std::uint64_t detail::lay_out(snapshot_header& header,std::vector<snapshot_column>& records) {
+        std::memcpy(header.magic,magic,sizeof magic);
+        header.version=snapshot_version;
+        header.byte_order=byte_order_mark;
+        header.columns=static_cast<std::uint32_t>(records.size());
+        std::uint64_t offset=aligned(sizeof(snapshot_header)+records.size()*sizeof(snapshot_column));
+        for(snapshot_column& c:records)
+            for(std::uint32_t k=0;k<c.components;k++) {
+                c.offset[k]=offset;
+                offset=aligned(offset+c.count*c.value_bytes);
+            }
+        header.image_bytes=offset;
+        return offset;
+    }
+
+    void detail::write_image(const snapshot_header& header,const std::vector<snapshot_column>& records,
+                             const std::vector<const void*>& data,unsigned char* out) {
+        std::memcpy(out,&header,sizeof header);
+        std::memcpy(out+sizeof header,records.data(),records.size()*sizeof(snapshot_column));
+        std::uint64_t written=sizeof header+records.size()*sizeof(snapshot_column);
+        std::size_t   next=0;
+        for(const snapshot_column& c:records)
+            for(std::uint32_t k=0;k<c.components;k++,next++) {
+                std::memset(out+written,0,c.offset[k]-written);
+                const std::uint64_t length=c.count*c.value_bytes;
+                if(length>0) std::memcpy(out+c.offset[k],data[next],length);
+                written=c.offset[k]+length;
+            }
+        std::memset(out+written,0,header.image_bytes-written);
+    }
+
+    // WRITING:
+    //*////////
+
+    void snapshot_writer::add_column(const std::string& name,snapshot_column column,std::size_t count,
+                                     const void* const data[3]) {
+        for(const part& p:parts)
+            if(name==p.column.name) throw snapshot_error("Column '"+name+"' added twice");
+        detail::put_text(column.name,sizeof column.name,name.c_str());
+        column.count=count;
+        part added{column,{data[0],data[1],data[2]}};
+        parts.push_back(added);
+    }
+
+    void snapshot_writer::save(const std::string& path) const {
+        snapshot_header              header{};
+        std::vector<snapshot_column> records;
+        std::vector<const void*>     data;
+        for(const part& p:parts) {
+            records.push_back(p.column);
+            for(std::uint32_t k=0;k<p.column.components;k++) data.push_back(p.data[k]);
+        }
+        detail::lay_out(header,records);
+
+        const std::string temporary=path+".tmp";
+        {
+            std::ofstream out(temporary,std::ios::binary|std::ios::trunc);
+            if(!out) throw snapshot_error("Can't write "+temporary);
+            static const char zeros[data_alignment]{};
+            auto pad_to=[&](std::uint64_t position) {
+                const auto at=static_cast<std::uint64_t>(out.tellp());
+                out.write(zeros,static_cast<std::streamsize>(position-at));
+            };
+            out.write(reinterpret_cast<const char*>(&header),sizeof header);
+            out.write(reinterpret_cast<const char*>(records.data()),
+                      static_cast<std::streamsize>(records.size()*sizeof(snapshot_column)));
+            std::size_t next=0;
+            for(const snapshot_column& c:records)
+                for(std::uint32_t k=0;k<c.components;k++,next++) {
+                    pad_to(c.offset[k]);
+                    out.write(static_cast<const char*>(data[next]),static_cast<std::streamsize>(c.count*c.value_bytes));
+                }
+            pad_to(header.image_bytes);
+            out.close();
+            if(!out) { std::remove(temporary.c_str()); throw snapshot_error("Can't write "+temporary); }
+        }
+        if(std::rename(temporary.c_str(),path.c_str())!=0) {
+            std::remove(temporary.c_str());
+            throw snapshot_error("Can't replace "+path);
+        }
+    }
+
+    // READING:
+    //*////////
+
+    snapshot_image::snapshot_image(const unsigned char* image,std::size_t available,const std::string& what) {
+        if(available<sizeof(snapshot_header)) throw snapshot_error(what+" is not a snapshot");
+        std::memcpy(&header,image,sizeof header);
+        if(std::memcmp(header.magic,magic,sizeof magic)!=0) throw snapshot_error(what+" is not a snapshot");
+        if(header.byte_order!=byte_order_mark) throw snapshot_error(what+" has foreign byte order");
+        if(header.version!=snapshot_version)
+            throw snapshot_error(what+" has version "+std::to_string(header.version)+", only "
+                                 +std::to_string(snapshot_version)+" is supported");
+        const std::uint64_t bytes=header.image_bytes;
+        if(bytes>available || sizeof header+std::uint64_t(header.columns)*sizeof(snapshot_column)>bytes)
+            throw snapshot_error(what+" is truncated");
+        base=image;
+        records=reinterpret_cast<const snapshot_column*>(image+sizeof header);
+        column_count=header.columns;
+        for(std::size_t i=0;i<column_count;i++) {
+            const snapshot_column& c=records[i];
+            if(c.components<1 || c.components>3 || (c.value_bytes!=4 && c.value_bytes!=8))
+                throw snapshot_error(what+": column "+std::to_string(i)+" is damaged");
+            for(std::uint32_t k=0;k<c.components;k++)
+                if(c.offset[k]%data_alignment!=0 || c.offset[k]>bytes || c.count>(bytes-c.offset[k])/c.value_bytes)
+                    throw snapshot_error(what+": column "+std::to_string(i)+" is damaged");
+        }
+    }
+
+    snapshot_image& snapshot_image::operator = (snapshot_image&& other) noexcept {
+        base=other.base; header=other.header; records=other.records; column_count=other.column_count;
+        other.base=nullptr; other.header=snapshot_header{}; other.records=nullptr; other.column_count=0;
+        return *this;
+    }
+
+    const snapshot_column* snapshot_image::find(const std::string& name) const {
+        for(std::size_t i=0;i<column_count;i++)
+            if(column_text(records[i].name,sizeof records[i].name)==name) return records+i;
+        return nullptr;
+    }
+
+    const snapshot_column& snapshot_image::checked(const std::string& name,const snapshot_column& expected) const {
+        const snapshot_column* c=find(name);
+        if(c==nullptr) throw snapshot_error("No column '"+name+"' in the snapshot");
+        const std::string diff=mismatch(*c,expected);
+        if(!diff.empty()) throw snapshot_error("Column '"+name+"': "+diff);
+        return *c;
+    }
+
+    mapped_file::mapped_file(const std::string& path) {
+#if WB_SNAPSHOT_MMAP
+        const int fd=::open(path.c_str(),O_RDONLY);
+        if(fd<0) throw snapshot_error("Can't open "+path);
+        struct stat info{};
+        if(::fstat(fd,&info)!=0) { ::close(fd); throw snapshot_error("Can't open "+path); }
+        bytes=static_cast<std::size_t>(info.st_size);
+        if(bytes>0) {
+            void* p=::mmap(nullptr,bytes,PROT_READ,MAP_PRIVATE,fd,0);
+            if(p==MAP_FAILED) { ::close(fd); throw snapshot_error("Can't map "+path); }
+            base=static_cast<const unsigned char*>(p);
+        }
+        ::close(fd);
+#else
+        std::ifstream in(path,std::ios::binary|std::ios::ate);
+        if(!in) throw snapshot_error("Can't open "+path);
+        bytes=static_cast<std::size_t>(in.tellg());
+        auto* buffer=static_cast<unsigned char*>(::operator new(bytes+1,std::align_val_t{data_alignment}));
+        base=buffer;
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(buffer),static_cast<std::streamsize>(bytes));
+        if(!in) { release(); throw snapshot_error("Can't read "+path); }
+#endif
+    }
+
+    mapped_file::~mapped_file() { release(); }
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept:base(other.base),bytes(other.bytes) {
+        other.base=nullptr; other.bytes=0;
+    }
+
+    mapped_file& mapped_file::operator = (mapped_file&& other) noexcept {
+        if(this!=&other) {
+            release();
+            base=other.base; bytes=other.bytes;
+            other.base=nullptr; other.bytes=0;
+        }
+        return *this;
+    }
+
+    void mapped_file::release() {
+        if(base!=nullptr) {
+#if WB_SNAPSHOT_MMAP
+            ::munmap(const_cast<unsigned char*>(base),bytes);
+#else
+            ::operator delete(const_cast<unsigned char*>(base),std::align_val_t{data_alignment});
+#endif
+        }
+        base=nullptr; bytes=0;
+    }
+
+    snapshot::snapshot(const std::string& path):file(path) {
+        static_cast<snapshot_image&>(*this)=snapshot_image(file.data(),file.size(),path);
+        if(bytes()!=file.size()) throw snapshot_error(path+" is truncated");
+    }
+}
@@ -0,0 +1,137 @@
+/// @date 2026-10-16 (last modification)
+/// Background writing and reading of trajectories of `ios_trajectory.h`.
+/// The simulation thread only copies columns into a free staging buffer. Buffers go around in a ring:
+/// free -> ready -> written by the background thread -> free.
+///
+#include "ios_trajectory.h"
+
+#include <algorithm>
+
+namespace merry_tools::iostreams {
+
+    // WRITING:
+    //*////////
+
+    trajectory_writer::trajectory_writer(const std::string& path,std::size_t depth,std::uint64_t every):
+            path(path),every(std::max<std::uint64_t>(every,1)),buffers(std::max<std::size_t>(depth,1)) {
+        file=std::fopen(path.c_str(),"wb");
+        if(file==nullptr) throw snapshot_error("Can't write "+path);
+        for(std::size_t b=0;b<buffers.size();b++) free_buffers.push_back(b);
+        background=std::thread([this] { run(); });
+    }
+
+    trajectory_writer::~trajectory_writer() {
+        try { close(); } catch(...) {}                                                     // NOLINT(*-empty-catch)
+    }
+
+    void trajectory_writer::add_source(const std::string& name,snapshot_column column,std::uint64_t every,
+                                       fetch_type fetch) {
+        for(const source& s:sources)
+            if(name==s.column.name) throw snapshot_error("Column '"+name+"' added twice");
+        detail::put_text(column.name,sizeof column.name,name.c_str());
+        sources.push_back(source{column,std::max<std::uint64_t>(every,1),std::move(fetch)});
+    }
+
+    void trajectory_writer::rethrow() {
+        if(error) { std::exception_ptr e=error; error=nullptr; std::rethrow_exception(e); }
+    }
+
+    bool trajectory_writer::write(std::uint64_t step,const math::TimeSI64& time) {
+        if(!due(step)) return false;
+        std::size_t b;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            if(file==nullptr) throw snapshot_error(path+" is closed");
+            if(free_buffers.empty()) {
+                stalled.fetch_add(1,std::memory_order_relaxed);
+                changed.wait(guard,[this] { return !free_buffers.empty() || error; });
+            }
+            rethrow();
+            b=free_buffers.front();
+            free_buffers.pop_front();
+        }
+
+        records.clear();
+        data.clear();
+        for(const source& s:sources) {
+            if(step%s.every!=0) continue;
+            const void* d[3]={nullptr,nullptr,nullptr};
+            snapshot_column c=s.column;
+            c.count=s.fetch(d);
+            records.push_back(c);
+            for(std::uint32_t k=0;k<c.components;k++) data.push_back(d[k]);
+        }
+        snapshot_header header{};
+        header.step=step;
+        header.time=time.value;
+        const std::uint64_t bytes=detail::lay_out(header,records);
+        buffers[b].resize(bytes);
+        detail::write_image(header,records,data,buffers[b].data());
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            ready.push_back(b);
+        }
+        changed.notify_all();
+        return true;
+    }
+
+    void trajectory_writer::flush() {
+        std::unique_lock<std::mutex> guard(lock);
+        changed.wait(guard,[this] { return ready.empty() || error; });
+        rethrow();
+        if(file!=nullptr && std::fflush(file)!=0) throw snapshot_error("Can't write "+path);
+    }
+
+    void trajectory_writer::close() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping=true;
+        }
+        changed.notify_all();
+        if(background.joinable()) background.join();
+        if(file!=nullptr) {
+            const bool failed=std::fclose(file)!=0;
+            file=nullptr;
+            if(failed && !error) error=std::make_exception_ptr(snapshot_error("Can't write "+path));
+        }
+        rethrow();
+    }
+
+    void trajectory_writer::run() {
+        for(;;) {
+            std::size_t b;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard,[this] { return stopping || !ready.empty(); });
+                if(ready.empty()) return;
+                b=ready.front();                         // Stays queued until written, so `flush()` waits for it.
+            }
+            const bool ok=std::fwrite(buffers[b].data(),1,buffers[b].size(),file)==buffers[b].size();
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                ready.pop_front();
+                free_buffers.push_back(b);
+                if(ok) written.fetch_add(1,std::memory_order_relaxed);
+                else if(!error) error=std::make_exception_ptr(snapshot_error("Can't write "+path));
+            }
+            changed.notify_all();
+        }
+    }
+
+    // READING:
+    //*////////
+
+    trajectory::trajectory(const std::string& path):file(path) {
+        std::size_t offset=0;
+        while(offset<file.size()) {
+            const std::size_t left=file.size()-offset;
+            snapshot_header header;
+            if(left<sizeof header) { whole=false; break; }
+            std::memcpy(&header,file.data()+offset,sizeof header);
+            if(header.image_bytes>left) { whole=false; break; }
+            images.emplace_back(file.data()+offset,left,path+" frame "+std::to_string(images.size()));
+            offset+=images.back().bytes();
+        }
+    }
+}
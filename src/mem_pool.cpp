@@ -0,0 +1,221 @@
+/// @date 2026-10-16 (last modification)
+/// Slabs, caches and checks of `mem_pool.h`.
+/// A slot of a pool is the front guard (padded to the alignment), the block and the back guard. Free slots keep
+/// the front guard retired, i.e. in its destructed state, so walking a slab tells free, used and damaged slots apart.
+/// An allocation of an arena is a header with its size, the front guard, the block and the back guard.
+///
+#include "mem_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace merry_tools::memory {
+
+    namespace {
+        std::atomic<std::uint64_t> pools{0};
+
+        std::size_t round_up(std::size_t n,std::size_t alignment) { return (n+alignment-1)&~(alignment-1); }
+
+        /// @brief Size and offset of an arena allocation, before its front guard.
+        struct arena_header {
+            std::size_t bytes;
+            std::size_t start;      //!< Of the block, from the header.
+        };
+
+        unsigned char* bytes_of(void* p) { return static_cast<unsigned char*>(p); }
+
+        [[maybe_unused]] front_guard* front_of(void* p) {
+            return reinterpret_cast<front_guard*>(bytes_of(p)-sizeof(front_guard));
+        }
+
+        [[maybe_unused]] back_guard* back_of(void* p,std::size_t bytes) {
+            return reinterpret_cast<back_guard*>(bytes_of(p)+round_up(bytes,sizeof(back_guard)));
+        }
+    }
+
+    // POOLS:
+    //*//////
+
+    block_pool::block_pool(std::size_t block_bytes,std::size_t alignment,std::size_t slab_blocks)
+        :bytes(round_up(std::max(block_bytes,sizeof(void*)),8)),alignment(std::max<std::size_t>(alignment,8)),
+         slab_blocks(std::max<std::size_t>(slab_blocks,1)),id(++pools) {
+        assert((alignment&(alignment-1))==0);                                       // Only powers of two!
+        front=pool_guards?round_up(sizeof(front_guard),this->alignment):0;
+        stride=round_up(front+bytes+(pool_guards?sizeof(back_guard):0),this->alignment);
+    }
+
+    block_pool::~block_pool() {
+        for(void* s:slabs) ::operator delete(s,std::align_val_t{alignment});
+    }
+
+    block_pool::cache& block_pool::find_cache() {
+        const std::thread::id me=std::this_thread::get_id();
+        std::lock_guard<std::mutex> guard(lock);
+        for(const auto& c:caches)
+            if(c->owner==me) return *c;                 // Also a cache of a finished thread with the same id.
+        caches.push_back(std::make_unique<cache>());
+        caches.back()->owner=me;
+        caches.back()->epoch=epoch.load(std::memory_order_relaxed);
+        return *caches.back();
+    }
+
+    void block_pool::add_slab() {
+        auto* slab=static_cast<unsigned char*>(::operator new(stride*slab_blocks,std::align_val_t{alignment}));
+        slabs.push_back(slab);
+        for(std::size_t i=slab_blocks;i-->0;) {
+            void* p=slab+i*stride+front;
+#if WB_POOL_GUARDS
+            (new(front_of(p)) front_guard)->retire();
+            new(back_of(p,bytes)) back_guard;
+#endif
+            next_of(p)=shared;
+            shared=p;
+        }
+    }
+
+    void block_pool::refill(cache& c) {
+        std::lock_guard<std::mutex> guard(lock);
+        for(std::size_t k=0;k<cache_blocks;k++) {
+            if(shared==nullptr) add_slab();
+            void* p=shared;
+            shared=next_of(p);
+            next_of(p)=c.head;
+            c.head=p;
+            c.count++;
+        }
+    }
+
+    void block_pool::spill(cache& c) {
+        std::lock_guard<std::mutex> guard(lock);
+        for(std::size_t k=0;k<cache_blocks;k++) {
+            void* p=c.head;
+            c.head=next_of(p);
+            c.count--;
+            next_of(p)=shared;
+            shared=p;
+        }
+    }
+
+    void block_pool::reset() {
+        std::lock_guard<std::mutex> guard(lock);
+        epoch.fetch_add(1,std::memory_order_relaxed);   // Caches see it at their next use and forget their lists.
+        shared=nullptr;
+        for(std::size_t s=slabs.size();s-->0;)
+            for(std::size_t i=slab_blocks;i-->0;) {
+                void* p=static_cast<unsigned char*>(slabs[s])+i*stride+front;
+#if WB_POOL_GUARDS
+                (new(front_of(p)) front_guard)->retire();
+                new(back_of(p,bytes)) back_guard;
+#endif
+                next_of(p)=shared;
+                shared=p;
+            }
+    }
+
+    bool block_pool::validate() const {
+#if WB_POOL_GUARDS
+        std::lock_guard<std::mutex> guard(lock);
+        for(void* s:slabs)
+            for(std::size_t i=0;i<slab_blocks;i++) {
+                void* p=static_cast<unsigned char*>(s)+i*stride+front;
+                const front_guard* f=front_of(p);
+                if(!(f->is_constructed() || f->is_destructed()) || !back_of(p,bytes)->is_constructed()) return false;
+            }
+#endif
+        return true;
+    }
+
+    std::size_t block_pool::capacity() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return slabs.size()*slab_blocks;
+    }
+
+#if WB_POOL_GUARDS
+    void block_pool::disarm(void* p) const {
+        front_guard* f=front_of(p);
+        assert(!f->is_destructed());                                            // Freed twice!
+        assert(f->is_constructed() && back_of(p,bytes)->is_constructed());     // Written out of the block!
+        f->retire();
+        std::memset(p,0xDD,bytes);
+    }
+#endif
+
+    // ARENAS:
+    //*///////
+
+    guarded_arena::~guarded_arena() {
+        for(const chunk& c:chunks) ::operator delete(c.data,std::align_val_t{64});
+    }
+
+    void* guarded_arena::allocate(std::size_t bytes,std::size_t alignment) {
+        assert((alignment&(alignment-1))==0);                                       // Only powers of two!
+        alignment=std::max<std::size_t>(alignment,8);
+        const std::size_t most=bytes+alignment+(pool_guards?sizeof(arena_header)+2*sizeof(front_guard)+8:0);
+        for(;;) {
+            if(current<chunks.size()) {
+                chunk& c=chunks[current];
+                const auto base=reinterpret_cast<std::uintptr_t>(c.data);
+#if WB_POOL_GUARDS
+                const std::size_t header=round_up(c.used,alignof(arena_header));
+                const std::size_t start=round_up(base+header+sizeof(arena_header)+sizeof(front_guard),alignment)-base;
+                const std::size_t end=start+round_up(bytes,sizeof(back_guard))+sizeof(back_guard);
+                if(end<=c.size) {
+                    new(c.data+header) arena_header{bytes,start-header};
+                    new(front_of(c.data+start)) front_guard;
+                    new(back_of(c.data+start,bytes)) back_guard;
+                    c.used=end;
+                    return c.data+start;
+                }
+#else
+                const std::size_t start=round_up(base+c.used,alignment)-base;
+                if(start+bytes<=c.size) {
+                    c.used=start+bytes;
+                    return c.data+start;
+                }
+#endif
+                if(current+1<chunks.size() && chunks[current+1].size>=most) {
+                    current++;
+                    continue;
+                }
+            }
+            const std::size_t size=std::max(chunk_bytes,2*most);
+            chunks.insert(chunks.begin()+std::ptrdiff_t(std::min(current+1,chunks.size())),
+                          chunk{static_cast<unsigned char*>(::operator new(size,std::align_val_t{64})),size});
+            if(chunks.size()>1) current=std::min(current+1,chunks.size()-1);
+        }
+    }
+
+    void guarded_arena::reset() {
+        assert(validate());                                                     // Written out of a block!
+        for(chunk& c:chunks) c.used=0;
+        current=0;
+    }
+
+    bool guarded_arena::validate() const {
+#if WB_POOL_GUARDS
+        for(const chunk& c:chunks)
+            for(std::size_t pos=0;round_up(pos,alignof(arena_header))<c.used;) {
+                const std::size_t header=round_up(pos,alignof(arena_header));
+                const auto* h=reinterpret_cast<const arena_header*>(c.data+header);
+                if(h->start>c.used-header) return false;
+                unsigned char* p=c.data+header+h->start;
+                if(!front_of(p)->is_constructed() || p+h->bytes>c.data+c.used) return false;
+                if(!back_of(p,h->bytes)->is_constructed()) return false;
+                pos=std::size_t(bytes_of(back_of(p,h->bytes))-c.data)+sizeof(back_guard);
+            }
+#endif
+        return true;
+    }
+
+    std::size_t guarded_arena::used() const {
+        std::size_t total=0;
+        for(const chunk& c:chunks) total+=c.used;
+        return total;
+    }
+
+    std::size_t guarded_arena::capacity() const {
+        std::size_t total=0;
+        for(const chunk& c:chunks) total+=c.size;
+        return total;
+    }
+}
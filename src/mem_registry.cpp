@@ -0,0 +1,187 @@
+/// @date 2026-10-16 (last modification)
+/// Shards and the sweep of `mem_registry.h`.
+/// A shard is a list of chunks of slots, filled only by its thread. Slots withdrawn by the owner go to its list
+/// of spare slots, slots withdrawn by other threads become holes, collected by the owner when there are enough.
+/// Shards of finished threads are adopted by new ones, so slots of guards still alive are never lost.
+///
+#include "mem_registry.h"
+#include "flw_parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+namespace merry_tools::memory {
+
+    namespace {
+        constexpr std::size_t chunk_slots=4096;
+
+        /// @brief Value of spare slots of the owner, so that collecting holes skips them.
+        const char spare_tag=0;
+        const void* const spare=&spare_tag;
+    }
+
+    struct guard_shard {
+        std::mutex                                 lock;      //!< Only for `chunks`, changed rarely.
+        std::vector<std::unique_ptr<guard_slot[]>> chunks;
+        std::size_t                                used=0;    //!< Slots of the last chunk ever given. Owner only.
+        std::vector<guard_slot*>                   spares;    //!< Owner only.
+        std::atomic<std::size_t>                   holes{0};  //!< Withdrawn by other threads.
+
+        /// @brief Takes holes back as spares, by the owner.
+        void collect() {
+            std::lock_guard<std::mutex> guard(lock);
+            std::size_t found=0;
+            for(const auto& c:chunks)
+                for(std::size_t i=0;i<chunk_slots;i++) {
+                    guard_slot& s=c[i];
+                    if(&c==&chunks.back() && i>=used) break;
+                    if(s.value.load(std::memory_order_relaxed)==nullptr) {
+                        s.value.store(spare,std::memory_order_relaxed);
+                        spares.push_back(&s);
+                        found++;
+                    }
+                }
+            holes.fetch_sub(found,std::memory_order_relaxed);
+        }
+
+        guard_slot* take() {
+            if(spares.empty() && holes.load(std::memory_order_relaxed)>=chunk_slots/4) collect();
+            if(!spares.empty()) {
+                guard_slot* s=spares.back();
+                spares.pop_back();
+                return s;
+            }
+            if(chunks.empty() || used==chunk_slots) {
+                auto chunk=std::make_unique<guard_slot[]>(chunk_slots);
+                for(std::size_t i=0;i<chunk_slots;i++) chunk[i].owner=this;
+                std::lock_guard<std::mutex> guard(lock);
+                chunks.push_back(std::move(chunk));
+                used=0;
+            }
+            return &chunks.back()[used++];
+        }
+    };
+
+    namespace {
+        /// @brief Never destroyed, guards may die during static destruction.
+        struct registry {
+            std::mutex                                lock;
+            std::vector<std::unique_ptr<guard_shard>> shards;
+            std::vector<guard_shard*>                 orphans;
+        };
+
+        registry& shards() {
+            static registry* r=new registry;
+            return *r;
+        }
+
+        struct shard_owner {
+            guard_shard* shard;
+
+            shard_owner() {
+                registry& r=shards();
+                std::lock_guard<std::mutex> guard(r.lock);
+                if(!r.orphans.empty()) {
+                    shard=r.orphans.back();
+                    r.orphans.pop_back();
+                } else {
+                    r.shards.push_back(std::make_unique<guard_shard>());
+                    shard=r.shards.back().get();
+                }
+            }
+
+            ~shard_owner() {
+                registry& r=shards();
+                std::lock_guard<std::mutex> guard(r.lock);
+                r.orphans.push_back(shard);
+                shard=nullptr;                          // Guards withdrawn later leave holes, like of other threads.
+            }
+        };
+
+        thread_local shard_owner this_shard;
+
+        std::uint64_t read_value(const void* p,std::size_t bytes) {
+            switch(bytes) {
+                case 1: { std::uint8_t  v; std::memcpy(&v,p,1); return v; }
+                case 2: { std::uint16_t v; std::memcpy(&v,p,2); return v; }
+                case 4: { std::uint32_t v; std::memcpy(&v,p,4); return v; }
+                default: { std::uint64_t v; std::memcpy(&v,p,8); return v; }
+            }
+        }
+    }
+
+    guard_slot* enrol_guard(const void* value,const guard_kind* kind) {
+        guard_shard* shard=this_shard.shard;
+        guard_slot* slot=shard->take();
+        slot->kind.store(kind,std::memory_order_relaxed);
+        slot->value.store(value,std::memory_order_release);
+        return slot;
+    }
+
+    void withdraw_guard(guard_slot* slot) {
+        guard_shard* shard=slot->owner;
+        if(shard==this_shard.shard) {
+            slot->value.store(spare,std::memory_order_relaxed);
+            shard->spares.push_back(slot);
+        } else {
+            slot->value.store(nullptr,std::memory_order_release);
+            shard->holes.fetch_add(1,std::memory_order_relaxed);
+        }
+    }
+
+    guard_report validate_all(unsigned threads,std::size_t addresses) {
+        std::vector<const guard_slot*> chunks;
+        {
+            registry& r=shards();
+            std::lock_guard<std::mutex> guard(r.lock);
+            for(const auto& s:r.shards) {
+                std::lock_guard<std::mutex> chunks_guard(s->lock);
+                for(const auto& c:s->chunks) chunks.push_back(c.get());
+            }
+        }
+
+        std::vector<guard_report> reports(chunks.size());
+        flow::parallel_for(chunks.size(),1,[&](std::size_t b,std::size_t e) {
+            for(std::size_t k=b;k<e;k++) {
+                guard_report& report=reports[k];
+                for(std::size_t i=0;i<chunk_slots;i++) {        // Slots never given are empty.
+                    const guard_slot& s=chunks[k][i];
+                    const void* value=s.value.load(std::memory_order_acquire);
+                    if(value==nullptr || value==spare) continue;
+                    const guard_kind* kind=s.kind.load(std::memory_order_relaxed);
+                    const std::uint64_t v=read_value(value,kind->bytes);
+                    report.checked++;
+                    if(v==kind->constructed) continue;
+                    report.overwritten++;
+                    if(report.damaged.size()<addresses) report.damaged.push_back(value);
+                }
+            }
+        },threads);
+
+        guard_report all;
+        for(const guard_report& r:reports) {
+            all.checked+=r.checked;
+            all.overwritten+=r.overwritten;
+            for(const void* p:r.damaged)
+                if(all.damaged.size()<addresses) all.damaged.push_back(p);
+        }
+        return all;
+    }
+
+    std::size_t registered_guards() {
+        registry& r=shards();
+        std::lock_guard<std::mutex> guard(r.lock);
+        std::size_t total=0;
+        for(const auto& s:r.shards) {
+            std::lock_guard<std::mutex> chunks_guard(s->lock);
+            for(const auto& c:s->chunks)
+                for(std::size_t i=0;i<chunk_slots;i++) {
+                    const void* value=c[i].value.load(std::memory_order_relaxed);
+                    total+=value!=nullptr && value!=spare;
+                }
+        }
+        return total;
+    }
+}
@@ -0,0 +1,310 @@
+/// @date 2026-10-16 (last modification)
+/// Raw SIMD kernels for bulk conversions of `fix_float` (see `mth_fix_float.h`).
+/// The instruction set is the one chosen by `simd::active()` of `mth_vec_batch.h`.
+/// Vector and scalar code give the same codes: the same operations in the same order and rounding to nearest even.
+/// The SSE level and `uint32_t` codes without AVX-512 use the scalar code.
+///
+#include "mth_fix_float.h"
+#include "mth_vec_batch.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#   define WB_FIX_FLOAT_X86 1
+#   include <immintrin.h>
+#   define WB_TARGET(ISA) __attribute__((target(ISA)))
+#else
+#   define WB_FIX_FLOAT_X86 0
+#endif
+
+namespace merry_tools::math::simd {
+
+    // SCALAR FALLBACK:
+    //*////////////////
+
+    template<class D>
+    static void quantize_scalar(const float* in,float offset,float scale,float lo,float hi,D* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++)
+            out[i]=static_cast<D>(detail::round_code(detail::clamp_code((in[i]-offset)*scale,lo,hi)));
+    }
+
+    template<class D>
+    static void dequantize_scalar(const D* in,float offset,float step,float* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++) out[i]=float(in[i])*step+offset;
+    }
+
+#if WB_FIX_FLOAT_X86
+
+    // AVX2:
+    //*/////
+
+    /// Eight codes as `int32` lanes, clamped like `detail::clamp_code()`: `max_ps` gives `lo` for NaN.
+    WB_TARGET("avx2")
+    static __m256i codes8(const float* in,__m256 offset,__m256 scale,__m256 lo,__m256 hi) {
+        __m256 s=_mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(in),offset),scale);
+        s=_mm256_min_ps(_mm256_max_ps(s,lo),hi);
+        return _mm256_cvtps_epi32(s);
+    }
+
+    // Codes are clamped already, so saturating packs only narrow them.
+    WB_TARGET("avx2")
+    static void store8(__m256i c,std::int8_t* out) {
+        __m128i w=_mm_packs_epi32(_mm256_castsi256_si128(c),_mm256_extracti128_si256(c,1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out),_mm_packs_epi16(w,w));
+    }
+
+    WB_TARGET("avx2")
+    static void store8(__m256i c,std::uint8_t* out) {
+        __m128i w=_mm_packus_epi32(_mm256_castsi256_si128(c),_mm256_extracti128_si256(c,1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out),_mm_packus_epi16(w,w));
+    }
+
+    WB_TARGET("avx2")
+    static void store8(__m256i c,std::int16_t* out) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                         _mm_packs_epi32(_mm256_castsi256_si128(c),_mm256_extracti128_si256(c,1)));
+    }
+
+    WB_TARGET("avx2")
+    static void store8(__m256i c,std::uint16_t* out) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                         _mm_packus_epi32(_mm256_castsi256_si128(c),_mm256_extracti128_si256(c,1)));
+    }
+
+    WB_TARGET("avx2")
+    static void store8(__m256i c,std::int32_t* out) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),c);
+    }
+
+    WB_TARGET("avx2")
+    static __m256i load8(const std::int8_t* in) {
+        return _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+    }
+
+    WB_TARGET("avx2")
+    static __m256i load8(const std::uint8_t* in) {
+        return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+    }
+
+    WB_TARGET("avx2")
+    static __m256i load8(const std::int16_t* in) {
+        return _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+    }
+
+    WB_TARGET("avx2")
+    static __m256i load8(const std::uint16_t* in) {
+        return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+    }
+
+    WB_TARGET("avx2")
+    static __m256i load8(const std::int32_t* in) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    }
+
+    template<class D>
+    WB_TARGET("avx2")
+    static void quantize_avx2(const float* in,float offset,float scale,float lo,float hi,D* out,std::size_t n) {
+        const __m256 vo=_mm256_set1_ps(offset), vs=_mm256_set1_ps(scale);
+        const __m256 vl=_mm256_set1_ps(lo),     vh=_mm256_set1_ps(hi);
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) store8(codes8(in+i,vo,vs,vl,vh),out+i);
+        quantize_scalar(in+i,offset,scale,lo,hi,out+i,n-i);
+    }
+
+    template<class D>
+    WB_TARGET("avx2")
+    static void dequantize_avx2(const D* in,float offset,float step,float* out,std::size_t n) {
+        const __m256 vo=_mm256_set1_ps(offset), vs=_mm256_set1_ps(step);
+        std::size_t i=0;
+        for(;i+8<=n;i+=8)
+            _mm256_storeu_ps(out+i,_mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(load8(in+i)),vs),vo));
+        dequantize_scalar(in+i,offset,step,out+i,n-i);
+    }
+
+    // AVX-512:
+    //*////////
+
+    /// All lanes. Masked forms avoid false `-Wmaybe-uninitialized` warnings of GCC 12 in unmasked intrinsics.
+    static constexpr __mmask16 all16=0xFFFF;
+
+    WB_TARGET("avx512f")
+    static __m512i codes16(const float* in,__m512 offset,__m512 scale,__m512 lo,__m512 hi) {
+        __m512 s=_mm512_maskz_mul_ps(all16,_mm512_maskz_sub_ps(all16,_mm512_loadu_ps(in),offset),scale);
+        s=_mm512_maskz_min_ps(all16,_mm512_maskz_max_ps(all16,s,lo),hi);
+        return _mm512_maskz_cvtps_epi32(all16,s);
+    }
+
+    // Down conversions truncate, which is exact for clamped codes.
+    WB_TARGET("avx512f")
+    static void store16(__m512i c,std::int8_t* out) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),_mm512_maskz_cvtepi32_epi8(all16,c));
+    }
+
+    WB_TARGET("avx512f")
+    static void store16(__m512i c,std::uint8_t* out) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),_mm512_maskz_cvtepi32_epi8(all16,c));
+    }
+
+    WB_TARGET("avx512f")
+    static void store16(__m512i c,std::int16_t* out) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),_mm512_maskz_cvtepi32_epi16(all16,c));
+    }
+
+    WB_TARGET("avx512f")
+    static void store16(__m512i c,std::uint16_t* out) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),_mm512_maskz_cvtepi32_epi16(all16,c));
+    }
+
+    WB_TARGET("avx512f")
+    static void store16(__m512i c,std::int32_t* out) {
+        _mm512_storeu_si512(out,c);
+    }
+
+    WB_TARGET("avx512f")
+    static __m512 load16(const std::int8_t* in) {
+        __m128i c=_mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        return _mm512_maskz_cvtepi32_ps(all16,_mm512_maskz_cvtepi8_epi32(all16,c));
+    }
+
+    WB_TARGET("avx512f")
+    static __m512 load16(const std::uint8_t* in) {
+        __m128i c=_mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        return _mm512_maskz_cvtepi32_ps(all16,_mm512_maskz_cvtepu8_epi32(all16,c));
+    }
+
+    WB_TARGET("avx512f")
+    static __m512 load16(const std::int16_t* in) {
+        __m256i c=_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+        return _mm512_maskz_cvtepi32_ps(all16,_mm512_maskz_cvtepi16_epi32(all16,c));
+    }
+
+    WB_TARGET("avx512f")
+    static __m512 load16(const std::uint16_t* in) {
+        __m256i c=_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+        return _mm512_maskz_cvtepi32_ps(all16,_mm512_maskz_cvtepu16_epi32(all16,c));
+    }
+
+    WB_TARGET("avx512f")
+    static __m512 load16(const std::int32_t* in) {
+        return _mm512_maskz_cvtepi32_ps(all16,_mm512_loadu_si512(in));
+    }
+
+    WB_TARGET("avx512f")
+    static __m512 load16(const std::uint32_t* in) {
+        return _mm512_maskz_cvtepu32_ps(all16,_mm512_loadu_si512(in));
+    }
+
+    /// `uint32_t` codes need their own conversion, above the range of `int32_t`.
+    WB_TARGET("avx512f")
+    static void quantize_avx512(const float* in,float offset,float scale,float lo,float hi,std::uint32_t* out,
+                                std::size_t n) {
+        const __m512 vo=_mm512_set1_ps(offset), vs=_mm512_set1_ps(scale);
+        const __m512 vl=_mm512_set1_ps(lo),     vh=_mm512_set1_ps(hi);
+        std::size_t i=0;
+        for(;i+16<=n;i+=16) {
+            __m512 s=_mm512_maskz_mul_ps(all16,_mm512_maskz_sub_ps(all16,_mm512_loadu_ps(in+i),vo),vs);
+            s=_mm512_maskz_min_ps(all16,_mm512_maskz_max_ps(all16,s,vl),vh);
+            _mm512_storeu_si512(out+i,_mm512_maskz_cvtps_epu32(all16,s));
+        }
+        quantize_scalar(in+i,offset,scale,lo,hi,out+i,n-i);
+    }
+
+    template<class D>
+    WB_TARGET("avx512f")
+    static void quantize_avx512(const float* in,float offset,float scale,float lo,float hi,D* out,std::size_t n) {
+        const __m512 vo=_mm512_set1_ps(offset), vs=_mm512_set1_ps(scale);
+        const __m512 vl=_mm512_set1_ps(lo),     vh=_mm512_set1_ps(hi);
+        std::size_t i=0;
+        for(;i+16<=n;i+=16) store16(codes16(in+i,vo,vs,vl,vh),out+i);
+        quantize_scalar(in+i,offset,scale,lo,hi,out+i,n-i);
+    }
+
+    template<class D>
+    WB_TARGET("avx512f")
+    static void dequantize_avx512(const D* in,float offset,float step,float* out,std::size_t n) {
+        const __m512 vo=_mm512_set1_ps(offset), vs=_mm512_set1_ps(step);
+        std::size_t i=0;
+        for(;i+16<=n;i+=16)
+            _mm512_storeu_ps(out+i,_mm512_maskz_add_ps(all16,_mm512_maskz_mul_ps(all16,load16(in+i),vs),vo));
+        dequantize_scalar(in+i,offset,step,out+i,n-i);
+    }
+
+#endif // WB_FIX_FLOAT_X86
+
+    // DISPATCH:
+    //*/////////
+
+    template<class D>
+    static void quantize_any(const float* in,float offset,float scale,float lo,float hi,D* out,std::size_t n) {
+#if WB_FIX_FLOAT_X86
+        switch(active()) {
+            case level::avx512: quantize_avx512(in,offset,scale,lo,hi,out,n); return;
+            case level::avx2:
+                if constexpr (!std::is_same_v<D,std::uint32_t>) { quantize_avx2(in,offset,scale,lo,hi,out,n); return; }
+                break;
+            default: break;
+        }
+#endif
+        quantize_scalar(in,offset,scale,lo,hi,out,n);
+    }
+
+    template<class D>
+    static void dequantize_any(const D* in,float offset,float step,float* out,std::size_t n) {
+#if WB_FIX_FLOAT_X86
+        switch(active()) {
+            case level::avx512: dequantize_avx512(in,offset,step,out,n); return;
+            case level::avx2:
+                if constexpr (!std::is_same_v<D,std::uint32_t>) { dequantize_avx2(in,offset,step,out,n); return; }
+                break;
+            default: break;
+        }
+#endif
+        dequantize_scalar(in,offset,step,out,n);
+    }
+
+    void quantize(const float* in,float offset,float scale,float lo,float hi,std::int8_t* out,std::size_t n) {
+        quantize_any(in,offset,scale,lo,hi,out,n);
+    }
+
+    void quantize(const float* in,float offset,float scale,float lo,float hi,std::uint8_t* out,std::size_t n) {
+        quantize_any(in,offset,scale,lo,hi,out,n);
+    }
+
+    void quantize(const float* in,float offset,float scale,float lo,float hi,std::int16_t* out,std::size_t n) {
+        quantize_any(in,offset,scale,lo,hi,out,n);
+    }
+
+    void quantize(const float* in,float offset,float scale,float lo,float hi,std::uint16_t* out,std::size_t n) {
+        quantize_any(in,offset,scale,lo,hi,out,n);
+    }
+
+    void quantize(const float* in,float offset,float scale,float lo,float hi,std::int32_t* out,std::size_t n) {
+        quantize_any(in,offset,scale,lo,hi,out,n);
+    }
+
+    void quantize(const float* in,float offset,float scale,float lo,float hi,std::uint32_t* out,std::size_t n) {
+        quantize_any(in,offset,scale,lo,hi,out,n);
+    }
+
+    void dequantize(const std::int8_t* in,float offset,float step,float* out,std::size_t n) {
+        dequantize_any(in,offset,step,out,n);
+    }
+
+    void dequantize(const std::uint8_t* in,float offset,float step,float* out,std::size_t n) {
+        dequantize_any(in,offset,step,out,n);
+    }
+
+    void dequantize(const std::int16_t* in,float offset,float step,float* out,std::size_t n) {
+        dequantize_any(in,offset,step,out,n);
+    }
+
+    void dequantize(const std::uint16_t* in,float offset,float step,float* out,std::size_t n) {
+        dequantize_any(in,offset,step,out,n);
+    }
+
+    void dequantize(const std::int32_t* in,float offset,float step,float* out,std::size_t n) {
+        dequantize_any(in,offset,step,out,n);
+    }
+
+    void dequantize(const std::uint32_t* in,float offset,float step,float* out,std::size_t n) {
+        dequantize_any(in,offset,step,out,n);
+    }
+}
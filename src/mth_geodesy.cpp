@@ -0,0 +1,396 @@
+/// @date 2026-10-16 (last modification)
+/// Frames and kernels of `mth_geodesy.h`.
+/// Points go through kernels in blocks of `lanes`, every step a loop over the block, so the compiler keeps a block
+/// in SIMD registers. The rest of fewer than `lanes` points goes through the same steps one point at a time, so
+/// a single position pays for a single point. Sine, cosine and arcus tangent are polynomials without branches
+/// (Cephes coefficients, within 2 ulp), geodetic latitude is Bowring's iteration on tangents with a single `atan2`
+/// at the end. Every kernel is compiled for the baseline instruction set and for AVX2 with FMA, chosen by
+/// `simd::active()`.
+/// Rounding relies on IEEE arithmetic, so do not build this file with `-ffast-math`. It is built with
+/// `-fno-math-errno -fno-trapping-math` instead (see `CMakeLists.txt`): otherwise every `sqrt` and every choice
+/// between two values is a branch, and blocks stay scalar.
+///
+#include "mth_geodesy.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#   define WB_GEODESY_X86 1
+#   define WB_TARGET(ISA) __attribute__((target(ISA)))
+#else
+#   define WB_GEODESY_X86 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define WB_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#   define WB_ALWAYS_INLINE inline
+#endif
+
+namespace merry_tools::math {
+
+    namespace {
+        constexpr std::size_t lanes=8;                  //!< Points in a block, two AVX2 registers of `double`.
+        constexpr double      pi=3.14159265358979323846;
+        constexpr double      seconds_per_day=86400.0;
+        constexpr double      astronomical_unit=1.495978707e11;
+        constexpr double      degree=pi/180;
+
+        /// @brief Rounds to the nearest integer, exact for |v|<2^51. `nearbyint` is a call below SSE4.1.
+        WB_ALWAYS_INLINE double round_near(double v) {
+            constexpr double magic=6755399441055744.0;  // 1.5*2^52
+            return (v+magic)-magic;
+        }
+
+        WB_ALWAYS_INLINE void sin_cos(double x,double& s,double& c) {
+            const double q=round_near(x*(2/pi));
+            const double r=((x-q*1.57079625129699707031)-q*7.54978941586159635336e-8)-q*5.39030285815811905290e-15;
+            const double z=r*r;
+            const double sr=r+r*z*(((((1.58962301576546568060e-10*z-2.50507477628578072866e-8)*z
+                                      +2.75573136213857245213e-6)*z-1.98412698295895385996e-4)*z
+                                      +8.33333333332211858878e-3)*z-1.66666666666666307295e-1);
+            const double cr=1-0.5*z+z*z*(((((-1.13585365213876817300e-11*z+2.08757008419747316778e-9)*z
+                                            -2.75573141792967388112e-7)*z+2.48015872888517045348e-5)*z
+                                            -1.38888888888730564116e-3)*z+4.16666666666665929218e-2);
+            const double m=q-4*round_near(q*0.25);     // Quadrant: 0, 1, -1, or 2 as well as -2.
+            const double u=m*m;                        // Sine and cosine of m*pi/2 by exact polynomials, no selects.
+            const double cq=(u-1)*(u-4)/4-u*(u-1)/12;
+            const double sq=m*(4-u)/3;
+            s=sr*cq+cr*sq;
+            c=cr*cq-sr*sq;
+        }
+
+        // Both sides of every choice below are computed, so that the compiler may select them in SIMD registers.
+
+        /// @brief Arcus tangent of `t` from [0,1].
+        WB_ALWAYS_INLINE double atan_unit(double t) {
+            const bool   big=t>0.66;
+            const double reduced=(t-1)/(t+1);
+            const double x=big?reduced:t;
+            const double z=x*x;
+            const double p=(((-8.750608600031904122785e-1*z-1.615753718733365076637e1)*z-7.500855792314704667340e1)*z
+                            -1.228866684490136173410e2)*z-6.485021904942025371773e1;
+            const double q=((((z+2.485846490142306297962e1)*z+1.650270098316988542046e2)*z+4.328810604912902668951e2)*z
+                            +4.853903996359136964868e2)*z+1.945506571482613964425e2;
+            const double r=x+x*z*p/q;
+            const double shifted=(pi/4+3.061616997868382943065e-17)+r;
+            return big?shifted:r;
+        }
+
+        WB_ALWAYS_INLINE double atan_2(double y,double x) {
+            const double ax=std::fabs(x),ay=std::fabs(y);
+            const double most=std::max(ax,ay),least=std::min(ax,ay);
+            const double ratio=least/most;
+            const double a=atan_unit(most>0?ratio:0);
+            const double b=ay>ax?pi/2-a:a;
+            const double c=x<0?pi-b:b;
+            return std::copysign(c,y);
+        }
+
+        // BLOCKS:
+        //*///////
+        // Input and output are `W` triples, `lanes` of them in whole blocks, a single one in the rest.
+
+        template<std::size_t W>
+        WB_ALWAYS_INLINE void geo_to_earth_block(const double* in,double* out,const ellipsoid& shape) {
+            const double a=shape.a,e2=shape.e2();
+            double sin_lat[W],cos_lat[W],sin_lon[W],cos_lon[W],h[W];
+            for(std::size_t k=0;k<W;k++) {
+                sin_cos(in[3*k],sin_lat[k],cos_lat[k]);
+                sin_cos(in[3*k+1],sin_lon[k],cos_lon[k]);
+                h[k]=in[3*k+2];
+            }
+            for(std::size_t k=0;k<W;k++) {
+                const double n=a/std::sqrt(1-e2*sin_lat[k]*sin_lat[k]);     // Prime vertical radius.
+                out[3*k]  =(n+h[k])*cos_lat[k]*cos_lon[k];
+                out[3*k+1]=(n+h[k])*cos_lat[k]*sin_lon[k];
+                out[3*k+2]=(n*(1-e2)+h[k])*sin_lat[k];
+            }
+        }
+
+        template<std::size_t W>
+        WB_ALWAYS_INLINE void earth_to_geo_block(const double* in,double* out,const ellipsoid& shape) {
+            const double a=shape.a,b=shape.b(),e2=shape.e2(),ep2=e2/(1-e2);
+            double x[W],y[W],z[W],p[W],num[W],den[W];
+            for(std::size_t k=0;k<W;k++) {
+                x[k]=in[3*k]; y[k]=in[3*k+1]; z[k]=in[3*k+2];
+                p[k]=std::sqrt(x[k]*x[k]+y[k]*y[k]);
+                num[k]=a*z[k];                          // Tangent of the parametric latitude of a surface point.
+                den[k]=b*p[k];
+            }
+            for(int iteration=0;iteration<3;iteration++)
+                for(std::size_t k=0;k<W;k++) {
+                    const double r=std::sqrt(num[k]*num[k]+den[k]*den[k]);
+                    const double sb=num[k]/r,cb=den[k]/r;
+                    const double n=z[k]+ep2*b*sb*sb*sb;     // Tangent of the geodetic latitude is n/d.
+                    const double d=p[k]-e2*a*cb*cb*cb;
+                    num[k]=b*n;                            // Parametric from geodetic: tan(beta)=(b/a)*tan(phi).
+                    den[k]=a*d;
+                }
+            for(std::size_t k=0;k<W;k++) {
+                const double n=num[k]/b,d=den[k]/a;
+                const double r=std::sqrt(n*n+d*d);
+                const double s=n/r,c=d/r;
+                out[3*k]  =atan_2(n,d);
+                out[3*k+1]=atan_2(y[k],x[k]);
+                out[3*k+2]=p[k]*c+z[k]*s-a*std::sqrt(1-e2*s*s);
+            }
+        }
+
+        template<std::size_t W,class OUT>
+        WB_ALWAYS_INLINE void to_frame_block(const double* in,OUT* out,const detail::rigid_transform& t) {
+            const double* m=t.rot;
+            for(std::size_t k=0;k<W;k++) {
+                const double x=in[3*k]-t.shift[0],y=in[3*k+1]-t.shift[1],z=in[3*k+2]-t.shift[2];
+                out[3*k]  =OUT(m[0]*x+m[1]*y+m[2]*z);
+                out[3*k+1]=OUT(m[3]*x+m[4]*y+m[5]*z);
+                out[3*k+2]=OUT(m[6]*x+m[7]*y+m[8]*z);
+            }
+        }
+
+        template<std::size_t W,class IN>
+        WB_ALWAYS_INLINE void from_frame_block(const IN* in,double* out,const detail::rigid_transform& t) {
+            const double* m=t.rot;
+            for(std::size_t k=0;k<W;k++) {
+                const double x=in[3*k],y=in[3*k+1],z=in[3*k+2];
+                out[3*k]  =m[0]*x+m[3]*y+m[6]*z+t.shift[0];
+                out[3*k+1]=m[1]*x+m[4]*y+m[7]*z+t.shift[1];
+                out[3*k+2]=m[2]*x+m[5]*y+m[8]*z+t.shift[2];
+            }
+        }
+
+        /// @brief Kernels as objects, so one driver runs them for every instruction set.
+        struct geo_to_earth_op {
+            const ellipsoid& shape;
+            template<std::size_t W>
+            WB_ALWAYS_INLINE void block(const double* in,double* out) const { geo_to_earth_block<W>(in,out,shape); }
+        };
+
+        struct earth_to_geo_op {
+            const ellipsoid& shape;
+            template<std::size_t W>
+            WB_ALWAYS_INLINE void block(const double* in,double* out) const { earth_to_geo_block<W>(in,out,shape); }
+        };
+
+        struct to_frame_op {
+            const detail::rigid_transform& t;
+            template<std::size_t W,class OUT>
+            WB_ALWAYS_INLINE void block(const double* in,OUT* out) const { to_frame_block<W>(in,out,t); }
+        };
+
+        struct from_frame_op {
+            const detail::rigid_transform& t;
+            template<std::size_t W,class IN>
+            WB_ALWAYS_INLINE void block(const IN* in,double* out) const { from_frame_block<W>(in,out,t); }
+        };
+
+        struct geo_to_frame_op {
+            const ellipsoid&               shape;
+            const detail::rigid_transform& t;
+            template<std::size_t W,class OUT>
+            WB_ALWAYS_INLINE void block(const double* in,OUT* out) const {
+                double earth[3*W];
+                geo_to_earth_block<W>(in,earth,shape);
+                to_frame_block<W>(earth,out,t);
+            }
+        };
+
+        struct frame_to_geo_op {
+            const ellipsoid&               shape;
+            const detail::rigid_transform& t;
+            template<std::size_t W,class IN>
+            WB_ALWAYS_INLINE void block(const IN* in,double* out) const {
+                double earth[3*W];
+                from_frame_block<W>(in,earth,t);
+                earth_to_geo_block<W>(earth,out,shape);
+            }
+        };
+
+        /// @brief Whole blocks in place, the rest point by point, so a single position costs a single point.
+        template<class IN,class OUT,class OP>
+        WB_ALWAYS_INLINE void by_blocks(const IN* in,OUT* out,std::size_t n,const OP& op) {
+            std::size_t i=0;
+            for(;i+lanes<=n;i+=lanes) op.template block<lanes>(in+3*i,out+3*i);
+            for(;i<n;i++) op.template block<1>(in+3*i,out+3*i);
+        }
+
+        template<class IN,class OUT,class OP>
+        void run_baseline(const IN* in,OUT* out,std::size_t n,const OP& op) { by_blocks(in,out,n,op); }
+
+#if WB_GEODESY_X86
+        template<class IN,class OUT,class OP>
+        WB_TARGET("avx2,fma")
+        void run_avx2(const IN* in,OUT* out,std::size_t n,const OP& op) { by_blocks(in,out,n,op); }
+#endif
+
+        template<class IN,class OUT,class OP>
+        void run(const IN* in,OUT* out,std::size_t n,const OP& op) {
+#if WB_GEODESY_X86
+            if(simd::active()>=simd::level::avx2) return run_avx2(in,out,n,op);
+#endif
+            run_baseline(in,out,n,op);
+        }
+
+        /// @brief Rotation about `z` by `angle`, then about `x` by `tilt`, both of axes, as rows.
+        void rotation_zx(double angle,double tilt,double* rot) {
+            const double ca=std::cos(angle),sa=std::sin(angle),ct=std::cos(tilt),st=std::sin(tilt);
+            const double r[9]={ ca,     sa,    0,
+                               -sa*ct,  ca*ct, st,
+                                sa*st, -ca*st, ct };
+            std::copy(r,r+9,rot);
+        }
+    }
+
+    // RAW KERNELS:
+    //*////////////
+
+    namespace detail {
+        void geo_to_earth(const double* in,double* out,std::size_t n,const ellipsoid& shape) {
+            run(in,out,n,geo_to_earth_op{shape});
+        }
+
+        void earth_to_geo(const double* in,double* out,std::size_t n,const ellipsoid& shape) {
+            run(in,out,n,earth_to_geo_op{shape});
+        }
+
+        void to_frame(const double* in,double* out,std::size_t n,const rigid_transform& t) {
+            run(in,out,n,to_frame_op{t});
+        }
+
+        void to_frame(const double* in,float* out,std::size_t n,const rigid_transform& t) {
+            run(in,out,n,to_frame_op{t});
+        }
+
+        void from_frame(const double* in,double* out,std::size_t n,const rigid_transform& t) {
+            run(in,out,n,from_frame_op{t});
+        }
+
+        void from_frame(const float* in,double* out,std::size_t n,const rigid_transform& t) {
+            run(in,out,n,from_frame_op{t});
+        }
+
+        void geo_to_frame(const double* in,double* out,std::size_t n,const ellipsoid& shape,const rigid_transform& t) {
+            run(in,out,n,geo_to_frame_op{shape,t});
+        }
+
+        void geo_to_frame(const double* in,float* out,std::size_t n,const ellipsoid& shape,const rigid_transform& t) {
+            run(in,out,n,geo_to_frame_op{shape,t});
+        }
+
+        void frame_to_geo(const double* in,double* out,std::size_t n,const ellipsoid& shape,const rigid_transform& t) {
+            run(in,out,n,frame_to_geo_op{shape,t});
+        }
+
+        void frame_to_geo(const float* in,double* out,std::size_t n,const ellipsoid& shape,const rigid_transform& t) {
+            run(in,out,n,frame_to_geo_op{shape,t});
+        }
+    }
+
+    // FRAMES:
+    //*///////
+
+    local_frame::local_frame(const GeoPosition& origin,const ellipsoid& shape)
+        :origin_(origin),earth_(to_earth(origin,shape)),shape_(shape),transform_{} {
+        // East, north and up: about `z` to the meridian, then about `x` by the colatitude.
+        rotation_zx(origin.lon.val.value+pi/2,pi/2-origin.lat.val.value,transform_.rot);
+        transform_.shift[0]=earth_.x.val.value;
+        transform_.shift[1]=earth_.y.val.value;
+        transform_.shift[2]=earth_.z.val.value;
+    }
+
+    solar_frame::solar_frame(const TimeSI64& since_j2000)
+        :moment_(since_j2000),earth_{Scalar<Solar_x,DistSI64>{0.0},Scalar<Solar_y,DistSI64>{0.0},
+                                     Scalar<Solar_z,DistSI64>{0.0}},transform_{} {
+        const double days=since_j2000.value/seconds_per_day;
+        // Mean elements of the Sun seen from the Earth (Astronomical Almanac), the Earth is on the other side.
+        // Longitudes are taken back from the equinox of the date to the one of J2000, by the general precession.
+        const double mean_longitude=(280.460+0.9856474*days-3.8247e-5*days)*degree;
+        const double anomaly=(357.528+0.9856003*days)*degree;
+        const double longitude=mean_longitude+(1.915*std::sin(anomaly)+0.020*std::sin(2*anomaly))*degree;
+        const double distance=(1.00014-0.01671*std::cos(anomaly)-0.00014*std::cos(2*anomaly))*astronomical_unit;
+        earth_=SolarPosition{Scalar<Solar_x,DistSI64>{-distance*std::cos(longitude)},
+                             Scalar<Solar_y,DistSI64>{-distance*std::sin(longitude)},Scalar<Solar_z,DistSI64>{0.0}};
+
+        // Earth rotation angle, then the obliquity of the ecliptic. Rows of `to_solar` are `Solar` axes in ECEF.
+        const double rotation=2*pi*std::fmod(0.7790572732640+1.00273781191135448*days,1.0);
+        const double obliquity=23.439291*degree;
+        double to_solar[9];
+        rotation_zx(-rotation,obliquity,to_solar);
+        std::copy(to_solar,to_solar+9,transform_.rot);
+        // solar=rot*ecef+earth, so the origin of `Solar` in ECEF is -transposed(rot)*earth.
+        const double e[3]={earth_.x.val.value,earth_.y.val.value,earth_.z.val.value};
+        for(int c=0;c<3;c++) transform_.shift[c]=-(to_solar[c]*e[0]+to_solar[3+c]*e[1]+to_solar[6+c]*e[2]);
+    }
+
+    // SINGLE POSITIONS:
+    //*/////////////////
+
+    namespace {
+        const double* values(const GeoPosition& p) { return &p.lat.val.value; }
+        double*       values(GeoPosition& p)       { return &p.lat.val.value; }
+
+        template<class VEC>
+        const double* values(const VEC& p) { return &p.x.val.value; }
+
+        template<class VEC>
+        double* values(VEC& p) { return &p.x.val.value; }
+
+        const GeoPosition      no_geo{GeoLatitude{AngleSI64{0.0}},GeoLongitude{AngleSI64{0.0}},
+                                      GeoHeight{DistSI64{0.0}}};
+        const EarthPosition    no_earth{Scalar<Earth_x,DistSI64>{0.0},Scalar<Earth_y,DistSI64>{0.0},
+                                        Scalar<Earth_z,DistSI64>{0.0}};
+        const SolarPosition    no_solar{Scalar<Solar_x,DistSI64>{0.0},Scalar<Solar_y,DistSI64>{0.0},
+                                        Scalar<Solar_z,DistSI64>{0.0}};
+        const VolumePosition64 no_local{Scalar<Along,DistSI64>{0.0},Scalar<Across,DistSI64>{0.0},
+                                        Scalar<Upward,DistSI64>{0.0}};
+    }
+
+    EarthPosition to_earth(const GeoPosition& p,const ellipsoid& shape) {
+        EarthPosition out=no_earth;
+        detail::geo_to_earth(values(p),values(out),1,shape);
+        return out;
+    }
+
+    GeoPosition to_geo(const EarthPosition& p,const ellipsoid& shape) {
+        GeoPosition out=no_geo;
+        detail::earth_to_geo(values(p),values(out),1,shape);
+        return out;
+    }
+
+    VolumePosition64 to_local(const EarthPosition& p,const local_frame& frame) {
+        VolumePosition64 out=no_local;
+        detail::to_frame(values(p),values(out),1,frame.transform());
+        return out;
+    }
+
+    VolumePosition64 to_local(const GeoPosition& p,const local_frame& frame) {
+        VolumePosition64 out=no_local;
+        detail::geo_to_frame(values(p),values(out),1,frame.shape(),frame.transform());
+        return out;
+    }
+
+    EarthPosition to_earth(const VolumePosition64& p,const local_frame& frame) {
+        EarthPosition out=no_earth;
+        detail::from_frame(values(p),values(out),1,frame.transform());
+        return out;
+    }
+
+    GeoPosition to_geo(const VolumePosition64& p,const local_frame& frame) {
+        GeoPosition out=no_geo;
+        detail::frame_to_geo(values(p),values(out),1,frame.shape(),frame.transform());
+        return out;
+    }
+
+    SolarPosition to_solar(const EarthPosition& p,const solar_frame& frame) {
+        SolarPosition out=no_solar;
+        detail::to_frame(values(p),values(out),1,frame.transform());
+        return out;
+    }
+
+    EarthPosition to_earth(const SolarPosition& p,const solar_frame& frame) {
+        EarthPosition out=no_earth;
+        detail::from_frame(values(p),values(out),1,frame.transform());
+        return out;
+    }
+}
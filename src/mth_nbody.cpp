@@ -0,0 +1,365 @@
+/// @date 2026-10-16 (last modification)
+/// Kernels of `mth_nbody.h`: SIMD tiles of pair forces at the level of `simd::active()`, the direct sum over them
+/// and the Barnes-Hut octree, whose groups of bodies collect interaction lists for the same tiles.
+///
+#include "mth_nbody.h"
+#include "mth_vec_batch.h"
+#include "mth_spatial.h"
+#include "flw_parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#   define WB_NBODY_X86 1
+#   include <immintrin.h>
+#   define WB_TARGET(ISA) __attribute__((target(ISA)))
+#else
+#   define WB_NBODY_X86 0
+#endif
+
+namespace merry_tools::math::detail {
+
+    // TILES OF PAIR FORCES:
+    //*/////////////////////
+    // a[i]+=sum of gm[j]*(s[j]-t[i])/(|s[j]-t[i]|^2+eps2)^1.5 for `nt` targets and all sources of `s`.
+    // Targets go in SIMD registers, sources are broadcast one by one. Zero distances add nothing.
+
+    typedef void (*tile_kernel)(const float* tx,const float* ty,const float* tz,std::size_t nt,
+                                const gravity_bodies& s,float eps2,float* ax,float* ay,float* az);
+
+    static void tile_scalar(const float* tx,const float* ty,const float* tz,std::size_t nt,const gravity_bodies& s,
+                            float eps2,float* ax,float* ay,float* az) {
+        for(std::size_t i=0;i<nt;i++) {
+            float sx=0,sy=0,sz=0;
+            for(std::size_t j=0;j<s.n;j++) {
+                const float dx=s.x[j]-tx[i],dy=s.y[j]-ty[i],dz=s.z[j]-tz[i];
+                const float r2=dx*dx+dy*dy+dz*dz+eps2;
+                if(!(r2>0)) continue;
+                const float r=1/std::sqrt(r2),w=s.gm[j]*r*r*r;
+                sx+=dx*w; sy+=dy*w; sz+=dz*w;
+            }
+            ax[i]+=sx; ay[i]+=sy; az[i]+=sz;
+        }
+    }
+
+#if WB_NBODY_X86
+
+    /// 1/r^3 from r^2, by a reciprocal square root and a Newton step. 0 for r^2 of 0.
+    WB_TARGET("sse2")
+    static __m128 inverse_cube_sse(__m128 r2) {
+        const __m128 live=_mm_cmpgt_ps(r2,_mm_setzero_ps());
+        __m128 r=_mm_rsqrt_ps(r2);
+        r=_mm_mul_ps(r,_mm_sub_ps(_mm_set1_ps(1.5f),_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f),r2),_mm_mul_ps(r,r))));
+        return _mm_and_ps(_mm_mul_ps(r,_mm_mul_ps(r,r)),live);
+    }
+
+    WB_TARGET("sse2")
+    static void tile_sse(const float* tx,const float* ty,const float* tz,std::size_t nt,const gravity_bodies& s,
+                         float eps2,float* ax,float* ay,float* az) {
+        const __m128 e=_mm_set1_ps(eps2);
+        std::size_t i=0;
+        for(;i+4<=nt;i+=4) {
+            const __m128 px=_mm_loadu_ps(tx+i),py=_mm_loadu_ps(ty+i),pz=_mm_loadu_ps(tz+i);
+            __m128 sx=_mm_setzero_ps(),sy=sx,sz=sx;
+            for(std::size_t j=0;j<s.n;j++) {
+                const __m128 dx=_mm_sub_ps(_mm_set1_ps(s.x[j]),px);
+                const __m128 dy=_mm_sub_ps(_mm_set1_ps(s.y[j]),py);
+                const __m128 dz=_mm_sub_ps(_mm_set1_ps(s.z[j]),pz);
+                const __m128 r2=_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx,dx),_mm_mul_ps(dy,dy)),
+                                           _mm_add_ps(_mm_mul_ps(dz,dz),e));
+                const __m128 w=_mm_mul_ps(_mm_set1_ps(s.gm[j]),inverse_cube_sse(r2));
+                sx=_mm_add_ps(sx,_mm_mul_ps(dx,w));
+                sy=_mm_add_ps(sy,_mm_mul_ps(dy,w));
+                sz=_mm_add_ps(sz,_mm_mul_ps(dz,w));
+            }
+            _mm_storeu_ps(ax+i,_mm_add_ps(_mm_loadu_ps(ax+i),sx));
+            _mm_storeu_ps(ay+i,_mm_add_ps(_mm_loadu_ps(ay+i),sy));
+            _mm_storeu_ps(az+i,_mm_add_ps(_mm_loadu_ps(az+i),sz));
+        }
+        tile_scalar(tx+i,ty+i,tz+i,nt-i,s,eps2,ax+i,ay+i,az+i);
+    }
+
+    WB_TARGET("avx2,fma")
+    static __m256 inverse_cube_avx2(__m256 r2) {
+        const __m256 live=_mm256_cmp_ps(r2,_mm256_setzero_ps(),_CMP_GT_OQ);
+        __m256 r=_mm256_rsqrt_ps(r2);
+        const __m256 h=_mm256_mul_ps(_mm256_set1_ps(0.5f),r2);
+        r=_mm256_mul_ps(r,_mm256_fnmadd_ps(_mm256_mul_ps(h,r),r,_mm256_set1_ps(1.5f)));
+        return _mm256_and_ps(_mm256_mul_ps(r,_mm256_mul_ps(r,r)),live);
+    }
+
+    WB_TARGET("avx2,fma")
+    static void tile_avx2(const float* tx,const float* ty,const float* tz,std::size_t nt,const gravity_bodies& s,
+                          float eps2,float* ax,float* ay,float* az) {
+        const __m256 e=_mm256_set1_ps(eps2);
+        std::size_t i=0;
+        for(;i+8<=nt;i+=8) {
+            const __m256 px=_mm256_loadu_ps(tx+i),py=_mm256_loadu_ps(ty+i),pz=_mm256_loadu_ps(tz+i);
+            __m256 sx=_mm256_setzero_ps(),sy=sx,sz=sx;
+            for(std::size_t j=0;j<s.n;j++) {
+                const __m256 dx=_mm256_sub_ps(_mm256_broadcast_ss(s.x+j),px);
+                const __m256 dy=_mm256_sub_ps(_mm256_broadcast_ss(s.y+j),py);
+                const __m256 dz=_mm256_sub_ps(_mm256_broadcast_ss(s.z+j),pz);
+                const __m256 r2=_mm256_fmadd_ps(dx,dx,_mm256_fmadd_ps(dy,dy,_mm256_fmadd_ps(dz,dz,e)));
+                const __m256 w=_mm256_mul_ps(_mm256_broadcast_ss(s.gm+j),inverse_cube_avx2(r2));
+                sx=_mm256_fmadd_ps(dx,w,sx); sy=_mm256_fmadd_ps(dy,w,sy); sz=_mm256_fmadd_ps(dz,w,sz);
+            }
+            _mm256_storeu_ps(ax+i,_mm256_add_ps(_mm256_loadu_ps(ax+i),sx));
+            _mm256_storeu_ps(ay+i,_mm256_add_ps(_mm256_loadu_ps(ay+i),sy));
+            _mm256_storeu_ps(az+i,_mm256_add_ps(_mm256_loadu_ps(az+i),sz));
+        }
+        tile_sse(tx+i,ty+i,tz+i,nt-i,s,eps2,ax+i,ay+i,az+i);
+    }
+
+    WB_TARGET("avx512f")
+    static __m512 inverse_cube_avx512(__m512 r2) {
+        const __mmask16 live=_mm512_cmp_ps_mask(r2,_mm512_setzero_ps(),_CMP_GT_OQ);
+        __m512 r=_mm512_maskz_rsqrt14_ps(live,r2);                // Masked form, as GCC 12 warns about the other.
+        const __m512 h=_mm512_mul_ps(_mm512_set1_ps(0.5f),r2);
+        r=_mm512_mul_ps(r,_mm512_fnmadd_ps(_mm512_mul_ps(h,r),r,_mm512_set1_ps(1.5f)));
+        return _mm512_mul_ps(r,_mm512_mul_ps(r,r));
+    }
+
+    /// A block of up to 16 targets, `m` marks valid ones.
+    WB_TARGET("avx512f")
+    static void tile_block_avx512(const float* tx,const float* ty,const float* tz,const gravity_bodies& s,__m512 e,
+                                  float* ax,float* ay,float* az,__mmask16 m) {
+        const __m512 px=_mm512_maskz_loadu_ps(m,tx),py=_mm512_maskz_loadu_ps(m,ty),pz=_mm512_maskz_loadu_ps(m,tz);
+        __m512 sx=_mm512_setzero_ps(),sy=sx,sz=sx;
+        for(std::size_t j=0;j<s.n;j++) {
+            const __m512 dx=_mm512_sub_ps(_mm512_set1_ps(s.x[j]),px);
+            const __m512 dy=_mm512_sub_ps(_mm512_set1_ps(s.y[j]),py);
+            const __m512 dz=_mm512_sub_ps(_mm512_set1_ps(s.z[j]),pz);
+            const __m512 r2=_mm512_fmadd_ps(dx,dx,_mm512_fmadd_ps(dy,dy,_mm512_fmadd_ps(dz,dz,e)));
+            const __m512 w=_mm512_mul_ps(_mm512_set1_ps(s.gm[j]),inverse_cube_avx512(r2));
+            sx=_mm512_fmadd_ps(dx,w,sx); sy=_mm512_fmadd_ps(dy,w,sy); sz=_mm512_fmadd_ps(dz,w,sz);
+        }
+        _mm512_mask_storeu_ps(ax,m,_mm512_add_ps(_mm512_maskz_loadu_ps(m,ax),sx));
+        _mm512_mask_storeu_ps(ay,m,_mm512_add_ps(_mm512_maskz_loadu_ps(m,ay),sy));
+        _mm512_mask_storeu_ps(az,m,_mm512_add_ps(_mm512_maskz_loadu_ps(m,az),sz));
+    }
+
+    WB_TARGET("avx512f")
+    static void tile_avx512(const float* tx,const float* ty,const float* tz,std::size_t nt,const gravity_bodies& s,
+                            float eps2,float* ax,float* ay,float* az) {
+        const __m512 e=_mm512_set1_ps(eps2);
+        std::size_t i=0;
+        for(;i+16<=nt;i+=16) tile_block_avx512(tx+i,ty+i,tz+i,s,e,ax+i,ay+i,az+i,0xFFFF);
+        if(i<nt) tile_block_avx512(tx+i,ty+i,tz+i,s,e,ax+i,ay+i,az+i,static_cast<__mmask16>((1u<<(nt-i))-1u));
+    }
+
+#endif // WB_NBODY_X86
+
+    static tile_kernel tile_for(simd::level l) {
+#if WB_NBODY_X86
+        switch(l) {
+            case simd::level::scalar: return tile_scalar;
+            case simd::level::sse:    return tile_sse;
+            case simd::level::avx2:   return tile_avx2;
+            case simd::level::avx512: return tile_avx512;
+        }
+#endif
+        (void)l;
+        return tile_scalar;
+    }
+
+    // DIRECT SUM:
+    //*///////////
+
+    /// Sources of a tile stay in L1 while all targets of a chunk pass by.
+    static constexpr std::size_t tile_size=1024;
+
+    void direct_gravity(const gravity_bodies& b,float eps2,const gravity_out& out,std::size_t min_chunk,
+                        unsigned threads) {
+        const tile_kernel tile=tile_for(simd::active());
+        flow::parallel_for(b.n,std::max<std::size_t>(min_chunk,1),[&](std::size_t first,std::size_t last) {
+            std::fill(out.x+first,out.x+last,0.f);
+            std::fill(out.y+first,out.y+last,0.f);
+            std::fill(out.z+first,out.z+last,0.f);
+            for(std::size_t t=0;t<b.n;t+=tile_size) {
+                const gravity_bodies s{b.x+t,b.y+t,b.z+t,b.gm+t,std::min(tile_size,b.n-t)};
+                tile(b.x+first,b.y+first,b.z+first,last-first,s,eps2,out.x+first,out.y+first,out.z+first);
+            }
+        },threads);
+    }
+
+    // BARNES-HUT TREE:
+    //*////////////////
+
+    static constexpr int           morton_bits=21;
+    static constexpr std::uint64_t octants=8;
+
+    void gravity_tree::build(const gravity_bodies& b,float theta,std::size_t leaf_size,std::size_t group_size,
+                             std::size_t min_chunk,unsigned threads) {
+        const std::size_t n=b.n;                             assert(n<std::numeric_limits<std::uint32_t>::max());
+        tree.clear(); leaf_nodes.clear(); group_nodes.clear();
+        keys.resize(n); x.resize(n); y.resize(n); z.resize(n); gm.resize(n);
+        if(n==0) return;
+        leaf_size=std::max<std::size_t>(leaf_size,1);
+        group_size=std::max(group_size,leaf_size);
+        min_chunk=std::max<std::size_t>(min_chunk,1);
+
+        // Morton codes within the bounding box, then bodies in their order.
+        const float* cols[3]={b.x,b.y,b.z};
+        double lo[3],scale[3];
+        const double cells=double((std::uint64_t(1)<<morton_bits)-1);
+        for(std::size_t a=0;a<3;a++) {
+            const auto mm=std::minmax_element(cols[a],cols[a]+n);
+            lo[a]=*mm.first;
+            scale[a]=*mm.second>*mm.first?cells/(double(*mm.second)-lo[a]):0;
+        }
+        flow::parallel_for(n,min_chunk,[&](std::size_t first,std::size_t last) {
+            for(std::size_t i=first;i<last;i++) {
+                std::uint64_t code=0;
+                for(std::size_t a=0;a<3;a++)
+                    code|=spread_by_3(static_cast<std::uint64_t>((double(cols[a][i])-lo[a])*scale[a]))<<a;
+                keys[i]={code,static_cast<std::uint32_t>(i)};
+            }
+        },threads);
+        flow::parallel_sort(keys.begin(),keys.end(),std::less<>{},min_chunk*16,threads);
+        flow::parallel_for(n,min_chunk,[&](std::size_t first,std::size_t last) {
+            for(std::size_t k=first;k<last;k++) {
+                const std::uint32_t i=keys[k].second;
+                x[k]=b.x[i]; y[k]=b.y[i]; z[k]=b.z[i]; gm[k]=b.gm[i];
+            }
+        },threads);
+
+        // Nodes breadth first over ranges of codes, levels with a single child are skipped.
+        tree.push_back(node{0,static_cast<std::uint32_t>(n),0,0,{},{},{},0,0});
+        std::vector<int>           level{morton_bits-1};
+        std::vector<std::uint32_t> parent{0};
+        for(std::size_t q=0;q<tree.size();q++) {
+            const std::uint32_t first=tree[q].begin,last=tree[q].end;
+            if(last-first<=group_size && (q==0 || tree[parent[q]].end-tree[parent[q]].begin>group_size))
+                group_nodes.push_back(static_cast<std::uint32_t>(q));
+            if(last-first<=leaf_size) { leaf_nodes.push_back(static_cast<std::uint32_t>(q)); continue; }
+            std::uint32_t split[octants+1];
+            int l=level[q];
+            for(;l>=0;l--) {
+                const unsigned shift=unsigned(l)*3;
+                split[0]=first;
+                for(std::uint64_t o=0;o<octants;o++)
+                    split[o+1]=static_cast<std::uint32_t>(std::partition_point(keys.begin()+split[o],keys.begin()+last,
+                        [&](const auto& k) { return ((k.first>>shift)&(octants-1))<=o; })-keys.begin());
+                std::size_t used=0;
+                for(std::uint64_t o=0;o<octants;o++) used+=split[o]!=split[o+1];
+                if(used>1) break;
+            }
+            if(l<0) {                                                                     // Equal positions only.
+                leaf_nodes.push_back(static_cast<std::uint32_t>(q));
+                if(last-first>group_size) group_nodes.push_back(static_cast<std::uint32_t>(q));
+                continue;
+            }
+            tree[q].first_child=static_cast<std::uint32_t>(tree.size());
+            for(std::uint64_t o=0;o<octants;o++) {
+                if(split[o]==split[o+1]) continue;
+                tree.push_back(node{split[o],split[o+1],0,0,{},{},{},0,0});
+                level.push_back(l-1);
+                parent.push_back(static_cast<std::uint32_t>(q));
+                tree[q].children++;
+            }
+        }
+        moments(theta,min_chunk,threads);
+    }
+
+    /// Boxes, masses and centres of mass of leaves on all cores, then of inner nodes from their children.
+    /// A node is opened within `size/theta` plus the offset of the centre of mass from the centre of its box.
+    void gravity_tree::moments(float theta,std::size_t min_chunk,unsigned threads) {
+        auto finish=[theta](node& nd,const double (&sum)[3],double mass) {
+            float offset2=0,size=0;
+            for(std::size_t a=0;a<3;a++) {
+                const float centre=0.5f*(nd.lo[a]+nd.hi[a]);
+                nd.c[a]=mass!=0?static_cast<float>(sum[a]/mass):centre;
+                offset2+=(nd.c[a]-centre)*(nd.c[a]-centre);
+                size=std::max(size,nd.hi[a]-nd.lo[a]);
+            }
+            nd.gm=static_cast<float>(mass);
+            const float r=theta>0?size/theta+std::sqrt(offset2):std::numeric_limits<float>::infinity();
+            nd.open2=r*r;
+        };
+        const float* cols[3]={x.data(),y.data(),z.data()};
+        const std::size_t chunk=std::max<std::size_t>(1,min_chunk*leaf_nodes.size()/keys.size());
+        flow::parallel_for(leaf_nodes.size(),chunk,[&](std::size_t first,std::size_t last) {
+            for(std::size_t l=first;l<last;l++) {
+                node& nd=tree[leaf_nodes[l]];
+                double sum[3]={0,0,0},mass=0;
+                for(std::size_t a=0;a<3;a++) {
+                    nd.lo[a]=std::numeric_limits<float>::max();
+                    nd.hi[a]=std::numeric_limits<float>::lowest();
+                    for(std::uint32_t k=nd.begin;k<nd.end;k++) {
+                        nd.lo[a]=std::min(nd.lo[a],cols[a][k]); nd.hi[a]=std::max(nd.hi[a],cols[a][k]);
+                        sum[a]+=double(gm[k])*cols[a][k];
+                    }
+                }
+                for(std::uint32_t k=nd.begin;k<nd.end;k++) mass+=gm[k];
+                finish(nd,sum,mass);
+            }
+        },threads);
+        for(std::size_t q=tree.size();q-->0;) {
+            node& nd=tree[q];
+            if(nd.children==0) continue;
+            double sum[3]={0,0,0},mass=0;
+            for(std::size_t a=0;a<3;a++) {
+                nd.lo[a]=std::numeric_limits<float>::max();
+                nd.hi[a]=std::numeric_limits<float>::lowest();
+            }
+            for(std::uint32_t ch=nd.first_child;ch<nd.first_child+nd.children;ch++) {
+                const node& c=tree[ch];
+                for(std::size_t a=0;a<3;a++) {
+                    nd.lo[a]=std::min(nd.lo[a],c.lo[a]); nd.hi[a]=std::max(nd.hi[a],c.hi[a]);
+                    sum[a]+=double(c.gm)*c.c[a];
+                }
+                mass+=c.gm;
+            }
+            finish(nd,sum,mass);
+        }
+    }
+
+    /// Every group walks the tree once: far nodes go to its list as single bodies, near leaves with all bodies.
+    /// The list is then a tile for all bodies of the group.
+    void gravity_tree::accelerations(float eps2,const gravity_out& out,std::size_t min_chunk,unsigned threads) const {
+        if(tree.empty()) return;
+        const tile_kernel tile=tile_for(simd::active());
+        const std::size_t chunk=std::max<std::size_t>(1,min_chunk*group_nodes.size()/keys.size());
+        flow::parallel_for(group_nodes.size(),chunk,[&](std::size_t first,std::size_t last) {
+            std::vector<float>         lx,ly,lz,lm;                      // The interaction list.
+            std::vector<float>         ax,ay,az;
+            std::vector<std::uint32_t> stack;
+            for(std::size_t q=first;q<last;q++) {
+                const node& g=tree[group_nodes[q]];
+                lx.clear(); ly.clear(); lz.clear(); lm.clear();
+                stack.assign(1,0);
+                while(!stack.empty()) {
+                    const node& nd=tree[stack.back()]; stack.pop_back();
+                    float d2=0;                                             // From the box of the group.
+                    for(std::size_t a=0;a<3;a++) {
+                        const float d=nd.c[a]<g.lo[a]?g.lo[a]-nd.c[a]:nd.c[a]>g.hi[a]?nd.c[a]-g.hi[a]:0.f;
+                        d2+=d*d;
+                    }
+                    if(d2>nd.open2) {
+                        lx.push_back(nd.c[0]); ly.push_back(nd.c[1]); lz.push_back(nd.c[2]); lm.push_back(nd.gm);
+                    } else if(nd.children==0) {
+                        lx.insert(lx.end(),x.begin()+nd.begin,x.begin()+nd.end);
+                        ly.insert(ly.end(),y.begin()+nd.begin,y.begin()+nd.end);
+                        lz.insert(lz.end(),z.begin()+nd.begin,z.begin()+nd.end);
+                        lm.insert(lm.end(),gm.begin()+nd.begin,gm.begin()+nd.end);
+                    } else {
+                        for(std::uint32_t ch=0;ch<nd.children;ch++) stack.push_back(nd.first_child+ch);
+                    }
+                }
+                const std::size_t k=g.end-g.begin;
+                ax.assign(k,0.f); ay.assign(k,0.f); az.assign(k,0.f);
+                const gravity_bodies s{lx.data(),ly.data(),lz.data(),lm.data(),lx.size()};
+                tile(x.data()+g.begin,y.data()+g.begin,z.data()+g.begin,k,s,eps2,ax.data(),ay.data(),az.data());
+                for(std::size_t i=0;i<k;i++) {
+                    const std::uint32_t o=keys[g.begin+i].second;
+                    out.x[o]=ax[i]; out.y[o]=ay[i]; out.z[o]=az[i];
+                }
+            }
+        },threads);
+    }
+
+} // namespace merry_tools::math::detail
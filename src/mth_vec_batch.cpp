@@ -0,0 +1,684 @@
+/// @date 2026-10-16 (last modification)
+/// Raw SIMD kernels for `mth_vec_batch.h` with runtime selection of the instruction set.
+/// Kernels exist for `float`, `double` and mixed precision.
+/// Every kernel has a scalar version, which is the only one outside x86 with GCC/Clang.
+///
+#include "mth_vec_batch.h"
+
+#include <atomic>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#   define WB_VEC_BATCH_X86 1
+#   include <immintrin.h>
+#   define WB_TARGET(ISA) __attribute__((target(ISA)))
+#else
+#   define WB_VEC_BATCH_X86 0
+#endif
+
+namespace merry_tools::math::simd {
+
+    // SCALAR FALLBACK:
+    //*////////////////
+
+    static void add_scalar(const float* a,const float* b,float* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++) out[i]=a[i]+b[i];
+    }
+
+    static void sub_scalar(const float* a,const float* b,float* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++) out[i]=a[i]-b[i];
+    }
+
+    static void scale_scalar(const float* a,double s,float* out,std::size_t n) {
+        const auto fs=static_cast<float>(s);
+        for(std::size_t i=0;i<n;i++) out[i]=a[i]*fs;
+    }
+
+    static void fma_scalar(const float* a,const float* b,double s,float* out,std::size_t n) {
+        const auto fs=static_cast<float>(s);
+        for(std::size_t i=0;i<n;i++) out[i]=a[i]+b[i]*fs;
+    }
+
+    static void affine_scalar(const float* a,double s,double o,float* out,std::size_t n) {
+        const auto fs=static_cast<float>(s),fo=static_cast<float>(o);
+        for(std::size_t i=0;i<n;i++) out[i]=a[i]*fs+fo;
+    }
+
+    static void add_scalar(const double* a,const double* b,double* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++) out[i]=a[i]+b[i];
+    }
+
+    static void sub_scalar(const double* a,const double* b,double* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++) out[i]=a[i]-b[i];
+    }
+
+    static void scale_scalar(const double* a,double s,double* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++) out[i]=a[i]*s;
+    }
+
+    static void fma_scalar(const double* a,const double* b,double s,double* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++) out[i]=a[i]+b[i]*s;
+    }
+
+    static void fma_scalar(const double* a,const float* b,double s,double* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++) out[i]=a[i]+double(b[i])*s;
+    }
+
+    static void affine_scalar(const double* a,double s,double o,double* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++) out[i]=a[i]*s+o;
+    }
+
+    static void convert_scalar(const float* in,double* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++) out[i]=in[i];
+    }
+
+    static void convert_scalar(const double* in,float* out,std::size_t n) {
+        for(std::size_t i=0;i<n;i++) out[i]=static_cast<float>(in[i]);
+    }
+
+    /// Squares of norms, `z` may be `nullptr`.
+    template<class FLOAT>
+    static FLOAT norm2_at(const FLOAT* x,const FLOAT* y,const FLOAT* z,std::size_t i) {
+        return x[i]*x[i]+y[i]*y[i]+(z?z[i]*z[i]:FLOAT(0));
+    }
+
+    template<class FLOAT>
+    static void norm_scalar(const FLOAT* x,const FLOAT* y,const FLOAT* z,FLOAT* out,std::size_t n,precision) {
+        for(std::size_t i=0;i<n;i++) out[i]=std::sqrt(norm2_at(x,y,z,i));
+    }
+
+    template<class FLOAT>
+    static void normalize_scalar(FLOAT* x,FLOAT* y,FLOAT* z,std::size_t n,double length,FLOAT* norms,precision) {
+        const auto len=static_cast<FLOAT>(length);
+        for(std::size_t i=0;i<n;i++) {
+            const FLOAT r=std::sqrt(norm2_at(x,y,z,i));
+            const FLOAT f=r>0?len/r:FLOAT(0);
+            if(norms) norms[i]=r;
+            x[i]*=f; y[i]*=f;
+            if(z) z[i]*=f;
+        }
+    }
+
+#if WB_VEC_BATCH_X86
+
+    // SSE:
+    //*////
+
+    WB_TARGET("sse2")
+    static void add_sse(const float* a,const float* b,float* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm_storeu_ps(out+i,_mm_add_ps(_mm_loadu_ps(a+i),_mm_loadu_ps(b+i)));
+        add_scalar(a+i,b+i,out+i,n-i);
+    }
+
+    WB_TARGET("sse2")
+    static void sub_sse(const float* a,const float* b,float* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm_storeu_ps(out+i,_mm_sub_ps(_mm_loadu_ps(a+i),_mm_loadu_ps(b+i)));
+        sub_scalar(a+i,b+i,out+i,n-i);
+    }
+
+    WB_TARGET("sse2")
+    static void scale_sse(const float* a,double s,float* out,std::size_t n) {
+        const __m128 vs=_mm_set1_ps(static_cast<float>(s));
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm_storeu_ps(out+i,_mm_mul_ps(_mm_loadu_ps(a+i),vs));
+        scale_scalar(a+i,s,out+i,n-i);
+    }
+
+    WB_TARGET("sse2")
+    static void fma_sse(const float* a,const float* b,double s,float* out,std::size_t n) {
+        const __m128 vs=_mm_set1_ps(static_cast<float>(s));
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm_storeu_ps(out+i,_mm_add_ps(_mm_loadu_ps(a+i),_mm_mul_ps(_mm_loadu_ps(b+i),vs)));
+        fma_scalar(a+i,b+i,s,out+i,n-i);
+    }
+
+    WB_TARGET("sse2")
+    static void affine_sse(const float* a,double s,double o,float* out,std::size_t n) {
+        const __m128 vs=_mm_set1_ps(static_cast<float>(s)),vo=_mm_set1_ps(static_cast<float>(o));
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm_storeu_ps(out+i,_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a+i),vs),vo));
+        affine_scalar(a+i,s,o,out+i,n-i);
+    }
+
+    /// Reciprocal norms from their squares, 0 for zero vectors.
+    WB_TARGET("sse2")
+    static __m128 recip_norm_sse(__m128 s,precision p) {
+        const __m128 live=_mm_cmpgt_ps(s,_mm_setzero_ps());
+        __m128 r;
+        if(p==precision::exact) r=_mm_div_ps(_mm_set1_ps(1.f),_mm_sqrt_ps(s));
+        else {
+            r=_mm_rsqrt_ps(s);
+            if(p==precision::refined)                                               // r*(1.5-0.5*s*r*r)
+                r=_mm_mul_ps(r,_mm_sub_ps(_mm_set1_ps(1.5f),_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f),s),
+                                                                       _mm_mul_ps(r,r))));
+        }
+        return _mm_and_ps(r,live);
+    }
+
+    WB_TARGET("sse2")
+    static __m128 norm2_sse(const float* x,const float* y,const float* z,std::size_t i) {
+        const __m128 vx=_mm_loadu_ps(x+i),vy=_mm_loadu_ps(y+i);
+        __m128 s=_mm_add_ps(_mm_mul_ps(vx,vx),_mm_mul_ps(vy,vy));
+        if(z) { const __m128 vz=_mm_loadu_ps(z+i); s=_mm_add_ps(s,_mm_mul_ps(vz,vz)); }
+        return s;
+    }
+
+    WB_TARGET("sse2")
+    static void norm_sse(const float* x,const float* y,const float* z,float* out,std::size_t n,precision p) {
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) {
+            const __m128 s=norm2_sse(x,y,z,i);
+            _mm_storeu_ps(out+i,p==precision::exact?_mm_sqrt_ps(s):_mm_mul_ps(s,recip_norm_sse(s,p)));
+        }
+        norm_scalar(x+i,y+i,z?z+i:z,out+i,n-i,p);
+    }
+
+    WB_TARGET("sse2")
+    static void normalize_sse(float* x,float* y,float* z,std::size_t n,double length,float* norms,precision p) {
+        const __m128 len=_mm_set1_ps(static_cast<float>(length));
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) {
+            const __m128 s=norm2_sse(x,y,z,i),r=recip_norm_sse(s,p),f=_mm_mul_ps(r,len);
+            if(norms) _mm_storeu_ps(norms+i,p==precision::exact?_mm_sqrt_ps(s):_mm_mul_ps(s,r));
+            _mm_storeu_ps(x+i,_mm_mul_ps(_mm_loadu_ps(x+i),f));
+            _mm_storeu_ps(y+i,_mm_mul_ps(_mm_loadu_ps(y+i),f));
+            if(z) _mm_storeu_ps(z+i,_mm_mul_ps(_mm_loadu_ps(z+i),f));
+        }
+        normalize_scalar(x+i,y+i,z?z+i:z,n-i,length,norms?norms+i:norms,p);
+    }
+
+    // AVX2:
+    //*/////
+
+    WB_TARGET("avx2")
+    static void add_avx2(const float* a,const float* b,float* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm256_storeu_ps(out+i,_mm256_add_ps(_mm256_loadu_ps(a+i),_mm256_loadu_ps(b+i)));
+        add_sse(a+i,b+i,out+i,n-i);
+    }
+
+    WB_TARGET("avx2")
+    static void sub_avx2(const float* a,const float* b,float* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm256_storeu_ps(out+i,_mm256_sub_ps(_mm256_loadu_ps(a+i),_mm256_loadu_ps(b+i)));
+        sub_sse(a+i,b+i,out+i,n-i);
+    }
+
+    WB_TARGET("avx2")
+    static void scale_avx2(const float* a,double s,float* out,std::size_t n) {
+        const __m256 vs=_mm256_set1_ps(static_cast<float>(s));
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm256_storeu_ps(out+i,_mm256_mul_ps(_mm256_loadu_ps(a+i),vs));
+        scale_sse(a+i,s,out+i,n-i);
+    }
+
+    WB_TARGET("avx2,fma")
+    static void fma_avx2(const float* a,const float* b,double s,float* out,std::size_t n) {
+        const __m256 vs=_mm256_set1_ps(static_cast<float>(s));
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm256_storeu_ps(out+i,_mm256_fmadd_ps(_mm256_loadu_ps(b+i),vs,_mm256_loadu_ps(a+i)));
+        fma_sse(a+i,b+i,s,out+i,n-i);
+    }
+
+    WB_TARGET("avx2,fma")
+    static void affine_avx2(const float* a,double s,double o,float* out,std::size_t n) {
+        const __m256 vs=_mm256_set1_ps(static_cast<float>(s)),vo=_mm256_set1_ps(static_cast<float>(o));
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm256_storeu_ps(out+i,_mm256_fmadd_ps(_mm256_loadu_ps(a+i),vs,vo));
+        affine_sse(a+i,s,o,out+i,n-i);
+    }
+
+    WB_TARGET("avx2")
+    static void add_avx2(const double* a,const double* b,double* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm256_storeu_pd(out+i,_mm256_add_pd(_mm256_loadu_pd(a+i),_mm256_loadu_pd(b+i)));
+        add_scalar(a+i,b+i,out+i,n-i);
+    }
+
+    WB_TARGET("avx2")
+    static void sub_avx2(const double* a,const double* b,double* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm256_storeu_pd(out+i,_mm256_sub_pd(_mm256_loadu_pd(a+i),_mm256_loadu_pd(b+i)));
+        sub_scalar(a+i,b+i,out+i,n-i);
+    }
+
+    WB_TARGET("avx2")
+    static void scale_avx2(const double* a,double s,double* out,std::size_t n) {
+        const __m256d vs=_mm256_set1_pd(s);
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm256_storeu_pd(out+i,_mm256_mul_pd(_mm256_loadu_pd(a+i),vs));
+        scale_scalar(a+i,s,out+i,n-i);
+    }
+
+    WB_TARGET("avx2,fma")
+    static void fma_avx2(const double* a,const double* b,double s,double* out,std::size_t n) {
+        const __m256d vs=_mm256_set1_pd(s);
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm256_storeu_pd(out+i,_mm256_fmadd_pd(_mm256_loadu_pd(b+i),vs,_mm256_loadu_pd(a+i)));
+        fma_scalar(a+i,b+i,s,out+i,n-i);
+    }
+
+    WB_TARGET("avx2,fma")
+    static void fma_avx2(const double* a,const float* b,double s,double* out,std::size_t n) {
+        const __m256d vs=_mm256_set1_pd(s);
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm256_storeu_pd(out+i,_mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(b+i)),vs,_mm256_loadu_pd(a+i)));
+        fma_scalar(a+i,b+i,s,out+i,n-i);
+    }
+
+    WB_TARGET("avx2,fma")
+    static void affine_avx2(const double* a,double s,double o,double* out,std::size_t n) {
+        const __m256d vs=_mm256_set1_pd(s),vo=_mm256_set1_pd(o);
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm256_storeu_pd(out+i,_mm256_fmadd_pd(_mm256_loadu_pd(a+i),vs,vo));
+        affine_scalar(a+i,s,o,out+i,n-i);
+    }
+
+    WB_TARGET("avx2")
+    static void convert_avx2(const float* in,double* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm256_storeu_pd(out+i,_mm256_cvtps_pd(_mm_loadu_ps(in+i)));
+        convert_scalar(in+i,out+i,n-i);
+    }
+
+    WB_TARGET("avx2")
+    static void convert_avx2(const double* in,float* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) _mm_storeu_ps(out+i,_mm256_cvtpd_ps(_mm256_loadu_pd(in+i)));
+        convert_scalar(in+i,out+i,n-i);
+    }
+
+    WB_TARGET("avx2,fma")
+    static __m256 recip_norm_avx2(__m256 s,precision p) {
+        const __m256 live=_mm256_cmp_ps(s,_mm256_setzero_ps(),_CMP_GT_OQ);
+        __m256 r;
+        if(p==precision::exact) r=_mm256_div_ps(_mm256_set1_ps(1.f),_mm256_sqrt_ps(s));
+        else {
+            r=_mm256_rsqrt_ps(s);
+            if(p==precision::refined) {
+                const __m256 h=_mm256_mul_ps(_mm256_set1_ps(0.5f),s);
+                r=_mm256_mul_ps(r,_mm256_fnmadd_ps(_mm256_mul_ps(h,r),r,_mm256_set1_ps(1.5f)));
+            }
+        }
+        return _mm256_and_ps(r,live);
+    }
+
+    WB_TARGET("avx2,fma")
+    static __m256 norm2_avx2(const float* x,const float* y,const float* z,std::size_t i) {
+        const __m256 vx=_mm256_loadu_ps(x+i),vy=_mm256_loadu_ps(y+i);
+        __m256 s=_mm256_fmadd_ps(vy,vy,_mm256_mul_ps(vx,vx));
+        if(z) { const __m256 vz=_mm256_loadu_ps(z+i); s=_mm256_fmadd_ps(vz,vz,s); }
+        return s;
+    }
+
+    WB_TARGET("avx2,fma")
+    static void norm_avx2(const float* x,const float* y,const float* z,float* out,std::size_t n,precision p) {
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) {
+            const __m256 s=norm2_avx2(x,y,z,i);
+            _mm256_storeu_ps(out+i,p==precision::exact?_mm256_sqrt_ps(s):_mm256_mul_ps(s,recip_norm_avx2(s,p)));
+        }
+        norm_sse(x+i,y+i,z?z+i:z,out+i,n-i,p);
+    }
+
+    WB_TARGET("avx2,fma")
+    static void normalize_avx2(float* x,float* y,float* z,std::size_t n,double length,float* norms,precision p) {
+        const __m256 len=_mm256_set1_ps(static_cast<float>(length));
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) {
+            const __m256 s=norm2_avx2(x,y,z,i),r=recip_norm_avx2(s,p),f=_mm256_mul_ps(r,len);
+            if(norms) _mm256_storeu_ps(norms+i,p==precision::exact?_mm256_sqrt_ps(s):_mm256_mul_ps(s,r));
+            _mm256_storeu_ps(x+i,_mm256_mul_ps(_mm256_loadu_ps(x+i),f));
+            _mm256_storeu_ps(y+i,_mm256_mul_ps(_mm256_loadu_ps(y+i),f));
+            if(z) _mm256_storeu_ps(z+i,_mm256_mul_ps(_mm256_loadu_ps(z+i),f));
+        }
+        normalize_sse(x+i,y+i,z?z+i:z,n-i,length,norms?norms+i:norms,p);
+    }
+
+    WB_TARGET("avx2,fma")
+    static void norm_avx2(const double* x,const double* y,const double* z,double* out,std::size_t n,precision p) {
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) {
+            const __m256d vx=_mm256_loadu_pd(x+i),vy=_mm256_loadu_pd(y+i);
+            __m256d s=_mm256_fmadd_pd(vy,vy,_mm256_mul_pd(vx,vx));
+            if(z) { const __m256d vz=_mm256_loadu_pd(z+i); s=_mm256_fmadd_pd(vz,vz,s); }
+            _mm256_storeu_pd(out+i,_mm256_sqrt_pd(s));
+        }
+        norm_scalar(x+i,y+i,z?z+i:z,out+i,n-i,p);
+    }
+
+    WB_TARGET("avx2,fma")
+    static void normalize_avx2(double* x,double* y,double* z,std::size_t n,double length,double* norms,precision p) {
+        const __m256d len=_mm256_set1_pd(length),zero=_mm256_setzero_pd();
+        std::size_t i=0;
+        for(;i+4<=n;i+=4) {
+            const __m256d vx=_mm256_loadu_pd(x+i),vy=_mm256_loadu_pd(y+i);
+            __m256d s=_mm256_fmadd_pd(vy,vy,_mm256_mul_pd(vx,vx));
+            if(z) { const __m256d vz=_mm256_loadu_pd(z+i); s=_mm256_fmadd_pd(vz,vz,s); }
+            const __m256d r=_mm256_sqrt_pd(s);
+            const __m256d f=_mm256_and_pd(_mm256_div_pd(len,r),_mm256_cmp_pd(r,zero,_CMP_GT_OQ));
+            if(norms) _mm256_storeu_pd(norms+i,r);
+            _mm256_storeu_pd(x+i,_mm256_mul_pd(vx,f));
+            _mm256_storeu_pd(y+i,_mm256_mul_pd(vy,f));
+            if(z) _mm256_storeu_pd(z+i,_mm256_mul_pd(_mm256_loadu_pd(z+i),f));
+        }
+        normalize_scalar(x+i,y+i,z?z+i:z,n-i,length,norms?norms+i:norms,p);
+    }
+
+    // AVX-512:
+    //*////////
+
+    WB_TARGET("avx512f")
+    static void add_avx512(const float* a,const float* b,float* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+16<=n;i+=16) _mm512_storeu_ps(out+i,_mm512_add_ps(_mm512_loadu_ps(a+i),_mm512_loadu_ps(b+i)));
+        const __mmask16 tail=static_cast<__mmask16>((1u<<(n-i))-1u);
+        _mm512_mask_storeu_ps(out+i,tail,_mm512_add_ps(_mm512_maskz_loadu_ps(tail,a+i),_mm512_maskz_loadu_ps(tail,b+i)));
+    }
+
+    WB_TARGET("avx512f")
+    static void sub_avx512(const float* a,const float* b,float* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+16<=n;i+=16) _mm512_storeu_ps(out+i,_mm512_sub_ps(_mm512_loadu_ps(a+i),_mm512_loadu_ps(b+i)));
+        const __mmask16 tail=static_cast<__mmask16>((1u<<(n-i))-1u);
+        _mm512_mask_storeu_ps(out+i,tail,_mm512_sub_ps(_mm512_maskz_loadu_ps(tail,a+i),_mm512_maskz_loadu_ps(tail,b+i)));
+    }
+
+    WB_TARGET("avx512f")
+    static void scale_avx512(const float* a,double s,float* out,std::size_t n) {
+        const __m512 vs=_mm512_set1_ps(static_cast<float>(s));
+        std::size_t i=0;
+        for(;i+16<=n;i+=16) _mm512_storeu_ps(out+i,_mm512_mul_ps(_mm512_loadu_ps(a+i),vs));
+        const __mmask16 tail=static_cast<__mmask16>((1u<<(n-i))-1u);
+        _mm512_mask_storeu_ps(out+i,tail,_mm512_mul_ps(_mm512_maskz_loadu_ps(tail,a+i),vs));
+    }
+
+    WB_TARGET("avx512f")
+    static void fma_avx512(const float* a,const float* b,double s,float* out,std::size_t n) {
+        const __m512 vs=_mm512_set1_ps(static_cast<float>(s));
+        std::size_t i=0;
+        for(;i+16<=n;i+=16) _mm512_storeu_ps(out+i,_mm512_fmadd_ps(_mm512_loadu_ps(b+i),vs,_mm512_loadu_ps(a+i)));
+        const __mmask16 tail=static_cast<__mmask16>((1u<<(n-i))-1u);
+        _mm512_mask_storeu_ps(out+i,tail,
+                              _mm512_fmadd_ps(_mm512_maskz_loadu_ps(tail,b+i),vs,_mm512_maskz_loadu_ps(tail,a+i)));
+    }
+
+    WB_TARGET("avx512f")
+    static void affine_avx512(const float* a,double s,double o,float* out,std::size_t n) {
+        const __m512 vs=_mm512_set1_ps(static_cast<float>(s)),vo=_mm512_set1_ps(static_cast<float>(o));
+        std::size_t i=0;
+        for(;i+16<=n;i+=16) _mm512_storeu_ps(out+i,_mm512_fmadd_ps(_mm512_loadu_ps(a+i),vs,vo));
+        const __mmask16 tail=static_cast<__mmask16>((1u<<(n-i))-1u);
+        _mm512_mask_storeu_ps(out+i,tail,_mm512_fmadd_ps(_mm512_maskz_loadu_ps(tail,a+i),vs,vo));
+    }
+
+    WB_TARGET("avx512f")
+    static void add_avx512(const double* a,const double* b,double* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm512_storeu_pd(out+i,_mm512_add_pd(_mm512_loadu_pd(a+i),_mm512_loadu_pd(b+i)));
+        add_scalar(a+i,b+i,out+i,n-i);
+    }
+
+    WB_TARGET("avx512f")
+    static void sub_avx512(const double* a,const double* b,double* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm512_storeu_pd(out+i,_mm512_sub_pd(_mm512_loadu_pd(a+i),_mm512_loadu_pd(b+i)));
+        sub_scalar(a+i,b+i,out+i,n-i);
+    }
+
+    WB_TARGET("avx512f")
+    static void scale_avx512(const double* a,double s,double* out,std::size_t n) {
+        const __m512d vs=_mm512_set1_pd(s);
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm512_storeu_pd(out+i,_mm512_mul_pd(_mm512_loadu_pd(a+i),vs));
+        scale_scalar(a+i,s,out+i,n-i);
+    }
+
+    WB_TARGET("avx512f")
+    static void fma_avx512(const double* a,const double* b,double s,double* out,std::size_t n) {
+        const __m512d vs=_mm512_set1_pd(s);
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm512_storeu_pd(out+i,_mm512_fmadd_pd(_mm512_loadu_pd(b+i),vs,_mm512_loadu_pd(a+i)));
+        fma_scalar(a+i,b+i,s,out+i,n-i);
+    }
+
+    WB_TARGET("avx512f")
+    static void fma_avx512(const double* a,const float* b,double s,double* out,std::size_t n) {
+        const __m512d vs=_mm512_set1_pd(s);
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm512_storeu_pd(out+i,_mm512_fmadd_pd(_mm512_maskz_cvtps_pd(0xFF,_mm256_loadu_ps(b+i)),vs,_mm512_loadu_pd(a+i)));
+        fma_scalar(a+i,b+i,s,out+i,n-i);
+    }
+
+    WB_TARGET("avx512f")
+    static void affine_avx512(const double* a,double s,double o,double* out,std::size_t n) {
+        const __m512d vs=_mm512_set1_pd(s),vo=_mm512_set1_pd(o);
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm512_storeu_pd(out+i,_mm512_fmadd_pd(_mm512_loadu_pd(a+i),vs,vo));
+        affine_scalar(a+i,s,o,out+i,n-i);
+    }
+
+    WB_TARGET("avx512f")
+    static void convert_avx512(const float* in,double* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm512_storeu_pd(out+i,_mm512_maskz_cvtps_pd(0xFF,_mm256_loadu_ps(in+i)));
+        convert_scalar(in+i,out+i,n-i);
+    }
+
+    WB_TARGET("avx512f")
+    static void convert_avx512(const double* in,float* out,std::size_t n) {
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) _mm256_storeu_ps(out+i,_mm512_maskz_cvtpd_ps(0xFF,_mm512_loadu_pd(in+i)));
+        convert_scalar(in+i,out+i,n-i);
+    }
+
+    WB_TARGET("avx512f")
+    static __m512 recip_norm_avx512(__m512 s,precision p) {
+        const __mmask16 live=_mm512_cmp_ps_mask(s,_mm512_setzero_ps(),_CMP_GT_OQ);
+        if(p==precision::exact) return _mm512_maskz_div_ps(live,_mm512_set1_ps(1.f),_mm512_maskz_sqrt_ps(live,s));
+        __m512 r=_mm512_maskz_rsqrt14_ps(live,s);                                  // Masked forms, as GCC 12 warns
+        if(p==precision::refined) {                                                 // about `_mm512_undefined_ps()`.
+            const __m512 h=_mm512_mul_ps(_mm512_set1_ps(0.5f),s);
+            r=_mm512_mul_ps(r,_mm512_fnmadd_ps(_mm512_mul_ps(h,r),r,_mm512_set1_ps(1.5f)));
+        }
+        return r;
+    }
+
+    /// A block of up to 16 vectors, `m` marks valid ones.
+    WB_TARGET("avx512f")
+    static void norm_block_avx512(const float* x,const float* y,const float* z,float* out,__mmask16 m,precision p) {
+        const __m512 vx=_mm512_maskz_loadu_ps(m,x),vy=_mm512_maskz_loadu_ps(m,y);
+        __m512 s=_mm512_fmadd_ps(vy,vy,_mm512_mul_ps(vx,vx));
+        if(z) { const __m512 vz=_mm512_maskz_loadu_ps(m,z); s=_mm512_fmadd_ps(vz,vz,s); }
+        _mm512_mask_storeu_ps(out,m,p==precision::exact?_mm512_maskz_sqrt_ps(0xFFFF,s)
+                                                       :_mm512_mul_ps(s,recip_norm_avx512(s,p)));
+    }
+
+    WB_TARGET("avx512f")
+    static void norm_avx512(const float* x,const float* y,const float* z,float* out,std::size_t n,precision p) {
+        std::size_t i=0;
+        for(;i+16<=n;i+=16) norm_block_avx512(x+i,y+i,z?z+i:z,out+i,0xFFFF,p);
+        if(i<n) norm_block_avx512(x+i,y+i,z?z+i:z,out+i,static_cast<__mmask16>((1u<<(n-i))-1u),p);
+    }
+
+    WB_TARGET("avx512f")
+    static void normalize_block_avx512(float* x,float* y,float* z,__m512 len,float* norms,__mmask16 m,precision p) {
+        const __m512 vx=_mm512_maskz_loadu_ps(m,x),vy=_mm512_maskz_loadu_ps(m,y);
+        const __m512 vz=z?_mm512_maskz_loadu_ps(m,z):_mm512_setzero_ps();
+        const __m512 s=_mm512_fmadd_ps(vz,vz,_mm512_fmadd_ps(vy,vy,_mm512_mul_ps(vx,vx)));
+        const __m512 r=recip_norm_avx512(s,p),f=_mm512_mul_ps(r,len);
+        if(norms) _mm512_mask_storeu_ps(norms,m,p==precision::exact?_mm512_maskz_sqrt_ps(0xFFFF,s):_mm512_mul_ps(s,r));
+        _mm512_mask_storeu_ps(x,m,_mm512_mul_ps(vx,f));
+        _mm512_mask_storeu_ps(y,m,_mm512_mul_ps(vy,f));
+        if(z) _mm512_mask_storeu_ps(z,m,_mm512_mul_ps(vz,f));
+    }
+
+    WB_TARGET("avx512f")
+    static void normalize_avx512(float* x,float* y,float* z,std::size_t n,double length,float* norms,precision p) {
+        const __m512 len=_mm512_set1_ps(static_cast<float>(length));
+        std::size_t i=0;
+        for(;i+16<=n;i+=16) normalize_block_avx512(x+i,y+i,z?z+i:z,len,norms?norms+i:norms,0xFFFF,p);
+        if(i<n) normalize_block_avx512(x+i,y+i,z?z+i:z,len,norms?norms+i:norms,
+                                       static_cast<__mmask16>((1u<<(n-i))-1u),p);
+    }
+
+    WB_TARGET("avx512f")
+    static void norm_avx512(const double* x,const double* y,const double* z,double* out,std::size_t n,precision p) {
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) {
+            const __m512d vx=_mm512_loadu_pd(x+i),vy=_mm512_loadu_pd(y+i);
+            __m512d s=_mm512_fmadd_pd(vy,vy,_mm512_mul_pd(vx,vx));
+            if(z) { const __m512d vz=_mm512_loadu_pd(z+i); s=_mm512_fmadd_pd(vz,vz,s); }
+            _mm512_storeu_pd(out+i,_mm512_maskz_sqrt_pd(0xFF,s));
+        }
+        norm_scalar(x+i,y+i,z?z+i:z,out+i,n-i,p);
+    }
+
+    WB_TARGET("avx512f")
+    static void normalize_avx512(double* x,double* y,double* z,std::size_t n,double length,double* norms,precision p) {
+        const __m512d len=_mm512_set1_pd(length);
+        std::size_t i=0;
+        for(;i+8<=n;i+=8) {
+            const __m512d vx=_mm512_loadu_pd(x+i),vy=_mm512_loadu_pd(y+i);
+            __m512d s=_mm512_fmadd_pd(vy,vy,_mm512_mul_pd(vx,vx));
+            if(z) { const __m512d vz=_mm512_loadu_pd(z+i); s=_mm512_fmadd_pd(vz,vz,s); }
+            const __m512d r=_mm512_maskz_sqrt_pd(0xFF,s);
+            const __m512d f=_mm512_maskz_div_pd(_mm512_cmp_pd_mask(r,_mm512_setzero_pd(),_CMP_GT_OQ),len,r);
+            if(norms) _mm512_storeu_pd(norms+i,r);
+            _mm512_storeu_pd(x+i,_mm512_mul_pd(vx,f));
+            _mm512_storeu_pd(y+i,_mm512_mul_pd(vy,f));
+            if(z) _mm512_storeu_pd(z+i,_mm512_mul_pd(_mm512_loadu_pd(z+i),f));
+        }
+        normalize_scalar(x+i,y+i,z?z+i:z,n-i,length,norms?norms+i:norms,p);
+    }
+
+#endif // WB_VEC_BATCH_X86
+
+    // DISPATCH:
+    //*/////////
+
+    /// All kernels of a single instruction set level.
+    /// @note `double` kernels of the SSE level are the scalar ones. Two lanes are not worth the code.
+    struct kernel_table {
+        void (*add)  (const float*,const float*,float*,std::size_t);
+        void (*sub)  (const float*,const float*,float*,std::size_t);
+        void (*scale)(const float*,double,float*,std::size_t);
+        void (*fma)  (const float*,const float*,double,float*,std::size_t);
+        void (*add_d)  (const double*,const double*,double*,std::size_t);
+        void (*sub_d)  (const double*,const double*,double*,std::size_t);
+        void (*scale_d)(const double*,double,double*,std::size_t);
+        void (*fma_d)  (const double*,const double*,double,double*,std::size_t);
+        void (*fma_m)  (const double*,const float*,double,double*,std::size_t);
+        void (*widen)  (const float*,double*,std::size_t);
+        void (*narrow) (const double*,float*,std::size_t);
+        void (*affine)  (const float*,double,double,float*,std::size_t);
+        void (*affine_d)(const double*,double,double,double*,std::size_t);
+        void (*norm)       (const float*,const float*,const float*,float*,std::size_t,precision);
+        void (*normalize)  (float*,float*,float*,std::size_t,double,float*,precision);
+        void (*norm_d)     (const double*,const double*,const double*,double*,std::size_t,precision);
+        void (*normalize_d)(double*,double*,double*,std::size_t,double,double*,precision);
+    };
+
+    static const kernel_table tables[]={
+        { add_scalar, sub_scalar, scale_scalar, fma_scalar,
+          add_scalar, sub_scalar, scale_scalar, fma_scalar, fma_scalar, convert_scalar, convert_scalar,
+          affine_scalar, affine_scalar,
+          norm_scalar<float>, normalize_scalar<float>, norm_scalar<double>, normalize_scalar<double> },
+#if WB_VEC_BATCH_X86
+        { add_sse,    sub_sse,    scale_sse,    fma_sse,
+          add_scalar, sub_scalar, scale_scalar, fma_scalar, fma_scalar, convert_scalar, convert_scalar,
+          affine_sse,    affine_scalar,
+          norm_sse,    normalize_sse,    norm_scalar<double>, normalize_scalar<double> },
+        { add_avx2,   sub_avx2,   scale_avx2,   fma_avx2,
+          add_avx2,   sub_avx2,   scale_avx2,   fma_avx2,   fma_avx2,   convert_avx2,   convert_avx2,
+          affine_avx2,   affine_avx2,
+          norm_avx2,   normalize_avx2,   norm_avx2,   normalize_avx2 },
+        { add_avx512, sub_avx512, scale_avx512, fma_avx512,
+          add_avx512, sub_avx512, scale_avx512, fma_avx512, fma_avx512, convert_avx512, convert_avx512,
+          affine_avx512, affine_avx512,
+          norm_avx512, normalize_avx512, norm_avx512, normalize_avx512 },
+#endif
+    };
+
+    level detected() {
+#if WB_VEC_BATCH_X86
+        static const level best=[]{
+            __builtin_cpu_init();
+            if(__builtin_cpu_supports("avx512f")) return level::avx512;
+            if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return level::avx2;
+            if(__builtin_cpu_supports("sse2")) return level::sse;
+            return level::scalar;
+        }();
+        return best;
+#else
+        return level::scalar;
+#endif
+    }
+
+    /// Index into `tables`. Starts as "not yet chosen".
+    static std::atomic<int> current{-1};
+
+    static const kernel_table& kernels() {
+        int l=current.load(std::memory_order_relaxed);
+        if(l<0) {
+            l=static_cast<int>(detected());
+            current.store(l,std::memory_order_relaxed);
+        }
+        return tables[l];
+    }
+
+    level active() {
+        kernels();
+        return static_cast<level>(current.load(std::memory_order_relaxed));
+    }
+
+    level use(level wanted) {
+        const level best=detected();
+        current.store(static_cast<int>(wanted<best?wanted:best),std::memory_order_relaxed);
+        return active();
+    }
+
+    const char* name(level l) {
+        switch(l) {
+            case level::scalar: return "scalar";
+            case level::sse:    return "sse";
+            case level::avx2:   return "avx2";
+            case level::avx512: return "avx512";
+        }
+        return "?";
+    }
+
+    void add(const float* a,const float* b,float* out,std::size_t n)            { kernels().add(a,b,out,n); }
+    void sub(const float* a,const float* b,float* out,std::size_t n)            { kernels().sub(a,b,out,n); }
+    void scale(const float* a,double s,float* out,std::size_t n)                 { kernels().scale(a,s,out,n); }
+    void fma(const float* a,const float* b,double s,float* out,std::size_t n)    { kernels().fma(a,b,s,out,n); }
+    void affine(const float* a,double s,double o,float* out,std::size_t n)       { kernels().affine(a,s,o,out,n); }
+
+    void add(const double* a,const double* b,double* out,std::size_t n)         { kernels().add_d(a,b,out,n); }
+    void sub(const double* a,const double* b,double* out,std::size_t n)         { kernels().sub_d(a,b,out,n); }
+    void scale(const double* a,double s,double* out,std::size_t n)               { kernels().scale_d(a,s,out,n); }
+    void fma(const double* a,const double* b,double s,double* out,std::size_t n) { kernels().fma_d(a,b,s,out,n); }
+    void fma(const double* a,const float* b,double s,double* out,std::size_t n)  { kernels().fma_m(a,b,s,out,n); }
+    void affine(const double* a,double s,double o,double* out,std::size_t n)     { kernels().affine_d(a,s,o,out,n); }
+    void convert(const float* in,double* out,std::size_t n)                      { kernels().widen(in,out,n); }
+    void convert(const double* in,float* out,std::size_t n)                      { kernels().narrow(in,out,n); }
+
+    void norm(const float* x,const float* y,const float* z,float* out,std::size_t n,precision p) {
+        kernels().norm(x,y,z,out,n,p);
+    }
+
+    void norm(const double* x,const double* y,const double* z,double* out,std::size_t n,precision p) {
+        kernels().norm_d(x,y,z,out,n,p);
+    }
+
+    void normalize(float* x,float* y,float* z,std::size_t n,double length,float* norms,precision p) {
+        kernels().normalize(x,y,z,n,length,norms,p);
+    }
+
+    void normalize(double* x,double* y,double* z,std::size_t n,double length,double* norms,precision p) {
+        kernels().normalize_d(x,y,z,n,length,norms,p);
+    }
+
+} // namespace merry_tools::math::simd
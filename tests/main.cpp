@@ -1,10 +1,49 @@
 /// @date 2024-10-24 (modification)
 #include "mth_vectors.h"
+#include "mth_vec_arrays.h"
+#include "mth_vec_batch.h"
+#include "mth_vec_expr.h"
+#include "mth_vec_compact.h"
+#include "mth_spatial.h"
+#include "mth_reductions.h"
+#include "flw_tasks.h"
+#include "ios_snapshot.h"
+#include "ios_trajectory.h"
+#include "ios_format.h"
+#include "ios_parse.h"
+#include "ios_logging.h"
+#include "ios_profiling.h"
+#include "mth_integrators.h"
 #include "mth_fix_float.h"
 #include "ios_benders.h"
 #include "mem_guard.h"
+#include "mem_pool.h"
+#include "mem_registry.h"
+#include "mth_geodesy.h"
+#include "mth_vec_anchored.h"
+#include "mth_units.h"
+#include "mth_vec_algebra.h"
+#include "mth_nbody.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace merry_tools::tests {
 
@@ -107,6 +146,1748 @@ namespace merry_tools::tests {
         return true;
     }
 
+    bool test_vector_arrays(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for SoA vector arrays..."<<NOCOLO<<std::endl;
+
+        VolumeArray<VolumePosition> positions(3,xD(Longitude{1_m},Latitude{2_m},Altitude{3_m}));
+        positions.push_back(xD(Longitude{-1_m},Latitude{-2_m},Altitude{-3_m}));
+        positions[1]=xD(Longitude{10_m},Latitude{20_m},Altitude{30_m});
+        positions[2]+=VolumePosition{Longitude{1_m},Latitude{1_m},Altitude{1_m}};
+        //positions[0]=VolumeVelocity{VelAlong{1_m_s},VelAcross{1_m_s},VelUpward{1_m_s}}; //type mismatch
+
+        VolumePosition p1=positions[1];
+        if(positions.size()!=4 || p1.y.val.value!=20.0f || positions[2].get().z.val.value!=4.0f) return false;
+        if(positions.zs()[3]!=-3.0f) return false;
+        if(reinterpret_cast<std::uintptr_t>(positions.xs())%column_alignment!=0) return false;
+
+        PlaneArray<PlaneVelocity> velocities;
+        for(int i=0;i<1000;i++) velocities.push_back(xD(VelAlong{1_m_s},VelAcross{VelocitySI{i*1.0}}));
+        float sum=0;
+        for(auto v:velocities) sum+=v.y().val.value;
+        if(sum!=499500.0f) return false;
+
+        auto copy=velocities;
+        copy.resize(2);
+        if(copy.size()!=2 || copy.get(1).y.val.value!=1.0f) return false;
+        auto shrunk=velocities;                                  // Copying a shorter array zeroes the rest.
+        shrunk=copy;
+        for(std::size_t i=2;i<shrunk.capacity();i++) if(shrunk.ys()[i]!=0.0f || shrunk.xs()[i]!=0.0f) return false;
+
+        // Moved-from arrays are empty and still usable.
+        auto moved=std::move(copy);
+        if(moved.size()!=2 || !copy.empty() || copy.capacity()!=0) return false;
+        copy.push_back(xD(VelAlong{2_m_s},VelAcross{3_m_s}));
+        if(copy.size()!=1 || copy.get(0).y.val.value!=3.0f) return false;
+        moved=std::move(copy);
+        if(moved.size()!=1 || moved.get(0).x.val.value!=2.0f || !copy.empty()) return false;
+        copy.resize(3);
+        if(copy.get(2).x.val.value!=0.0f || moved.size()!=1) return false;
+
+        o<<COLOR2<<"END OF tests for SoA vector arrays."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_vector_batches(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for batch kernels, detected: "<<simd::name(simd::detected())<<NOCOLO<<std::endl;
+
+        const std::size_t n=1003; // Not a multiple of any SIMD width.
+        std::vector<VolumePosition> pos(n,VolumePosition{Longitude{0_m},Latitude{0_m},Altitude{0_m}});
+        std::vector<VolumeVelocity> vel(n,VolumeVelocity{VelAlong{0_m_s},VelAcross{0_m_s},VelUpward{0_m_s}});
+        VolumeArray<VolumePosition> soaPos(n);
+        VolumeArray<VolumeVelocity> soaVel(n);
+        for(std::size_t i=0;i<n;i++) {
+            pos[i]=xD(Longitude{DistSI{i*1.0}},Latitude{DistSI{-i*2.0}},Altitude{DistSI{0.5}});
+            vel[i]=xD(VelAlong{VelocitySI{1.0}},VelAcross{VelocitySI{i*0.25}},VelUpward{VelocitySI{-2.0}});
+            soaPos[i]=pos[i];
+            soaVel[i]=vel[i];
+        }
+
+        for(int l=int(simd::level::scalar);l<=int(simd::detected());l++) {
+            simd::use(simd::level(l));
+            std::vector<VolumePosition> next(pos);
+            batch_advance(span_of(pos),span_of(vel),TimeSpan{0.5_s},span_of(next));
+            //batch_advance(span_of(vel),span_of(pos),TimeSpan{0.5_s},span_of(next)); //fail on static_assert
+            std::vector<VolumePosition> twice(pos);
+            batch_add(span_of(pos),span_of(pos),span_of(twice));
+            batch_sub(span_of(twice),span_of(pos),span_of(twice));
+            batch_scale(span_of(twice),2.0,span_of(twice));
+
+            VolumeArray<VolumePosition> soaNext;
+            batch_advance(soaPos,soaVel,TimeSpan{0.5_s},soaNext);
+
+            for(std::size_t i=0;i<n;i++) {
+                const VolumePosition expected=pos[i]+xD(Longitude{DistSI{0.5}},Latitude{DistSI{i*0.125}},Altitude{DistSI{-1.0}});
+                if(next[i].x.val.value!=expected.x.val.value || next[i].y.val.value!=expected.y.val.value
+                || next[i].z.val.value!=expected.z.val.value) return false;
+                if(soaNext.get(i).y.val.value!=expected.y.val.value) return false;
+                if(twice[i].y.val.value!=2*pos[i].y.val.value) return false;
+            }
+            o<<COLOR5<<"Kernels "<<COLOR3<<simd::name(simd::active())<<COLOR5<<" OK"<<NOCOLO<<std::endl;
+        }
+        simd::use(simd::detected());
+
+        o<<COLOR2<<"END OF tests for batch kernels."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    /// Typed kernel for comparing with `raw_kernel()`. Both should compile to the same machine code.
+    __attribute__((noinline))
+    void typed_kernel(const DistSI* d,const TimeSI* t,const VelocitySI* v,DistSI* out,std::size_t n)
+    {
+        for(std::size_t i=0;i<n;i++) out[i]=d[i]+v[i]*t[i]+(d[i]/t[i])*t[i];
+    }
+
+    /// Hand-written raw float equivalent of `typed_kernel()`.
+    __attribute__((noinline))
+    void raw_kernel(const float* d,const float* t,const float* v,float* out,std::size_t n)
+    {
+        for(std::size_t i=0;i<n;i++) out[i]=d[i]+v[i]*t[i]+(d[i]/t[i])*t[i];
+    }
+
+    bool test_dimensional_analysis(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for dimensional analysis..."<<NOCOLO<<std::endl;
+
+        static_assert(std::is_same_v<decltype(10_m_s*2_s),DistSI>);
+        static_assert(std::is_same_v<decltype(10_m/2_s),VelocitySI>);
+        static_assert(std::is_same_v<decltype(10_m_s/2_s),AccelerationSI>);
+        static_assert(std::is_same_v<decltype(10_m/2_m),float_base>);
+        static_assert(std::is_same_v<decltype(2_m*3_m),AreaSI>);
+        static_assert(std::is_same_v<decltype(VelAlong{1_m_s}*2_s),Scalar<Along,DistSI>>);
+        static_assert(sizeof(DistSI)==sizeof(float) && sizeof(AreaSI)==sizeof(float));
+        static_assert((10_m_s*2_s).value==20.0f);                     // Fully resolved at compile time.
+        static_assert(strings_equal(AreaSI::abbreviation(),"[m^2]"));
+        static_assert(strings_equal(decltype(1_kg*1_m_s2)::abbreviation(),"[m*kg/s^2]"));
+        static_assert(strings_equal(decltype(1_kg/(1_m*1_m*1_m))::abbreviation(),"[kg/m^3]"));
+        static_assert(strings_equal(decltype(1_K/(1_m*1_s))::abbreviation(),"[K*m^-1*s^-1]"));
+        static_assert(strings_equal(decltype(1_m_s2/1_m_s)::abbreviation(),"[1/s]"));
+
+        Longitude lon=VelAlong{3_m_s}*2_s;
+        if(lon.val.value!=6.0f) return false;
+
+        const std::size_t n=1<<16;
+        std::vector<DistSI> d(n,0_m); std::vector<TimeSI> t(n,1_s); std::vector<VelocitySI> v(n,0_m_s);
+        std::vector<DistSI> typedOut(n,0_m); std::vector<float> rawOut(n);
+        for(std::size_t i=0;i<n;i++) { d[i]=DistSI{i*0.5}; t[i]=TimeSI{1.0+i%7}; v[i]=VelocitySI{i%13-6.0}; }
+
+        typed_kernel(d.data(),t.data(),v.data(),typedOut.data(),n);
+        raw_kernel(&d[0].value,&t[0].value,&v[0].value,rawOut.data(),n);
+        for(std::size_t i=0;i<n;i++) if(typedOut[i].value!=rawOut[i]) return false;   // Bitwise the same math.
+
+        // Same layout as raw floats, so arrays of quantities are arrays of floats. Timings are for merry_bench.
+        static_assert(std::is_trivially_copyable_v<DistSI> && std::is_standard_layout_v<DistSI>);
+        static_assert(alignof(DistSI)==alignof(float) && alignof(VelocitySI)==alignof(float));
+        static_assert(sizeof(DistSI[4])==sizeof(float[4]) && sizeof(TimeSI[4])==sizeof(float[4]));
+
+        o<<COLOR2<<"END OF tests for dimensional analysis."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_precision_policy(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for precision policy..."<<NOCOLO<<std::endl;
+
+        static_assert(sizeof(DistSI64)==sizeof(double) && sizeof(VolumePosition64)==3*sizeof(double));
+        static_assert(std::is_same_v<Solar::precision,float_wide> && std::is_same_v<Flat_simulation::precision,float_base>);
+        static_assert(std::is_same_v<decltype(1_m_s*TimeSI64{2.0}),DistSI64>);
+        static_assert(std::is_same_v<with_precision_t<VelocitySI,float_wide>,VelocitySI64>);
+        static_assert(!std::is_convertible_v<DistSI64,DistSI> && !std::is_convertible_v<DistSI,DistSI64>);
+        static_assert(std::is_constructible_v<DistSI,DistSI64> && std::is_constructible_v<VolumePosition64,VolumePosition>);
+
+        // 1 AU plus one meter is exact in double only.
+        const double au=1.495978707e11;
+        DistSI64 far{au+1.0};
+        if(far.value-au!=1.0 || double(DistSI{far}.value)-au==1.0) return false;
+
+        const std::size_t n=1001;
+        std::vector<VolumePosition64> pos(n,VolumePosition64{VolumePosition{Longitude{0_m},Latitude{0_m},Altitude{0_m}}});
+        std::vector<VolumeVelocity> vel(n,VolumeVelocity{VelAlong{0_m_s},VelAcross{0_m_s},VelUpward{0_m_s}});
+        for(std::size_t i=0;i<n;i++) {
+            pos[i]=xD(Scalar<Along,DistSI64>{DistSI64{au+i}},Scalar<Across,DistSI64>{DistSI64{-au}},
+                      Scalar<Upward,DistSI64>{DistSI64{i*0.5}});
+            vel[i]=xD(VelAlong{VelocitySI{1.0}},VelAcross{VelocitySI{i*0.25}},VelUpward{VelocitySI{-2.0}});
+        }
+        VolumeArray<VolumePosition64> soaPos(n);
+        VolumeArray<VolumeVelocity>   soaVel(n);
+        for(std::size_t i=0;i<n;i++) { soaPos[i]=pos[i]; soaVel[i]=vel[i]; }
+
+        for(int l=int(simd::level::scalar);l<=int(simd::detected());l++) {
+            simd::use(simd::level(l));
+            std::vector<VolumePosition64> next(pos);
+            batch_advance(span_of(pos),span_of(vel),TimeSpan{0.5_s},span_of(next));   // double += float*dt
+            //batch_advance(span_of(vel),span_of(pos),TimeSpan{0.5_s},span_of(next)); //fail on static_assert
+            std::vector<VolumePosition> narrow(n,VolumePosition{Longitude{0_m},Latitude{0_m},Altitude{0_m}});
+            std::vector<VolumePosition64> back(pos);
+            batch_convert(span_of(next),span_of(narrow));
+            batch_convert(span_of(narrow),span_of(back));
+            VolumeArray<VolumePosition64> soaNext;
+            batch_advance(soaPos,soaVel,TimeSpan{0.5_s},soaNext);
+            VolumeArray<VolumePosition> soaNarrow;
+            batch_convert(soaNext,soaNarrow);
+
+            for(std::size_t i=0;i<n;i++) {
+                if(next[i].x.val.value!=au+i+0.5 || next[i].y.val.value!=-au+i*0.125 || soaNext.get(i).z.val.value!=i*0.5-1.0)
+                    return false;
+                if(narrow[i].x.val.value!=float(next[i].x.val.value) || back[i].x.val.value!=double(narrow[i].x.val.value))
+                    return false;
+                if(soaNarrow.get(i).y.val.value!=narrow[i].y.val.value) return false;
+            }
+            o<<COLOR5<<"Mixed kernels "<<COLOR3<<simd::name(simd::active())<<COLOR5<<" OK"<<NOCOLO<<std::endl;
+        }
+        simd::use(simd::detected());
+
+        o<<COLOR2<<"END OF tests for precision policy."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_lazy_expressions(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for lazy expressions..."<<NOCOLO<<std::endl;
+
+        const VolumePosition     p=xD(Longitude{1_m},Latitude{2_m},Altitude{3_m});
+        const VolumeVelocity     v=xD(VelAlong{4_m_s},VelAcross{-5_m_s},VelUpward{6_m_s});
+        const VolumeAcceleration a=xD(AccAlong{0_m_s2},AccAcross{0_m_s2},AccUpward{-9.81_m_s2});
+        const TimeSpan           dt{0.5_s};
+
+        static_assert(!std::is_same_v<decltype(p+v*dt),VolumePosition>);                   // Still lazy.
+        static_assert(std::is_same_v<decltype(p+p),VolumePosition>);                        // Plain `xD()` as before.
+        VolumePosition next=p+v*dt+a*dt*dt/2;
+        //VolumePosition wrong=p+v;                                                         //fail on `xD()`
+        //VolumePosition wrong=lazy(p)+v;                                                   //fail on static_assert
+        //VolumeVelocity wrong=p+v*dt;                                                      //fail on static_assert
+        const float dt2=0.5f*0.5f/2;
+        if(next.x.val.value!=1.0f+4.0f*0.5f+0.0f*dt2 || next.y.val.value!=2.0f-5.0f*0.5f+0.0f*dt2
+        || next.z.val.value!=3.0f+6.0f*0.5f+(-9.81f*0.5f*0.5f)/2) return false;
+
+        VolumePosition diff=lazy(next)-p;
+        VolumeVelocity back=(next-p)/dt;
+        if(diff.y.val.value!=next.y.val.value-2.0f || back.x.val.value!=(next.x.val.value-1.0f)/0.5f) return false;
+        Longitude lon=lazy(p.x)*2.0;
+        if(lon.val.value!=2.0f) return false;
+
+        // Containers, single loop, one of them is also the output.
+        const std::size_t n=1001;
+        VolumeArray<VolumePosition> P(n);
+        VolumeArray<VolumeVelocity> V(n);
+        std::vector<VolumeAcceleration> A(n,a);
+        for(std::size_t i=0;i<n;i++) {
+            P[i]=xD(Longitude{DistSI{i*1.0}},Latitude{DistSI{-i*2.0}},Altitude{DistSI{0.5}});
+            V[i]=xD(VelAlong{VelocitySI{1.0}},VelAcross{VelocitySI{i*0.25}},VelUpward{VelocitySI{-2.0}});
+            A[i].x=AccAlong{AccelerationSI{i*0.1}};
+        }
+        VolumeArray<VolumePosition> expected(P);
+        for(std::size_t i=0;i<n;i++) expected[i]=P.get(i)+V.get(i)*dt+A[i]*dt*dt/2;
+
+        evaluate(lazy(P)+lazy(V)*dt+lazy(span_of(A))*dt*dt/2,P);
+        for(std::size_t i=0;i<n;i++)
+            if(P.xs()[i]!=expected.xs()[i] || P.ys()[i]!=expected.ys()[i] || P.zs()[i]!=expected.zs()[i]) return false;
+
+        std::vector<VolumeVelocity> vel(n,v);
+        evaluate(lazy(span_of(vel))+a*dt,span_of(vel));                                    // Broadcast of `a`.
+        if(vel[n-1].z.val.value!=6.0f+(-9.81f*0.5f)) return false;
+
+        o<<COLOR2<<"END OF tests for lazy expressions."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_integrators(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for integrators..."<<NOCOLO<<std::endl;
+
+        // Harmonic oscillators a=-omega^2*x with the period of 1s. After a single period they should be back.
+        const double pi=3.14159265358979323846;
+        const si_quantity_for<0,0,-2,0>::type omega2{4*pi*pi};
+        auto spring=per_particle([omega2](const VolumePosition& p,const VolumeVelocity&) -> VolumeAcceleration {
+            return -(p*omega2);
+        });
+        typedef Integrator<VolumePosition,VolumeVelocity,VolumeAcceleration> integrator;
+        const std::size_t n=1000,steps=200;
+        const TimeSpan dt{TimeSI{1.0/steps}};
+
+        ParticleState<VolumePosition,VolumeVelocity> start;
+        for(std::size_t i=0;i<n;i++)
+            start.push_back(xD(Longitude{DistSI{1.0+i}},Latitude{DistSI{-0.5*i}},Altitude{0_m}),
+                            xD(VelAlong{0_m_s},VelAcross{0_m_s},VelUpward{0_m_s}));
+
+        auto energy_ratio=[&](const ParticleState<VolumePosition,VolumeVelocity>& s,std::size_t i) {
+            const double x=s.pos.xs()[i],v=s.vel.xs()[i],x0=start.pos.xs()[i];
+            return (x*x*omega2.value+v*v)/(x0*x0*omega2.value);
+        };
+
+        const double tolerance[]={1.0,0.05,2e-3,1e-4};                         // Relative error of position.
+        for(auto m:{integration::euler,integration::semi_implicit_euler,integration::velocity_verlet,integration::rk4}) {
+            auto s=start;
+            integrator in(m); in.min_chunk=64;
+            in.run(s,dt,steps,spring);
+            double worst=0;
+            for(std::size_t i=0;i<n;i++)
+                worst=std::max(worst,std::abs(double(s.pos.xs()[i])/start.pos.xs()[i]-1.0));
+            o<<COLOR5<<name(m)<<": error "<<COLOR3<<worst<<COLOR5<<" energy "<<COLOR3<<energy_ratio(s,n-1)<<NOCOLO<<std::endl;
+            if(std::abs(s.time.value-1.0)>1e-6) return false;
+            if(m==integration::euler) { if(energy_ratio(s,n-1)<1.1) return false; }                 // It must grow.
+            else if(worst>tolerance[int(m)] || std::abs(energy_ratio(s,n-1)-1.0)>0.01) return false;
+        }
+
+        // The same results for any number of threads.
+        auto s1=start,s4=start;
+        integrator single(integration::velocity_verlet),multi(integration::velocity_verlet);
+        single.threads=1; multi.threads=4; multi.min_chunk=64;
+        single.run(s1,dt,10,spring); multi.run(s4,dt,10,spring);
+        for(std::size_t i=0;i<n;i++)
+            if(s1.pos.xs()[i]!=s4.pos.xs()[i] || s1.vel.ys()[i]!=s4.vel.ys()[i]) return false;
+
+        // Wide positions with narrow velocities.
+        ParticleState<VolumePosition64,VolumeVelocity> wide;
+        wide.push_back(VolumePosition64{xD(Longitude{1_m},Latitude{0_m},Altitude{0_m})},
+                       xD(VelAlong{1_m_s},VelAcross{0_m_s},VelUpward{0_m_s}));
+        Integrator<VolumePosition64,VolumeVelocity,VolumeAcceleration> free(integration::rk4);
+        free.run(wide,TimeSpan{0.25_s},4,[](const auto&,std::size_t b,std::size_t e,VecArray<VolumeAcceleration>& out) {
+            for(std::size_t i=b;i<e;i++) out[i]=xD(AccAlong{0_m_s2},AccAcross{0_m_s2},AccUpward{0_m_s2});
+        });
+        if(wide.pos.get(0).x.val.value!=2.0) return false;
+
+        o<<COLOR2<<"END OF tests for integrators."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    /// Bulk conversions of `FIX` must give the same codes as single ones.
+    template<class FIX>
+    bool check_fix_float_bulk(const std::vector<float>& values)
+    {
+        std::vector<FIX>   bulk(values.size());
+        std::vector<float> back(values.size());
+        FIX::encode(values,bulk);
+        FIX::decode(bulk,back);
+        for(std::size_t i=0;i<values.size();i++) {
+            const FIX single(values[i]);
+            if(bulk[i].code()!=single.code() || back[i]!=float(single)) return false;
+        }
+        return true;
+    }
+
+    /// Values from the whole range of `FIX`, with ties between codes and the odd tail for scalar code of kernels.
+    template<class FIX>
+    std::vector<float> fix_float_samples(bool out_of_range)
+    {
+        const std::size_t n=1000;
+        const float lo=FIX::lowest(),hi=FIX::highest();
+        std::vector<float> v;
+        for(std::size_t i=0;i<n;i++) v.push_back(std::min(hi,lo+(hi-lo)*float(i)/float(n-1)));
+        for(int k=0;k<21;k++) v.push_back(FIX::offset+(k+0.5f)*FIX::step);                 // Ties to even.
+        if(out_of_range) {
+            v.push_back(hi+1000*FIX::step); v.push_back(lo-1000*FIX::step);
+            v.push_back(std::numeric_limits<float>::quiet_NaN());
+            v.push_back(std::numeric_limits<float>::infinity());
+            v.push_back(-std::numeric_limits<float>::infinity());
+        }
+        return v;
+    }
+
+    bool test_fix_float(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for fixed point floats..."<<NOCOLO<<std::endl;
+
+        typedef fix_float<float,std::int8_t,4>                           Quarter8;    // [-32,31.5] by 0.25
+        typedef fix_float<float,std::uint8_t,2,-40>                      Celsius8;    // [-40,87] by 0.5
+        typedef fix_float<double,std::uint16_t,1,0,10>                   Tens16;      // [0,655340] by 10
+        typedef fix_float<float,std::int16_t,8,0,1,fix_saturate>         Eighth16;
+        typedef fix_float<float,std::int32_t,256>                        Fine32;
+        typedef fix_float<float,std::uint32_t,1,0,1,fix_saturate>        Count32;
+        static_assert(sizeof(UFloat16)==2 && sizeof(Quarter8)==1 && sizeof(Fine32)==4);
+
+        // Single values.
+        UFloat16 u;
+        if(u.isAssigned() || !UFloat16::isFloatingPoint()) return false;
+        u=0.74f; if(float(u)!=0.5f) return false;                                    // Rounding, not truncation.
+        u=0.76f; if(float(u)!=1.0f) return false;
+        u=0.25f; if(u.code()!=0) return false;                                       // Ties to even.
+        u=0.75f; if(u.code()!=2) return false;
+        u=10; u+=0.5f; if(float(u)!=10.5f || !u.isAssigned()) return false;
+        if(float(fl)!=123.5f || UFloat16::highest()!=32767.0f || UFloat16::lowest()!=0.0f) return false;
+        if(UFloat16::from_code(77).code()!=77) return false;
+
+        if(Celsius8(-40.0f).code()!=0 || Celsius8(20.5f).code()!=121 || float(Celsius8(20.5f))!=20.5f) return false;
+        if(Tens16(1234.0).code()!=123 || double(Tens16(1234.0))!=1230.0) return false;
+        if(Quarter8(-32.0f).code()!=-128 || Quarter8(31.5f).code()!=126) return false;
+
+        Eighth16 e=1e9f;
+        if(e.code()!=Eighth16::highest_code || !e.isAssigned()) return false;      // The reserved code is never hit.
+        e=-1e9f;                                   if(e.code()!=-32768) return false;
+        e=std::numeric_limits<float>::quiet_NaN(); if(e.code()!=-32768) return false;
+        if(Count32(-5.0f).code()!=0 || Count32(1e12f).code()!=4294967040u) return false;
+
+        // Bulk conversions for every level.
+        for(int l=int(simd::level::scalar);l<=int(simd::detected());l++) {
+            simd::use(simd::level(l));
+            if(!check_fix_float_bulk<UFloat16>(fix_float_samples<UFloat16>(false))) return false;
+            if(!check_fix_float_bulk<Quarter8>(fix_float_samples<Quarter8>(false))) return false;
+            if(!check_fix_float_bulk<Celsius8>(fix_float_samples<Celsius8>(false))) return false;
+            if(!check_fix_float_bulk<Eighth16>(fix_float_samples<Eighth16>(true))) return false;
+            if(!check_fix_float_bulk<Fine32>(fix_float_samples<Fine32>(false))) return false;
+            if(!check_fix_float_bulk<Count32>(fix_float_samples<Count32>(true))) return false;
+            o<<COLOR5<<"Kernels "<<COLOR3<<simd::name(simd::active())<<COLOR5<<" OK"<<NOCOLO<<std::endl;
+        }
+        simd::use(simd::detected());
+
+        std::vector<double> wide={0.0,15.0,25.0,654321.0};
+        std::vector<Tens16> tens(wide.size());
+        Tens16::encode(wide,tens);
+        Tens16::decode(tens,wide);
+        if(wide[1]!=20.0 || wide[2]!=20.0 || wide[3]!=654320.0) return false;
+
+        o<<COLOR2<<"END OF tests for fixed point floats."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_compact_arrays(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for compact arrays..."<<NOCOLO<<std::endl;
+
+        // Agents scattered over 10x10 km, the last block only partially filled.
+        const std::size_t n=10000+37;
+        VolumeArray<VolumePosition> pos(n);
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> area(-5000.0f,5000.0f),height(0.0f,300.0f);
+        for(std::size_t i=0;i<n;i++)
+            pos[i]=xD(Longitude{DistSI{area(rng)}},Latitude{DistSI{area(rng)}},Altitude{DistSI{height(rng)}});
+
+        CompactVolumeArray<VolumePosition> compact(pos);
+        o<<COLOR5<<"Bytes per position: "<<COLOR3<<double(compact.bytes())/n<<NOCOLO<<std::endl;
+        if(compact.size()!=n || compact.blocks()!=(n+255)/256 || compact.bytes()>n*6.2) return false;
+
+        auto close=[](float a,float b,float error) { return std::abs(a-b)<=error*1.01f+1e-3f; };
+        auto within_errors=[&](const CompactVolumeArray<VolumePosition>& c,std::size_t i,const VolumePosition& p) {
+            const std::size_t b=i/c.block_size;
+            const VolumePosition d=c.get(i);
+            return close(d.x.val.value,p.x.val.value,c.max_error<0>(b).value)
+                && close(d.y.val.value,p.y.val.value,c.max_error<1>(b).value)
+                && close(d.z.val.value,p.z.val.value,c.max_error<2>(b).value);
+        };
+        for(std::size_t i=0;i<n;i++) if(!within_errors(compact,i,pos.get(i))) return false;
+        if(compact.max_error<0>(0).value>0.1f || compact.max_error<2>(0).value>0.005f) return false;
+
+        // Bulk decoding agrees with single elements for every level.
+        for(int l=int(simd::level::scalar);l<=int(simd::detected());l++) {
+            simd::use(simd::level(l));
+            CompactVolumeArray<VolumePosition> again(pos);
+            VolumeArray<VolumePosition> out;
+            again.decode(out);
+            for(std::size_t i=0;i<n;i++) {
+                const VolumePosition single=compact.get(i);
+                if(!close(out.xs()[i],single.x.val.value,0) || !close(out.ys()[i],single.y.val.value,0)
+                || !close(out.zs()[i],single.z.val.value,0)) return false;
+            }
+            o<<COLOR5<<"Kernels "<<COLOR3<<simd::name(simd::active())<<COLOR5<<" OK"<<NOCOLO<<std::endl;
+        }
+        simd::use(simd::detected());
+
+        // An update inside the range of the block keeps the frame, an update outside re-encodes the block.
+        const float step=compact.frame(0).step[0];
+        const VolumePosition near=xD(Longitude{DistSI{1.0}},Latitude{DistSI{2.0}},Altitude{DistSI{3.0}});
+        compact.set(5,near);
+        if(compact.frame(0).step[0]!=step || !within_errors(compact,5,near)) return false;
+        const VolumePosition far=xD(Longitude{DistSI{1.0e6}},Latitude{DistSI{2.0}},Altitude{DistSI{3.0}});
+        compact.set(7,far);
+        if(compact.frame(0).step[0]<=step || !within_errors(compact,7,far)) return false;
+        for(std::size_t i=0;i<compact.block_size;i++) {
+            VolumePosition p=pos.get(i);
+            if(i==5) p=near; else if(i==7) p=far;
+            if(std::abs(compact.get(i).x.val.value-p.x.val.value)>step/2+compact.max_error<0>(0).value+1e-3f)
+                return false;
+        }
+        if(!within_errors(compact,256,pos.get(256))) return false;                         // Other blocks untouched.
+
+        // Growing one by one, with the resolution limit.
+        CompactPlaneArray<PlanePosition> track(DistSI{0.01});
+        for(std::size_t i=0;i<1000;i++) track.push_back(xD(Longitude{DistSI{i*0.5}},Latitude{DistSI{-1.0}}));
+        for(std::size_t i=0;i<1000;i++) {
+            const PlanePosition p=track.get(i);
+            if(std::abs(p.x.val.value-i*0.5f)>track.max_error<0>(i/256).value*1.01f) return false;
+            if(p.y.val.value!=-1.0f || track.frame(i/256).step[1]!=0.01f) return false;
+        }
+        track.resize(1100);
+        if(track.get(1050).x.val.value!=0.0f || track.get(999).x.val.value!=999*0.5f) return false;
+
+        // Without the resolution limit, appended blocks refit to their values. Repeated refits may double errors
+        // and the step may end up to twice that of bulk encoding, so 4 times the bulk bound at most.
+        VolumeArray<VolumePosition> steps(600);
+        for(std::size_t i=0;i<steps.size();i++)
+            steps[i]=xD(Longitude{DistSI{0.1f*(i+1)}},Latitude{DistSI{area(rng)/1000}},Altitude{DistSI{-0.5f}});
+        CompactVolumeArray<VolumePosition> appended,bulk(steps);
+        for(std::size_t i=0;i<steps.size();i++) appended.push_back(steps.get(i));
+        for(std::size_t i=0;i<steps.size();i++) {
+            const std::size_t b=i/appended.block_size;
+            const VolumePosition p=steps.get(i),d=appended.get(i);
+            auto fits=[](float a,float e,float own,float bulk) { return std::abs(a-e)<=std::min(2*own,4*bulk)*1.01f; };
+            if(!fits(d.x.val.value,p.x.val.value,appended.max_error<0>(b).value,bulk.max_error<0>(b).value)
+            || !fits(d.y.val.value,p.y.val.value,appended.max_error<1>(b).value,bulk.max_error<1>(b).value)
+            || d.z.val.value!=-0.5f) return false;
+        }
+        if(std::abs(appended.get(2).x.val.value-0.3f)>0.001f) return false;                 // Not whole metres.
+        appended.resize(700);
+        appended.set(650,xD(Longitude{DistSI{0.2f}},Latitude{DistSI{0.1f}},Altitude{DistSI{0.3f}}));
+        const VolumePosition set=appended.get(650);
+        if(std::abs(set.x.val.value-0.2f)>0.001f || std::abs(set.y.val.value-0.1f)>0.001f
+        || std::abs(set.z.val.value-0.3f)>0.001f || appended.get(649).x.val.value!=0.0f) return false;
+
+        o<<COLOR2<<"END OF tests for compact arrays."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    /// Brute force reference for spatial indices: sorted indices within `r` of `c`.
+    template<class POS>
+    std::vector<std::size_t> brute_radius(const VecArray<POS>& pts,const POS& c,float r)
+    {
+        std::vector<std::size_t> found;
+        for(std::size_t i=0;i<pts.size();i++) {
+            const float dx=pts.xs()[i]-c.x.val.value,dy=pts.ys()[i]-c.y.val.value;
+            float d2=dx*dx+dy*dy;
+            if constexpr (VecArray<POS>::dimensions==3) { const float dz=pts.zs()[i]-c.z.val.value; d2+=dz*dz; }
+            if(d2<=r*r) found.push_back(i);
+        }
+        return found;
+    }
+
+    template<class POS>
+    float distance_between(const POS& a,const POS& b)
+    {
+        const float dx=a.x.val.value-b.x.val.value,dy=a.y.val.value-b.y.val.value;
+        float d2=dx*dx+dy*dy;
+        if constexpr (vec_traits<POS>::dimensions==3) { const float dz=a.z.val.value-b.z.val.value; d2+=dz*dz; }
+        return std::sqrt(d2);
+    }
+
+    /// Radius and k-nearest queries of `index` must agree with brute force, single and batched.
+    template<class INDEX,class POS>
+    bool check_spatial_index(const INDEX& index,const VecArray<POS>& pts,const VecArray<POS>& queries,float r,
+                             std::size_t k)
+    {
+        typedef typename INDEX::neighbor_type found_type;
+        std::vector<found_type> found;
+        typename INDEX::lists_type all_within,all_nearest;
+        index.radius_all(queries,DistSI{r},all_within);
+        index.nearest_all(queries,k,all_nearest);
+        if(all_within.size()!=queries.size() || all_nearest.size()!=queries.size()) return false;
+        for(std::size_t q=0;q<queries.size();q++) {
+            const POS c=queries.get(q);
+            const std::vector<std::size_t> expected=brute_radius(pts,c,r);
+            index.radius(c,DistSI{r},found);
+            std::vector<std::size_t> got;
+            for(const auto& f:found) got.push_back(f.index);
+            std::sort(got.begin(),got.end());
+            if(got!=expected || all_within.count(q)!=found.size()) return false;
+            for(const auto& f:found) if(std::abs(f.distance.value-distance_between(pts.get(f.index),c))>1e-3f) return false;
+
+            // The k-th nearest distance: the radius that holds exactly k elements or more.
+            index.nearest(c,k,found);
+            if(found.size()!=std::min(k,pts.size())) return false;
+            for(std::size_t j=1;j<found.size();j++) if(found[j].distance.value<found[j-1].distance.value) return false;
+            const float kth=found.back().distance.value;
+            if(brute_radius(pts,c,kth*1.0001f).size()<k) return false;
+            if(kth>0 && brute_radius(pts,c,kth*0.9999f).size()>=k) return false;
+            for(std::size_t j=0;j<found.size();j++)
+                if(all_nearest.begin(q)[j].distance.value!=found[j].distance.value) return false;
+        }
+        return true;
+    }
+
+    bool test_spatial_index(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for spatial indices..."<<NOCOLO<<std::endl;
+
+        std::vector<int> numbers(100000);
+        std::mt19937 rng(11);
+        for(int& v:numbers) v=int(rng()%1000);
+        std::vector<int> sorted=numbers;
+        std::sort(sorted.begin(),sorted.end());
+        flow::parallel_sort(numbers.begin(),numbers.end(),std::less<>{},1000,5);
+        if(numbers!=sorted) return false;
+
+        // Agents in 1000x1000x100 m, with a crowd at a single point.
+        std::uniform_real_distribution<float> area(0.0f,1000.0f),height(0.0f,100.0f);
+        auto random_position=[&] {
+            return xD(Longitude{DistSI{area(rng)}},Latitude{DistSI{area(rng)}},Altitude{DistSI{height(rng)}});
+        };
+        VolumeArray<VolumePosition> pts;
+        for(std::size_t i=0;i<20000;i++) pts.push_back(random_position());
+        for(std::size_t i=0;i<100;i++) pts.push_back(xD(Longitude{500_m},Latitude{500_m},Altitude{50_m}));
+        VolumeArray<VolumePosition> queries;
+        for(std::size_t i=0;i<150;i++) queries.push_back(random_position());
+        queries.push_back(xD(Longitude{500_m},Latitude{500_m},Altitude{50_m}));
+        queries.push_back(xD(Longitude{DistSI{-3000.0}},Latitude{0_m},Altitude{0_m}));      // Far outside.
+
+        UniformGrid<VolumePosition> grid(10_m);
+        MortonOctree<VolumePosition> tree;
+        grid.min_chunk=tree.min_chunk=64;
+        auto t0=std::chrono::steady_clock::now();
+        grid.rebuild(pts);
+        auto t1=std::chrono::steady_clock::now();
+        tree.rebuild(pts);
+        auto t2=std::chrono::steady_clock::now();
+        o<<COLOR5<<"Rebuild of grid "<<COLOR3<<std::chrono::duration<double,std::micro>(t1-t0).count()<<"us"
+         <<COLOR5<<", octree "<<COLOR3<<std::chrono::duration<double,std::micro>(t2-t1).count()<<"us"
+         <<COLOR5<<" with "<<COLOR3<<tree.nodes()<<COLOR5<<" nodes"<<NOCOLO<<std::endl;
+        if(!check_spatial_index(grid,pts,queries,12.0f,8) || !check_spatial_index(tree,pts,queries,12.0f,8)) return false;
+        if(!check_spatial_index(grid,pts,queries,150.0f,3) || !check_spatial_index(tree,pts,queries,150.0f,200))
+            return false;
+
+        // Some agents move far, the rest a little.
+        std::vector<std::size_t> moved;
+        for(std::size_t i=0;i<pts.size();i+=97) { pts[i]=random_position(); moved.push_back(i); }
+        grid.update(moved);
+        if(grid.loose_count()==0) return false;
+        for(std::size_t i=1;i<pts.size();i+=89) pts[i]+=xD(Longitude{3_m},Latitude{-4_m},Altitude{1_m});
+        grid.update();
+        tree.update();
+        if(!check_spatial_index(grid,pts,queries,12.0f,8) || !check_spatial_index(tree,pts,queries,12.0f,8)) return false;
+
+        // Plane positions, indexed again after growing.
+        PlaneArray<PlanePosition> flat;
+        for(std::size_t i=0;i<3000;i++) flat.push_back(xD(Longitude{DistSI{area(rng)}},Latitude{DistSI{area(rng)}}));
+        PlaneArray<PlanePosition> flat_queries;
+        for(std::size_t i=0;i<50;i++) flat_queries.push_back(flat.get(i*7));
+        UniformGrid<PlanePosition> flat_grid(25_m);
+        MortonOctree<PlanePosition> flat_tree;
+        flat_grid.rebuild(flat); flat_tree.rebuild(flat);
+        if(!check_spatial_index(flat_grid,flat,flat_queries,30.0f,5)) return false;
+        if(!check_spatial_index(flat_tree,flat,flat_queries,30.0f,5)) return false;
+        flat.push_back(xD(Longitude{2000_m},Latitude{2000_m}));
+        flat_grid.update(); flat_tree.rebuild(flat);
+        if(!check_spatial_index(flat_grid,flat,flat_queries,30.0f,5)) return false;
+        if(!check_spatial_index(flat_tree,flat,flat_queries,30.0f,5)) return false;
+
+        // A far outlier: growing cubes stop before reaching it, so all elements are checked at once.
+        VolumeArray<VolumePosition> sparse;
+        for(int i=0;i<5;i++) sparse.push_back(xD(Longitude{DistSI{0.3f*float(i)}},Latitude{0_m},Altitude{0_m}));
+        sparse.push_back(xD(Longitude{DistSI{1e5f}},Latitude{0_m},Altitude{0_m}));
+        UniformGrid<VolumePosition> sparse_grid(1_m);
+        MortonOctree<VolumePosition> sparse_tree;
+        sparse_grid.rebuild(sparse); sparse_tree.rebuild(sparse);
+        std::vector<neighbor<DistSI>> from_grid,from_tree;
+        const VolumePosition origin=xD(Longitude{0_m},Latitude{0_m},Altitude{0_m});
+        sparse_grid.nearest(origin,6,from_grid); sparse_tree.nearest(origin,6,from_tree);
+        if(from_grid.size()!=6 || from_tree.size()!=6 || from_grid.back().index!=5 || from_tree.back().index!=5)
+            return false;
+        sparse_grid.radius(origin,DistSI{std::numeric_limits<float>::max()},from_grid);
+        if(from_grid.size()!=6) return false;
+        sparse_grid.radius(xD(Longitude{DistSI{-1e30f}},Latitude{0_m},Altitude{0_m}),2_m,from_grid);
+        if(!from_grid.empty()) return false;
+
+        o<<COLOR2<<"END OF tests for spatial indices."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_reductions(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for reductions..."<<NOCOLO<<std::endl;
+
+        // Millions of small masses: a naive `float` sum would lose whole percents.
+        const std::size_t n=3000000;
+        std::mt19937 rng(12);
+        std::uniform_real_distribution<float> small(0.05f,0.15f),area(-1000.0f,1000.0f),speed(-20.0f,20.0f);
+        std::vector<MassQuan> masses(n,MassQuan{MassSI{0.0f}});
+        VolumeArray<VolumePosition> pos;
+        VolumeArray<VolumeVelocity> vel;
+        pos.resize(n); vel.resize(n);
+        long double total=0,moment[3]={0,0,0},plain[3]={0,0,0},energy=0,momentum=0;
+        float naive=0;
+        for(std::size_t i=0;i<n;i++) {
+            masses[i]=MassQuan{MassSI{small(rng)}};
+            pos[i]=xD(Longitude{DistSI{area(rng)}},Latitude{DistSI{area(rng)}},Altitude{DistSI{area(rng)/10}});
+            vel[i]=xD(VelAlong{VelocitySI{speed(rng)}},VelAcross{VelocitySI{speed(rng)}},VelUpward{VelocitySI{0.0f}});
+            const long double m=masses[i].val.value;
+            const long double p[3]={pos.xs()[i],pos.ys()[i],pos.zs()[i]};
+            total+=m; naive+=masses[i].val.value;
+            for(int a=0;a<3;a++) { moment[a]+=m*p[a]; plain[a]+=p[a]; }
+            momentum+=vel.xs()[i];
+            energy+=m*((long double)vel.xs()[i]*vel.xs()[i]+(long double)vel.ys()[i]*vel.ys()[i])/2;
+        }
+        auto close=[](long double got,long double expected,long double tolerance) {
+            return std::abs(got-expected)<=tolerance*std::max<long double>(1,std::abs(expected));
+        };
+
+        auto t0=std::chrono::steady_clock::now();
+        const MassQuan mass=sum(masses);
+        auto t1=std::chrono::steady_clock::now();
+        o<<COLOR5<<"Sum of "<<COLOR3<<n<<COLOR5<<" masses in "<<COLOR3
+         <<std::chrono::duration<double,std::micro>(t1-t0).count()<<"us"<<COLOR5<<", error "<<COLOR3
+         <<double(mass.val.value-total)<<COLOR5<<", naive float error "<<COLOR3<<double(naive-total)<<NOCOLO<<std::endl;
+        if(!close(mass.val.value,total,1e-7L)) return false;
+        if(sum(masses,1).val.value!=mass.val.value || sum(masses,7).val.value!=mass.val.value) return false;
+
+        const VolumePosition mean=centroid(pos);
+        const VolumePosition center=centroid(pos,masses,3);
+        if(!close(mean.x.val.value,plain[0]/n,1e-6L) || !close(mean.z.val.value,plain[2]/n,1e-6L)) return false;
+        if(!close(center.x.val.value,moment[0]/total,1e-6L) || !close(center.y.val.value,moment[1]/total,1e-6L))
+            return false;
+        if(centroid(pos,masses,1).z.val.value!=center.z.val.value) return false;
+
+        const auto kinetic=kinetic_energy(masses,vel);
+        static_assert(std::is_same_v<decltype(kinetic)::unit_type,decltype(1_kg*1_m_s*1_m_s)::unit_type>,
+                      "Kinetic energy must be in kg*m^2/s^2!");
+        if(!close(kinetic.value,energy,1e-6L)) return false;
+        if(kinetic_energy(masses,vel,2).value!=kinetic.value) return false;
+
+        const VolumeVelocity drift=sum(vel);
+        if(drift.z.val.value!=0.0f || !close(drift.x.val.value,momentum,1e-6L)) return false;
+
+        // Extremes, with a few elements not filling a block.
+        const auto box=bounds(pos);
+        if(box.lo.x.val.value<-1000.0f || box.hi.x.val.value>1000.0f || box.lo.z.val.value<-100.0f) return false;
+        if(box.hi.y.val.value<999.0f || box.lo.y.val.value>-999.0f) return false;
+        std::vector<DistSI> few{DistSI{3.0f},DistSI{-2.5f},DistSI{7.0f}};
+        const auto [lo,hi]=min_max(few);
+        if(lo.value!=-2.5f || hi.value!=7.0f || sum(few).value!=7.5f) return false;
+
+        o<<COLOR2<<"END OF tests for reductions."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_task_pool(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for the task pool..."<<NOCOLO<<std::endl;
+
+        // Every index exactly once, in chunks not shorter than asked.
+        flow::task_pool pool(4);
+        const std::size_t n=100000;
+        std::vector<std::atomic<int>> visits(n);
+        std::atomic<std::size_t> chunks{0},shortest{n};
+        pool.parallel_for(n,300,[&](std::size_t b,std::size_t e) {
+            for(std::size_t i=b;i<e;i++) visits[i]++;
+            chunks++;
+            std::size_t s=shortest.load();
+            while(e-b<s && !shortest.compare_exchange_weak(s,e-b)) {}
+        });
+        for(const auto& v:visits) if(v.load()!=1) return false;
+        if(shortest.load()<300 || chunks.load()<8) return false;
+        chunks=0;
+        pool.parallel_for(n,10,[&](std::size_t,std::size_t) { chunks++; },2);
+        if(chunks.load()>2) return false;
+
+        // Nested loops and exceptions.
+        std::atomic<std::size_t> inner{0};
+        flow::parallel_for(64,1,[&](std::size_t b,std::size_t e) {
+            for(std::size_t i=b;i<e;i++)
+                flow::parallel_for(1000,10,[&](std::size_t bb,std::size_t ee) { inner+=ee-bb; });
+        });
+        if(inner.load()!=64000) return false;
+        bool caught=false;
+        try { pool.parallel_for(n,100,[](std::size_t b,std::size_t) { if(b>0) throw std::runtime_error("chunk"); }); }
+        catch(const std::runtime_error&) { caught=true; }
+        if(!caught) return false;
+
+        // Positions of a typed array moved in place.
+        VolumeArray<VolumePosition> pos;
+        for(std::size_t i=0;i<5000;i++) pos.push_back(xD(Longitude{DistSI{float(i)}},Latitude{0_m},Altitude{0_m}));
+        const VolumePosition shift=xD(Longitude{1_m},Latitude{2_m},Altitude{3_m});
+        flow::parallel_for_each(pos,256,[&shift](auto p) { p=VolumePosition(p)+shift; });
+        for(std::size_t i=0;i<pos.size();i++)
+            if(pos.xs()[i]!=float(i)+1 || pos.ys()[i]!=2.0f || pos.zs()[i]!=3.0f) return false;
+
+        // Groups and graphs of step phases.
+        std::atomic<int> done{0};
+        {
+            flow::task_group group(pool);
+            for(int k=0;k<100;k++) group.run([&] { done++; });
+            group.wait();
+        }
+        if(done.load()!=100) return false;
+
+        std::vector<int> order;
+        std::mutex order_lock;
+        auto phase=[&](int id) { return [&,id] { std::lock_guard<std::mutex> g(order_lock); order.push_back(id); }; };
+        flow::task_graph step;
+        const auto forces=step.add(phase(1));
+        const auto drag=step.add(phase(2));
+        const auto integrate=step.add(phase(3),{forces,drag});
+        step.add(phase(4),{integrate});
+        for(int k=0;k<3;k++) {
+            order.clear();
+            step.run(pool);
+            if(order.size()!=4 || order[2]!=3 || order[3]!=4) return false;
+        }
+        step.add([] { throw std::runtime_error("phase"); },{integrate});
+        caught=false;
+        try { step.run(pool); } catch(const std::runtime_error&) { caught=true; }
+        if(!caught) return false;
+
+        // Scratch memory is aligned and reused.
+        void* first=nullptr;
+        for(int k=0;k<2;k++) {
+            flow::scratch_scope scope;
+            float* a=scope.allocate<float>(1000);
+            double* b=scope.allocate<double>(1u<<17);
+            if(reinterpret_cast<std::uintptr_t>(a)%64!=0 || reinterpret_cast<std::uintptr_t>(b)%64!=0) return false;
+            if(k==0) first=a; else if(first!=a) return false;
+            a[999]=1; b[(1u<<17)-1]=2;
+        }
+
+        o<<COLOR2<<"END OF tests for the task pool."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_snapshots(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for snapshots..."<<NOCOLO<<std::endl;
+        const std::string path=(std::filesystem::temp_directory_path()/"merry_snapshot_test.snap").string();
+
+        VolumeArray<VolumePosition> pos;
+        PlaneArray<PlaneVelocity> vel;
+        std::vector<MassQuan> masses;
+        std::vector<TimeSI64> ages;
+        for(std::size_t i=0;i<1001;i++) {
+            pos.push_back(xD(Longitude{DistSI{i*0.5f}},Latitude{DistSI{-1.0f*i}},Altitude{DistSI{100.0f}}));
+            vel.push_back(xD(VelAlong{VelocitySI{float(i)}},VelAcross{VelocitySI{2.0f}}));
+            masses.push_back(MassQuan{MassSI{1.0f+i}});
+            ages.push_back(TimeSI64{i*1e6});
+        }
+        snapshot_writer{}.add("positions",pos).add("velocities",vel).add("masses",masses).add("ages",ages)
+                         .add("nothing",std::vector<MassQuan>{}).save(path);
+
+        {
+            const snapshot snap(path);
+            if(snap.columns()!=5 || std::string(snap.find("positions")->system)!="flat-Earth") return false;
+            if(std::string(snap.find("velocities")->unit)!="[m/s]" || snap.find("masses")->value_bytes!=4) return false;
+            const auto p=snap.vectors<VolumePosition>("positions");
+            const auto v=snap.vectors<PlaneVelocity>("velocities");
+            const auto m=snap.values<MassQuan>("masses");
+            const auto a=snap.values<TimeSI64>("ages");
+            if(p.size()!=1001 || m.size()!=1001 || snap.values<MassQuan>("nothing").size()!=0) return false;
+            if(reinterpret_cast<std::uintptr_t>(p.zs())%64!=0 || reinterpret_cast<std::uintptr_t>(m.data())%64!=0)
+                return false;
+            for(std::size_t i=0;i<1001;i++) {
+                if(p[i].x.val.value!=pos.xs()[i] || p[i].y.val.value!=pos.ys()[i] || p.zs()[i]!=100.0f) return false;
+                if(v[i].x.val.value!=float(i) || m[i].val.value!=1.0f+i || a[i].value!=i*1e6) return false;
+            }
+            VolumeArray<VolumePosition> copy;
+            p.copy_to(copy);
+            if(copy.size()!=1001 || copy.get(1000).y.val.value!=-1000.0f) return false;
+
+            // Types not matching the file are rejected before any value is read.
+            auto rejected=[](auto open) { try { open(); } catch(const snapshot_error&) { return true; } return false; };
+            if(!rejected([&] { snap.vectors<VolumeVelocity>("positions"); })) return false;        // Unit.
+            if(!rejected([&] { snap.vectors<PlanePosition>("positions"); })) return false;         // Components.
+            if(!rejected([&] { snap.values<MassSI>("masses"); })) return false;                    // Axis.
+            if(!rejected([&] { snap.values<TimeSI>("ages"); })) return false;                      // Precision.
+            if(!rejected([&] { snap.values<MassQuan>("mass"); })) return false;                    // Name.
+        }
+
+        // Damaged files.
+        {
+            std::fstream f(path,std::ios::in|std::ios::out|std::ios::binary);
+            f.seekp(8); const std::uint32_t version=99; f.write(reinterpret_cast<const char*>(&version),4);
+        }
+        bool caught=false;
+        try { snapshot bad(path); } catch(const snapshot_error& e) { caught=true; o<<COLOR5<<e.what()<<NOCOLO<<std::endl; }
+        std::filesystem::resize_file(path,100);
+        try { snapshot bad(path); caught=false; } catch(const snapshot_error&) {}
+        std::filesystem::remove(path);
+        if(!caught) return false;
+
+        o<<COLOR2<<"END OF tests for snapshots."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_trajectories(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for trajectories..."<<NOCOLO<<std::endl;
+        const std::string path=(std::filesystem::temp_directory_path()/"merry_trajectory_test.traj").string();
+
+        const std::size_t n=20000;
+        VolumeArray<VolumePosition> pos(n);
+        VolumeArray<VolumeVelocity> vel(n);
+        std::vector<MassQuan> masses(n,MassQuan{MassSI{2.0f}});
+        for(std::size_t i=0;i<n;i++) vel[i]=xD(VelAlong{VelocitySI{float(i%100)}},VelAcross{1_m_s},VelUpward{0_m_s});
+        auto step=[&] { batch_advance(pos,vel,TimeSpan{0.5_s},pos); };
+
+        // Every second step with positions, every tenth also with velocities, masses only at the beginning.
+        auto t0=std::chrono::steady_clock::now();
+        {
+            trajectory_writer out(path,2,2);
+            out.column("positions",pos).column("velocities",vel,10).column("masses",masses,1000);
+            for(std::uint64_t k=0;k<200;k++) {
+                step();
+                if(out.write(k,TimeSI64{k*0.5})!=(k%2==0)) return false;
+            }
+            out.flush();
+            if(out.frames()!=100) return false;
+            const auto t1=std::chrono::steady_clock::now();
+            o<<COLOR5<<"Written "<<COLOR3<<out.frames()<<COLOR5<<" frames with "<<COLOR3<<out.stalls()
+             <<COLOR5<<" stalls in "<<COLOR3<<std::chrono::duration<double,std::milli>(t1-t0).count()<<"ms"
+             <<NOCOLO<<std::endl;
+            out.close();
+        }
+
+        {
+            const trajectory traj(path);
+            if(traj.frames()!=100 || !traj.complete()) return false;
+            for(std::size_t f=0;f<traj.frames();f++) {
+                const snapshot_image& frame=traj.frame(f);
+                const std::uint64_t k=2*f;
+                if(frame.step()!=k || frame.time().value!=k*0.5) return false;
+                if((frame.find("velocities")!=nullptr)!=(k%10==0) || (frame.find("masses")!=nullptr)!=(k==0))
+                    return false;
+                const auto p=frame.vectors<VolumePosition>("positions");
+                if(p.size()!=n || p.xs()[123]!=float(23*0.5*(k+1)) || p.ys()[n-1]!=float(0.5*(k+1))) return false;
+            }
+            if(traj.frame(0).values<MassQuan>("masses")[7].val.value!=2.0f) return false;
+            if(traj.frame(5).vectors<VolumeVelocity>("velocities").xs()[42]!=42.0f) return false;
+        }
+
+        // A crash in the middle of a frame loses only that frame.
+        std::filesystem::resize_file(path,std::filesystem::file_size(path)-100);
+        {
+            const trajectory traj(path);
+            if(traj.frames()!=99 || traj.complete()) return false;
+        }
+        std::filesystem::remove(path);
+
+        bool caught=false;
+        try { trajectory_writer bad("/nonexistent/directory/x.traj"); } catch(const snapshot_error&) { caught=true; }
+        if(!caught) return false;
+
+        o<<COLOR2<<"END OF tests for trajectories."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_formatting(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for formatting..."<<NOCOLO<<std::endl;
+
+        if(to_text(DistSI{1.5f})!="1.5[m]" || to_text(MassQuan{MassSI{2.0f}})!="m=2[kg]") return false;
+        if(to_text(xD(Longitude{DistSI{1.5f}},Latitude{2_m}))!="X=1.5[m] Y=2[m]") return false;
+        const VolumeVelocity v=xD(VelAlong{1_m_s},VelAcross{VelocitySI{-0.25f}},VelUpward{0_m_s});
+        if(to_text(v)!="X=1[m/s] Y=-0.25[m/s] Z=0[m/s]") return false;
+        if(to_text(1_m*2_m)!="2[m^2]" || to_text(TimeSI64{0.1})!="0.1[s]" || to_string(DistSI{1e-7f})!="1e-07[m]")
+            return false;
+
+        // Shortest text that reads back the same.
+        std::mt19937 rng(15);
+        std::uniform_real_distribution<float> any(-1e6f,1e6f);
+        for(int k=0;k<1000;k++) {
+            const DistSI d{any(rng)};
+            const std::string_view t=to_text(d);
+            if(std::strtof(std::string(t.substr(0,t.size()-3)).c_str(),nullptr)!=d.value) return false;
+        }
+
+        char small[8];
+        if(format_to(small,small+sizeof small,DistSI{1.5f}).ec!=std::errc() ||
+           format_to(small,small+sizeof small,xD(Longitude{DistSI{1.5f}},Latitude{2_m})).ec!=std::errc::value_too_large)
+            return false;
+
+        std::ostringstream os;
+        os<<xD(Longitude{1_m},Latitude{2_m},Altitude{3_m})<<';'<<TimeSpan{0.5_s};
+        if(os.str()!="X=1[m] Y=2[m] Z=3[m];t=0.5[s]") return false;
+
+        // Tables, bigger than a single block of rows.
+        VolumeArray<VolumePosition> pos;
+        std::vector<MassQuan> masses;
+        std::vector<TimeSI> ages;
+        for(std::size_t i=0;i<10000;i++) {
+            pos.push_back(xD(Longitude{DistSI{i*0.5f}},Latitude{DistSI{-1.0f*i}},Altitude{3_m}));
+            masses.push_back(MassQuan{MassSI{float(i%7)}});
+            ages.push_back(TimeSI{float(i)});
+        }
+        std::ostringstream csv,tsv;
+        table_writer(csv).column("pos",pos).column("mass",masses).column("age",ages).write();
+        table_writer(tsv,'\t').column("",masses).write(3);
+        const std::string text=csv.str();
+        if(text.compare(0,47,"pos.X[m],pos.Y[m],pos.Z[m],mass.m[kg],age[s]\n0,")!=0) return false;
+        if(text.find("\n4999.5,-9999,3,3,9999\n")==std::string::npos || text.back()!='\n') return false;
+        if(std::count(text.begin(),text.end(),'\n')!=10001) return false;
+        const std::string tabs=tsv.str();
+        if(tabs.compare(0,12,"m[kg]\n0\n1\n2\n")!=0 || std::count(tabs.begin(),tabs.end(),'\n')!=10001) return false;
+        try {
+            table_writer(csv).column("pos",pos).column("age",std::vector<TimeSI>(ages.begin(),ages.end()-1));
+            return false;
+        } catch(const std::invalid_argument&) {}
+
+        o<<COLOR2<<"END OF tests for formatting."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_parsing(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for parsing..."<<NOCOLO<<std::endl;
+
+        if(from_text<VelocitySI>("12.5[m/s]").value!=12.5f || from_text<TimeSI64>("-1e-3[s]").value!=-1e-3)
+            return false;
+        const VolumeVelocity v=from_text<VolumeVelocity>("X=1[m/s] Y=-0.25[m/s]\tZ=0[m/s]");
+        if(v.x.val.value!=1.0f || v.y.val.value!=-0.25f || v.z.val.value!=0.0f) return false;
+        if(from_text<MassQuan>(to_text(MassQuan{MassSI{0.1f}})).val.value!=0.1f) return false;
+
+        // Units and axes must be the ones of the type.
+        for(const char* bad:{"12.5[m]","12.5","12.5[m/s] ","[m/s]"}) {
+            try { from_text<VelocitySI>(bad); return false; } catch(const parse_error&) {}
+        }
+        try { from_text<VelAcross>("X=1[m/s]"); return false; } catch(const parse_error&) {}
+        VelAlong along{0_m_s};
+        const char text[]="X=3[m/s],rest";
+        const auto [end,ec]=parse(text,text+sizeof text-1,along);
+        if(ec!=std::errc() || *end!=',' || along.val.value!=3.0f) return false;
+        if(parse(text+1,text+sizeof text-1,along).ec!=std::errc::invalid_argument) return false;
+
+        // Tables written by `table_writer` read back the same, over several chunks of the file.
+        const std::string path=(std::filesystem::temp_directory_path()/"merry_parse_test.csv").string();
+        VolumeArray<VolumePosition> pos;
+        std::vector<MassQuan> masses;
+        std::vector<TimeSI> ages;
+        std::mt19937 rng(16);
+        std::uniform_real_distribution<float> any(-1e6f,1e6f);
+        for(std::size_t i=0;i<30000;i++) {
+            pos.push_back(xD(Longitude{DistSI{any(rng)}},Latitude{DistSI{-1.0f*i}},Altitude{DistSI{any(rng)}}));
+            masses.push_back(MassQuan{MassSI{float(i%7)}});
+            ages.push_back(TimeSI{any(rng)});
+        }
+        {
+            std::ofstream csv(path,std::ios::binary);
+            table_writer(csv).column("pos",pos).column("mass",masses).column("age",ages).write();
+        }
+        VolumeArray<VolumePosition> pos2;
+        std::vector<TimeSI> ages2;
+        table_reader reader(path);
+        if(reader.labels().size()!=5 || reader.labels()[3]!="mass.m[kg]") return false;
+        if(reader.column("pos",pos2).column("age",ages2).read(3)!=pos.size()) return false;
+        if(pos2.size()!=pos.size() || ages2.size()!=ages.size()) return false;
+        for(std::size_t i=0;i<pos.size();i++)
+            if(pos2.xs()[i]!=pos.xs()[i] || pos2.ys()[i]!=pos.ys()[i] || pos2.zs()[i]!=pos.zs()[i] ||
+               ages2[i].value!=ages[i].value) return false;
+
+        std::vector<DistSI> wrong;
+        PlaneArray<PlanePosition> missing;
+        try { table_reader(path).column("age",wrong); return false; } catch(const parse_error&) {}
+        try { table_reader(path).column("posit",missing); return false; } catch(const parse_error&) {}
+
+        {
+            std::ofstream tsv(path,std::ios::binary);
+            tsv<<"m[kg]\tnote\r\n1\tx\r\n\r\n2.5\ty\r\nheavy\tz\r\n";
+        }
+        std::vector<MassQuan> masses2;
+        try { table_reader(path,'\t').column("",masses2).read(); return false; }
+        catch(const parse_error& e) { if(std::string(e.what()).find("Row 3")==std::string::npos) return false; }
+        if(masses2.size()!=3 || masses2[1].val.value!=2.5f) return false;
+        std::filesystem::remove(path);
+
+        o<<COLOR2<<"END OF tests for parsing."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_logging(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for logging..."<<NOCOLO<<std::endl;
+
+        // Lines of every thread in order, colors stripped as the stream is not a terminal.
+        std::ostringstream os;
+        {
+            log_sink sink(log_options{1<<10,log_overflow::block});
+            if(sink.is_set()) return false;
+            os<<sink;
+            if(!sink.is_set() || sink.colored()) return false;
+            std::vector<std::thread> threads;
+            for(int t=0;t<4;t++)
+                threads.emplace_back([&sink,t] {
+                    for(int i=0;i<2000;i++) log_line(sink)<<COLOR3<<"thread "<<t<<" line "<<i<<NOCOLO;
+                });
+            for(std::thread& t:threads) t.join();
+            log_line(sink)<<"at "<<xD(Longitude{1_m},Latitude{2.5_m})<<' '<<0.5_s;
+            sink.flush();
+            if(sink.dropped()!=0) return false;
+        }
+        const std::string text=os.str();
+        if(std::count(text.begin(),text.end(),'\n')!=8001 || text.find('\033')!=std::string::npos) return false;
+        if(text.find("at X=1[m] Y=2.5[m] 0.5[s]\n")==std::string::npos) return false;
+        for(int t=0;t<4;t++) {
+            std::size_t at=0;
+            for(int i=0;i<2000;i++) {
+                at=text.find("thread "+std::to_string(t)+" line "+std::to_string(i)+"\n",at);
+                if(at==std::string::npos) return false;
+            }
+        }
+
+        // Colors kept when asked, lines dropped and counted when the ring is full.
+        std::ostringstream colored;
+        log_sink keep(colored,log_options{1<<16,log_overflow::drop,log_colors::keep});
+        log_line(keep)<<COLOR1<<"red"<<NOCOLO;
+        keep.flush();
+        if(colored.str()!=COLOR1+"red"+NOCOLO+"\n") return false;
+
+        // A thread logging to two sinks in turn keeps a ring in each.
+        std::ostringstream first,second;
+        {
+            log_sink one(first),two(second);
+            for(int i=0;i<500;i++) {
+                log_line(one)<<"one "<<i;
+                log_line(two)<<"two "<<i;
+            }
+        }
+        for(int i=0,at1=0,at2=0;i<500;i++) {
+            at1=int(first.str().find("one "+std::to_string(i)+"\n",std::size_t(at1)));
+            at2=int(second.str().find("two "+std::to_string(i)+"\n",std::size_t(at2)));
+            if(at1<0 || at2<0) return false;
+        }
+        if(first.str().find("two")!=std::string::npos || second.str().find("one")!=std::string::npos) return false;
+
+        log_sink unbound(log_options{64});
+        std::size_t accepted=0;
+        for(int i=0;i<100;i++) accepted+=unbound.log("0123456789\n");
+        if(accepted!=4 || unbound.dropped()!=96) return false;
+        unbound.flush();
+
+        o<<COLOR2<<"END OF tests for logging."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_profiling(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for profiling..."<<NOCOLO<<std::endl;
+
+        auto phase=[](int i) {
+            PROFILE_SCOPE("test.phase");
+            PROFILE_COUNT("test.items",i%4);
+            volatile double x=0;
+            for(int k=0;k<100;k++) x=x+std::sqrt(double(k+i));
+        };
+        std::vector<std::thread> threads;
+        for(int t=0;t<3;t++) threads.emplace_back([&phase] { for(int i=0;i<1000;i++) phase(i); });
+        for(int i=0;i<500;i++) phase(i);
+        threads.front().join();
+
+        // Finished and living threads both counted.
+        const auto all=profile_summaries();
+        auto find=[&all](const char* name) {
+            return std::find_if(all.begin(),all.end(),[name](const profile_summary& s) { return s.name==name; });
+        };
+        const auto timer=find("test.phase"),items=find("test.items");
+        if(timer==all.end() || items==all.end() || timer->kind!=profile_kind::timer) return false;
+        if(timer->count<1500 || timer->count>3500 || timer->total<=0) return false;
+        if(timer->lowest>timer->median || timer->median>timer->highest || timer->p99>timer->highest) return false;
+        for(std::size_t t=1;t<threads.size();t++) threads[t].join();
+        const auto joined=profile_summaries();
+        const auto counted=std::find_if(joined.begin(),joined.end(),
+                                        [](const profile_summary& s) { return s.name=="test.items"; });
+        if(counted->count!=3500 || counted->total!=3*1500+750 || counted->lowest!=0 || counted->highest!=3)
+            return false;
+
+        std::ostringstream report,json;
+        report<<profile_report();
+        write_profile_json(json);
+        if(report.str().find("test.phase")==std::string::npos || report.str().find("test.items")==std::string::npos)
+            return false;
+        if(json.str().find("{\"name\":\"test.items\",\"kind\":\"counter\",\"count\":3500,\"total\":5250")
+           ==std::string::npos) return false;
+
+        o<<COLOR2<<"END OF tests for profiling."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_memory_pools(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for memory pools..."<<NOCOLO<<std::endl;
+        using namespace merry_tools::memory;
+
+        struct agent { double pos[3]; std::uint32_t id; };
+        object_pool<agent> agents(256);
+        std::vector<agent*> alive;
+        for(std::uint32_t i=0;i<1000;i++) alive.push_back(agents.create(agent{{1.0*i,0,0},i}));
+        for(std::size_t i=0;i<alive.size();i++)
+            if(alive[i]->id!=i || reinterpret_cast<std::uintptr_t>(alive[i])%alignof(agent)!=0) return false;
+        for(std::size_t i=0;i<alive.size();i+=2) agents.destroy(alive[i]);
+        if(!agents.validate() || agents.capacity()<1000) return false;
+
+        // Threads allocate and free in their own caches, blocks freed by other threads too.
+        const std::size_t before=agents.capacity();
+        std::vector<std::thread> threads;
+        std::atomic<bool> wrong{false};
+        for(int t=0;t<4;t++)
+            threads.emplace_back([&,t] {
+                std::vector<agent*> mine;
+                for(int round=0;round<20;round++) {
+                    for(std::uint32_t i=0;i<200;i++) mine.push_back(agents.create(agent{{0,0,0},i+1000u*t}));
+                    for(std::size_t i=0;i<mine.size();i++) if(mine[i]->id!=i%200+1000u*t) wrong=true;
+                    for(agent* a:mine) agents.destroy(a);
+                    mine.clear();
+                }
+                if(t==0) for(std::size_t i=1;i<alive.size();i+=2) agents.destroy(alive[i]);
+            });
+        for(std::thread& t:threads) t.join();
+        if(wrong || !agents.validate() || agents.capacity()>before+4*512) return false;
+
+        // Reset frees everything, memory is reused.
+        agents.reset();
+        for(std::uint32_t i=0;i<1000;i++) agents.create(agent{{0,0,0},i});
+        if(agents.capacity()!=std::max<std::size_t>(before,agents.capacity()) || !agents.validate()) return false;
+
+        // A thread using two pools in turn keeps a cache in each, blocks never cross between them.
+        struct mark { std::uint16_t v; };
+        object_pool<agent> left(64);
+        object_pool<mark>  right(64);
+        for(std::uint32_t i=0;i<10000;i++) {
+            agent* a=left.create(agent{{0,0,0},i});
+            mark*  m=right.create(mark{std::uint16_t(i)});
+            if(a->id!=i || m->v!=std::uint16_t(i)) return false;
+            left.destroy(a);
+            right.destroy(m);
+        }
+        if(left.capacity()!=64 || right.capacity()!=64 || !left.validate() || !right.validate()) return false;
+
+        block_pool bytes(40,64,16);
+        void* b=bytes.allocate();
+        if(reinterpret_cast<std::uintptr_t>(b)%64!=0 || bytes.block_size()!=40) return false;
+        if(pool_guards) {
+            static_cast<unsigned char*>(b)[40]^=0xFF;          // One byte past the block.
+            if(bytes.validate()) return false;
+            static_cast<unsigned char*>(b)[40]^=0xFF;
+        }
+        bytes.deallocate(b);
+        if(!bytes.validate()) return false;
+
+        guarded_arena arena(1024);
+        for(int step=0;step<3;step++) {
+            for(int i=0;i<100;i++) {
+                double* d=arena.allocate<double>(std::size_t(i%7+1));
+                if(reinterpret_cast<std::uintptr_t>(d)%alignof(double)!=0) return false;
+                d[i%7]=i;
+            }
+            auto* wide=static_cast<unsigned char*>(arena.allocate(10,128));
+            if(reinterpret_cast<std::uintptr_t>(wide)%128!=0 || !arena.validate()) return false;
+            if(pool_guards) {
+                wide[-1]^=0xFF;                                 // One byte before the block.
+                if(arena.validate()) return false;
+                wide[-1]^=0xFF;
+            }
+            if(arena.used()==0) return false;
+            arena.reset();
+            if(arena.used()!=0) return false;
+        }
+
+        o<<COLOR2<<"END OF tests for memory pools."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_guard_registry(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for the registry of guards..."<<NOCOLO<<std::endl;
+        using namespace merry_tools::memory;
+
+        struct plain { MEMORY_GUARD(std::uint32_t,0x600DF00D) int x=1; };
+        plain p;
+        if(!p.valid_memory(&p) || p.valid_memory(nullptr)) return false;
+
+        struct body { REGISTERED_MEMORY_GUARD(std::uint32_t,0xB0D1E5u) double mass=1; };
+        if(!WB_REGISTERED_GUARDS) return true;
+        const std::size_t before=registered_guards();
+
+        // Threads create bodies, each destroys half of its own and half of those of the next thread.
+        constexpr int threads_count=4;
+        constexpr std::size_t per_thread=6000;
+        std::vector<std::vector<std::unique_ptr<body>>> made(threads_count),more(threads_count);
+        std::vector<std::thread> threads;
+        for(int t=0;t<threads_count;t++)
+            threads.emplace_back([&,t] {
+                for(std::size_t i=0;i<per_thread;i++) made[t].push_back(std::make_unique<body>());
+                for(std::size_t i=0;i<per_thread;i+=4) made[t][i].reset();
+            });
+        for(std::thread& t:threads) t.join();
+        threads.clear();
+        for(int t=0;t<threads_count;t++)
+            threads.emplace_back([&,t] {
+                auto& next=made[(t+1)%threads_count];
+                for(std::size_t i=1;i<per_thread;i+=4) next[i].reset();
+                for(std::size_t i=0;i<per_thread/2;i++) more[t].push_back(std::make_unique<body>());
+            });
+        for(std::thread& t:threads) t.join();
+
+        const std::size_t expected=threads_count*(per_thread/2+per_thread/2);
+        guard_report all=validate_all();
+        if(!all.ok() || all.checked!=before+expected || registered_guards()!=before+expected) return false;
+        for(const auto& m:more) for(const auto& b:m) if(!b->valid_memory(b.get())) return false;
+
+        // Two guards overwritten by stray writes, only one address kept.
+        body* hit=made[0][2].get();
+        body* other=made[1][3].get();
+        const std::uint32_t wrong=0x12345678u,zero=0;
+        std::uint32_t keep_hit,keep_other;
+        std::memcpy(&keep_hit,hit,4); std::memcpy(&keep_other,other,4);
+        std::memcpy(static_cast<void*>(hit),&wrong,4); std::memcpy(static_cast<void*>(other),&zero,4);
+        all=validate_all(2,1);
+        const bool found=all.overwritten==2 && all.damaged.size()==1
+                         && (all.damaged[0]==hit || all.damaged[0]==other) && !hit->valid_memory(hit);
+        std::memcpy(static_cast<void*>(hit),&keep_hit,4); std::memcpy(static_cast<void*>(other),&keep_other,4);
+        if(!found || !validate_all().ok()) return false;
+
+        // Copies are registered on their own, slots of destroyed bodies are reused.
+        body copy=*made[0][2];
+        if(registered_guards()!=before+expected+1 || !copy.valid_memory(&copy)) return false;
+        made.clear();
+        more.clear();
+        if(registered_guards()!=before+1) return false;
+        all=validate_all();
+        if(!all.ok() || all.checked!=before+1) return false;
+
+        o<<COLOR2<<"END OF tests for the registry of guards."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_geodesy(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for geodesy..."<<NOCOLO<<std::endl;
+        using namespace merry_tools::math;
+        auto geo=[](double lat,double lon,double h) {
+            return xD(GeoLatitude{AngleSI64{lat}},GeoLongitude{AngleSI64{lon}},GeoHeight{DistSI64{h}});
+        };
+        auto near=[](double a,double b,double eps) { return std::fabs(a-b)<=eps; };
+
+        // Known points of WGS 84.
+        const EarthPosition equator=to_earth(geo(0,0,0));
+        if(!near(equator.x.val.value,wgs84.a,1e-6) || !near(equator.y.val.value,0,1e-6)) return false;
+        const EarthPosition pole=to_earth(geo(std::acos(-1.0)/2,0,100));
+        if(!near(pole.z.val.value,wgs84.b()+100,1e-6) || !near(std::hypot(pole.x.val.value,pole.y.val.value),0,1e-6))
+            return false;
+        const GeoPosition back=to_geo(equator);
+        if(!near(back.lat.val.value,0,1e-12) || !near(back.height.val.value,0,1e-6)) return false;
+
+        // The origin of a frame is its zero, a point above it is up.
+        const local_frame frame(geo(0.8,0.3,120));
+        const VolumePosition64 zero=to_local(frame.origin(),frame);
+        const VolumePosition64 up=to_local(geo(0.8,0.3,1120),frame);
+        if(!near(zero.x.val.value,0,1e-6) || !near(zero.y.val.value,0,1e-6) || !near(zero.z.val.value,0,1e-6))
+            return false;
+        if(!near(up.x.val.value,0,1e-6) || !near(up.y.val.value,0,1e-6) || !near(up.z.val.value,1000,1e-6))
+            return false;
+        const VolumePosition64 north=to_local(geo(0.8001,0.3,120),frame);
+        if(north.y.val.value<600 || !near(north.x.val.value,0,1e-6)) return false;
+
+        // Batches round trip for every instruction set, and agree with single positions.
+        constexpr std::size_t n=37;
+        std::vector<GeoPosition> places;
+        for(std::size_t i=0;i<n;i++) places.push_back(geo(-1.5+i*0.08,-3.1+i*0.17,-400.0+i*250));
+        std::vector<EarthPosition> earth(n,equator),again(n,equator);
+        std::vector<GeoPosition> geo_back(places);
+        std::vector<VolumePosition64> local(n,zero);
+        std::vector<VolumePosition> local32(n,VolumePosition{zero});
+        for(int l=int(simd::level::scalar);l<=int(simd::detected());l++) {
+            simd::use(simd::level(l));
+            batch_to_earth(span_of(std::as_const(places)),span_of(earth));
+            batch_to_geo(span_of(earth),span_of(geo_back));
+            batch_earth_to_local(span_of(earth),span_of(local),frame);
+            batch_local_to_earth(span_of(local),span_of(again),frame);
+            for(std::size_t i=0;i<n;i++) {
+                const EarthPosition single=to_earth(places[i]);
+                if(!near(single.x.val.value,earth[i].x.val.value,1e-6)) return false;
+                if(!near(geo_back[i].lat.val.value,places[i].lat.val.value,1e-12)
+                || !near(geo_back[i].lon.val.value,places[i].lon.val.value,1e-12)
+                || !near(geo_back[i].height.val.value,places[i].height.val.value,1e-6)) return false;
+                if(!near(again[i].z.val.value,earth[i].z.val.value,1e-6)) return false;
+            }
+            batch_geo_to_local(span_of(places),span_of(local),frame);
+            batch_local_to_geo(span_of(local),span_of(geo_back),frame);
+            batch_geo_to_local(span_of(places),span_of(local32),frame);
+            for(std::size_t i=0;i<n;i++) {
+                const VolumePosition64 single=to_local(places[i],frame);
+                if(!near(single.z.val.value,local[i].z.val.value,1e-6)) return false;
+                if(!near(geo_back[i].lat.val.value,places[i].lat.val.value,1e-12)
+                || !near(geo_back[i].height.val.value,places[i].height.val.value,1e-6)) return false;
+                const double wide=local[i].x.val.value;
+                if(!near(local32[i].x.val.value,wide,std::fabs(wide)*1e-6)) return false;
+            }
+            o<<COLOR5<<"Geodesy "<<COLOR3<<simd::name(simd::active())<<COLOR5<<" OK"<<NOCOLO<<std::endl;
+        }
+        simd::use(simd::detected());
+
+        // The Earth is about 1 AU from the Sun, nearer in January, and positions come back.
+        const solar_frame january(TimeSI64{0.0});
+        const solar_frame july(TimeSI64{182.5*86400});
+        auto distance=[](const SolarPosition& p) {
+            return std::sqrt(p.x.val.value*p.x.val.value+p.y.val.value*p.y.val.value+p.z.val.value*p.z.val.value);
+        };
+        const double au=1.495978707e11;
+        if(!near(distance(january.earth_center()),0.983*au,0.002*au)) return false;
+        if(!near(distance(july.earth_center()),1.0167*au,0.002*au)) return false;
+        if(!near(january.earth_center().z.val.value,0,1e-4*au)) return false;          // In the ecliptic.
+        std::vector<SolarPosition> solar(n,january.earth_center());
+        batch_to_solar(span_of(earth),span_of(solar),july);
+        batch_solar_to_earth(span_of(solar),span_of(again),july);
+        for(std::size_t i=0;i<n;i++) {
+            if(!near(again[i].x.val.value,earth[i].x.val.value,1e-3)) return false;
+            const SolarPosition single=to_solar(earth[i],july);
+            if(!near(single.y.val.value,solar[i].y.val.value,1e-3)) return false;
+            if(!near(distance(solar[i]-july.earth_center()),std::sqrt(earth[i].x.val.value*earth[i].x.val.value
+                     +earth[i].y.val.value*earth[i].y.val.value+earth[i].z.val.value*earth[i].z.val.value),1e-3))
+                return false;
+        }
+
+        o<<COLOR2<<"END OF tests for geodesy."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_anchored_positions(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for anchored positions..."<<NOCOLO<<std::endl;
+        using namespace merry_tools::math;
+        auto wide=[](double x,double y,double z) {
+            return VolumePosition64{Scalar<Along,DistSI64>{DistSI64{x}},Scalar<Across,DistSI64>{DistSI64{y}},
+                                    Scalar<Upward,DistSI64>{DistSI64{z}}};
+        };
+
+        // Far from zero positions keep their millimetres, which plain floats lose.
+        AnchoredArray<VolumePosition> bodies(DistSI{1024.f});
+        const std::size_t n=1000;
+        std::vector<double> ref(3*n);
+        VecArray<VolumeVelocity> vel(n);
+        for(std::size_t i=0;i<n;i++) {
+            ref[3*i]=1e9+i*0.001; ref[3*i+1]=-2.5e8+i*700.0; ref[3*i+2]=0.125*i;
+            bodies.push_back(wide(ref[3*i],ref[3*i+1],ref[3*i+2]));
+            vel.set(i,VolumeVelocity{VelAlong{VelocitySI{float(i%7)*31.f}},VelAcross{VelocitySI{-250.f}},
+                                     VelUpward{VelocitySI{float(i%3)-1.f}}});
+        }
+        if(bodies.size()!=n || float(ref[3*(n-1)])!=float(ref[3*(n-2)])) return false;
+        for(std::size_t i=0;i<n;i++) {
+            const auto p=bodies.get(i);
+            if(std::fabs(p.x.val.value-ref[3*i])>1e-4 || std::fabs(p.y.val.value-ref[3*i+1])>1e-4) return false;
+            if(std::fabs(bodies.offset(i).x.val.value)>512 || bodies.region_of(i)!=bodies.region_of(p)) return false;
+        }
+
+        // Steps in float move elements between regions, rebasing changes no position.
+        std::size_t moved=0;
+        for(int step=0;step<100;step++) {
+            moved+=bodies.advance(vel,TimeSpan{0.5_s});
+            for(std::size_t i=0;i<n;i++) {
+                const VolumeVelocity v=vel.get(i);
+                ref[3*i]+=double(v.x.val.value)*0.5; ref[3*i+1]+=double(v.y.val.value)*0.5;
+                ref[3*i+2]+=double(v.z.val.value)*0.5;
+            }
+        }
+        if(moved==0) return false;
+        for(std::size_t i=0;i<n;i++) {
+            const auto p=bodies.get(i);
+            if(std::fabs(p.x.val.value-ref[3*i])>0.01 || std::fabs(p.y.val.value-ref[3*i+1])>0.01
+            || std::fabs(p.z.val.value-ref[3*i+2])>0.01) return false;
+            if(std::fabs(bodies.offset(i).y.val.value)>1024) return false;
+        }
+        bodies.offsets().set(0,VolumePosition{Longitude{DistSI{3000.5f}},Latitude{0_m},Altitude{DistSI{-1500.25f}}});
+        const auto before=bodies.get(0);
+        if(bodies.rebase(0,1)!=1) return false;
+        const auto after=bodies.get(0);
+        if(before.x.val.value!=after.x.val.value || before.z.val.value!=after.z.val.value) return false;
+        if(bodies.offset(0).x.val.value!=3000.5f-3*1024 || bodies.offset(0).z.val.value!=-1500.25f+1024) return false;
+        if(bodies.rebase()!=0) return false;
+
+        // Float positions around a region and between elements.
+        const auto centre=bodies.region_of(n/2);
+        VecArray<VolumePosition> around;
+        bodies.relative_to(centre,around);
+        const auto origin=bodies.origin(centre);
+        for(std::size_t i=0;i<n;i++) {
+            const auto p=bodies.get(i);
+            const double expected=p.y.val.value-origin.y.val.value;
+            if(std::fabs(around.get(i).y.val.value-expected)>std::fabs(expected)*1e-6+1e-3) return false;
+        }
+        const VolumePosition d=bodies.difference(n/2+1,n/2);
+        if(std::fabs(d.y.val.value-(bodies.get(n/2+1).y.val.value-bodies.get(n/2).y.val.value))>1e-3) return false;
+
+        // Regions farther apart than the range of their indices.
+        AnchoredArray<VolumePosition> far(DistSI{1.f});
+        far.push_back(wide(2e9,0,0));
+        far.push_back(wide(-2e9,0,0));
+        far.relative_to(far.region_of(1),around);
+        if(std::fabs(around.get(0).x.val.value-4e9f)>1e3f || std::fabs(far.difference(1,0).x.val.value+4e9f)>1e3f)
+            return false;
+
+        // Earth centred and planar positions.
+        AnchoredArray<EarthOffset> earth;
+        const EarthPosition surface=to_earth(xD(GeoLatitude{AngleSI64{0.7}},GeoLongitude{AngleSI64{0.2}},
+                                                GeoHeight{DistSI64{10.0}}));
+        earth.push_back(surface);
+        if(std::fabs(earth.get(0).z.val.value-surface.z.val.value)>1e-3 || earth.extent().value!=4096) return false;
+        AnchoredArray<PlanePosition> plane(DistSI{64.f});
+        plane.resize(2);
+        plane.offsets().set(1,PlanePosition{Longitude{DistSI{-100.f}},Latitude{DistSI{65.f}}});
+        if(plane.rebase()!=1 || plane.region_of(1)[0]!=-2 || plane.region_of(1)[1]!=1) return false;
+
+        o<<COLOR2<<"END OF tests for anchored positions."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_units(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for scaled units..."<<NOCOLO<<std::endl;
+        using namespace merry_tools::math;
+
+        // Literals are SI constants.
+        static_assert((5_km).value==5000.f && (1.5_km).value==1500.f && (2_h).value==7200.f);
+        static_assert((36_km_h).value==10.f && (20_degC).value==293.15f && TempCelsius{-40.0}.si().value==233.15f);
+        static_assert(std::is_same_v<TempCelsius::si_type,TempSI> && std::is_same_v<DistKm64::si_type,DistSI64>);
+        static_assert(DistKm{2.5}.si().value==2500.f && TempCelsius{TempSI{273.15f}}.value==0.f);
+        if(std::string(VelocityKmH::abbreviation())!="[km/h]" || std::string(TempCelsius::abbreviation())!="[degC]")
+            return false;
+
+        // Conversion at the boundary, then SI only.
+        const DistKm trip{12.5};
+        const TimeHour duration{0.25};
+        const DistSI longer=trip+100_m;
+        if(longer.value!=12600.f || (100_m+trip).value!=12600.f || (trip+trip).value!=25.f) return false;
+        const VelocitySI speed=trip.si()/duration.si();
+        if(std::fabs(VelocityKmH{speed}.value-50.f)>1e-4f) return false;
+        const TempCelsius warm{21.5};
+        const TempSI kelvin=warm;
+        if(std::fabs(kelvin.value-294.65f)>1e-4f || std::fabs(TempCelsius{kelvin}.value-21.5f)>1e-4f) return false;
+        if(std::fabs(TempCelsius64{TempCelsius64{-12.25}.si()}.value+12.25)>1e-12) return false;
+
+        // Batches agree with single conversions on every level of kernels.
+        const std::size_t n=1003;
+        std::vector<TempCelsius> temps;
+        std::vector<DistKm64> dists;
+        for(std::size_t i=0;i<n;i++) { temps.push_back(float(i)*0.37f-80.f); dists.push_back(double(i)*1.25e3-7.0); }
+        std::vector<TempSI> temps_si(n,TempSI{0.f});
+        std::vector<TempCelsius> temps_back(n,TempCelsius{0.f});
+        std::vector<DistSI64> dists_si(n,DistSI64{0.0});
+        for(int l=int(simd::level::scalar);l<=int(simd::detected());l++) {
+            simd::use(simd::level(l));
+            batch_to_si(span_of(std::as_const(temps)),span_of(temps_si));
+            batch_from_si(span_of(std::as_const(temps_si)),span_of(temps_back));
+            batch_to_si(span_of(dists),span_of(dists_si));
+            for(std::size_t i=0;i<n;i++) {
+                if(std::fabs(temps_si[i].value-temps[i].si().value)>1e-4f) return false;
+                if(std::fabs(temps_back[i].value-temps[i].value)>1e-3f) return false;
+                if(dists_si[i].value!=dists[i].si().value) return false;
+            }
+        }
+        simd::use(simd::detected());
+
+        // A column read in km converted in place.
+        VecArray<PlanePosition> track(n);
+        for(std::size_t i=0;i<n;i++)
+            track.set(i,PlanePosition{Longitude{DistSI{float(i)*0.5f}},Latitude{DistSI{-float(i)}}});
+        batch_to_si<km_unit>(track.xs(),track.xs(),n);
+        batch_to_si<km_unit>(track.ys(),track.ys(),n);
+        if(track.get(10).x.val.value!=5000.f || track.get(10).y.val.value!=-10000.f) return false;
+        batch_from_si<km_unit>(track.xs(),track.xs(),n);
+        if(std::fabs(track.get(n-1).x.val.value-float(n-1)*0.5f)>1e-4f) return false;
+
+        o<<COLOR2<<"END OF tests for scaled units."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_vector_algebra(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for vector algebra..."<<NOCOLO<<std::endl;
+        using namespace merry_tools::math;
+        const VolumePosition r{Longitude{3_m},Latitude{DistSI{-4.f}},Altitude{12_m}};
+        const VolumeVelocity v{VelAlong{2_m_s},VelAcross{VelocitySI{1.f}},VelUpward{VelocitySI{-2.f}}};
+
+        // Units of products follow the dimensions.
+        static_assert(std::is_same_v<decltype(dot(r,r)),AreaSI> && std::is_same_v<decltype(norm(v)),VelocitySI>);
+        static_assert(std::is_same_v<decltype(cross(r,v).x.val),DerivedSI<2,0,-1,0>>);
+        const VolumeAcceleration g{AccAlong{0_m_s2},AccAcross{0_m_s2},AccUpward{AccelerationSI{-9.81f}}};
+        static_assert(std::is_same_v<decltype(dot(g,v)),si_quantity_for<2,0,-3,0>::type>);
+        static_assert(std::is_same_v<decltype(norm(VolumePosition64{r})),DistSI64>);
+        if(dot(r,r).value!=169.f || norm(r).value!=13.f || norm(v).value!=3.f || norm2(v).value!=9.f) return false;
+        const auto l=cross(r,v);
+        if(l.x.val.value!=-4.f || l.y.val.value!=30.f || l.z.val.value!=11.f) return false;
+        if(dot(l,r).value!=0.f || dot(l,v).value!=0.f) return false;
+        const PlanePosition a{Longitude{2_m},Latitude{1_m}},b{Longitude{DistSI{-1.f}},Latitude{3_m}};
+        if(cross(a,b).value!=7.f || dot(a,b).value!=1.f) return false;
+
+        // Directions are dimensionless, times a quantity they are vectors again.
+        const auto d=normalize(v);
+        if(std::fabs(dot(d,d)-1.f)>1e-6f) return false;
+        const VolumeVelocity faster=d*VelocitySI{6.f};
+        if(std::fabs(faster.x.val.value-4.f)>1e-5f || std::fabs(faster.z.val.value+4.f)>1e-5f) return false;
+        if(normalize(VolumePosition{Longitude{0_m},Latitude{0_m},Altitude{0_m}}).z!=0.f) return false;
+
+        // Rotations on typed axes.
+        typedef Mat3<flat_axes,flat_axes> Rot;
+        const Rot yaw=Rot::rotation_about<Upward>(AngleSI64{std::acos(-1.0)/2});
+        const VolumePosition turned=yaw*r;
+        if(std::fabs(turned.x.val.value-4.f)>1e-5f || std::fabs(turned.y.val.value-3.f)>1e-5f
+        || turned.z.val.value!=12.f) return false;
+        const Rot any=Rot::rotation(normalize(r),AngleSI64{0.7});
+        const VolumePosition same=any*r;
+        const VolumeVelocity back=any.transposed()*(any*v);
+        if(std::fabs(norm(same).value-13.f)>1e-4f || std::fabs(same.y.val.value+4.f)>1e-4f) return false;
+        if(std::fabs(back.x.val.value-2.f)>1e-5f || std::fabs(any.determinant()-1.f)>1e-5f) return false;
+        const Rot none=any.transposed()*any;
+        for(int i=0;i<3;i++) for(int j=0;j<3;j++) if(std::fabs(none.m[i][j]-(i==j))>1e-6f) return false;
+
+        // The rotation of a local frame agrees with its transform.
+        const local_frame frame(xD(GeoLatitude{AngleSI64{0.9}},GeoLongitude{AngleSI64{-0.3}},GeoHeight{DistSI64{0.0}}));
+        const EarthPosition up_there=to_earth(xD(GeoLatitude{AngleSI64{0.9}},GeoLongitude{AngleSI64{-0.3}},
+                                                 GeoHeight{DistSI64{100.0}}));
+        const VolumePosition64 local=frame.rotation()*EarthPosition{up_there-frame.origin_earth()};
+        if(std::fabs(local.z.val.value-100.0)>1e-6 || std::fabs(local.x.val.value)>1e-6) return false;
+        if(std::fabs(frame.rotation().determinant()-1.0)>1e-12) return false;
+
+        // Batches on every level of kernels agree with single vectors.
+        const std::size_t n=1027;
+        VecArray<VolumeVelocity> vel(n);
+        VecArray<PlaneVelocity> flat(n);
+        VecArray<VolumePosition64> wide(n);
+        for(std::size_t i=0;i<n;i++) {
+            const float f=float(i);
+            vel.set(i,VolumeVelocity{VelAlong{VelocitySI{f*0.5f-100.f}},VelAcross{VelocitySI{f*f*1e-3f}},
+                                     VelUpward{VelocitySI{i%5==0?0.f:3.f}}});
+            flat.set(i,PlaneVelocity{VelAlong{VelocitySI{f}},VelAcross{VelocitySI{-2.f*f}}});
+            wide.set(i,VolumePosition64{Scalar<Along,DistSI64>{DistSI64{1e7+i}},
+                                        Scalar<Across,DistSI64>{DistSI64{-1.0*i}},Scalar<Upward,DistSI64>{DistSI64{0.5}}});
+        }
+        vel.set(7,VolumeVelocity{VelAlong{VelocitySI{0.f}},VelAcross{VelocitySI{0.f}},VelUpward{VelocitySI{0.f}}});
+        std::vector<VelocitySI> norms(n,VelocitySI{0.f}),old(n,VelocitySI{0.f});
+        std::vector<DistSI64> wide_norms(n,DistSI64{0.0});
+        const simd::precision modes[]={simd::precision::fast,simd::precision::refined,simd::precision::exact};
+        const float tolerance[]={4e-4f,2e-6f,1e-6f};
+        for(int l=int(simd::level::scalar);l<=int(simd::detected());l++) {
+            simd::use(simd::level(l));
+            for(int m=0;m<3;m++) {
+                batch_norm(vel,span_of(norms),modes[m]);
+                for(std::size_t i=0;i<n;i++) {
+                    const float expected=norm(vel.get(i)).value;
+                    if(std::fabs(norms[i].value-expected)>expected*tolerance[m]) return false;
+                }
+                VecArray<VolumeVelocity> unit(n);
+                batch_convert(vel,unit);
+                batch_normalize(unit,VelocitySI{2.f},span_of(old),modes[m]);
+                for(std::size_t i=0;i<n;i++) {
+                    const float len=norm(unit.get(i)).value;
+                    if(i==7 ? len!=0.f || old[i].value!=0.f : std::fabs(len-2.f)>4*tolerance[m]) return false;
+                }
+                batch_norm(flat,span_of(norms),modes[m]);
+                if(std::fabs(norms[n-1].value-norm(flat.get(n-1)).value)>norms[n-1].value*tolerance[m]) return false;
+            }
+            batch_norm(wide,span_of(wide_norms));
+            VecArray<VolumePosition64> wide_unit(n);
+            batch_convert(wide,wide_unit);
+            batch_normalize(wide_unit,DistSI64{1.0});
+            for(std::size_t i=0;i<n;i++) {
+                if(std::fabs(wide_norms[i].value-norm(wide.get(i)).value)>1e-8) return false;
+                if(std::fabs(norm(wide_unit.get(i)).value-1.0)>1e-14) return false;
+            }
+        }
+        simd::use(simd::detected());
+
+        o<<COLOR2<<"END OF tests for vector algebra."<<NOCOLO<<std::endl;
+        return true;
+    }
+
+    bool test_nbody(std::ostream& o)
+    {
+        o<<COLOR2<<"Now tests for N-body gravity..."<<NOCOLO<<std::endl;
+        using namespace merry_tools::math;
+        typedef Gravity<VolumePosition,VolumeAcceleration> gravity;
+        static_assert(std::is_same_v<decltype(VecArray<VolumeAcceleration>{}.get(0).x.val),AccelerationSI>);
+        auto at=[](float x,float y,float z) {
+            return VolumePosition{Longitude{DistSI{x}},Latitude{DistSI{y}},Altitude{DistSI{z}}};
+        };
+
+        // Two bodies attract each other, also with masses as scalars.
+        gravity g;
+        VecArray<VolumePosition>     pos;
+        VecArray<VolumeAcceleration> acc;
+        pos.push_back(at(0,0,0)); pos.push_back(at(100,0,0));
+        const std::vector<MassQuan> pair{MassQuan{MassSI{1e10f}},MassQuan{MassSI{2e10f}}};
+        g.accelerations(pos,pair,acc);
+        const double a0=gravitational_constant*2e10/1e4,a1=-gravitational_constant*1e10/1e4;
+        if(acc.size()!=2 || std::fabs(acc.get(0).x.val.value/a0-1)>1e-5 || std::fabs(acc.get(1).x.val.value/a1-1)>1e-5)
+            return false;
+        if(acc.get(0).y.val.value!=0 || acc.get(1).z.val.value!=0) return false;
+        g.softening=100_m;                                                        // Plummer: d/(d^2+eps^2)^1.5
+        g.accelerations(pos,pair,acc);
+        if(std::fabs(acc.get(0).x.val.value/(gravitational_constant*2e10*100/std::pow(2e4,1.5))-1)>1e-5) return false;
+
+        // Bodies at the same place do not attract, with and without softening. No bodies, no accelerations.
+        pos.push_back(at(0,0,0));
+        const std::vector<MassSI> three{1e10_kg,1e10_kg,1e10_kg};
+        g.leaf_size=g.group_size=1;                                   // Equal positions in a leaf above both sizes.
+        for(float eps:{0.f,1.f}) {
+            g.softening=DistSI{eps};
+            for(gravity_method m:{gravity_method::direct,gravity_method::barnes_hut}) {
+                g.method=m;
+                g.accelerations(pos,three,acc);
+                const float x0=acc.get(0).x.val.value;
+                if(!std::isfinite(x0) || x0!=acc.get(2).x.val.value) return false;
+                if(acc.get(0).x.val.value<=0 || acc.get(1).x.val.value>=0) return false;
+            }
+        }
+        g.accelerations(VecArray<VolumePosition>{},std::vector<MassSI>{},acc);
+        if(!acc.empty()) return false;
+        g.method=gravity_method::automatic;
+        if(g.method_for(g.direct_limit)!=gravity_method::direct || g.method_for(1000000)!=gravity_method::barnes_hut)
+            return false;
+
+        // A cluster against a double precision sum, on all instruction sets. Not a multiple of SIMD width.
+        const std::size_t n=1501;
+        std::mt19937 rng(25);
+        std::uniform_real_distribution<float> place(-500.0f,500.0f),weight(1e6f,1e9f);
+        VecArray<VolumePosition> cluster(n);
+        std::vector<MassSI> masses(n,0_kg);
+        for(std::size_t i=0;i<n;i++) {
+            cluster.set(i,at(place(rng),place(rng),0.2f*place(rng)));
+            masses[i]=MassSI{weight(rng)};
+        }
+        const double eps=1.0;
+        std::vector<double> exact(3*n,0.0);
+        double rms=0;
+        for(std::size_t i=0;i<n;i++) {
+            const double xi=cluster.xs()[i],yi=cluster.ys()[i],zi=cluster.zs()[i];
+            for(std::size_t j=0;j<n;j++) {
+                const double d[3]={cluster.xs()[j]-xi,cluster.ys()[j]-yi,cluster.zs()[j]-zi};
+                const double r2=d[0]*d[0]+d[1]*d[1]+d[2]*d[2]+eps*eps;
+                const double w=gravitational_constant*masses[j].value/(r2*std::sqrt(r2));
+                for(std::size_t a=0;a<3;a++) exact[3*i+a]+=d[a]*w;
+            }
+            for(std::size_t a=0;a<3;a++) rms+=exact[3*i+a]*exact[3*i+a];
+        }
+        rms=std::sqrt(rms/double(n));
+        auto errors=[&](const VecArray<VolumeAcceleration>& a,double& max,double& mean) {
+            max=0; mean=0;
+            for(std::size_t i=0;i<n;i++) {
+                const double d[3]={a.xs()[i]-exact[3*i],a.ys()[i]-exact[3*i+1],a.zs()[i]-exact[3*i+2]};
+                const double e=std::sqrt(d[0]*d[0]+d[1]*d[1]+d[2]*d[2])/rms;
+                max=std::max(max,e); mean+=e*e;
+            }
+            mean=std::sqrt(mean/double(n));
+        };
+
+        gravity direct,tree,opened;
+        direct.method=gravity_method::direct;
+        tree.method=opened.method=gravity_method::barnes_hut;
+        tree.leaf_size=opened.leaf_size=8;
+        opened.theta=0;
+        direct.softening=tree.softening=opened.softening=DistSI{float(eps)};
+        direct.min_chunk=tree.min_chunk=opened.min_chunk=64;
+        VecArray<VolumeAcceleration> a_direct,a_tree,a_opened;
+        for(int l=int(simd::level::scalar);l<=int(simd::detected());l++) {
+            simd::use(simd::level(l));
+            direct.accelerations(cluster,masses,a_direct);
+            tree.accelerations(cluster,masses,a_tree);
+            opened.accelerations(cluster,masses,a_opened);
+            double max,mean;
+            errors(a_direct,max,mean);
+            if(max>1e-4) return false;
+            errors(a_opened,max,mean);
+            if(max>1e-4) return false;
+            errors(a_tree,max,mean);
+            if(mean>1e-2 || max>0.1) return false;
+            o<<"  "<<simd::name(simd::level(l))<<": Barnes-Hut error "<<mean<<" (max "<<max<<") of "
+             <<tree.tree_nodes()<<" nodes"<<std::endl;
+
+            // Newton's third law: the total momentum stays, up to rounding.
+            double p[3]={0,0,0},scale=0;
+            for(std::size_t i=0;i<n;i++) {
+                const double m=masses[i].value;
+                p[0]+=m*a_direct.xs()[i]; p[1]+=m*a_direct.ys()[i]; p[2]+=m*a_direct.zs()[i];
+                scale+=m*std::fabs(a_direct.xs()[i]);
+            }
+            if(std::fabs(p[0])+std::fabs(p[1])+std::fabs(p[2])>1e-5*scale) return false;
+        }
+        simd::use(simd::detected());
+        if(tree.tree_nodes()<n/8 || opened.tree_nodes()!=tree.tree_nodes()) return false;
+
+        o<<COLOR2<<"END OF tests for N-body gravity."<<NOCOLO<<std::endl;
+        return true;
+    }
+
 } // tests namespace
 
 int main() {
@@ -116,6 +1897,30 @@ int main() {
 
     if(!test_ios_benders(std::clog) ) return 1;
     if(!test_vectors_bending(std::clog)) return 2;
+    if(!test_vector_arrays(std::clog)) return 3;
+    if(!test_vector_batches(std::clog)) return 4;
+    if(!test_dimensional_analysis(std::clog)) return 5;
+    if(!test_precision_policy(std::clog)) return 6;
+    if(!test_lazy_expressions(std::clog)) return 7;
+    if(!test_integrators(std::clog)) return 8;
+    if(!test_fix_float(std::clog)) return 9;
+    if(!test_compact_arrays(std::clog)) return 10;
+    if(!test_spatial_index(std::clog)) return 11;
+    if(!test_reductions(std::clog)) return 12;
+    if(!test_task_pool(std::clog)) return 13;
+    if(!test_snapshots(std::clog)) return 14;
+    if(!test_trajectories(std::clog)) return 15;
+    if(!test_formatting(std::clog)) return 16;
+    if(!test_parsing(std::clog)) return 17;
+    if(!test_logging(std::clog)) return 18;
+    if(!test_profiling(std::clog)) return 19;
+    if(!test_memory_pools(std::clog)) return 20;
+    if(!test_guard_registry(std::clog)) return 21;
+    if(!test_geodesy(std::clog)) return 22;
+    if(!test_anchored_positions(std::clog)) return 23;
+    if(!test_units(std::clog)) return 24;
+    if(!test_vector_algebra(std::clog)) return 25;
+    if(!test_nbody(std::clog)) return 26;
 
     std::cout << "SUCCESS!" << std::endl;
     return 0;